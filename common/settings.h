@@ -105,6 +105,11 @@ struct Settings {
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
   bool purge_persistent_cache = false;
+  // Whether the layouts of words shaped by libtxt and the glyph coverage of
+  // fonts are kept in the persistent cache, so that the text of the first
+  // frames is not shaped again and font cmaps are not parsed again in the
+  // next runs.
+  bool persistent_shaping_cache = false;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
   bool disable_dart_asserts = false;
@@ -218,6 +223,33 @@ struct Settings {
   /// https://github.com/dart-lang/sdk/blob/ca64509108b3e7219c50d6c52877c85ab6a35ff2/runtime/vm/flag_list.h#L150
   int64_t old_gen_heap_size = -1;
 
+  /// The maximum number of bytes used by images in the raster cache, or 0 for
+  /// no limit. See `RasterCache::SetMaxBytes`.
+  size_t raster_cache_max_bytes = 0;
+
+  /// How many frames an unused raster cache entry is kept before it's evicted.
+  /// See `RasterCache::SetRetainedFrames`.
+  size_t raster_cache_retained_frames = 0;
+
+  /// Whether pictures are rasterized into the raster cache on a worker thread
+  /// instead of the raster thread. See `RasterCache::SetAsyncTaskRunner`.
+  bool enable_async_raster_cache = false;
+
+  /// The number of tiles software rendered frames are split into, which are
+  /// then rendered in parallel on the concurrent worker threads. 0 or 1 renders
+  /// frames on the raster thread only. See `TiledPictureRasterizer`.
+  size_t software_raster_tile_count = 0;
+
+  /// The number of frames of an animated image that are decoded on the
+  /// concurrent worker threads ahead of the frame requested from Dart, or 0 to
+  /// decode each frame on the IO thread when requested. See `MultiFrameCodec`.
+  size_t animated_image_lookahead_frames = 0;
+
+  /// The maximum number of bytes of uploaded frames each repeating animated
+  /// image keeps to replay later loops without decoding them again, or 0 to
+  /// keep none. See `MultiFrameCodec`.
+  size_t animated_image_frame_cache_bytes = 0;
+
   /// A timestamp representing when the engine started. The value is based
   /// on the clock used by the Dart timeline APIs. This timestamp is used
   /// to log a timeline event that tracks the latency of engine startup.
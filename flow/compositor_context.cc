@@ -4,11 +4,40 @@
 
 #include "flutter/flow/compositor_context.h"
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 
 namespace flutter {
 
+std::optional<SkIRect> FrameDamage::ComputeClipRect(
+    const LayerTree& layer_tree,
+    const SkISize& device_size,
+    const SkMatrix& root_surface_transformation) {
+  frame_damage_ = std::nullopt;
+  buffer_damage_ = std::nullopt;
+  if (!prev_layer_tree_ || prev_layer_tree_ == &layer_tree ||
+      !layer_tree.root_layer() || !prev_layer_tree_->root_layer() ||
+      prev_layer_tree_->frame_size() != layer_tree.frame_size() ||
+      prev_layer_tree_->device_pixel_ratio() !=
+          layer_tree.device_pixel_ratio()) {
+    return std::nullopt;
+  }
+
+  TRACE_EVENT0("flutter", "FrameDamage::ComputeClipRect");
+  DiffContext context(device_size, root_surface_transformation);
+  layer_tree.root_layer()->Diff(&context, prev_layer_tree_->root_layer());
+  frame_damage_ = context.damage();
+
+  SkIRect clip_rect = *frame_damage_;
+  clip_rect.join(additional_damage_);
+  if (!clip_rect.intersect(SkIRect::MakeSize(device_size))) {
+    clip_rect.setEmpty();
+  }
+  buffer_damage_ = clip_rect;
+  return buffer_damage_;
+}
+
 CompositorContext::CompositorContext(fml::Milliseconds frame_budget)
     : raster_time_(frame_budget), ui_time_(frame_budget) {}
 
@@ -69,7 +98,8 @@ CompositorContext::ScopedFrame::~ScopedFrame() {
 
 RasterStatus CompositorContext::ScopedFrame::Raster(
     flutter::LayerTree& layer_tree,
-    bool ignore_raster_cache) {
+    bool ignore_raster_cache,
+    FrameDamage* frame_damage) {
   TRACE_EVENT0("flutter", "CompositorContext::ScopedFrame::Raster");
   bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
@@ -85,9 +115,25 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kSkipAndRetryFrame) {
     return RasterStatus::kSkipAndRetry;
   }
+  std::optional<SkIRect> clip_rect;
+  if (frame_damage && canvas()) {
+    clip_rect =
+        frame_damage->ComputeClipRect(layer_tree, canvas()->getBaseLayerSize(),
+                                      root_surface_transformation());
+  }
+
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
+  const int restore_count = canvas() ? canvas()->getSaveCount() : 0;
   if (canvas()) {
+    if (clip_rect) {
+      // The damage is in device coordinates.
+      canvas()->save();
+      SkMatrix matrix = canvas()->getTotalMatrix();
+      canvas()->resetMatrix();
+      canvas()->clipRect(SkRect::Make(*clip_rect));
+      canvas()->setMatrix(matrix);
+    }
     if (needs_save_layer) {
       FML_LOG(INFO) << "Using SaveLayer to protect non-readback surface";
       SkRect bounds = SkRect::Make(layer_tree.frame_size());
@@ -98,8 +144,8 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
     canvas()->clear(SK_ColorTRANSPARENT);
   }
   layer_tree.Paint(*this, ignore_raster_cache);
-  if (canvas() && needs_save_layer) {
-    canvas()->restore();
+  if (canvas()) {
+    canvas()->restoreToCount(restore_count);
   }
   return RasterStatus::kSuccess;
 }
@@ -6,6 +6,7 @@
 #define FLUTTER_FLOW_COMPOSITOR_CONTEXT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "flutter/flow/embedded_views.h"
@@ -50,6 +51,54 @@ enum class RasterStatus {
   kDiscarded
 };
 
+// Tracks the damage of a frame relative to the previous frame so that only the
+// parts of the frame that changed need to be repainted.
+//
+// See |CompositorContext::ScopedFrame::Raster|.
+class FrameDamage {
+ public:
+  // The layer tree that was rasterized into the surface in the previous frame.
+  // Its layers are compared with the layers of the current tree to determine
+  // what changed. If not set, the whole frame is repainted.
+  void SetPreviousLayerTree(const LayerTree* prev_layer_tree) {
+    prev_layer_tree_ = prev_layer_tree;
+  }
+
+  // Adds damage that the target framebuffer has in addition to the changes
+  // between the two layer trees. For example, in a swapchain the buffer being
+  // rendered into may be a few frames older than the previous frame.
+  void AddAdditionalDamage(const SkIRect& damage) {
+    additional_damage_.join(damage);
+  }
+
+  // Computes the area of the frame (in device coordinates) that must be
+  // repainted, or std::nullopt if the whole frame has to be repainted. Must be
+  // called after |layer_tree| has been prerolled.
+  std::optional<SkIRect> ComputeClipRect(
+      const LayerTree& layer_tree,
+      const SkISize& device_size,
+      const SkMatrix& root_surface_transformation);
+
+  // The area of the frame that differs from the previous frame, as computed by
+  // the last call to |ComputeClipRect|. std::nullopt if unknown.
+  const std::optional<SkIRect>& GetFrameDamage() const {
+    return frame_damage_;
+  }
+
+  // The area of the framebuffer that was repainted, i.e. the result of the
+  // last call to |ComputeClipRect|. std::nullopt if the whole framebuffer was
+  // repainted.
+  const std::optional<SkIRect>& GetBufferDamage() const {
+    return buffer_damage_;
+  }
+
+ private:
+  const LayerTree* prev_layer_tree_ = nullptr;
+  SkIRect additional_damage_ = SkIRect::MakeEmpty();
+  std::optional<SkIRect> frame_damage_;
+  std::optional<SkIRect> buffer_damage_;
+};
+
 class CompositorContext {
  public:
   class ScopedFrame {
@@ -79,8 +128,13 @@ class CompositorContext {
 
     GrDirectContext* gr_context() const { return gr_context_; }
 
+    // Prerolls and paints |layer_tree| into the frame.
+    //
+    // If |frame_damage| is specified, painting is clipped to the area of the
+    // frame that changed since the previous frame (see |FrameDamage|).
     virtual RasterStatus Raster(LayerTree& layer_tree,
-                                bool ignore_raster_cache);
+                                bool ignore_raster_cache,
+                                FrameDamage* frame_damage);
 
    private:
     CompositorContext& context_;
@@ -0,0 +1,110 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+namespace flutter {
+
+DiffContext::DiffContext(const SkISize& frame_size,
+                         const SkMatrix& root_transformation)
+    : frame_rect_(SkRect::Make(frame_size)),
+      state_({root_transformation, frame_rect_}) {}
+
+DiffContext::~DiffContext() = default;
+
+DiffContext::AutoSubtreeRestore::AutoSubtreeRestore(DiffContext* context)
+    : context_(context) {
+  context_->saved_states_.push_back(context_->state_);
+}
+
+DiffContext::AutoSubtreeRestore::~AutoSubtreeRestore() {
+  context_->state_ = context_->saved_states_.back();
+  context_->saved_states_.pop_back();
+}
+
+void DiffContext::PushTransform(const SkMatrix& transform) {
+  state_.transform.preConcat(transform);
+}
+
+void DiffContext::ClipRect(const SkRect& clip) {
+  if (!state_.clip.intersect(MapRect(clip))) {
+    state_.clip.setEmpty();
+  }
+}
+
+SkRect DiffContext::MapRect(const SkRect& rect) const {
+  SkRect mapped;
+  // Perspective transforms don't map to useful rectangles, assume the worst.
+  if (state_.transform.hasPerspective()) {
+    mapped = frame_rect_;
+  } else {
+    state_.transform.mapRect(&mapped, rect);
+  }
+  return mapped;
+}
+
+void DiffContext::AddDamage(const SkRect& rect) {
+  if (rect.isEmpty()) {
+    return;
+  }
+  SkRect device_rect = MapRect(rect);
+  if (device_rect.intersect(state_.clip)) {
+    damage_.join(device_rect);
+    damage_count_++;
+  }
+}
+
+void DiffContext::MarkFullDamage() {
+  damage_ = frame_rect_;
+}
+
+void DiffContext::AddReadbackRegion(const SkRect& rect) {
+  SkRect device_rect = MapRect(rect);
+  if (device_rect.intersect(state_.clip)) {
+    readback_regions_.push_back(device_rect);
+  }
+}
+
+void DiffContext::AddBackdropReadbackRegion(const SkImageFilter* filter) {
+  if (state_.clip.isEmpty()) {
+    return;
+  }
+  SkRect region = state_.clip;
+  if (filter) {
+    if (state_.transform.hasPerspective()) {
+      region = frame_rect_;
+    } else {
+      region.set(filter->filterBounds(state_.clip.roundOut(), state_.transform,
+                                      SkImageFilter::kReverse_MapDirection));
+    }
+  }
+  if (region.intersect(frame_rect_)) {
+    readback_regions_.push_back(region);
+  }
+}
+
+SkIRect DiffContext::damage() const {
+  SkRect expanded = damage_;
+  // Growing the damage may make it touch other readback regions, so repeat
+  // until it's stable.
+  bool changed = !expanded.isEmpty();
+  while (changed) {
+    changed = false;
+    for (const SkRect& region : readback_regions_) {
+      if (SkRect::Intersects(expanded, region) && !expanded.contains(region)) {
+        expanded.join(region);
+        changed = true;
+      }
+    }
+  }
+
+  SkIRect damage = expanded.roundOut();
+  if (!damage.intersect(SkIRect::MakeWH(frame_rect_.width(),
+                                        frame_rect_.height()))) {
+    return SkIRect::MakeEmpty();
+  }
+  return damage;
+}
+
+}  // namespace flutter
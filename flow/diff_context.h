@@ -0,0 +1,106 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DIFF_CONTEXT_H_
+#define FLUTTER_FLOW_DIFF_CONTEXT_H_
+
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkImageFilter.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Accumulates the damage between the layer tree of the previous frame and the
+/// layer tree of the current frame.
+///
+/// The diff is performed by `Layer::Diff` after both trees have been prerolled
+/// (so that their paint bounds are known). Layers walk the old and new trees in
+/// lockstep, pushing their transforms and clips onto the context and reporting
+/// the local rects whose contents changed via `AddDamage`. The context maps
+/// those rects into device space and unions them into a single damage rect.
+///
+class DiffContext {
+ public:
+  DiffContext(const SkISize& frame_size, const SkMatrix& root_transformation);
+
+  ~DiffContext();
+
+  //----------------------------------------------------------------------------
+  /// Saves the current transform and clip and restores them when the scope is
+  /// destroyed. Layers that push transforms or clips must do so inside such a
+  /// scope.
+  ///
+  class AutoSubtreeRestore {
+   public:
+    explicit AutoSubtreeRestore(DiffContext* context);
+
+    ~AutoSubtreeRestore();
+
+   private:
+    DiffContext* context_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoSubtreeRestore);
+  };
+
+  // Concatenates |transform| to the current transform for the layers diffed
+  // within the current subtree.
+  void PushTransform(const SkMatrix& transform);
+
+  // Intersects the current clip with |clip| (in local coordinates). Damage
+  // outside of the clip is ignored since nothing in the subtree may paint
+  // there.
+  void ClipRect(const SkRect& clip);
+
+  // Marks the area covered by |rect| (in local coordinates) as damaged.
+  void AddDamage(const SkRect& rect);
+
+  // Marks the entire frame as damaged. Used when the previous frame can't be
+  // compared to the current one.
+  void MarkFullDamage();
+
+  // Registers an area (in local coordinates) whose rendering depends on what
+  // was painted below it, such as the area covered by a backdrop filter. If
+  // the final damage touches such an area, the whole area is damaged.
+  void AddReadbackRegion(const SkRect& rect);
+
+  // Registers the area read back by a backdrop |filter| painted at the
+  // current transform: everything under the current clip, grown by as far as
+  // the filter moves pixels.
+  void AddBackdropReadbackRegion(const SkImageFilter* filter);
+
+  // The number of times damage was added within the current clip. Layers
+  // compare it before and after diffing their children to find out whether
+  // anything below them changed.
+  size_t damage_count() const { return damage_count_; }
+
+  // The accumulated damage in device coordinates, rounded out to integral
+  // pixels and limited to the frame.
+  SkIRect damage() const;
+
+ private:
+  struct State {
+    SkMatrix transform;
+    SkRect clip;  // In device coordinates.
+  };
+
+  SkRect MapRect(const SkRect& rect) const;
+
+  const SkRect frame_rect_;
+  State state_;
+  std::vector<State> saved_states_;
+  SkRect damage_ = SkRect::MakeEmpty();
+  size_t damage_count_ = 0;
+  std::vector<SkRect> readback_regions_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DiffContext);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DIFF_CONTEXT_H_
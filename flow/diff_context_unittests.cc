@@ -0,0 +1,223 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/diff_context.h"
+
+#include "flutter/flow/layers/backdrop_filter_layer.h"
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/color_filter_layer.h"
+#include "flutter/flow/layers/container_layer.h"
+#include "flutter/flow/layers/texture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
+#include "flutter/flow/testing/layer_test.h"
+#include "flutter/flow/testing/mock_layer.h"
+#include "third_party/skia/include/core/SkColorFilter.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+namespace flutter {
+namespace testing {
+
+class DiffContextTest : public LayerTest {
+ public:
+  SkIRect Diff(Layer* layer, Layer* old_layer) {
+    layer->Preroll(preroll_context(), SkMatrix());
+    if (old_layer) {
+      old_layer->Preroll(preroll_context(), SkMatrix());
+    }
+    DiffContext context(SkISize::Make(1000, 1000), SkMatrix());
+    layer->Diff(&context, old_layer);
+    return context.damage();
+  }
+
+  static std::shared_ptr<MockLayer> MakeMockLayer(const SkRect& rect) {
+    return std::make_shared<MockLayer>(SkPath().addRect(rect));
+  }
+};
+
+TEST_F(DiffContextTest, MapsDamageToDeviceCoordinates) {
+  DiffContext context(SkISize::Make(100, 100), SkMatrix::Scale(2, 2));
+  {
+    DiffContext::AutoSubtreeRestore subtree(&context);
+    context.PushTransform(SkMatrix::Translate(10, 10));
+    context.AddDamage(SkRect::MakeXYWH(0, 0, 5, 5));
+  }
+  context.AddDamage(SkRect::MakeXYWH(0, 0, 1.5, 1.5));
+  EXPECT_EQ(context.damage(), SkIRect::MakeLTRB(0, 0, 30, 30));
+}
+
+TEST_F(DiffContextTest, DamageIsClipped) {
+  DiffContext context(SkISize::Make(100, 100), SkMatrix());
+  {
+    DiffContext::AutoSubtreeRestore subtree(&context);
+    context.ClipRect(SkRect::MakeXYWH(10, 10, 10, 10));
+    context.AddDamage(SkRect::MakeXYWH(0, 0, 50, 50));
+  }
+  EXPECT_EQ(context.damage(), SkIRect::MakeXYWH(10, 10, 10, 10));
+
+  context.AddDamage(SkRect::MakeXYWH(90, 90, 50, 50));
+  EXPECT_EQ(context.damage(), SkIRect::MakeLTRB(10, 10, 100, 100));
+}
+
+TEST_F(DiffContextTest, DamageExpandsToTouchedReadbackRegions) {
+  DiffContext context(SkISize::Make(100, 100), SkMatrix());
+  context.AddReadbackRegion(SkRect::MakeXYWH(0, 0, 20, 20));
+  context.AddReadbackRegion(SkRect::MakeXYWH(15, 15, 20, 20));
+  context.AddReadbackRegion(SkRect::MakeXYWH(80, 80, 10, 10));
+  context.AddDamage(SkRect::MakeXYWH(5, 5, 1, 1));
+  EXPECT_EQ(context.damage(), SkIRect::MakeLTRB(0, 0, 35, 35));
+}
+
+TEST_F(DiffContextTest, RetainedLayerHasNoDamage) {
+  auto layer = MakeMockLayer(SkRect::MakeXYWH(10, 10, 10, 10));
+  EXPECT_TRUE(Diff(layer.get(), layer.get()).isEmpty());
+}
+
+TEST_F(DiffContextTest, NewLayerDamagesOldAndNewBounds) {
+  auto old_layer = MakeMockLayer(SkRect::MakeXYWH(10, 10, 10, 10));
+  auto layer = MakeMockLayer(SkRect::MakeXYWH(40, 40, 10, 10));
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeLTRB(10, 10, 50, 50));
+  EXPECT_EQ(Diff(layer.get(), nullptr), SkIRect::MakeXYWH(40, 40, 10, 10));
+}
+
+TEST_F(DiffContextTest, TransformLayerDiffsOnlyChangedChildren) {
+  auto retained = MakeMockLayer(SkRect::MakeXYWH(0, 0, 10, 10));
+  auto old_child = MakeMockLayer(SkRect::MakeXYWH(20, 20, 10, 10));
+  auto new_child = MakeMockLayer(SkRect::MakeXYWH(20, 20, 10, 10));
+
+  auto old_layer = std::make_shared<TransformLayer>(SkMatrix::Translate(5, 5));
+  old_layer->Add(retained);
+  old_layer->Add(old_child);
+  auto layer = std::make_shared<TransformLayer>(SkMatrix::Translate(5, 5));
+  layer->Add(retained);
+  layer->Add(new_child);
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeXYWH(25, 25, 10, 10));
+}
+
+TEST_F(DiffContextTest, RootContainerLayersDiffOnlyChangedChildren) {
+  // SceneBuilder creates a new root container for every frame.
+  auto retained = MakeMockLayer(SkRect::MakeXYWH(0, 0, 10, 10));
+  auto old_layer = std::make_shared<ContainerLayer>();
+  old_layer->Add(retained);
+  old_layer->Add(MakeMockLayer(SkRect::MakeXYWH(20, 20, 10, 10)));
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(retained);
+  layer->Add(MakeMockLayer(SkRect::MakeXYWH(20, 20, 10, 10)));
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeXYWH(20, 20, 10, 10));
+}
+
+TEST_F(DiffContextTest, ContainerLayerIsNotComparedWithEffectLayers) {
+  auto child = MakeMockLayer(SkRect::MakeXYWH(0, 0, 10, 10));
+  auto old_layer = std::make_shared<TransformLayer>(SkMatrix::Translate(5, 5));
+  old_layer->Add(child);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(child);
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeLTRB(0, 0, 15, 15));
+}
+
+TEST_F(DiffContextTest, TextureInRetainedFilterLayerIsDamaged) {
+  auto texture = std::make_shared<TextureLayer>(
+      SkPoint::Make(20, 20), SkSize::Make(10, 10), 0, false,
+      kNone_SkFilterQuality);
+  auto filter_layer =
+      std::make_shared<ColorFilterLayer>(SkColorFilters::LinearToSRGBGamma());
+  filter_layer->Add(MakeMockLayer(SkRect::MakeXYWH(0, 0, 100, 100)));
+  filter_layer->Add(texture);
+
+  auto old_layer = std::make_shared<ContainerLayer>();
+  old_layer->Add(filter_layer);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(filter_layer);
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeXYWH(20, 20, 10, 10));
+}
+
+TEST_F(DiffContextTest, TransformChangeDamagesWholeSubtree) {
+  auto child = MakeMockLayer(SkRect::MakeXYWH(0, 0, 10, 10));
+  auto old_layer = std::make_shared<TransformLayer>(SkMatrix::Translate(5, 5));
+  old_layer->Add(child);
+  auto layer = std::make_shared<TransformLayer>(SkMatrix::Translate(50, 50));
+  layer->Add(child);
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeLTRB(5, 5, 60, 60));
+}
+
+TEST_F(DiffContextTest, RemovedAndInsertedChildren) {
+  auto first = MakeMockLayer(SkRect::MakeXYWH(0, 0, 10, 10));
+  auto removed = MakeMockLayer(SkRect::MakeXYWH(20, 0, 10, 10));
+  auto last = MakeMockLayer(SkRect::MakeXYWH(40, 0, 10, 10));
+  auto inserted = MakeMockLayer(SkRect::MakeXYWH(60, 0, 10, 10));
+
+  auto old_layer = std::make_shared<TransformLayer>(SkMatrix());
+  old_layer->Add(first);
+  old_layer->Add(removed);
+  old_layer->Add(last);
+  auto layer = std::make_shared<TransformLayer>(SkMatrix());
+  layer->Add(first);
+  layer->Add(last);
+  layer->Add(inserted);
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeLTRB(20, 0, 70, 10));
+}
+
+TEST_F(DiffContextTest, ReorderedChildrenAreDamaged) {
+  auto first = MakeMockLayer(SkRect::MakeXYWH(0, 0, 10, 10));
+  auto second = MakeMockLayer(SkRect::MakeXYWH(5, 5, 10, 10));
+
+  auto old_layer = std::make_shared<TransformLayer>(SkMatrix());
+  old_layer->Add(first);
+  old_layer->Add(second);
+  auto layer = std::make_shared<TransformLayer>(SkMatrix());
+  layer->Add(second);
+  layer->Add(first);
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeXYWH(0, 0, 10, 10));
+}
+
+TEST_F(DiffContextTest, ClipRectLayerClipsChildDamage) {
+  const SkRect clip = SkRect::MakeXYWH(0, 0, 20, 20);
+  auto old_layer = std::make_shared<ClipRectLayer>(clip, Clip::hardEdge);
+  old_layer->Add(MakeMockLayer(SkRect::MakeXYWH(10, 10, 100, 100)));
+  auto layer = std::make_shared<ClipRectLayer>(clip, Clip::hardEdge);
+  layer->Add(MakeMockLayer(SkRect::MakeXYWH(10, 10, 100, 100)));
+
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()),
+            SkIRect::MakeLTRB(10, 10, 20, 20));
+}
+
+TEST_F(DiffContextTest, BackdropFilterRepaintsWhenBackdropChanges) {
+  auto filter = SkImageFilters::Blur(5, 5, SkTileMode::kClamp, nullptr);
+  auto backdrop = std::make_shared<BackdropFilterLayer>(filter);
+  backdrop->Add(MakeMockLayer(SkRect::MakeXYWH(0, 0, 50, 50)));
+
+  const SkRect clip = SkRect::MakeXYWH(0, 0, 100, 100);
+  auto old_layer = std::make_shared<ClipRectLayer>(clip, Clip::hardEdge);
+  old_layer->Add(MakeMockLayer(SkRect::MakeXYWH(10, 10, 5, 5)));
+  old_layer->Add(backdrop);
+  auto layer = std::make_shared<ClipRectLayer>(clip, Clip::hardEdge);
+  layer->Add(MakeMockLayer(SkRect::MakeXYWH(10, 10, 5, 5)));
+  layer->Add(backdrop);
+
+  // The filter reads back the whole clip, not just the bounds of its
+  // children, and blurs in pixels from around it.
+  SkIRect expected =
+      filter->filterBounds(clip.roundOut(), SkMatrix(),
+                           SkImageFilter::kReverse_MapDirection);
+  ASSERT_TRUE(expected.intersect(SkIRect::MakeWH(1000, 1000)));
+  EXPECT_GT(expected.width(), clip.width());
+  EXPECT_EQ(Diff(layer.get(), old_layer.get()), expected);
+}
+
+}  // namespace testing
+}  // namespace flutter
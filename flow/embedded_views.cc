@@ -64,4 +64,10 @@ bool ExternalViewEmbedder::SupportsDynamicThreadMerging() {
   return false;
 }
 
+size_t ExternalViewEmbedder::GetRenderTargetCacheBytes() const {
+  return 0;
+}
+
+void ExternalViewEmbedder::PurgeRenderTargetCache() {}
+
 }  // namespace flutter
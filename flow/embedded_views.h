@@ -334,6 +334,15 @@ class ExternalViewEmbedder {
   // |RasterThreadMerger| instance.
   virtual bool SupportsDynamicThreadMerging();
 
+  // The estimated bytes held by render targets that are kept between frames
+  // for reuse.
+  virtual size_t GetRenderTargetCacheBytes() const;
+
+  // Releases the render targets that are kept between frames. New ones are
+  // created as needed by the next frame. Must be called on the raster thread
+  // outside of a frame.
+  virtual void PurgeRenderTargetCache();
+
   FML_DISALLOW_COPY_AND_ASSIGN(ExternalViewEmbedder);
 
 };  // ExternalViewEmbedder
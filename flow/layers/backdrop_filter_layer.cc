@@ -16,6 +16,14 @@ void BackdropFilterLayer::Preroll(PrerollContext* context,
   ContainerLayer::Preroll(context, matrix);
 }
 
+void BackdropFilterLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  // The filter reads back everything painted below it within the clip, not
+  // just below its children, so any damage touching that area requires the
+  // whole area to be repainted.
+  context->AddBackdropReadbackRegion(filter_.get());
+  DiffRetainedChildren(context, old_layer, false);
+}
+
 void BackdropFilterLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "BackdropFilterLayer::Paint");
   FML_DCHECK(needs_painting());
@@ -38,6 +38,20 @@ void ClipPathLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->cull_rect = previous_cull_rect;
 }
 
+void ClipPathLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const ClipPathLayer* prev =
+      old_layer ? old_layer->as_clip_path_layer() : nullptr;
+  if (!prev || prev->clip_path_ != clip_path_ ||
+      prev->clip_behavior_ != clip_behavior_) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_path_.getBounds());
+  DiffChildren(context, prev);
+}
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 void ClipPathLayer::UpdateScene(SceneUpdateContext& context) {
@@ -17,6 +17,10 @@ class ClipPathLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context, const Layer* old_layer) override;
+
+  const ClipPathLayer* as_clip_path_layer() const override { return this; }
+
   bool UsesSaveLayer() const {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
@@ -25,6 +29,10 @@ class ClipPathLayer : public ContainerLayer {
   void UpdateScene(SceneUpdateContext& context) override;
 #endif
 
+ protected:
+  // |ContainerLayer|
+  bool HasEffect() const override { return true; }
+
  private:
   SkPath clip_path_;
   Clip clip_behavior_;
@@ -33,6 +33,20 @@ void ClipRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->cull_rect = previous_cull_rect;
 }
 
+void ClipRectLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const ClipRectLayer* prev =
+      old_layer ? old_layer->as_clip_rect_layer() : nullptr;
+  if (!prev || prev->clip_rect_ != clip_rect_ ||
+      prev->clip_behavior_ != clip_behavior_) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_rect_);
+  DiffChildren(context, prev);
+}
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 void ClipRectLayer::UpdateScene(SceneUpdateContext& context) {
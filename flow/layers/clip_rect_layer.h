@@ -16,6 +16,10 @@ class ClipRectLayer : public ContainerLayer {
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context, const Layer* old_layer) override;
+
+  const ClipRectLayer* as_clip_rect_layer() const override { return this; }
+
   bool UsesSaveLayer() const {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
@@ -24,6 +28,10 @@ class ClipRectLayer : public ContainerLayer {
   void UpdateScene(SceneUpdateContext& context) override;
 #endif
 
+ protected:
+  // |ContainerLayer|
+  bool HasEffect() const override { return true; }
+
  private:
   SkRect clip_rect_;
   Clip clip_behavior_;
@@ -34,6 +34,20 @@ void ClipRRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->cull_rect = previous_cull_rect;
 }
 
+void ClipRRectLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const ClipRRectLayer* prev =
+      old_layer ? old_layer->as_clip_rrect_layer() : nullptr;
+  if (!prev || prev->clip_rrect_ != clip_rrect_ ||
+      prev->clip_behavior_ != clip_behavior_) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->ClipRect(clip_rrect_.getBounds());
+  DiffChildren(context, prev);
+}
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 void ClipRRectLayer::UpdateScene(SceneUpdateContext& context) {
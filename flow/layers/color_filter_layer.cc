@@ -16,6 +16,12 @@ void ColorFilterLayer::Preroll(PrerollContext* context,
   ContainerLayer::Preroll(context, matrix);
 }
 
+void ColorFilterLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  // Color filters map each pixel on its own, so damage to the children only
+  // damages the same pixels of the filtered output.
+  DiffRetainedChildren(context, old_layer, false);
+}
+
 void ColorFilterLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ColorFilterLayer::Paint");
   FML_DCHECK(needs_painting());
@@ -18,6 +18,12 @@ class ColorFilterLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context, const Layer* old_layer) override;
+
+ protected:
+  // |ContainerLayer|
+  bool HasEffect() const override { return true; }
+
  private:
   sk_sp<SkColorFilter> filter_;
 
@@ -5,6 +5,7 @@
 #include "flutter/flow/layers/container_layer.h"
 
 #include <optional>
+#include <unordered_map>
 
 namespace flutter {
 
@@ -28,6 +29,85 @@ void ContainerLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void ContainerLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const ContainerLayer* prev =
+      old_layer ? old_layer->as_container_layer() : nullptr;
+  if (!prev || HasEffect() || prev->HasEffect()) {
+    DiffRetainedChildren(context, old_layer, true);
+    return;
+  }
+  DiffChildren(context, prev);
+}
+
+void ContainerLayer::DiffRetainedChildren(DiffContext* context,
+                                          const Layer* old_layer,
+                                          bool effect_spreads_damage) {
+  if (!old_layer || old_layer->unique_id() != unique_id()) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+  const size_t damage_count = context->damage_count();
+  DiffChildren(context, old_layer->as_container_layer());
+  if (effect_spreads_damage && context->damage_count() != damage_count) {
+    context->AddDamage(paint_bounds());
+  }
+}
+
+void ContainerLayer::DiffChildren(DiffContext* context,
+                                  const ContainerLayer* old_layer) const {
+  const auto& old_layers = old_layer->layers();
+
+  std::unordered_map<uint64_t, size_t> old_index_by_id;
+  for (size_t i = 0; i < old_layers.size(); i++) {
+    old_index_by_id[old_layers[i]->unique_id()] = i;
+  }
+
+  // Old children that are retained in this frame, or that a new child at the
+  // same position was compared against.
+  std::vector<bool> old_layer_matched(old_layers.size(), false);
+  for (const auto& layer : layers_) {
+    auto found = old_index_by_id.find(layer->unique_id());
+    if (found != old_index_by_id.end()) {
+      old_layer_matched[found->second] = true;
+    }
+  }
+
+  // The highest index of a retained old child seen so far. A retained child
+  // that appears before it in the old list was reordered, which changes how it
+  // overlaps its siblings.
+  size_t last_retained_index = 0;
+  bool has_retained = false;
+  for (size_t i = 0; i < layers_.size(); i++) {
+    const Layer* layer = layers_[i].get();
+    auto found = old_index_by_id.find(layer->unique_id());
+    if (found != old_index_by_id.end()) {
+      if (has_retained && found->second < last_retained_index) {
+        context->AddDamage(layer->paint_bounds());
+      }
+      last_retained_index = found->second;
+      has_retained = true;
+      // Retained subtrees are still walked since they may contain textures
+      // that produced new frames, or readback regions.
+      layer->Diff(context, old_layers[found->second].get());
+      continue;
+    }
+
+    const Layer* old_child = nullptr;
+    if (i < old_layers.size() && !old_layer_matched[i]) {
+      old_child = old_layers[i].get();
+      old_layer_matched[i] = true;
+    }
+    layer->Diff(context, old_child);
+  }
+
+  // Whatever remains was removed from the tree.
+  for (size_t i = 0; i < old_layers.size(); i++) {
+    if (!old_layer_matched[i]) {
+      context->AddDamage(old_layers[i]->paint_bounds());
+    }
+  }
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
@@ -26,7 +26,42 @@ class ContainerLayer : public Layer {
 
   const std::vector<std::shared_ptr<Layer>>& layers() const { return layers_; }
 
+  // |Layer|
+  const ContainerLayer* as_container_layer() const override { return this; }
+
+  // |Layer|
+  // Containers without an effect of their own, such as the root layer that
+  // SceneBuilder creates for every frame, diff their children against those
+  // of the plain container that held their place.
+  void Diff(DiffContext* context, const Layer* old_layer) override;
+
+  // Diffs the children of this layer against the children of |old_layer|.
+  //
+  // Children are matched by unique_id() first so that retained layers which
+  // are reordered, inserted or removed are recognized, and the remaining
+  // children are matched by position. Container layers call this from their
+  // Diff implementations once they have established that |old_layer| applies
+  // the same transform, clip and effects to its children as they do.
+  void DiffChildren(DiffContext* context,
+                    const ContainerLayer* old_layer) const;
+
  protected:
+  // Whether this container transforms, clips or applies an effect to its
+  // children. Only plain containers compare their children with those of
+  // whatever container held their place, since for the others that requires
+  // comparing the effects too.
+  virtual bool HasEffect() const { return false; }
+
+  // Diffs a container whose effect can't be compared with that of another
+  // layer. If |old_layer| is this layer retained from the previous frame, its
+  // children are still walked, since they may contain textures that produced
+  // new frames. If |effect_spreads_damage|, as for filters that move pixels,
+  // any damage to the children damages the whole layer. Any other layer is
+  // damaged entirely.
+  void DiffRetainedChildren(DiffContext* context,
+                            const Layer* old_layer,
+                            bool effect_spreads_damage);
+
   void PrerollChildren(PrerollContext* context,
                        const SkMatrix& child_matrix,
                        SkRect* child_paint_bounds);
@@ -127,6 +162,9 @@ class MergedContainerLayer : public ContainerLayer {
    */
   Layer* GetCacheableChild() const;
 
+  // |ContainerLayer|
+  bool HasEffect() const override { return true; }
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(MergedContainerLayer);
 };
@@ -27,6 +27,16 @@ uint64_t Layer::NextUniqueID() {
 
 void Layer::Preroll(PrerollContext* context, const SkMatrix& matrix) {}
 
+void Layer::Diff(DiffContext* context, const Layer* old_layer) {
+  if (old_layer && old_layer->unique_id() == unique_id()) {
+    return;
+  }
+  if (old_layer) {
+    context->AddDamage(old_layer->paint_bounds());
+  }
+  context->AddDamage(paint_bounds());
+}
+
 Layer::AutoPrerollSaveLayerState::AutoPrerollSaveLayerState(
     PrerollContext* preroll_context,
     bool save_layer_is_active,
@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
@@ -37,6 +38,15 @@ namespace flutter {
 
 static constexpr SkRect kGiantRect = SkRect::MakeLTRB(-1E9F, -1E9F, 1E9F, 1E9F);
 
+class ContainerLayer;
+class PictureLayer;
+class TransformLayer;
+class OpacityLayer;
+class ClipRectLayer;
+class ClipRRectLayer;
+class ClipPathLayer;
+class PhysicalShapeLayer;
+
 // This should be an exact copy of the Clip enum in painting.dart.
 enum Clip { none, hardEdge, antiAlias, antiAliasWithSaveLayer };
 
@@ -153,6 +163,28 @@ class Layer {
 
   virtual void Paint(PaintContext& context) const = 0;
 
+  // Reports to |context| the areas of the frame that changed between
+  // |old_layer|, the layer that held this layer's place in the previous frame's
+  // layer tree (or nullptr if there was none), and this layer. Both layers must
+  // have been prerolled.
+  //
+  // The default implementation assumes that a layer with the same unique_id()
+  // is a retained layer whose contents have not changed, and that any other
+  // layer changed entirely.
+  virtual void Diff(DiffContext* context, const Layer* old_layer);
+
+  // Accessors used by Diff to match layers of the same type across frames.
+  virtual const ContainerLayer* as_container_layer() const { return nullptr; }
+  virtual const PictureLayer* as_picture_layer() const { return nullptr; }
+  virtual const TransformLayer* as_transform_layer() const { return nullptr; }
+  virtual const OpacityLayer* as_opacity_layer() const { return nullptr; }
+  virtual const ClipRectLayer* as_clip_rect_layer() const { return nullptr; }
+  virtual const ClipRRectLayer* as_clip_rrect_layer() const { return nullptr; }
+  virtual const ClipPathLayer* as_clip_path_layer() const { return nullptr; }
+  virtual const PhysicalShapeLayer* as_physical_shape_layer() const {
+    return nullptr;
+  }
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
   // Updates the system composited scene.
   virtual void UpdateScene(SceneUpdateContext& context);
@@ -88,6 +88,21 @@ void OpacityLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+void OpacityLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const OpacityLayer* prev =
+      old_layer ? old_layer->as_opacity_layer() : nullptr;
+  if (!prev || prev->alpha_ != alpha_ || prev->offset_ != offset_) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+
+  // The child container is recreated along with this layer, so compare its
+  // children directly.
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushTransform(SkMatrix::Translate(offset_.fX, offset_.fY));
+  GetChildContainer()->DiffChildren(context, prev->GetChildContainer());
+}
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 void OpacityLayer::UpdateScene(SceneUpdateContext& context) {
@@ -74,6 +74,15 @@ PerformanceOverlayLayer::PerformanceOverlayLayer(uint64_t options,
   }
 }
 
+void PerformanceOverlayLayer::Diff(DiffContext* context,
+                                   const Layer* old_layer) {
+  // The statistics are redrawn every frame.
+  if (old_layer) {
+    context->AddDamage(old_layer->paint_bounds());
+  }
+  context->AddDamage(paint_bounds());
+}
+
 void PerformanceOverlayLayer::Paint(PaintContext& context) const {
   const int padding = 8;
 
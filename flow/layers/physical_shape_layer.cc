@@ -43,6 +43,26 @@ void PhysicalShapeLayer::Preroll(PrerollContext* context,
   }
 }
 
+void PhysicalShapeLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const PhysicalShapeLayer* prev =
+      old_layer ? old_layer->as_physical_shape_layer() : nullptr;
+  if (!prev || prev->color_ != color_ ||
+      prev->shadow_color_ != shadow_color_ ||
+      prev->elevation_ != elevation_ || prev->path_ != path_ ||
+      prev->clip_behavior_ != clip_behavior_ ||
+      prev->paint_bounds() != paint_bounds()) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+
+  // The shape and its shadow are unchanged, only the children may differ.
+  DiffContext::AutoSubtreeRestore subtree(context);
+  if (clip_behavior_ != Clip::none) {
+    context->ClipRect(path_.getBounds());
+  }
+  DiffChildren(context, prev);
+}
+
 void PhysicalShapeLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "PhysicalShapeLayer::Paint");
   FML_DCHECK(needs_painting());
@@ -31,12 +31,22 @@ class PhysicalShapeLayer : public ContainerLayer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context, const Layer* old_layer) override;
+
+  const PhysicalShapeLayer* as_physical_shape_layer() const override {
+    return this;
+  }
+
   bool UsesSaveLayer() const {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
 
   float elevation() const { return elevation_; }
 
+ protected:
+  // |ContainerLayer|
+  bool HasEffect() const override { return true; }
+
  private:
   SkColor color_;
   SkColor shadow_color_;
@@ -42,6 +42,18 @@ void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   set_paint_bounds(bounds);
 }
 
+void PictureLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const PictureLayer* prev =
+      old_layer ? old_layer->as_picture_layer() : nullptr;
+  // The framework creates a new PictureLayer every time the parent layer is
+  // rebuilt, but reuses the recorded picture if its contents didn't change.
+  if (prev && prev->offset_ == offset_ &&
+      prev->picture()->uniqueID() == picture()->uniqueID()) {
+    return;
+  }
+  Layer::Diff(context, old_layer);
+}
+
 void PictureLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "PictureLayer::Paint");
   FML_DCHECK(picture_.get());
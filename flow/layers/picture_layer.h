@@ -26,6 +26,10 @@ class PictureLayer : public Layer {
 
   void Paint(PaintContext& context) const override;
 
+  void Diff(DiffContext* context, const Layer* old_layer) override;
+
+  const PictureLayer* as_picture_layer() const override { return this; }
+
  private:
   SkPoint offset_;
   // Even though pictures themselves are not GPU resources, they may reference
@@ -21,6 +21,11 @@ void ShaderMaskLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   ContainerLayer::Preroll(context, matrix);
 }
 
+void ShaderMaskLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  // The mask blends each pixel of the children on its own.
+  DiffRetainedChildren(context, old_layer, false);
+}
+
 void ShaderMaskLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ShaderMaskLayer::Paint");
   FML_DCHECK(needs_painting());
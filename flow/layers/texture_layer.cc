@@ -30,6 +30,14 @@ void TextureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
                                     size_.height()));
 }
 
+void TextureLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  // The texture may have produced a new frame even if the layer was retained.
+  if (old_layer) {
+    context->AddDamage(old_layer->paint_bounds());
+  }
+  context->AddDamage(paint_bounds());
+}
+
 void TextureLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "TextureLayer::Paint");
 
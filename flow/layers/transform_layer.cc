@@ -52,6 +52,19 @@ void TransformLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->mutators_stack.Pop();
 }
 
+void TransformLayer::Diff(DiffContext* context, const Layer* old_layer) {
+  const TransformLayer* prev =
+      old_layer ? old_layer->as_transform_layer() : nullptr;
+  if (!prev || prev->transform_ != transform_) {
+    Layer::Diff(context, old_layer);
+    return;
+  }
+
+  DiffContext::AutoSubtreeRestore subtree(context);
+  context->PushTransform(transform_);
+  DiffChildren(context, prev);
+}
+
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
 
 void TransformLayer::UpdateScene(SceneUpdateContext& context) {
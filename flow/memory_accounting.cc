@@ -0,0 +1,202 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/memory_accounting.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr const char* kMemoryCategoryNames[kMemoryCategoryCount] = {
+    "rasterCache", "images", "renderTargets", "textAtlases", "resourceCache",
+};
+
+}  // namespace
+
+const char* MemoryCategoryToString(MemoryCategory category) {
+  return kMemoryCategoryNames[static_cast<size_t>(category)];
+}
+
+std::optional<MemoryCategory> MemoryCategoryFromString(
+    const std::string& name) {
+  for (size_t i = 0; i < kMemoryCategoryCount; i++) {
+    if (name == kMemoryCategoryNames[i]) {
+      return static_cast<MemoryCategory>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+MemoryAccounting::MemoryAccounting() = default;
+
+MemoryAccounting::~MemoryAccounting() = default;
+
+MemoryAccounting::Entry& MemoryAccounting::GetEntryLocked(
+    MemoryCategory category) {
+  return entries_[static_cast<size_t>(category)];
+}
+
+void MemoryAccounting::SetHandler(MemoryCategory category, Handler handler) {
+  std::optional<size_t> budget;
+  {
+    std::scoped_lock lock(mutex_);
+    Entry& entry = GetEntryLocked(category);
+    entry.handler = handler;
+    budget = entry.budget;
+  }
+  if (budget && handler.budget_changed) {
+    handler.budget_changed(budget);
+  }
+}
+
+void MemoryAccounting::ClearHandler(MemoryCategory category) {
+  std::scoped_lock lock(mutex_);
+  GetEntryLocked(category).handler = {};
+}
+
+void MemoryAccounting::SetUsage(MemoryCategory category, size_t bytes) {
+  bool pressure;
+  {
+    std::scoped_lock lock(mutex_);
+    GetEntryLocked(category).bytes = bytes;
+    pressure = UpdatePressureLocked(category);
+  }
+  if (pressure) {
+    ReportPressure(category);
+  }
+}
+
+void MemoryAccounting::AddUsage(MemoryCategory category, size_t bytes) {
+  bool pressure;
+  {
+    std::scoped_lock lock(mutex_);
+    GetEntryLocked(category).bytes += bytes;
+    pressure = UpdatePressureLocked(category);
+  }
+  if (pressure) {
+    ReportPressure(category);
+  }
+}
+
+void MemoryAccounting::RemoveUsage(MemoryCategory category, size_t bytes) {
+  std::scoped_lock lock(mutex_);
+  Entry& entry = GetEntryLocked(category);
+  FML_DCHECK(entry.bytes >= bytes);
+  entry.bytes -= std::min(entry.bytes, bytes);
+  UpdatePressureLocked(category);
+}
+
+void MemoryAccounting::SetBudget(MemoryCategory category,
+                                 std::optional<size_t> budget) {
+  std::function<void(std::optional<size_t>)> budget_changed;
+  bool pressure;
+  {
+    std::scoped_lock lock(mutex_);
+    Entry& entry = GetEntryLocked(category);
+    entry.budget = budget;
+    budget_changed = entry.handler.budget_changed;
+    pressure = UpdatePressureLocked(category);
+  }
+  if (budget_changed) {
+    budget_changed(budget);
+  }
+  if (pressure) {
+    ReportPressure(category);
+  }
+}
+
+void MemoryAccounting::Purge(MemoryCategory category, size_t target_bytes) {
+  std::function<void(size_t)> purge;
+  {
+    std::scoped_lock lock(mutex_);
+    purge = GetEntryLocked(category).handler.purge;
+  }
+  if (purge) {
+    TRACE_EVENT1("flutter", "MemoryAccounting::Purge", "category",
+                 MemoryCategoryToString(category));
+    purge(target_bytes);
+  }
+}
+
+MemoryAccounting::Usage MemoryAccounting::GetUsage(
+    MemoryCategory category) const {
+  std::scoped_lock lock(mutex_);
+  const Entry& entry = entries_[static_cast<size_t>(category)];
+  return {category, entry.bytes, entry.budget};
+}
+
+std::vector<MemoryAccounting::Usage> MemoryAccounting::GetAllUsage() const {
+  std::vector<Usage> usage;
+  usage.reserve(kMemoryCategoryCount);
+  std::scoped_lock lock(mutex_);
+  for (size_t i = 0; i < kMemoryCategoryCount; i++) {
+    usage.push_back({static_cast<MemoryCategory>(i), entries_[i].bytes,
+                     entries_[i].budget});
+  }
+  return usage;
+}
+
+size_t MemoryAccounting::GetTotalBytes() const {
+  size_t total = 0;
+  std::scoped_lock lock(mutex_);
+  for (const Entry& entry : entries_) {
+    total += entry.bytes;
+  }
+  return total;
+}
+
+size_t MemoryAccounting::AddPressureObserver(PressureObserver observer) {
+  std::scoped_lock lock(mutex_);
+  const size_t id = next_observer_id_++;
+  observers_[id] = std::move(observer);
+  return id;
+}
+
+void MemoryAccounting::RemovePressureObserver(size_t id) {
+  std::scoped_lock lock(mutex_);
+  observers_.erase(id);
+}
+
+bool MemoryAccounting::UpdatePressureLocked(MemoryCategory category) {
+  Entry& entry = GetEntryLocked(category);
+  const bool over_budget = entry.budget && entry.bytes > *entry.budget;
+  const bool went_over = over_budget && !entry.over_budget;
+  entry.over_budget = over_budget;
+  return went_over;
+}
+
+void MemoryAccounting::ReportPressure(MemoryCategory category) {
+  Usage usage;
+  std::function<void(size_t)> purge;
+  std::vector<PressureObserver> observers;
+  {
+    std::scoped_lock lock(mutex_);
+    Entry& entry = GetEntryLocked(category);
+    if (!entry.budget) {
+      return;
+    }
+    usage = {category, entry.bytes, entry.budget};
+    purge = entry.handler.purge;
+    observers.reserve(observers_.size());
+    for (const auto& item : observers_) {
+      observers.push_back(item.second);
+    }
+  }
+
+  TRACE_EVENT1("flutter", "MemoryAccounting::ReportPressure", "category",
+               MemoryCategoryToString(category));
+  if (purge) {
+    purge(*usage.budget);
+  }
+  for (const auto& observer : observers) {
+    observer(usage);
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,140 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_MEMORY_ACCOUNTING_H_
+#define FLUTTER_FLOW_MEMORY_ACCOUNTING_H_
+
+#include <array>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+enum class MemoryCategory {
+  kRasterCache,
+  kImages,
+  kRenderTargets,
+  // Skia's glyph cache is shared by all engines in the process. Every engine
+  // reports the usage of the whole process, and the largest budget applies.
+  kTextAtlases,
+  kResourceCache,
+};
+
+constexpr size_t kMemoryCategoryCount = 5;
+
+const char* MemoryCategoryToString(MemoryCategory category);
+
+std::optional<MemoryCategory> MemoryCategoryFromString(const std::string& name);
+
+//------------------------------------------------------------------------------
+/// Tracks how many bytes an engine holds in each category of memory, along
+/// with an optional budget per category.
+///
+/// The owner of a category reports its usage and installs a handler. The
+/// handler is told when the budget of its category changes, so that owners
+/// with a native limit (like Skia's resource cache) can apply it, and is asked
+/// to purge when the category goes over its budget or a purge is requested.
+/// This lets memory pressure be relieved one category at a time instead of
+/// dropping everything at once.
+///
+/// All methods are thread safe. Handlers and observers are invoked without
+/// any lock held, on the thread that caused the call, and should post to the
+/// thread that owns the memory if needed.
+///
+class MemoryAccounting {
+ public:
+  struct Handler {
+    // Called with the new budget of the category, or no value if the budget
+    // was removed.
+    std::function<void(std::optional<size_t> budget)> budget_changed;
+    // Called to free memory until the category uses at most |target_bytes|.
+    // Owners that can't free exactly that much should free what they can.
+    std::function<void(size_t target_bytes)> purge;
+  };
+
+  struct Usage {
+    MemoryCategory category;
+    size_t bytes = 0;
+    std::optional<size_t> budget;
+  };
+
+  // Called when a category goes over its budget.
+  using PressureObserver = std::function<void(const Usage& usage)>;
+
+  MemoryAccounting();
+
+  ~MemoryAccounting();
+
+  // Installs the handler of |category|, replacing any previous one. If the
+  // category already has a budget, the handler is told right away.
+  void SetHandler(MemoryCategory category, Handler handler);
+
+  // Removes the handler of |category|. Handlers must be removed before the
+  // objects they refer to go away.
+  void ClearHandler(MemoryCategory category);
+
+  // Replaces the usage of |category| with |bytes|, for owners that can
+  // measure their total cheaply.
+  void SetUsage(MemoryCategory category, size_t bytes);
+
+  // Adjusts the usage of |category|, for owners that track allocations one
+  // by one.
+  void AddUsage(MemoryCategory category, size_t bytes);
+  void RemoveUsage(MemoryCategory category, size_t bytes);
+
+  // Sets the budget of |category|, or removes it if |budget| has no value.
+  void SetBudget(MemoryCategory category, std::optional<size_t> budget);
+
+  // Asks the owner of |category| to free memory until it uses at most
+  // |target_bytes|.
+  void Purge(MemoryCategory category, size_t target_bytes = 0);
+
+  Usage GetUsage(MemoryCategory category) const;
+
+  std::vector<Usage> GetAllUsage() const;
+
+  size_t GetTotalBytes() const;
+
+  // Returns an ID that can be passed to |RemovePressureObserver|.
+  size_t AddPressureObserver(PressureObserver observer);
+
+  void RemovePressureObserver(size_t id);
+
+ private:
+  struct Entry {
+    size_t bytes = 0;
+    std::optional<size_t> budget;
+    // Pressure is only reported when a category goes over its budget, not
+    // again for every change while it stays over.
+    bool over_budget = false;
+    Handler handler;
+  };
+
+  mutable std::mutex mutex_;
+  std::array<Entry, kMemoryCategoryCount> entries_;
+  std::map<size_t, PressureObserver> observers_;
+  size_t next_observer_id_ = 1;
+
+  Entry& GetEntryLocked(MemoryCategory category);
+
+  // Updates the pressure state of |category| after its usage or budget
+  // changed. Returns true if it just went over its budget.
+  bool UpdatePressureLocked(MemoryCategory category);
+
+  // Purges |category| down to its budget and notifies observers. Must be
+  // called without the lock held.
+  void ReportPressure(MemoryCategory category);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(MemoryAccounting);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_MEMORY_ACCOUNTING_H_
@@ -0,0 +1,143 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/memory_accounting.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(MemoryAccounting, TracksUsagePerCategory) {
+  MemoryAccounting accounting;
+  accounting.SetUsage(MemoryCategory::kRasterCache, 100);
+  accounting.AddUsage(MemoryCategory::kImages, 40);
+  accounting.AddUsage(MemoryCategory::kImages, 60);
+  accounting.RemoveUsage(MemoryCategory::kImages, 30);
+
+  EXPECT_EQ(accounting.GetUsage(MemoryCategory::kRasterCache).bytes, 100u);
+  EXPECT_EQ(accounting.GetUsage(MemoryCategory::kImages).bytes, 70u);
+  EXPECT_EQ(accounting.GetUsage(MemoryCategory::kTextAtlases).bytes, 0u);
+  EXPECT_EQ(accounting.GetTotalBytes(), 170u);
+
+  auto all = accounting.GetAllUsage();
+  ASSERT_EQ(all.size(), kMemoryCategoryCount);
+  EXPECT_EQ(all[1].category, MemoryCategory::kImages);
+  EXPECT_EQ(all[1].bytes, 70u);
+  EXPECT_FALSE(all[1].budget.has_value());
+}
+
+TEST(MemoryAccounting, CategoryNamesRoundTrip) {
+  for (size_t i = 0; i < kMemoryCategoryCount; i++) {
+    auto category = static_cast<MemoryCategory>(i);
+    EXPECT_EQ(MemoryCategoryFromString(MemoryCategoryToString(category)),
+              category);
+  }
+  EXPECT_FALSE(MemoryCategoryFromString("unknown").has_value());
+}
+
+TEST(MemoryAccounting, BudgetChangesAreForwardedToHandler) {
+  MemoryAccounting accounting;
+  accounting.SetBudget(MemoryCategory::kResourceCache, 1000);
+
+  std::vector<std::optional<size_t>> budgets;
+  accounting.SetHandler(MemoryCategory::kResourceCache,
+                        {[&budgets](std::optional<size_t> budget) {
+                           budgets.push_back(budget);
+                         },
+                         nullptr});
+  accounting.SetBudget(MemoryCategory::kResourceCache, 500);
+  accounting.SetBudget(MemoryCategory::kResourceCache, std::nullopt);
+
+  ASSERT_EQ(budgets.size(), 3u);
+  EXPECT_EQ(budgets[0], 1000u);
+  EXPECT_EQ(budgets[1], 500u);
+  EXPECT_FALSE(budgets[2].has_value());
+}
+
+TEST(MemoryAccounting, GoingOverBudgetPurgesOnlyThatCategory) {
+  MemoryAccounting accounting;
+  std::vector<size_t> raster_cache_purges;
+  std::vector<size_t> image_purges;
+  accounting.SetHandler(MemoryCategory::kRasterCache,
+                        {nullptr, [&](size_t target_bytes) {
+                           raster_cache_purges.push_back(target_bytes);
+                         }});
+  accounting.SetHandler(MemoryCategory::kImages,
+                        {nullptr, [&](size_t target_bytes) {
+                           image_purges.push_back(target_bytes);
+                         }});
+  accounting.SetBudget(MemoryCategory::kRasterCache, 100);
+
+  accounting.SetUsage(MemoryCategory::kRasterCache, 50);
+  EXPECT_TRUE(raster_cache_purges.empty());
+
+  accounting.SetUsage(MemoryCategory::kRasterCache, 150);
+  ASSERT_EQ(raster_cache_purges.size(), 1u);
+  EXPECT_EQ(raster_cache_purges[0], 100u);
+
+  // Staying over budget doesn't report pressure again.
+  accounting.SetUsage(MemoryCategory::kRasterCache, 200);
+  EXPECT_EQ(raster_cache_purges.size(), 1u);
+
+  // Going back under and over again does.
+  accounting.SetUsage(MemoryCategory::kRasterCache, 80);
+  accounting.SetUsage(MemoryCategory::kRasterCache, 120);
+  EXPECT_EQ(raster_cache_purges.size(), 2u);
+
+  EXPECT_TRUE(image_purges.empty());
+}
+
+TEST(MemoryAccounting, LoweringBudgetBelowUsageReportsPressure) {
+  MemoryAccounting accounting;
+  std::vector<MemoryAccounting::Usage> pressure;
+  size_t id = accounting.AddPressureObserver(
+      [&pressure](const MemoryAccounting::Usage& usage) {
+        pressure.push_back(usage);
+      });
+
+  accounting.AddUsage(MemoryCategory::kRenderTargets, 300);
+  accounting.SetBudget(MemoryCategory::kRenderTargets, 200);
+  ASSERT_EQ(pressure.size(), 1u);
+  EXPECT_EQ(pressure[0].category, MemoryCategory::kRenderTargets);
+  EXPECT_EQ(pressure[0].bytes, 300u);
+  EXPECT_EQ(pressure[0].budget, 200u);
+
+  accounting.RemovePressureObserver(id);
+  accounting.RemoveUsage(MemoryCategory::kRenderTargets, 300);
+  accounting.AddUsage(MemoryCategory::kRenderTargets, 300);
+  EXPECT_EQ(pressure.size(), 1u);
+}
+
+TEST(MemoryAccounting, ExplicitPurgeCallsHandler) {
+  MemoryAccounting accounting;
+  // Purging a category without a handler is a no-op.
+  accounting.Purge(MemoryCategory::kTextAtlases);
+
+  std::optional<size_t> target;
+  accounting.SetHandler(
+      MemoryCategory::kTextAtlases,
+      {nullptr, [&target](size_t target_bytes) { target = target_bytes; }});
+  accounting.Purge(MemoryCategory::kTextAtlases, 10);
+  EXPECT_EQ(target, 10u);
+
+  accounting.ClearHandler(MemoryCategory::kTextAtlases);
+  accounting.Purge(MemoryCategory::kTextAtlases);
+  EXPECT_EQ(target, 10u);
+}
+
+TEST(MemoryAccounting, HandlersMayCallBackIntoAccounting) {
+  MemoryAccounting accounting;
+  accounting.SetHandler(MemoryCategory::kImages,
+                        {nullptr, [&accounting](size_t target_bytes) {
+                           accounting.SetUsage(MemoryCategory::kImages,
+                                               target_bytes);
+                         }});
+  accounting.SetBudget(MemoryCategory::kImages, 64);
+  accounting.AddUsage(MemoryCategory::kImages, 128);
+  EXPECT_EQ(accounting.GetUsage(MemoryCategory::kImages).bytes, 64u);
+}
+
+}  // namespace testing
+}  // namespace flutter
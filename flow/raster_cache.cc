@@ -4,16 +4,21 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
+#include <functional>
 #include <vector>
 
 #include "flutter/common/constants.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/paint_utils.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkSerialProcs.h"
 #include "third_party/skia/include/core/SkSurface.h"
 #include "third_party/skia/include/gpu/GrDirectContext.h"
 
@@ -87,8 +92,7 @@ static bool IsPictureWorthRasterizing(SkPicture* picture,
   return picture->approximateOpCount() > 5;
 }
 
-/// @note Procedure doesn't copy all closures.
-static std::unique_ptr<RasterCacheResult> Rasterize(
+static sk_sp<SkImage> RasterizeImage(
     GrDirectContext* context,
     const SkMatrix& ctm,
     SkColorSpace* dst_color_space,
@@ -120,8 +124,24 @@ static std::unique_ptr<RasterCacheResult> Rasterize(
     DrawCheckerboard(canvas, logical_rect);
   }
 
-  return std::make_unique<RasterCacheResult>(surface->makeImageSnapshot(),
-                                             logical_rect);
+  return surface->makeImageSnapshot();
+}
+
+/// @note Procedure doesn't copy all closures.
+static std::unique_ptr<RasterCacheResult> Rasterize(
+    GrDirectContext* context,
+    const SkMatrix& ctm,
+    SkColorSpace* dst_color_space,
+    bool checkerboard,
+    const SkRect& logical_rect,
+    const std::function<void(SkCanvas*)>& draw_function) {
+  sk_sp<SkImage> image = RasterizeImage(context, ctm, dst_color_space,
+                                        checkerboard, logical_rect,
+                                        draw_function);
+  if (!image) {
+    return nullptr;
+  }
+  return std::make_unique<RasterCacheResult>(std::move(image), logical_rect);
 }
 
 std::unique_ptr<RasterCacheResult> RasterCache::RasterizePicture(
@@ -142,8 +162,11 @@ void RasterCache::Prepare(PrerollContext* context,
   Entry& entry = layer_cache_[cache_key];
   entry.access_count++;
   entry.used_this_frame = true;
-  if (!entry.image) {
+  if (!entry.image &&
+      FitsInBudget(GetDeviceBounds(layer->paint_bounds(), ctm))) {
+    const fml::TimePoint start = fml::TimePoint::Now();
     entry.image = RasterizeLayer(context, layer, ctm, checkerboard_images_);
+    entry.rasterize_time = fml::TimePoint::Now() - start;
   }
 }
 
@@ -177,6 +200,27 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizeLayer(
       });
 }
 
+// Whether |picture| or a picture nested in it draws a texture-backed image,
+// either directly or through an image shader. Serializing the picture is the
+// only way to visit all of its images.
+static bool DrawsTextureBackedImages(const SkPicture& picture) {
+  bool found = false;
+  SkSerialProcs procs;
+  procs.fImageProc = [](SkImage* image, void* ctx) {
+    if (image->isTextureBacked()) {
+      *static_cast<bool*>(ctx) = true;
+    }
+    // Skips encoding the image.
+    return SkData::MakeEmpty();
+  };
+  procs.fImageCtx = &found;
+  procs.fTypefaceProc = [](SkTypeface* typeface, void* ctx) {
+    return SkData::MakeEmpty();
+  };
+  picture.serialize(&procs);
+  return found;
+}
+
 bool RasterCache::Prepare(GrDirectContext* context,
                           SkPicture* picture,
                           const SkMatrix& transformation_matrix,
@@ -187,7 +231,8 @@ bool RasterCache::Prepare(GrDirectContext* context,
   if (access_threshold_ == 0) {
     return false;
   }
-  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+  if (!async_task_runner_ &&
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
     return false;
   }
   if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
@@ -204,6 +249,12 @@ bool RasterCache::Prepare(GrDirectContext* context,
     return false;
   }
 
+  if (!FitsInBudget(
+          GetDeviceBounds(picture->cullRect(), transformation_matrix))) {
+    // The picture would never fit in the cache.
+    return false;
+  }
+
   PictureRasterCacheKey cache_key(picture->uniqueID(), transformation_matrix);
 
   // Creates an entry, if not present prior.
@@ -213,18 +264,123 @@ bool RasterCache::Prepare(GrDirectContext* context,
     return false;
   }
 
+  if (!entry.image && async_task_runner_ &&
+      !entry.draws_texture_images.has_value()) {
+    entry.draws_texture_images = DrawsTextureBackedImages(*picture);
+  }
+
+  if (!entry.image && async_task_runner_ && !*entry.draws_texture_images) {
+    if (entry.async_pending && !async_results_collected_this_frame_) {
+      CollectAsyncResults(context);
+    }
+    if (!entry.image) {
+      if (!entry.async_pending) {
+        entry.async_pending = true;
+        RasterizePictureAsync(cache_key, picture, transformation_matrix,
+                              dst_color_space);
+      }
+      // Paint the picture directly until the result is ready.
+      return false;
+    }
+  }
+
   if (!entry.image) {
+    // Checked here too when rasterizing asynchronously, for the pictures
+    // that can't be.
+    if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+      return false;
+    }
+    const fml::TimePoint start = fml::TimePoint::Now();
     entry.image = RasterizePicture(picture, context, transformation_matrix,
                                    dst_color_space, checkerboard_images_);
+    entry.rasterize_time = fml::TimePoint::Now() - start;
     picture_cached_this_frame_++;
   }
   return true;
 }
 
+void RasterCache::RasterizePictureAsync(const PictureRasterCacheKey& cache_key,
+                                        SkPicture* picture,
+                                        const SkMatrix& ctm,
+                                        SkColorSpace* dst_color_space) {
+  async_task_runner_->PostTask(
+      [results = async_results_, cache_key, picture = sk_ref_sp(picture), ctm,
+       dst_color_space = sk_ref_sp(dst_color_space),
+       checkerboard = checkerboard_images_,
+       generation = async_generation_]() mutable {
+        TRACE_EVENT0("flutter", "RasterCache::RasterizePictureAsync");
+        const fml::TimePoint start = fml::TimePoint::Now();
+        SkPicture* raw_picture = picture.get();
+        sk_sp<SkImage> image = RasterizeImage(
+            nullptr, ctm, dst_color_space.get(), checkerboard,
+            raw_picture->cullRect(),
+            [raw_picture](SkCanvas* canvas) {
+              canvas->drawPicture(raw_picture);
+            });
+        const fml::TimeDelta rasterize_time = fml::TimePoint::Now() - start;
+
+        std::scoped_lock lock(results->mutex);
+        results->completed.push_back({cache_key, std::move(picture),
+                                      std::move(image), rasterize_time,
+                                      generation});
+      });
+}
+
+void RasterCache::CollectAsyncResults(GrDirectContext* context) {
+  async_results_collected_this_frame_ = true;
+
+  std::vector<AsyncResult> completed;
+  {
+    std::scoped_lock lock(async_results_->mutex);
+    std::swap(completed, async_results_->completed);
+  }
+  if (completed.empty()) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "RasterCache::CollectAsyncResults");
+  for (auto& result : completed) {
+    if (result.generation != async_generation_) {
+      continue;
+    }
+    auto found = picture_cache_.find(result.key);
+    if (found == picture_cache_.end() || !found->second.async_pending) {
+      // The entry was evicted while it was being rasterized.
+      continue;
+    }
+    Entry& entry = found->second;
+    entry.async_pending = false;
+    if (!result.image) {
+      continue;
+    }
+    sk_sp<SkImage> image = std::move(result.image);
+    if (context) {
+      if (sk_sp<SkImage> texture_image = image->makeTextureImage(context)) {
+        image = std::move(texture_image);
+      }
+    }
+    entry.image = std::make_unique<RasterCacheResult>(
+        std::move(image), result.picture->cullRect());
+    entry.rasterize_time = result.rasterize_time;
+  }
+}
+
+void RasterCache::SetAsyncTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  async_task_runner_ = std::move(task_runner);
+  if (async_task_runner_ && !async_results_) {
+    async_results_ = std::make_shared<AsyncResults>();
+  }
+  // Drop whatever is in flight, entries waiting on it will be rasterized
+  // again.
+  Clear();
+}
+
 bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix());
   auto it = picture_cache_.find(cache_key);
   if (it == picture_cache_.end()) {
+    metrics_.miss_count++;
     return false;
   }
 
@@ -233,10 +389,12 @@ bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
   entry.used_this_frame = true;
 
   if (entry.image) {
+    metrics_.hit_count++;
     entry.image->draw(canvas, nullptr);
     return true;
   }
 
+  metrics_.miss_count++;
   return false;
 }
 
@@ -246,6 +404,7 @@ bool RasterCache::Draw(const Layer* layer,
   LayerRasterCacheKey cache_key(layer->unique_id(), canvas.getTotalMatrix());
   auto it = layer_cache_.find(cache_key);
   if (it == layer_cache_.end()) {
+    metrics_.miss_count++;
     return false;
   }
 
@@ -254,23 +413,110 @@ bool RasterCache::Draw(const Layer* layer,
   entry.used_this_frame = true;
 
   if (entry.image) {
+    metrics_.hit_count++;
     entry.image->draw(canvas, paint);
     return true;
   }
 
+  metrics_.miss_count++;
   return false;
 }
 
 void RasterCache::SweepAfterFrame() {
   SweepOneCacheAfterFrame(picture_cache_);
   SweepOneCacheAfterFrame(layer_cache_);
+  EnforceByteBudget();
   picture_cached_this_frame_ = 0;
+  async_results_collected_this_frame_ = false;
   TraceStatsToTimeline();
 }
 
+bool RasterCache::FitsInBudget(const SkIRect& bounds) const {
+  if (max_bytes_ == 0) {
+    return true;
+  }
+  // Cached images are always N32.
+  const size_t estimated_bytes = static_cast<size_t>(bounds.width()) *
+                                 static_cast<size_t>(bounds.height()) * 4;
+  return estimated_bytes <= max_bytes_;
+}
+
+namespace {
+
+struct EvictionCandidate {
+  bool used_last_frame;
+  // Rasterization time per byte. Cheaper entries are evicted first since
+  // they give back the most memory for the least work to recreate them.
+  double cost_per_byte;
+  size_t bytes;
+  // Clears the image and resets the access count, so the entry has to
+  // reach the access threshold again before it's rasterized.
+  std::function<void()> evict;
+};
+
+template <class Cache>
+void CollectEvictionCandidates(Cache& cache,
+                               std::vector<EvictionCandidate>& candidates) {
+  for (auto& item : cache) {
+    auto& entry = item.second;
+    if (!entry.image) {
+      continue;
+    }
+    const size_t bytes = entry.image->image_bytes();
+    candidates.push_back({
+        entry.unused_frames == 0,
+        entry.rasterize_time.ToMicrosecondsF() / std::max<size_t>(bytes, 1),
+        bytes,
+        [&entry]() {
+          entry.image.reset();
+          entry.access_count = 0;
+        },
+    });
+  }
+}
+
+}  // namespace
+
+void RasterCache::EnforceByteBudget() {
+  if (max_bytes_ == 0) {
+    return;
+  }
+  PurgeToBytes(max_bytes_);
+}
+
+void RasterCache::PurgeToBytes(size_t target_bytes) {
+  size_t total_bytes =
+      EstimateLayerCacheByteSize() + EstimatePictureCacheByteSize();
+  if (total_bytes <= target_bytes) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "RasterCache::PurgeToBytes");
+  std::vector<EvictionCandidate> candidates;
+  CollectEvictionCandidates(picture_cache_, candidates);
+  CollectEvictionCandidates(layer_cache_, candidates);
+  std::sort(candidates.begin(), candidates.end(),
+            [](const EvictionCandidate& a, const EvictionCandidate& b) {
+              if (a.used_last_frame != b.used_last_frame) {
+                return !a.used_last_frame;
+              }
+              return a.cost_per_byte < b.cost_per_byte;
+            });
+
+  for (const auto& candidate : candidates) {
+    if (total_bytes <= target_bytes) {
+      break;
+    }
+    candidate.evict();
+    total_bytes -= candidate.bytes;
+    metrics_.eviction_count++;
+  }
+}
+
 void RasterCache::Clear() {
   picture_cache_.clear();
   layer_cache_.clear();
+  async_generation_++;
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
@@ -285,6 +531,15 @@ size_t RasterCache::GetPictureCachedEntriesCount() const {
   return picture_cache_.size();
 }
 
+void RasterCache::SetMaxBytes(size_t max_bytes) {
+  max_bytes_ = max_bytes;
+  EnforceByteBudget();
+}
+
+void RasterCache::SetRetainedFrames(size_t retained_frames) {
+  retained_frames_ = retained_frames;
+}
+
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
   if (checkerboard_images_ == checkerboard) {
     return;
@@ -304,6 +559,10 @@ void RasterCache::TraceStatsToTimeline() const {
                     EstimateLayerCacheByteSize() / kMegaByteSizeInBytes,
                     "PictureCount", picture_cache_.size(), "PictureMBytes",
                     EstimatePictureCacheByteSize() / kMegaByteSizeInBytes);
+  FML_TRACE_COUNTER("flutter", "RasterCacheMetrics",
+                    reinterpret_cast<int64_t>(this), "Hits", metrics_.hit_count,
+                    "Misses", metrics_.miss_count, "Evictions",
+                    metrics_.eviction_count);
 
 #endif  // !FLUTTER_RELEASE
 }
@@ -6,12 +6,18 @@
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/time/time_delta.h"
 #include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkSize.h"
 
 namespace flutter {
@@ -47,6 +53,17 @@ class RasterCache {
   // multiple frames.
   static constexpr int kDefaultPictureCacheLimitPerFrame = 3;
 
+  // Counters describing how effective the cache has been since it was created.
+  struct Metrics {
+    // Draws that were satisfied by a cached image.
+    size_t hit_count = 0;
+    // Draws that found no cached image and had to be painted directly.
+    size_t miss_count = 0;
+    // Cached images that were discarded, either because they went unused for
+    // too long or to stay within the byte budget.
+    size_t eviction_count = 0;
+  };
+
   explicit RasterCache(
       size_t access_threshold = 3,
       size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame);
@@ -132,6 +149,8 @@ class RasterCache {
   // 3. The picture is accessed too few times
   // 4. There are too many pictures to be cached in the current frame.
   //    (See also kDefaultPictureCacheLimitPerFrame.)
+  // 5. The picture is being rasterized asynchronously and isn't ready yet.
+  //    (See also |SetAsyncTaskRunner|.)
   bool Prepare(GrDirectContext* context,
                SkPicture* picture,
                const SkMatrix& transformation_matrix,
@@ -162,6 +181,69 @@ class RasterCache {
 
   void SetCheckboardCacheImages(bool checkerboard);
 
+  /**
+   * @brief Limit the memory used by cached images.
+   *
+   * When the estimated size of all cached images exceeds the budget after a
+   * frame, entries are evicted in order of least value until it is met again.
+   * Entries that weren't used in the last frame go first, then entries that
+   * took the least time to rasterize per byte since they are the cheapest to
+   * recreate. Content that can never fit within the budget is not cached.
+   *
+   * @param max_bytes the budget in bytes, or zero for no limit.
+   */
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t max_bytes() const { return max_bytes_; }
+
+  /**
+   * @brief Evict entries until the cache uses at most |target_bytes|.
+   *
+   * Entries are evicted in the same order as when the budget set by
+   * |SetMaxBytes| is exceeded. The budget itself is not changed, so the cache
+   * can grow back to it in later frames.
+   */
+  void PurgeToBytes(size_t target_bytes);
+
+  /**
+   * @brief Keep entries for a number of frames after they were last used.
+   *
+   * By default, entries are evicted as soon as a frame doesn't use them. Pages
+   * that alternate between a few states (e.g. scroll positions) would keep
+   * rasterizing the same content again. Retaining entries for a few frames
+   * avoids that at the cost of memory, which can be capped by
+   * |SetMaxBytes|.
+   *
+   * @param retained_frames how many frames an unused entry survives.
+   */
+  void SetRetainedFrames(size_t retained_frames);
+
+  size_t retained_frames() const { return retained_frames_; }
+
+  const Metrics& metrics() const { return metrics_; }
+
+  /**
+   * @brief Rasterize pictures on |task_runner| instead of during Preroll.
+   *
+   * Once a picture reaches the access threshold, it's rasterized in software
+   * on a worker and the frame paints the live picture. A later frame picks up
+   * the result, uploads it to the GPU if a context is available, and draws it
+   * from the cache from then on. This takes the cost of caching complex
+   * pictures off the raster thread. The per-frame limit on cached pictures
+   * doesn't apply since it no longer affects the frame time.
+   *
+   * Layers are always cached synchronously since painting them depends on
+   * state only available on the raster thread. So are pictures that draw
+   * texture-backed images, such as the images uploaded with the IO thread's
+   * resource context, since drawing them would use that context from the
+   * worker.
+   *
+   * @param task_runner the runner to rasterize on, or nullptr to rasterize
+   *        synchronously again.
+   */
+  void SetAsyncTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
   size_t GetCachedEntriesCount() const;
 
   size_t GetLayerCachedEntriesCount() const;
@@ -191,33 +273,93 @@ class RasterCache {
  private:
   struct Entry {
     bool used_this_frame = false;
+    // The number of consecutive frames this entry has gone unused.
+    size_t unused_frames = 0;
     size_t access_count = 0;
+    // How long it took to produce |image|. Used to estimate how costly it
+    // would be to evict the entry.
+    fml::TimeDelta rasterize_time;
+    // Whether |image| is being rasterized on the async task runner.
+    bool async_pending = false;
+    // Whether the picture draws texture-backed images, which can only be
+    // drawn on the thread that owns their GPU context. Such pictures are
+    // rasterized synchronously. Unknown until the picture is first
+    // rasterized.
+    std::optional<bool> draws_texture_images;
     std::unique_ptr<RasterCacheResult> image;
   };
 
+  // A picture rasterized on the async task runner, waiting to be picked up by
+  // the raster thread.
+  struct AsyncResult {
+    PictureRasterCacheKey key;
+    // Keeps the picture alive until the result is collected so that it's
+    // released on the raster thread.
+    sk_sp<SkPicture> picture;
+    sk_sp<SkImage> image;
+    fml::TimeDelta rasterize_time;
+    size_t generation;
+  };
+
+  // Shared with the async tasks, which may outlive the cache.
+  struct AsyncResults {
+    std::mutex mutex;
+    std::vector<AsyncResult> completed;
+  };
+
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
+  void SweepOneCacheAfterFrame(Cache& cache) {
     std::vector<typename Cache::iterator> dead;
 
     for (auto it = cache.begin(); it != cache.end(); ++it) {
       Entry& entry = it->second;
-      if (!entry.used_this_frame) {
+      if (entry.used_this_frame) {
+        entry.unused_frames = 0;
+      } else if (++entry.unused_frames > retained_frames_) {
         dead.push_back(it);
       }
       entry.used_this_frame = false;
     }
 
     for (auto it : dead) {
+      if (it->second.image) {
+        metrics_.eviction_count++;
+      }
       cache.erase(it);
     }
   }
 
+  void RasterizePictureAsync(const PictureRasterCacheKey& cache_key,
+                             SkPicture* picture,
+                             const SkMatrix& ctm,
+                             SkColorSpace* dst_color_space);
+
+  // Moves the completed async results into their entries, uploading them with
+  // |context| if there is one.
+  void CollectAsyncResults(GrDirectContext* context);
+
+  // Whether an image covering |bounds| could fit within the byte budget.
+  bool FitsInBudget(const SkIRect& bounds) const;
+
+  // Evicts the least valuable entries until the cached images fit within
+  // |max_bytes_|.
+  void EnforceByteBudget();
+
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
   size_t picture_cached_this_frame_ = 0;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
   bool checkerboard_images_;
+  size_t max_bytes_ = 0;
+  size_t retained_frames_ = 0;
+  mutable Metrics metrics_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> async_task_runner_;
+  std::shared_ptr<AsyncResults> async_results_;
+  // Bumped whenever the cache is cleared so that stale async results are
+  // dropped.
+  size_t async_generation_ = 0;
+  bool async_results_collected_this_frame_ = false;
 
   void TraceStatsToTimeline() const;
 
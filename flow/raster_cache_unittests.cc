@@ -4,8 +4,12 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
@@ -132,6 +136,217 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
 }
 
+TEST(RasterCache, RetainedFramesKeepUnusedEntries) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetRetainedFrames(2);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // Two frames without access are tolerated.
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.metrics().eviction_count, 1u);
+}
+
+TEST(RasterCache, PicturesLargerThanBudgetAreNotCached) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  // The sample picture needs 150 * 100 * 4 bytes.
+  cache.SetMaxBytes(150 * 100 * 4 - 1);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_FALSE(
+        cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+    ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+    cache.SweepAfterFrame();
+  }
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 0u);
+}
+
+TEST(RasterCache, SweepEnforcesByteBudget) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetMaxBytes(150 * 100 * 4);
+  cache.SetRetainedFrames(10);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  // Cache the first picture, then stop using it.
+  cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false);
+  cache.Draw(*picture1, dummy_canvas);
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture1.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // Caching the second picture exceeds the budget, so the unused first
+  // picture is evicted even though it's still within its retained frames.
+  cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false);
+  cache.Draw(*picture2, dummy_canvas);
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture2.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 2u * 150 * 100 * 4);
+  cache.SweepAfterFrame();
+
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 150u * 100 * 4);
+  ASSERT_EQ(cache.metrics().eviction_count, 1u);
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+}
+
+TEST(RasterCache, PurgeToBytesKeepsBudget) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false);
+  cache.Draw(*picture, dummy_canvas);
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 150u * 100 * 4);
+
+  cache.PurgeToBytes(150 * 100 * 4);
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 1u);
+
+  cache.PurgeToBytes(0);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 0u);
+  ASSERT_EQ(cache.max_bytes(), 0u);
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+}
+
+TEST(RasterCache, MetricsCountHitsAndMisses) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false);
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false);
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+
+  ASSERT_EQ(cache.metrics().hit_count, 2u);
+  ASSERT_EQ(cache.metrics().miss_count, 2u);
+  ASSERT_EQ(cache.metrics().eviction_count, 0u);
+}
+
+TEST(RasterCache, AsyncPopulationDrawsPictureUntilReady) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto task_runner = loop->GetTaskRunner();
+
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetAsyncTaskRunner(task_runner);
+
+  SkMatrix matrix = SkMatrix::I();
+  auto picture = GetSamplePicture();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The threshold is reached, but the picture is rasterized on the worker.
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The worker runs tasks in order, so the picture is done once this runs.
+  fml::AutoResetEvent latch;
+  task_runner->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 150u * 100 * 4);
+}
+
+TEST(RasterCache, AsyncPopulationAcceptsPicturesOfRasterImages) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto task_runner = loop->GetTaskRunner();
+
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetAsyncTaskRunner(task_runner);
+
+  // Images in memory can be drawn on any thread, unlike texture-backed ones.
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(10, 10);
+  bitmap.eraseColor(SK_ColorBLUE);
+  SkPictureRecorder recorder;
+  SkCanvas* recording_canvas =
+      recorder.beginRecording(SkRect::MakeWH(150, 100));
+  recording_canvas->drawImageRect(SkImage::MakeFromBitmap(bitmap),
+                                  SkRect::MakeWH(150, 100), nullptr);
+  auto picture = recorder.finishRecordingAsPicture();
+
+  SkMatrix matrix = SkMatrix::I();
+  SkCanvas dummy_canvas;
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  cache.SweepAfterFrame();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  cache.SweepAfterFrame();
+
+  fml::AutoResetEvent latch;
+  task_runner->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  ASSERT_TRUE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+}
+
 // Construct a cache result whose device target rectangle rounds out to be one
 // pixel wider than the cached image.  Verify that it can be drawn without
 // triggering any assertions.
@@ -49,4 +49,10 @@ void SkiaUnrefQueue::Drain() {
   }
 }
 
+void SkiaUnrefQueue::UpdateResourceContext(
+    fml::WeakPtr<GrDirectContext> context) {
+  FML_DCHECK(task_runner_->RunsTasksOnCurrentThread());
+  context_ = std::move(context);
+}
+
 }  // namespace flutter
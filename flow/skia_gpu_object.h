@@ -29,6 +29,10 @@ class SkiaUnrefQueue : public fml::RefCountedThreadSafe<SkiaUnrefQueue> {
   // after this call.
   void Drain();
 
+  // Replaces the context that is signaled to perform deferred cleanup after a
+  // drain. Must be called on the task runner of the queue.
+  void UpdateResourceContext(fml::WeakPtr<GrDirectContext> context);
+
  private:
   const fml::RefPtr<fml::TaskRunner> task_runner_;
   const fml::TimeDelta drain_delay_;
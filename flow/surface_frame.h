@@ -6,6 +6,7 @@
 #define FLUTTER_FLOW_SURFACE_FRAME_H_
 
 #include <memory>
+#include <optional>
 
 #include "flutter/flow/gl_context_switch.h"
 #include "flutter/fml/macros.h"
@@ -21,6 +22,29 @@ class SurfaceFrame {
   using SubmitCallback =
       std::function<bool(const SurfaceFrame& surface_frame, SkCanvas* canvas)>;
 
+  // Information about the underlying framebuffer, provided by the surface.
+  struct FramebufferInfo {
+    // The area of the framebuffer that does not hold the contents of the
+    // previously presented frame. An empty rect means that the framebuffer
+    // holds exactly the previous frame, so only the parts of the frame that
+    // changed need to be repainted. std::nullopt if the contents of the
+    // framebuffer are unknown and the whole frame must be repainted.
+    std::optional<SkIRect> existing_damage;
+  };
+
+  // Information about the rendered frame, passed back to the surface when the
+  // frame is submitted.
+  struct SubmitInfo {
+    // The area of the frame that differs from the previously presented frame.
+    // std::nullopt if unknown, in which case the whole frame must be assumed
+    // to have changed.
+    std::optional<SkIRect> frame_damage;
+
+    // The area of the framebuffer that was repainted. std::nullopt if the
+    // whole framebuffer was repainted.
+    std::optional<SkIRect> buffer_damage;
+  };
+
   SurfaceFrame(sk_sp<SkSurface> surface,
                bool supports_readback,
                const SubmitCallback& submit_callback);
@@ -42,10 +66,22 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  void set_framebuffer_info(const FramebufferInfo& framebuffer_info) {
+    framebuffer_info_ = framebuffer_info;
+  }
+  const FramebufferInfo& framebuffer_info() const { return framebuffer_info_; }
+
+  void set_submit_info(const SubmitInfo& submit_info) {
+    submit_info_ = submit_info;
+  }
+  const SubmitInfo& submit_info() const { return submit_info_; }
+
  private:
   bool submitted_ = false;
   sk_sp<SkSurface> surface_;
   bool supports_readback_;
+  FramebufferInfo framebuffer_info_;
+  SubmitInfo submit_info_;
   SubmitCallback submit_callback_;
   std::unique_ptr<GLContextResult> context_result_;
 
@@ -0,0 +1,132 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/tiled_picture_rasterizer.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+
+namespace flutter {
+
+TiledPictureRasterizer::RecordingCanvas::RecordingCanvas(int width, int height)
+    : SkNWayCanvas(width, height) {}
+
+SkCanvas::SaveLayerStrategy
+TiledPictureRasterizer::RecordingCanvas::getSaveLayerStrategy(
+    const SaveLayerRec& rec) {
+  if (rec.fBackdrop) {
+    needs_readback_ = true;
+  }
+  return SkNWayCanvas::getSaveLayerStrategy(rec);
+}
+
+TiledPictureRasterizer::TiledPictureRasterizer(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+    size_t tile_count)
+    : task_runner_(std::move(task_runner)),
+      tile_count_(std::max<size_t>(tile_count, 1)) {
+  FML_DCHECK(task_runner_);
+}
+
+TiledPictureRasterizer::~TiledPictureRasterizer() = default;
+
+SkCanvas* TiledPictureRasterizer::BeginRecording(const SkISize& size) {
+  SkCanvas* canvas = recorder_.beginRecording(SkRect::Make(size));
+  recording_canvas_ =
+      std::make_unique<RecordingCanvas>(size.width(), size.height());
+  recording_canvas_->addCanvas(canvas);
+  return recording_canvas_.get();
+}
+
+void TiledPictureRasterizer::DiscardRecording() {
+  if (recording_canvas_) {
+    recording_canvas_.reset();
+    recorder_.finishRecordingAsPicture();
+  }
+}
+
+bool TiledPictureRasterizer::Rasterize(SkSurface* surface,
+                                       const SkIRect& damage) {
+  if (!recording_canvas_) {
+    return false;
+  }
+  const bool needs_readback = recording_canvas_->needs_readback();
+  recording_canvas_.reset();
+  sk_sp<SkPicture> picture = recorder_.finishRecordingAsPicture();
+  if (!picture) {
+    return false;
+  }
+
+  // Lets the surface copy its pixels if a snapshot still shares them, and
+  // bumps its generation ID since the pixels are written directly below.
+  surface->notifyContentWillChange(SkSurface::kRetain_ContentChangeMode);
+  SkPixmap pixmap;
+  if (!surface->peekPixels(&pixmap)) {
+    return false;
+  }
+
+  TRACE_EVENT0("flutter", "TiledPictureRasterizer::Rasterize");
+  const std::vector<SkIRect> tiles = ComputeTiles(
+      pixmap.dimensions(), needs_readback ? 1 : tile_count_, damage);
+  if (tiles.empty()) {
+    return true;
+  }
+
+  auto draw_tile = [&picture, &pixmap](const SkIRect& tile) {
+    TRACE_EVENT0("flutter", "TiledPictureRasterizer::DrawTile");
+    SkPixmap tile_pixmap;
+    if (!pixmap.extractSubset(&tile_pixmap, tile)) {
+      return;
+    }
+    std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+        tile_pixmap.info(), tile_pixmap.writable_addr(),
+        tile_pixmap.rowBytes());
+    if (!canvas) {
+      return;
+    }
+    canvas->translate(-tile.left(), -tile.top());
+    canvas->drawPicture(picture);
+  };
+
+  fml::CountDownLatch latch(tiles.size() - 1);
+  for (size_t i = 1; i < tiles.size(); i++) {
+    task_runner_->PostTask([&draw_tile, &latch, tile = tiles[i]]() {
+      draw_tile(tile);
+      latch.CountDown();
+    });
+  }
+  draw_tile(tiles[0]);
+  latch.Wait();
+  return true;
+}
+
+std::vector<SkIRect> TiledPictureRasterizer::ComputeTiles(
+    const SkISize& size,
+    size_t tile_count,
+    const SkIRect& damage) {
+  SkIRect area = damage;
+  if (!area.intersect(SkIRect::MakeSize(size))) {
+    return {};
+  }
+
+  // Horizontal strips keep each tile's pixels contiguous in memory.
+  const size_t count =
+      std::clamp<size_t>(tile_count, 1, static_cast<size_t>(area.height()));
+  std::vector<SkIRect> tiles;
+  tiles.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    const int32_t top =
+        area.top() + static_cast<int32_t>(area.height() * i / count);
+    const int32_t bottom =
+        area.top() + static_cast<int32_t>(area.height() * (i + 1) / count);
+    tiles.push_back(SkIRect::MakeLTRB(area.left(), top, area.right(), bottom));
+  }
+  return tiles;
+}
+
+}  // namespace flutter
@@ -0,0 +1,87 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_TILED_PICTURE_RASTERIZER_H_
+#define FLUTTER_FLOW_TILED_PICTURE_RASTERIZER_H_
+
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/utils/SkNWayCanvas.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Renders frames into raster (software) surfaces using multiple threads.
+///
+/// The frame is first recorded into a picture on the calling thread. The
+/// picture is then played back into horizontal tiles of the surface, one task
+/// per tile on the concurrent task runner, and the call returns once all tiles
+/// are done. The calling thread renders one of the tiles itself.
+///
+/// Tiles that don't intersect the damaged area of the frame are skipped.
+///
+class TiledPictureRasterizer {
+ public:
+  TiledPictureRasterizer(std::shared_ptr<fml::ConcurrentTaskRunner> task_runner,
+                         size_t tile_count);
+
+  ~TiledPictureRasterizer();
+
+  size_t tile_count() const { return tile_count_; }
+
+  // Starts recording a frame of the given size. The returned canvas is valid
+  // until |Rasterize| or |DiscardRecording| is called.
+  SkCanvas* BeginRecording(const SkISize& size);
+
+  // Drops the frame being recorded.
+  void DiscardRecording();
+
+  // Ends the recording and renders the area of the frame covered by |damage|
+  // into |surface|, leaving the rest of its pixels untouched.
+  //
+  // Returns false if the surface pixels can't be accessed directly. The
+  // recording is discarded in that case.
+  bool Rasterize(SkSurface* surface, const SkIRect& damage);
+
+  // Splits the part of a frame of |size| covered by |damage| into at most
+  // |tile_count| horizontal strips of about equal height.
+  static std::vector<SkIRect> ComputeTiles(const SkISize& size,
+                                           size_t tile_count,
+                                           const SkIRect& damage);
+
+ private:
+  // Forwards to the recording canvas while watching for operations that read
+  // back what was drawn below them. Those can't be played back tile by tile
+  // since a tile can't see its neighbours.
+  class RecordingCanvas : public SkNWayCanvas {
+   public:
+    RecordingCanvas(int width, int height);
+
+    bool needs_readback() const { return needs_readback_; }
+
+   protected:
+    SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override;
+
+   private:
+    bool needs_readback_ = false;
+  };
+
+  std::shared_ptr<fml::ConcurrentTaskRunner> task_runner_;
+  const size_t tile_count_;
+  SkPictureRecorder recorder_;
+  std::unique_ptr<RecordingCanvas> recording_canvas_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TiledPictureRasterizer);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_TILED_PICTURE_RASTERIZER_H_
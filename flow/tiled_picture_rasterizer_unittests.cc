@@ -0,0 +1,94 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/tiled_picture_rasterizer.h"
+
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkPaint.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+void DrawScene(SkCanvas* canvas) {
+  canvas->clear(SK_ColorWHITE);
+  SkPaint paint;
+  paint.setColor(SK_ColorRED);
+  canvas->drawCircle(50, 50, 40, paint);
+  paint.setColor(SK_ColorBLUE);
+  canvas->drawRect(SkRect::MakeXYWH(20, 60, 70, 30), paint);
+}
+
+}  // namespace
+
+TEST(TiledPictureRasterizer, ComputeTilesSplitsDamageIntoStrips) {
+  auto tiles = TiledPictureRasterizer::ComputeTiles(
+      SkISize::Make(100, 100), 3, SkIRect::MakeLTRB(10, 10, 50, 40));
+  ASSERT_EQ(tiles.size(), 3u);
+  EXPECT_EQ(tiles[0], SkIRect::MakeLTRB(10, 10, 50, 20));
+  EXPECT_EQ(tiles[1], SkIRect::MakeLTRB(10, 20, 50, 30));
+  EXPECT_EQ(tiles[2], SkIRect::MakeLTRB(10, 30, 50, 40));
+}
+
+TEST(TiledPictureRasterizer, ComputeTilesLimitsToFrameAndRows) {
+  EXPECT_TRUE(TiledPictureRasterizer::ComputeTiles(
+                  SkISize::Make(100, 100), 4, SkIRect::MakeXYWH(200, 0, 5, 5))
+                  .empty());
+
+  auto tiles = TiledPictureRasterizer::ComputeTiles(
+      SkISize::Make(100, 100), 8, SkIRect::MakeLTRB(-10, 98, 120, 200));
+  ASSERT_EQ(tiles.size(), 2u);
+  EXPECT_EQ(tiles[0], SkIRect::MakeLTRB(0, 98, 100, 99));
+  EXPECT_EQ(tiles[1], SkIRect::MakeLTRB(0, 99, 100, 100));
+}
+
+TEST(TiledPictureRasterizer, MatchesSingleThreadedRendering) {
+  auto loop = fml::ConcurrentMessageLoop::Create(3);
+  TiledPictureRasterizer rasterizer(loop->GetTaskRunner(), 4);
+
+  const SkImageInfo info = SkImageInfo::MakeN32Premul(100, 100);
+  auto expected = SkSurface::MakeRaster(info);
+  DrawScene(expected->getCanvas());
+
+  auto actual = SkSurface::MakeRaster(info);
+  DrawScene(rasterizer.BeginRecording(SkISize::Make(100, 100)));
+  ASSERT_TRUE(rasterizer.Rasterize(actual.get(), SkIRect::MakeWH(100, 100)));
+
+  SkPixmap expected_pixels;
+  SkPixmap actual_pixels;
+  ASSERT_TRUE(expected->peekPixels(&expected_pixels));
+  ASSERT_TRUE(actual->peekPixels(&actual_pixels));
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 100; x++) {
+      ASSERT_EQ(actual_pixels.getColor(x, y), expected_pixels.getColor(x, y));
+    }
+  }
+}
+
+TEST(TiledPictureRasterizer, OnlyDamagedPixelsAreWritten) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  TiledPictureRasterizer rasterizer(loop->GetTaskRunner(), 2);
+
+  auto surface = SkSurface::MakeRaster(SkImageInfo::MakeN32Premul(100, 100));
+  surface->getCanvas()->clear(SK_ColorGREEN);
+  const uint32_t generation_id = surface->generationID();
+
+  SkCanvas* canvas = rasterizer.BeginRecording(SkISize::Make(100, 100));
+  canvas->clear(SK_ColorBLACK);
+  ASSERT_TRUE(
+      rasterizer.Rasterize(surface.get(), SkIRect::MakeLTRB(0, 40, 100, 60)));
+  EXPECT_NE(surface->generationID(), generation_id);
+
+  SkPixmap pixels;
+  ASSERT_TRUE(surface->peekPixels(&pixels));
+  EXPECT_EQ(pixels.getColor(50, 20), SK_ColorGREEN);
+  EXPECT_EQ(pixels.getColor(50, 45), SK_ColorBLACK);
+  EXPECT_EQ(pixels.getColor(50, 55), SK_ColorBLACK);
+  EXPECT_EQ(pixels.getColor(50, 80), SK_ColorGREEN);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -12,18 +12,30 @@
 namespace fml {
 
 std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
-    size_t worker_count) {
+    size_t worker_count,
+    std::vector<size_t> worker_cpus) {
   return std::shared_ptr<ConcurrentMessageLoop>{
-      new ConcurrentMessageLoop(worker_count)};
+      new ConcurrentMessageLoop(worker_count, std::move(worker_cpus))};
 }
 
-ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
+ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count,
+                                             std::vector<size_t> worker_cpus)
     : worker_count_(std::max<size_t>(worker_count, 1ul)) {
   for (size_t i = 0; i < worker_count_; ++i) {
-    workers_.emplace_back([i, this]() {
+    worker_queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
+  for (size_t i = 0; i < worker_count_; ++i) {
+    const bool pin = !worker_cpus.empty();
+    const size_t cpu = pin ? worker_cpus[i % worker_cpus.size()] : 0;
+    workers_.emplace_back([i, this, pin, cpu]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.flutter.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      if (pin && !fml::Thread::SetCurrentThreadAffinity(cpu)) {
+        FML_DLOG(WARNING) << "Could not pin concurrent worker " << i + 1
+                          << " to CPU " << cpu << ".";
+      }
+      WorkerMain(i);
     });
   }
 
@@ -47,80 +59,72 @@ std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+void ConcurrentMessageLoop::PostTask(const fml::closure& task,
+                                     ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
-  std::unique_lock lock(tasks_mutex_);
-
   // Don't just drop tasks on the floor in case of shutdown.
   if (shutdown_) {
     FML_DLOG(WARNING)
         << "Tried to post a task to shutdown concurrent message "
            "loop. The task will be executed on the callers thread.";
-    lock.unlock();
     task();
     return;
   }
 
-  tasks_.push(task);
+  // Tasks posted by a worker are likely related to the one it is running, so
+  // keep them on its queue. Other workers will steal them if they are idle.
+  size_t worker_index = GetCurrentWorkerIndex();
+  if (worker_index == worker_count_) {
+    worker_index = next_worker_++ % worker_count_;
+  }
 
-  // Unlock the mutex before notifying the condition variable because that mutex
-  // has to be acquired on the other thread anyway. Waiting in this scope till
-  // it is acquired there is a pessimization.
-  lock.unlock();
+  const size_t priority_index = static_cast<size_t>(priority);
+  {
+    auto& queue = *worker_queues_[worker_index];
+    std::scoped_lock lock(queue.mutex);
+    // Counted under the queue lock so that a worker can't take the task and
+    // decrement the count before it is incremented.
+    ++pending_tasks_[priority_index];
+    queue.tasks[priority_index].push_back(task);
+  }
 
-  tasks_condition_.notify_one();
+  WakeUpIdleWorkers(false);
 }
 
-void ConcurrentMessageLoop::WorkerMain() {
+void ConcurrentMessageLoop::WorkerMain(size_t worker_index) {
   while (true) {
-    std::unique_lock lock(tasks_mutex_);
-    tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
-    });
-
-    // Shutdown cannot be read with the task mutex unlocked.
-    bool shutdown_now = shutdown_;
-    fml::closure task;
-    std::vector<fml::closure> thread_tasks;
-
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
+    // Thread tasks are run even during shutdown as they may be cleaning up
+    // per thread state.
+    for (const auto& thread_task : TakeThreadTasks(worker_index)) {
+      thread_task();
     }
 
-    if (HasThreadTasksLocked()) {
-      thread_tasks = GetThreadTasksLocked();
-      FML_DCHECK(!HasThreadTasksLocked());
+    if (shutdown_) {
+      break;
     }
 
-    // Don't hold onto the mutex while tasks are being executed as they could
-    // themselves try to post more tasks to the message loop.
-    lock.unlock();
-
-    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
-    // Execute the primary task we woke up for.
-    if (task) {
+    if (fml::closure task = TakeTask(worker_index)) {
+      TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
       task();
+      continue;
     }
 
-    // Execute any thread tasks.
-    for (const auto& thread_task : thread_tasks) {
-      thread_task();
-    }
-
-    if (shutdown_now) {
-      break;
-    }
+    std::unique_lock lock(idle_mutex_);
+    ++idle_worker_count_;
+    idle_condition_.wait(lock, [&]() {
+      return shutdown_ || HasPendingTasks() ||
+             worker_queues_[worker_index]->has_thread_tasks;
+    });
+    --idle_worker_count_;
   }
 }
 
 void ConcurrentMessageLoop::Terminate() {
-  std::scoped_lock lock(tasks_mutex_);
   shutdown_ = true;
-  tasks_condition_.notify_all();
+  WakeUpIdleWorkers(true);
 }
 
 void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
@@ -128,24 +132,82 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
     return;
   }
 
-  std::scoped_lock lock(tasks_mutex_);
-  for (const auto& worker_thread_id : worker_thread_ids_) {
-    thread_tasks_[worker_thread_id].emplace_back(task);
+  for (const auto& queue : worker_queues_) {
+    std::scoped_lock lock(queue->mutex);
+    queue->thread_tasks.emplace_back(task);
+    queue->has_thread_tasks = true;
   }
-  tasks_condition_.notify_all();
+  WakeUpIdleWorkers(true);
 }
 
-bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
-  return thread_tasks_.count(std::this_thread::get_id()) > 0;
+size_t ConcurrentMessageLoop::GetCurrentWorkerIndex() const {
+  const auto current_thread_id = std::this_thread::get_id();
+  for (size_t i = 0; i < worker_thread_ids_.size(); ++i) {
+    if (worker_thread_ids_[i] == current_thread_id) {
+      return i;
+    }
+  }
+  return worker_count_;
+}
+
+fml::closure ConcurrentMessageLoop::TakeTask(size_t worker_index) {
+  for (size_t priority = 0; priority < kPriorityCount; ++priority) {
+    if (pending_tasks_[priority] == 0) {
+      continue;
+    }
+    // Look at the worker's own queue first, then steal from the others.
+    for (size_t i = 0; i < worker_count_; ++i) {
+      auto& queue = *worker_queues_[(worker_index + i) % worker_count_];
+      std::scoped_lock lock(queue.mutex);
+      auto& tasks = queue.tasks[priority];
+      if (!tasks.empty()) {
+        fml::closure task = std::move(tasks.front());
+        tasks.pop_front();
+        --pending_tasks_[priority];
+        return task;
+      }
+    }
+  }
+  return nullptr;
+}
+
+std::vector<fml::closure> ConcurrentMessageLoop::TakeThreadTasks(
+    size_t worker_index) {
+  std::vector<fml::closure> thread_tasks;
+  auto& queue = *worker_queues_[worker_index];
+  if (queue.has_thread_tasks) {
+    std::scoped_lock lock(queue.mutex);
+    std::swap(thread_tasks, queue.thread_tasks);
+    queue.has_thread_tasks = false;
+  }
+  return thread_tasks;
+}
+
+bool ConcurrentMessageLoop::HasPendingTasks() const {
+  for (const auto& pending_tasks : pending_tasks_) {
+    if (pending_tasks > 0) {
+      return true;
+    }
+  }
+  return false;
 }
 
-std::vector<fml::closure> ConcurrentMessageLoop::GetThreadTasksLocked() {
-  auto found = thread_tasks_.find(std::this_thread::get_id());
-  FML_DCHECK(found != thread_tasks_.end());
-  std::vector<fml::closure> pending_tasks;
-  std::swap(pending_tasks, found->second);
-  thread_tasks_.erase(found);
-  return pending_tasks;
+void ConcurrentMessageLoop::WakeUpIdleWorkers(bool all) {
+  // Workers increment the idle count with the mutex held before checking for
+  // work, so either they see the work or it is seen here that they are idle.
+  if (idle_worker_count_ == 0) {
+    return;
+  }
+
+  // Taking the mutex makes sure a worker that has decided to sleep is waiting
+  // on the condition variable before it is notified. It is released before
+  // notifying because the worker has to acquire it anyway.
+  { std::scoped_lock lock(idle_mutex_); }
+  if (all) {
+    idle_condition_.notify_all();
+  } else {
+    idle_condition_.notify_one();
+  }
 }
 
 ConcurrentTaskRunner::ConcurrentTaskRunner(
@@ -154,13 +216,14 @@ ConcurrentTaskRunner::ConcurrentTaskRunner(
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(const fml::closure& task,
+                                    ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(task, priority);
     return;
   }
 
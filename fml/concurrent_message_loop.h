@@ -5,10 +5,13 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
-#include <map>
-#include <queue>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
@@ -17,11 +20,29 @@ namespace fml {
 
 class ConcurrentTaskRunner;
 
+// The order in which workers pick up tasks. Tasks of a higher priority are
+// always picked up before tasks of a lower one, on any worker.
+enum class ConcurrentTaskPriority {
+  // Work whose result the user is waiting to see, like decoding an image that
+  // is about to be displayed.
+  kUserVisible,
+  kNormal,
+  // Speculative work, like warming up shaders that may be needed later.
+  kBackground,
+};
+
+// A pool of worker threads. Each worker has its own queue of tasks per
+// priority. Tasks posted from a worker go to its own queue, other tasks are
+// spread over the workers in turn. Workers that run out of tasks steal them
+// from the other workers before going to sleep.
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
+  // If |worker_cpus| isn't empty, worker |i| is pinned to CPU
+  // |worker_cpus[i % worker_cpus.size()]| where the platform supports it.
   static std::shared_ptr<ConcurrentMessageLoop> Create(
-      size_t worker_count = std::thread::hardware_concurrency());
+      size_t worker_count = std::thread::hardware_concurrency(),
+      std::vector<size_t> worker_cpus = {});
 
   ~ConcurrentMessageLoop();
 
@@ -36,24 +57,47 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
+  static constexpr size_t kPriorityCount =
+      static_cast<size_t>(ConcurrentTaskPriority::kBackground) + 1;
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<fml::closure> tasks[kPriorityCount];
+    std::vector<fml::closure> thread_tasks;
+    std::atomic_bool has_thread_tasks = false;
+  };
+
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
   std::vector<std::thread::id> worker_thread_ids_;
-  std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
-  bool shutdown_ = false;
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  std::atomic_size_t pending_tasks_[kPriorityCount] = {};
+  std::atomic_size_t next_worker_ = 0;
+
+  // Idle workers sleep on the condition variable. Posting a task only takes
+  // the mutex if a worker is idle.
+  std::mutex idle_mutex_;
+  std::condition_variable idle_condition_;
+  std::atomic_size_t idle_worker_count_ = 0;
+  std::atomic_bool shutdown_ = false;
+
+  ConcurrentMessageLoop(size_t worker_count, std::vector<size_t> worker_cpus);
+
+  void WorkerMain(size_t worker_index);
+
+  void PostTask(const fml::closure& task, ConcurrentTaskPriority priority);
 
-  ConcurrentMessageLoop(size_t worker_count);
+  // Returns the index of the worker running on the current thread, or
+  // |worker_count_| if the current thread is not a worker.
+  size_t GetCurrentWorkerIndex() const;
 
-  void WorkerMain();
+  fml::closure TakeTask(size_t worker_index);
 
-  void PostTask(const fml::closure& task);
+  std::vector<fml::closure> TakeThreadTasks(size_t worker_index);
 
-  bool HasThreadTasksLocked() const;
+  bool HasPendingTasks() const;
 
-  std::vector<fml::closure> GetThreadTasksLocked();
+  void WakeUpIdleWorkers(bool all);
 
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
@@ -64,7 +108,9 @@ class ConcurrentTaskRunner {
 
   ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task);
+  void PostTask(
+      const fml::closure& task,
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kNormal);
 
  private:
   friend ConcurrentMessageLoop;
@@ -0,0 +1,117 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/concurrent_message_loop.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace fml {
+namespace benchmarking {
+
+namespace {
+
+void Spin(fml::TimeDelta duration) {
+  const auto end = fml::TimePoint::Now() + duration;
+  while (fml::TimePoint::Now() < end) {
+  }
+}
+
+}  // namespace
+
+// Posts a burst of small tasks mixed with a few large ones, like a grid of
+// thumbnails being decoded while other work trickles in. Reports the
+// throughput and the tail latency from posting a task to it starting to run.
+static void BM_ConcurrentMessageLoopBurst(
+    benchmark::State& state) {  // NOLINT
+  const size_t worker_count = state.range(0);
+  const size_t num_tasks = 1000;
+  // One in every |large_task_interval| tasks is large.
+  const size_t large_task_interval = 50;
+
+  auto loop = fml::ConcurrentMessageLoop::Create(worker_count);
+  auto task_runner = loop->GetTaskRunner();
+  std::vector<int64_t> latencies(num_tasks);
+  std::vector<int64_t> all_latencies;
+
+  while (state.KeepRunning()) {
+    fml::CountDownLatch latch(num_tasks);
+    for (size_t i = 0; i < num_tasks; i++) {
+      const auto posted = fml::TimePoint::Now();
+      const auto duration = i % large_task_interval == 0
+                                ? fml::TimeDelta::FromMilliseconds(1)
+                                : fml::TimeDelta::FromMicroseconds(5);
+      task_runner->PostTask([&latencies, &latch, i, posted, duration]() {
+        latencies[i] = (fml::TimePoint::Now() - posted).ToNanoseconds();
+        Spin(duration);
+        latch.CountDown();
+      });
+    }
+    latch.Wait();
+    all_latencies.insert(all_latencies.end(), latencies.begin(),
+                         latencies.end());
+  }
+
+  std::sort(all_latencies.begin(), all_latencies.end());
+  auto percentile = [&all_latencies](double p) {
+    return static_cast<double>(
+        all_latencies[static_cast<size_t>((all_latencies.size() - 1) * p)]);
+  };
+  state.counters["p50_latency_ns"] = percentile(0.5);
+  state.counters["p99_latency_ns"] = percentile(0.99);
+  state.counters["max_latency_ns"] = percentile(1.0);
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
+BENCHMARK(BM_ConcurrentMessageLoopBurst)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+// Posts tiny tasks from several threads at once to measure the overhead of
+// posting and picking up tasks.
+static void BM_ConcurrentMessageLoopPostFromManyThreads(
+    benchmark::State& state) {  // NOLINT
+  const size_t worker_count = state.range(0);
+  const size_t num_posters = 4;
+  const size_t num_tasks_per_poster = 1000;
+
+  auto loop = fml::ConcurrentMessageLoop::Create(worker_count);
+  auto task_runner = loop->GetTaskRunner();
+
+  while (state.KeepRunning()) {
+    fml::CountDownLatch latch(num_posters * num_tasks_per_poster);
+    std::vector<std::thread> posters;
+    for (size_t i = 0; i < num_posters; i++) {
+      posters.emplace_back([&task_runner, &latch]() {
+        for (size_t j = 0; j < num_tasks_per_poster; j++) {
+          task_runner->PostTask([&latch]() { latch.CountDown(); });
+        }
+      });
+    }
+    for (auto& poster : posters) {
+      poster.join();
+    }
+    latch.Wait();
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_posters *
+                          num_tasks_per_poster);
+}
+
+BENCHMARK(BM_ConcurrentMessageLoopPostFromManyThreads)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+}  // namespace benchmarking
+}  // namespace fml
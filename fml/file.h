@@ -72,6 +72,14 @@ bool IsFile(const std::string& path);
 
 bool TruncateFile(const fml::UniqueFD& file, size_t size);
 
+/// Takes an exclusive advisory lock on the file, waiting for other processes
+/// that hold it to release it. Returns false if the lock could not be taken,
+/// as on file systems without support for locks.
+bool LockFile(const fml::UniqueFD& file);
+
+/// Releases a lock taken by `LockFile`.
+bool UnlockFile(const fml::UniqueFD& file);
+
 bool FileExists(const fml::UniqueFD& base_directory, const char* path);
 
 bool UnlinkDirectory(const char* path);
@@ -69,6 +69,25 @@ TEST(FileTest, CanOpenFileForWriting) {
   ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "some.txt"));
 }
 
+TEST(FileTest, CanLockAndUnlock) {
+  fml::ScopedTemporaryDirectory dir;
+  auto fd = fml::OpenFile(dir.fd(), "some.lock", true,
+                          fml::FilePermission::kReadWrite);
+  ASSERT_TRUE(fd.is_valid());
+  ASSERT_TRUE(fml::LockFile(fd));
+  ASSERT_TRUE(fml::UnlockFile(fd));
+
+  // Another descriptor of the file can take the lock once it is released.
+  auto other_fd = fml::OpenFile(dir.fd(), "some.lock", false,
+                                fml::FilePermission::kReadWrite);
+  ASSERT_TRUE(fml::LockFile(other_fd));
+  ASSERT_TRUE(fml::UnlockFile(other_fd));
+
+  fd.reset();
+  other_fd.reset();
+  ASSERT_TRUE(fml::UnlinkFile(dir.fd(), "some.lock"));
+}
+
 TEST(FileTest, CanTruncateAndWrite) {
   fml::ScopedTemporaryDirectory dir;
   ASSERT_TRUE(dir.fd().is_valid());
@@ -85,6 +104,7 @@ TEST(FileTest, CanTruncateAndWrite) {
     fml::FileMapping mapping(fd, {fml::FileMapping::Protection::kWrite});
     ASSERT_EQ(mapping.GetSize(), contents.size());
     ASSERT_NE(mapping.GetMutableMapping(), nullptr);
+    ASSERT_TRUE(mapping.IsWritable());
 
     ::memcpy(mapping.GetMutableMapping(), contents.data(), contents.size());
   }
@@ -96,6 +116,7 @@ TEST(FileTest, CanTruncateAndWrite) {
 
     fml::FileMapping mapping(fd);
     ASSERT_EQ(mapping.GetSize(), contents.size());
+    ASSERT_FALSE(mapping.IsWritable());
 
     ASSERT_EQ(0,
               ::memcmp(mapping.GetMapping(), contents.data(), contents.size()));
@@ -9,12 +9,22 @@
 
 namespace fml {
 
+// Mapping
+
+bool Mapping::IsWritable() const {
+  return false;
+}
+
 // FileMapping
 
 uint8_t* FileMapping::GetMutableMapping() {
   return mutable_mapping_;
 }
 
+bool FileMapping::IsWritable() const {
+  return mutable_mapping_ != nullptr;
+}
+
 std::unique_ptr<FileMapping> FileMapping::CreateReadOnly(
     const std::string& path) {
   return CreateReadOnly(OpenFile(path.c_str(), false, FilePermission::kRead),
@@ -81,12 +91,20 @@ const uint8_t* DataMapping::GetMapping() const {
   return data_.data();
 }
 
+bool DataMapping::IsWritable() const {
+  return true;
+}
+
 // NonOwnedMapping
 
 NonOwnedMapping::NonOwnedMapping(const uint8_t* data,
                                  size_t size,
-                                 const ReleaseProc& release_proc)
-    : data_(data), size_(size), release_proc_(release_proc) {}
+                                 const ReleaseProc& release_proc,
+                                 bool is_writable)
+    : data_(data),
+      size_(size),
+      release_proc_(release_proc),
+      is_writable_(is_writable) {}
 
 NonOwnedMapping::~NonOwnedMapping() {
   if (release_proc_) {
@@ -102,6 +120,10 @@ const uint8_t* NonOwnedMapping::GetMapping() const {
   return data_;
 }
 
+bool NonOwnedMapping::IsWritable() const {
+  return is_writable_;
+}
+
 // Symbol Mapping
 
 SymbolMapping::SymbolMapping(fml::RefPtr<fml::NativeLibrary> native_library,
@@ -28,6 +28,11 @@ class Mapping {
 
   virtual const uint8_t* GetMapping() const = 0;
 
+  // Whether the memory returned by |GetMapping| may be written to by whoever
+  // holds the mapping. This allows handing the buffer out to code that
+  // expects mutable memory, such as Dart typed data, without a copy.
+  virtual bool IsWritable() const;
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Mapping);
 };
@@ -65,6 +70,9 @@ class FileMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  bool IsWritable() const override;
+
   uint8_t* GetMutableMapping();
 
   bool IsValid() const;
@@ -96,6 +104,9 @@ class DataMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  bool IsWritable() const override;
+
  private:
   std::vector<uint8_t> data_;
 
@@ -105,9 +116,12 @@ class DataMapping final : public Mapping {
 class NonOwnedMapping final : public Mapping {
  public:
   using ReleaseProc = std::function<void(const uint8_t* data, size_t size)>;
+  // Set |is_writable| only if the owner of |data| allows the holder of the
+  // mapping to modify it until |release_proc| is called.
   NonOwnedMapping(const uint8_t* data,
                   size_t size,
-                  const ReleaseProc& release_proc = nullptr);
+                  const ReleaseProc& release_proc = nullptr,
+                  bool is_writable = false);
 
   ~NonOwnedMapping() override;
 
@@ -117,10 +131,14 @@ class NonOwnedMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  bool IsWritable() const override;
+
  private:
   const uint8_t* const data_;
   const size_t size_;
   const ReleaseProc release_proc_;
+  const bool is_writable_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(NonOwnedMapping);
 };
@@ -6,6 +6,7 @@
 
 #include "flutter/fml/message_loop_task_queues.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "flutter/fml/make_copyable.h"
@@ -13,17 +14,65 @@
 
 namespace fml {
 
+namespace {
+
+int64_t ToWakeTime(fml::TimePoint time) {
+  return time.ToEpochDelta().ToNanoseconds();
+}
+
+fml::TimePoint FromWakeTime(int64_t wake_time) {
+  return fml::TimePoint::FromEpochDelta(
+      fml::TimeDelta::FromNanoseconds(wake_time));
+}
+
+}  // namespace
+
 std::mutex MessageLoopTaskQueues::creation_mutex_;
 
 const size_t TaskQueueId::kUnmerged = ULONG_MAX;
 
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::instance_;
 
+IncomingTaskList::IncomingTaskList() : head_(nullptr) {}
+
+IncomingTaskList::~IncomingTaskList() {
+  Node* node = head_.load();
+  while (node) {
+    Node* next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
+void IncomingTaskList::Push(DelayedTask task) {
+  Node* node = new Node{std::move(task), head_.load(std::memory_order_relaxed)};
+  while (!head_.compare_exchange_weak(node->next, node)) {
+  }
+}
+
+bool IncomingTaskList::IsEmpty() const {
+  return head_.load() == nullptr;
+}
+
+void IncomingTaskList::MoveTo(DelayedTaskQueue& tasks) {
+  // The list is taken as a whole so there is no ABA problem. Its order doesn't
+  // matter since the heap orders tasks by target time and registration order.
+  Node* node = head_.exchange(nullptr);
+  while (node) {
+    Node* next = node->next;
+    tasks.push(std::move(node->task));
+    delete node;
+    node = next;
+  }
+}
+
 TaskQueueEntry::TaskQueueEntry()
-    : owner_of(_kUnmerged), subsumed_by(_kUnmerged) {
+    : num_pending_tasks(0),
+      wake_time(ToWakeTime(fml::TimePoint::Max())),
+      owner_of(_kUnmerged),
+      subsumed_by(_kUnmerged) {
   wakeable = NULL;
   task_observers = TaskObservers();
-  delayed_tasks = DelayedTaskQueue();
 }
 
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
@@ -35,7 +84,7 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 }
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
   ++task_queue_id_counter_;
   queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>();
@@ -43,12 +92,14 @@ TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
 }
 
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : task_queue_id_counter_(0), order_(0) {}
+    : queue_mutex_(fml::SharedMutex::Create()),
+      task_queue_id_counter_(0),
+      order_(0) {}
 
 MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
@@ -59,55 +110,83 @@ void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   TaskQueueId subsumed = queue_entry->owner_of;
+  MoveIncomingTasksUnlocked(queue_id);
   queue_entry->delayed_tasks = {};
+  queue_entry->num_pending_tasks = 0;
   if (subsumed != _kUnmerged) {
-    queue_entries_.at(subsumed)->delayed_tasks = {};
+    const auto& subsumed_entry = queue_entries_.at(subsumed);
+    subsumed_entry->delayed_tasks = {};
+    subsumed_entry->num_pending_tasks = 0;
   }
 }
 
 void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
                                          const fml::closure& task,
                                          fml::TimePoint target_time) {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_mutex_);
   size_t order = order_++;
   const auto& queue_entry = queue_entries_.at(queue_id);
-  queue_entry->delayed_tasks.push({order, task, target_time});
+  // Counted before the push so the task is never pending without being
+  // counted.
+  ++queue_entry->num_pending_tasks;
+  queue_entry->incoming_tasks.Push({order, task, target_time});
   TaskQueueId loop_to_wake = queue_id;
   if (queue_entry->subsumed_by != _kUnmerged) {
     loop_to_wake = queue_entry->subsumed_by;
   }
-  WakeUpUnlocked(loop_to_wake, GetNextWakeTimeUnlocked(loop_to_wake));
+  WakeUpForNewTaskUnlocked(loop_to_wake, target_time);
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_mutex_);
   return HasPendingTasksUnlocked(queue_id);
 }
 
 fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
                                                      fml::TimePoint from_time) {
-  std::lock_guard guard(queue_mutex_);
-  if (!HasPendingTasksUnlocked(queue_id)) {
+  fml::SharedLock lock(*queue_mutex_);
+  const auto& entry = queue_entries_.at(queue_id);
+  if (entry->subsumed_by != _kUnmerged) {
     return nullptr;
   }
+
   TaskQueueId top_queue = _kUnmerged;
-  const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
+  const DelayedTask* top = nullptr;
+  for (;;) {
+    if (!MoveIncomingTasksUnlocked(queue_id)) {
+      // Reset the wake time so that the next task registered wakes the loop
+      // up at its own target time. The check below catches tasks pushed after
+      // the incoming lists were emptied whose wake-up this store has undone.
+      entry->wake_time = ToWakeTime(fml::TimePoint::Max());
+      if (HasIncomingTasksUnlocked(queue_id)) {
+        continue;
+      }
+      return nullptr;
+    }
 
-  if (!HasPendingTasksUnlocked(queue_id)) {
-    WakeUpUnlocked(queue_id, fml::TimePoint::Max());
-  } else {
-    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
+    top = &PeekNextTaskUnlocked(queue_id, top_queue);
+    const fml::TimePoint wake_time = top->GetTargetTime();
+    entry->wake_time = ToWakeTime(wake_time);
+    WakeUpUnlocked(queue_id, wake_time);
+
+    // A task pushed after the incoming lists were emptied may have had its
+    // wake-up overridden by the one above.
+    if (!HasIncomingTasksUnlocked(queue_id)) {
+      break;
+    }
   }
 
-  if (top.GetTargetTime() > from_time) {
+  if (top->GetTargetTime() > from_time) {
     return nullptr;
   }
-  fml::closure invocation = top.GetTask();
-  queue_entries_.at(top_queue)->delayed_tasks.pop();
+  fml::closure invocation = top->GetTask();
+  const auto& top_entry = queue_entries_.at(top_queue);
+  top_entry->delayed_tasks.pop();
+  --top_entry->num_pending_tasks;
   return invocation;
 }
 
@@ -118,20 +197,46 @@ void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
   }
 }
 
+void MessageLoopTaskQueues::WakeUpForNewTaskUnlocked(
+    TaskQueueId queue_id,
+    fml::TimePoint time) const {
+  const auto& entry = queue_entries_.at(queue_id);
+
+  // Only ever move the wake time earlier. A later task will be found when the
+  // loop wakes up for the earlier one.
+  int64_t wake_time = ToWakeTime(time);
+  int64_t scheduled = entry->wake_time.load();
+  while (wake_time < scheduled &&
+         !entry->wake_time.compare_exchange_weak(scheduled, wake_time)) {
+  }
+  wake_time = std::min(wake_time, scheduled);
+
+  for (;;) {
+    WakeUpUnlocked(queue_id, FromWakeTime(wake_time));
+    // Another producer, or the loop itself, may have scheduled an earlier
+    // wake-up that the one above has overridden.
+    const int64_t latest = entry->wake_time.load();
+    if (latest >= wake_time) {
+      break;
+    }
+    wake_time = latest;
+  }
+}
+
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_mutex_);
   const auto& queue_entry = queue_entries_.at(queue_id);
   if (queue_entry->subsumed_by != _kUnmerged) {
     return 0;
   }
 
   size_t total_tasks = 0;
-  total_tasks += queue_entry->delayed_tasks.size();
+  total_tasks += queue_entry->num_pending_tasks;
 
   TaskQueueId subsumed = queue_entry->owner_of;
   if (subsumed != _kUnmerged) {
     const auto& subsumed_entry = queue_entries_.at(subsumed);
-    total_tasks += subsumed_entry->delayed_tasks.size();
+    total_tasks += subsumed_entry->num_pending_tasks;
   }
   return total_tasks;
 }
@@ -139,20 +244,20 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
                                             intptr_t key,
                                             const fml::closure& callback) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
   queue_entries_.at(queue_id)->task_observers[key] = callback;
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   queue_entries_.at(queue_id)->task_observers.erase(key);
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_mutex_);
   std::vector<fml::closure> observers;
 
   if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
@@ -175,7 +280,7 @@ std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   FML_CHECK(!queue_entries_.at(queue_id)->wakeable)
       << "Wakeable can only be set once.";
   queue_entries_.at(queue_id)->wakeable = wakeable;
@@ -185,7 +290,7 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   if (owner == subsumed) {
     return true;
   }
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   auto& owner_entry = queue_entries_.at(owner);
   auto& subsumed_entry = queue_entries_.at(subsumed);
 
@@ -206,15 +311,19 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   owner_entry->owner_of = subsumed;
   subsumed_entry->subsumed_by = owner;
 
-  if (HasPendingTasksUnlocked(owner)) {
-    WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
+  // No task can be registered while the lock is held exclusively, so the
+  // timer heaps can be used from this thread.
+  if (MoveIncomingTasksUnlocked(owner)) {
+    const fml::TimePoint wake_time = GetNextWakeTimeUnlocked(owner);
+    owner_entry->wake_time = ToWakeTime(wake_time);
+    WakeUpUnlocked(owner, wake_time);
   }
 
   return true;
 }
 
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
-  std::lock_guard guard(queue_mutex_);
+  fml::UniqueLock lock(*queue_mutex_);
   const auto& owner_entry = queue_entries_.at(owner);
   const TaskQueueId subsumed = owner_entry->owner_of;
   if (subsumed == _kUnmerged) {
@@ -224,12 +333,12 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
   queue_entries_.at(subsumed)->subsumed_by = _kUnmerged;
   owner_entry->owner_of = _kUnmerged;
 
-  if (HasPendingTasksUnlocked(owner)) {
-    WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
-  }
-
-  if (HasPendingTasksUnlocked(subsumed)) {
-    WakeUpUnlocked(subsumed, GetNextWakeTimeUnlocked(subsumed));
+  for (TaskQueueId queue_id : {owner, subsumed}) {
+    if (MoveIncomingTasksUnlocked(queue_id)) {
+      const fml::TimePoint wake_time = GetNextWakeTimeUnlocked(queue_id);
+      queue_entries_.at(queue_id)->wake_time = ToWakeTime(wake_time);
+      WakeUpUnlocked(queue_id, wake_time);
+    }
   }
 
   return true;
@@ -237,7 +346,7 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
 
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
-  std::lock_guard guard(queue_mutex_);
+  fml::SharedLock lock(*queue_mutex_);
   return subsumed == queue_entries_.at(owner)->owner_of;
 }
 
@@ -251,7 +360,7 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     return false;
   }
 
-  if (!entry->delayed_tasks.empty()) {
+  if (entry->num_pending_tasks > 0) {
     return true;
   }
 
@@ -260,8 +369,34 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     // this is not an owner and queue is empty.
     return false;
   } else {
-    return !queue_entries_.at(subsumed)->delayed_tasks.empty();
+    return queue_entries_.at(subsumed)->num_pending_tasks > 0;
+  }
+}
+
+// Must only be called from the thread servicing |owner|, or with the lock held
+// exclusively.
+bool MessageLoopTaskQueues::MoveIncomingTasksUnlocked(TaskQueueId owner) {
+  const auto& entry = queue_entries_.at(owner);
+  entry->incoming_tasks.MoveTo(entry->delayed_tasks);
+  bool has_tasks = !entry->delayed_tasks.empty();
+
+  const TaskQueueId subsumed = entry->owner_of;
+  if (subsumed != _kUnmerged) {
+    const auto& subsumed_entry = queue_entries_.at(subsumed);
+    subsumed_entry->incoming_tasks.MoveTo(subsumed_entry->delayed_tasks);
+    has_tasks = has_tasks || !subsumed_entry->delayed_tasks.empty();
   }
+  return has_tasks;
+}
+
+bool MessageLoopTaskQueues::HasIncomingTasksUnlocked(TaskQueueId owner) const {
+  const auto& entry = queue_entries_.at(owner);
+  if (!entry->incoming_tasks.IsEmpty()) {
+    return true;
+  }
+  const TaskQueueId subsumed = entry->owner_of;
+  return subsumed != _kUnmerged &&
+         !queue_entries_.at(subsumed)->incoming_tasks.IsEmpty();
 }
 
 fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
@@ -273,7 +408,6 @@ fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
 const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
     TaskQueueId owner,
     TaskQueueId& top_queue_id) const {
-  FML_DCHECK(HasPendingTasksUnlocked(owner));
   const auto& entry = queue_entries_.at(owner);
   const TaskQueueId subsumed = entry->owner_of;
   if (subsumed == _kUnmerged) {
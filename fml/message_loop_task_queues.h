@@ -5,7 +5,9 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -32,6 +34,33 @@ class TaskQueueId {
 
 static const TaskQueueId _kUnmerged = TaskQueueId(TaskQueueId::kUnmerged);
 
+// Lock-free list of tasks that have been registered on a queue but not yet
+// moved to its |DelayedTaskQueue|. Any number of threads may push tasks, only
+// the thread servicing the queue may take them out.
+class IncomingTaskList {
+ public:
+  IncomingTaskList();
+
+  ~IncomingTaskList();
+
+  void Push(DelayedTask task);
+
+  bool IsEmpty() const;
+
+  // Moves all the pushed tasks to |tasks|.
+  void MoveTo(DelayedTaskQueue& tasks);
+
+ private:
+  struct Node {
+    DelayedTask task;
+    Node* next;
+  };
+
+  std::atomic<Node*> head_;
+
+  FML_DISALLOW_COPY_ASSIGN_AND_MOVE(IncomingTaskList);
+};
+
 // This is keyed by the |TaskQueueId| and contains all the queue
 // components that make up a single TaskQueue.
 class TaskQueueEntry {
@@ -39,8 +68,20 @@ class TaskQueueEntry {
   using TaskObservers = std::map<intptr_t, fml::closure>;
   Wakeable* wakeable;
   TaskObservers task_observers;
+
+  // Tasks are registered on |incoming_tasks| without taking any lock. They are
+  // moved to the |delayed_tasks| timer heap by the thread that services the
+  // queue, which is the only thread that may touch the heap.
+  IncomingTaskList incoming_tasks;
   DelayedTaskQueue delayed_tasks;
 
+  // The number of tasks in |incoming_tasks| and |delayed_tasks|.
+  std::atomic_size_t num_pending_tasks;
+
+  // The time the wakeable of this queue was last asked to wake up at, in
+  // nanoseconds since the epoch.
+  std::atomic<int64_t> wake_time;
+
   // Note: Both of these can be _kUnmerged, which indicates that
   // this queue has not been merged or subsumed. OR exactly one
   // of these will be _kUnmerged, if owner_of is _kUnmerged, it means
@@ -131,8 +172,19 @@ class MessageLoopTaskQueues
 
   void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
 
+  // Wakes up the loop servicing |queue_id| after a task targeting |time| was
+  // pushed to it, without touching the timer heaps.
+  void WakeUpForNewTaskUnlocked(TaskQueueId queue_id,
+                                fml::TimePoint time) const;
+
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
+  // Moves the incoming tasks of |owner|, and of the queue it owns, to their
+  // timer heaps. Returns false if the heaps are empty afterwards.
+  bool MoveIncomingTasksUnlocked(TaskQueueId owner);
+
+  bool HasIncomingTasksUnlocked(TaskQueueId owner) const;
+
   const DelayedTask& PeekNextTaskUnlocked(TaskQueueId owner,
                                           TaskQueueId& top_queue_id) const;
 
@@ -141,7 +193,9 @@ class MessageLoopTaskQueues
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
+  // Guards the entries and their merged state. Registering and running tasks
+  // only needs a shared lock.
+  std::unique_ptr<fml::SharedMutex> queue_mutex_;
   std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
 
   size_t task_queue_id_counter_;
@@ -66,5 +66,75 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
 
 BENCHMARK(BM_RegisterAndGetTasks);
 
+// Several producer threads register tasks on each of several queues while one
+// consumer thread per queue services it, as happens when many threads post to
+// the platform, UI and raster task runners at once.
+static void BM_MultiProducerContention(benchmark::State& state) {  // NOLINT
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  const int num_task_queues = state.range(0);
+  const int num_producers_per_queue = state.range(1);
+  const int num_tasks_per_producer = 1000;
+  const int num_tasks_per_queue =
+      num_producers_per_queue * num_tasks_per_producer;
+
+  while (state.KeepRunning()) {
+    std::vector<TaskQueueId> queue_ids;
+    for (int i = 0; i < num_task_queues; i++) {
+      queue_ids.push_back(task_queue->CreateTaskQueue());
+    }
+
+    const fml::TimePoint past = fml::TimePoint::Now();
+    CountDownLatch start(1);
+    std::vector<std::thread> threads;
+
+    for (const TaskQueueId& queue_id : queue_ids) {
+      for (int i = 0; i < num_producers_per_queue; i++) {
+        threads.emplace_back([&task_queue, &start, queue_id, past]() {
+          start.Wait();
+          for (int j = 0; j < num_tasks_per_producer; j++) {
+            task_queue->RegisterTask(queue_id, [] {}, past);
+          }
+        });
+      }
+      threads.emplace_back([&task_queue, &start, queue_id,
+                            num_tasks_per_queue]() {
+        start.Wait();
+        int num_invocations = 0;
+        while (num_invocations < num_tasks_per_queue) {
+          fml::closure invocation =
+              task_queue->GetNextTaskToRun(queue_id, fml::TimePoint::Now());
+          if (invocation) {
+            num_invocations++;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    start.CountDown();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (const TaskQueueId& queue_id : queue_ids) {
+      task_queue->Dispose(queue_id);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_task_queues *
+                          num_tasks_per_queue);
+}
+
+BENCHMARK(BM_MultiProducerContention)
+    ->ArgNames({"queues", "producers"})
+    ->Args({1, 1})
+    ->Args({1, 4})
+    ->Args({4, 1})
+    ->Args({4, 4})
+    ->Args({8, 4})
+    ->UseRealTime();
+
 }  // namespace benchmarking
 }  // namespace fml
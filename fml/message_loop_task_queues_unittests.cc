@@ -283,5 +283,51 @@ TEST(MessageLoopTaskQueue, RegisterTaskWakesUpOwnerQueue) {
   ASSERT_EQ(time1, wakes[2]);
 }
 
+TEST(MessageLoopTaskQueue, ConcurrentProducersDoNotLoseTasksOrWakeUps) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+
+  // Tracks the latest requested wake-up.
+  std::mutex wake_mutex;
+  fml::TimePoint wake_time = fml::TimePoint::Max();
+  task_queue->SetWakeable(queue_id,
+                          new TestWakeable([&](fml::TimePoint time) {
+                            std::scoped_lock lock(wake_mutex);
+                            wake_time = time;
+                          }));
+
+  const int num_producers = 4;
+  const int num_tasks_per_producer = 1000;
+  const auto past = fml::TimePoint::Now();
+  std::vector<std::thread> producers;
+  for (int i = 0; i < num_producers; i++) {
+    producers.emplace_back([&]() {
+      for (int j = 0; j < num_tasks_per_producer; j++) {
+        task_queue->RegisterTask(
+            queue_id, []() {}, past);
+      }
+    });
+  }
+
+  int num_invocations = 0;
+  while (num_invocations < num_producers * num_tasks_per_producer) {
+    if (task_queue->GetNextTaskToRun(queue_id, fml::TimePoint::Now())) {
+      num_invocations++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  ASSERT_FALSE(task_queue->HasPendingTasks(queue_id));
+
+  task_queue->RegisterTask(
+      queue_id, []() {}, past);
+  std::scoped_lock lock(wake_mutex);
+  ASSERT_EQ(wake_time, past);
+}
+
 }  // namespace testing
 }  // namespace fml
@@ -316,3 +316,80 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsHigherPriorityTasksFirst) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1u);
+  auto task_runner = loop->GetTaskRunner();
+
+  // Keep the only worker busy until all the tasks are posted.
+  fml::AutoResetWaitableEvent worker_busy, tasks_posted;
+  task_runner->PostTask([&]() {
+    worker_busy.Signal();
+    tasks_posted.Wait();
+  });
+  worker_busy.Wait();
+
+  std::vector<int> order;
+  fml::CountDownLatch latch(3);
+  task_runner->PostTask(
+      [&]() {
+        order.push_back(3);
+        latch.CountDown();
+      },
+      fml::ConcurrentTaskPriority::kBackground);
+  task_runner->PostTask([&]() {
+    order.push_back(2);
+    latch.CountDown();
+  });
+  task_runner->PostTask(
+      [&]() {
+        order.push_back(1);
+        latch.CountDown();
+      },
+      fml::ConcurrentTaskPriority::kUserVisible);
+  tasks_posted.Signal();
+  latch.Wait();
+
+  ASSERT_EQ(order, std::vector<int>({1, 2, 3}));
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopIdleWorkersStealTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2u);
+  auto task_runner = loop->GetTaskRunner();
+
+  // Both tasks are posted from the same worker so they land on its queue. The
+  // second can only run while the first one blocks if the other worker steals
+  // it.
+  fml::AutoResetWaitableEvent stolen_task_ran;
+  fml::CountDownLatch latch(1);
+  task_runner->PostTask([&]() {
+    task_runner->PostTask([&]() { stolen_task_ran.Signal(); });
+    stolen_task_ran.Wait();
+    latch.CountDown();
+  });
+  latch.Wait();
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopCanPinWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2u, {0u});
+  auto task_runner = loop->GetTaskRunner();
+  fml::CountDownLatch latch(4);
+  for (size_t i = 0; i < 4; ++i) {
+    task_runner->PostTask([&]() { latch.CountDown(); });
+  }
+  latch.Wait();
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksOnAllWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(3u);
+  fml::CountDownLatch latch(3);
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  loop->PostTaskToAllWorkers([&]() {
+    std::scoped_lock lock(thread_ids_mutex);
+    thread_ids.insert(std::this_thread::get_id());
+    latch.CountDown();
+  });
+  latch.Wait();
+  ASSERT_EQ(thread_ids.size(), 3u);
+}
@@ -68,7 +68,7 @@ FileMapping::FileMapping(const fml::UniqueFD& handle,
     return;
   }
 
-  const auto is_writable = IsWritable(protection);
+  const auto is_writable = fml::IsWritable(protection);
 
   auto* mapping =
       ::mmap(nullptr, stat_buffer.st_size, ToPosixProtectionFlags(protection),
@@ -329,6 +329,25 @@ bool TruncateFile(const fml::UniqueFD& file, size_t size) {
   return true;
 }
 
+bool LockFile(const fml::UniqueFD& file) {
+  OVERLAPPED overlapped = {};
+  if (!::LockFileEx(file.get(), LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD,
+                    &overlapped)) {
+    FML_DLOG(ERROR) << "Could not lock file. " << GetLastErrorMessage();
+    return false;
+  }
+  return true;
+}
+
+bool UnlockFile(const fml::UniqueFD& file) {
+  OVERLAPPED overlapped = {};
+  if (!::UnlockFileEx(file.get(), 0, MAXDWORD, MAXDWORD, &overlapped)) {
+    FML_DLOG(ERROR) << "Could not unlock file. " << GetLastErrorMessage();
+    return false;
+  }
+  return true;
+}
+
 bool FileExists(const fml::UniqueFD& base_directory, const char* path) {
   return GetFileAttributesForUtf8Path(base_directory, path) !=
          INVALID_FILE_ATTRIBUTES;
@@ -60,7 +60,7 @@ FileMapping::FileMapping(const fml::UniqueFD& fd,
   }
 
   DWORD protect_flags = 0;
-  bool read_only = !IsWritable(protections);
+  bool read_only = !fml::IsWritable(protections);
 
   if (IsExecutable(protections)) {
     protect_flags = PAGE_EXECUTE_READ;
@@ -96,7 +96,7 @@ FileMapping::FileMapping(const fml::UniqueFD& fd,
   mapping_ = mapping;
   size_ = mapping_size;
   valid_ = true;
-  if (IsWritable(protections)) {
+  if (fml::IsWritable(protections)) {
     mutable_mapping_ = mapping_;
   }
 }
@@ -21,6 +21,10 @@
 #include <pthread.h>
 #endif
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sched.h>
+#endif
+
 namespace fml {
 
 Thread::Thread(const std::string& name) : joined_(false) {
@@ -94,4 +98,18 @@ void Thread::SetCurrentThreadName(const std::string& name) {
 #endif
 }
 
+bool Thread::SetCurrentThreadAffinity(size_t cpu) {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  return sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace fml
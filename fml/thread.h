@@ -26,6 +26,10 @@ class Thread {
 
   static void SetCurrentThreadName(const std::string& name);
 
+  // Restricts the current thread to run on the given CPU. Returns false if
+  // that isn't supported on this platform or the CPU doesn't exist.
+  static bool SetCurrentThreadAffinity(size_t cpu);
+
  private:
   std::unique_ptr<std::thread> thread_;
   fml::RefPtr<fml::TaskRunner> task_runner_;
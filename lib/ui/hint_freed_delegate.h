@@ -17,6 +17,22 @@ class HintFreedDelegate {
   ///                   previously supplied value, rather than replacing.
   ///
   virtual void HintFreed(size_t size) = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Notifies the engine that an image referenced from Dart now
+  ///             holds native bytes, for memory accounting.
+  ///
+  /// @param[in]  size  The number of bytes held by the image.
+  ///
+  virtual void HintImageRetained(size_t size) = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Notifies the engine that an image previously reported via
+  ///             `HintImageRetained` released its bytes.
+  ///
+  /// @param[in]  size  The number of bytes the image held.
+  ///
+  virtual void HintImageReleased(size_t size) = 0;
 };
 
 }  // namespace flutter
@@ -4813,6 +4813,42 @@ class ImageDescriptor extends NativeFieldWrapperClass2 {
   void _instantiateCodec(Codec outCodec, int targetWidth, int targetHeight) native 'ImageDescriptor_instantiateCodec';
 }
 
+/// Signature for the callback that [ProgressiveImageDecoder] invokes with the
+/// image decoded so far.
+///
+/// The `image` is null if `isFinal` is true and the image could not be
+/// decoded.
+typedef ProgressiveImageCallback = void Function(Image? image, bool isFinal);
+
+/// Decodes an image while its encoded bytes arrive, like from the network.
+///
+/// Add the bytes with [addChunk] as they are received, and call [close] once
+/// all of them were added. The `callback` is invoked with the image decoded
+/// from the bytes received so far, and once more with `isFinal` set once
+/// the image is complete.
+///
+/// PNG and GIF images are decoded and shown while their bytes arrive. The
+/// bytes that were decoded are dropped, so the whole encoded image is never
+/// held in memory. Other formats are decoded once [close] was called.
+/// Animated images only yield their first frame.
+class ProgressiveImageDecoder extends NativeFieldWrapperClass2 {
+  /// Creates a decoder that invokes `callback` with the decoded images.
+  ProgressiveImageDecoder(ProgressiveImageCallback callback) {
+    _constructor(callback);
+  }
+  void _constructor(ProgressiveImageCallback callback) native 'ProgressiveImageDecoder_constructor';
+
+  /// Adds the next chunk of the encoded image. The bytes are copied.
+  void addChunk(Uint8List chunk) native 'ProgressiveImageDecoder_addChunk';
+
+  /// Signals that all chunks were added.
+  void close() native 'ProgressiveImageDecoder_close';
+
+  /// Stops decoding and releases the resources used by this object. The
+  /// callback is not invoked after this method is called.
+  void dispose() native 'ProgressiveImageDecoder_dispose';
+}
+
 /// Generic callback signature, used by [_futurize].
 typedef _Callback<T> = void Function(T result);
 
@@ -0,0 +1,178 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <iterator>
+#include <string_view>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+size_t DecodedImageCache::Key::Hash::operator()(const Key& key) const {
+  return fml::HashCombine(key.content_hash, key.content_size, key.target_width,
+                          key.target_height);
+}
+
+bool DecodedImageCache::Key::operator==(const Key& other) const {
+  return content_hash == other.content_hash &&
+         content_size == other.content_size &&
+         target_width == other.target_width &&
+         target_height == other.target_height;
+}
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+DecodedImageCache::~DecodedImageCache() {
+  Release(std::move(entries_));
+}
+
+DecodedImageCache::Key DecodedImageCache::MakeKey(const SkData& content,
+                                                  const SkImageInfo& info,
+                                                  size_t row_bytes,
+                                                  uint32_t target_width,
+                                                  uint32_t target_height) {
+  TRACE_EVENT0("flutter", "DecodedImageCache::MakeKey");
+  const std::string_view bytes(static_cast<const char*>(content.data()),
+                               content.size());
+  // The bytes of decompressed images only mean something along with how the
+  // pixels are laid out.
+  Key key;
+  key.content_hash = fml::HashCombine(
+      std::hash<std::string_view>{}(bytes), info.width(), info.height(),
+      info.colorType(), info.alphaType(), row_bytes);
+  key.content_size = content.size();
+  key.target_width = target_width;
+  key.target_height = target_height;
+  return key;
+}
+
+static bool SameContent(const sk_sp<SkData>& a, const sk_sp<SkData>& b) {
+  return a == b || (a && b && a->equals(b.get()));
+}
+
+DecodedImageCache::RequestResult DecodedImageCache::Request(
+    const Key& key,
+    sk_sp<SkData> content,
+    Callback on_decoded,
+    SkiaGPUObject<SkImage>* cached_image) {
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    EntryList::iterator entry = found->second;
+    if (!SameContent(entry->content, content)) {
+      return RequestResult::kBypass;
+    }
+    entries_.splice(entries_.begin(), entries_, entry);
+    *cached_image = {entry->image, entry->queue};
+    return RequestResult::kHit;
+  }
+
+  auto pending = pending_.find(key);
+  if (pending != pending_.end()) {
+    if (!SameContent(pending->second.content, content)) {
+      return RequestResult::kBypass;
+    }
+    pending->second.callbacks.push_back(std::move(on_decoded));
+    return RequestResult::kJoined;
+  }
+
+  pending_[key].content = std::move(content);
+  return RequestResult::kDecode;
+}
+
+void DecodedImageCache::Complete(const Key& key,
+                                 sk_sp<SkImage> image,
+                                 fml::RefPtr<SkiaUnrefQueue> queue) {
+  std::vector<Callback> callbacks;
+  EntryList evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    auto pending = pending_.find(key);
+    if (pending == pending_.end()) {
+      FML_DCHECK(false) << "Completed a decode that wasn't requested.";
+      return;
+    }
+    callbacks = std::move(pending->second.callbacks);
+    sk_sp<SkData> content = std::move(pending->second.content);
+    pending_.erase(pending);
+
+    // Images that don't fit are handed to the waiting callbacks only.
+    const size_t bytes =
+        image ? image->imageInfo().computeMinByteSize() + content->size() : 0;
+    if (image && bytes <= max_bytes_) {
+      entries_.push_front({key, std::move(content), image, queue, bytes});
+      index_[key] = entries_.begin();
+      cached_bytes_ += bytes;
+      evicted = EvictLocked(max_bytes_);
+      TraceUsageLocked();
+    }
+  }
+
+  Release(std::move(evicted));
+
+  for (auto& callback : callbacks) {
+    if (image) {
+      callback({image, queue});
+    } else {
+      callback({});
+    }
+  }
+}
+
+void DecodedImageCache::Purge(size_t target_bytes) {
+  EntryList evicted;
+  {
+    std::scoped_lock lock(mutex_);
+    if (cached_bytes_ <= target_bytes) {
+      return;
+    }
+    TRACE_EVENT0("flutter", "DecodedImageCache::Purge");
+    evicted = EvictLocked(target_bytes);
+    TraceUsageLocked();
+  }
+  Release(std::move(evicted));
+}
+
+size_t DecodedImageCache::GetCachedBytes() const {
+  std::scoped_lock lock(mutex_);
+  return cached_bytes_;
+}
+
+size_t DecodedImageCache::GetCachedCount() const {
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+DecodedImageCache::EntryList DecodedImageCache::EvictLocked(
+    size_t target_bytes) {
+  EntryList evicted;
+  while (cached_bytes_ > target_bytes && !entries_.empty()) {
+    const Entry& entry = entries_.back();
+    cached_bytes_ -= entry.bytes;
+    index_.erase(entry.key);
+    evicted.splice(evicted.end(), entries_, std::prev(entries_.end()));
+  }
+  return evicted;
+}
+
+void DecodedImageCache::Release(EntryList entries) {
+  for (Entry& entry : entries) {
+    if (entry.queue) {
+      entry.queue->Unref(entry.image.release());
+    }
+  }
+}
+
+void DecodedImageCache::TraceUsageLocked() const {
+  FML_TRACE_COUNTER("flutter", "DecodedImageCache",
+                    reinterpret_cast<int64_t>(this), "Bytes", cached_bytes_,
+                    "Images", entries_.size());
+}
+
+}  // namespace flutter
@@ -0,0 +1,166 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Keeps recently decoded images so that decoding the same bytes to the same
+/// size again, like when a list scrolls an image back into view or another
+/// engine shows the same asset, reuses the image instead of decoding and
+/// uploading it again.
+///
+/// Images are keyed by a hash of their encoded bytes and the size they were
+/// decoded to. The bytes are compared as well, so that a hash collision never
+/// hands out the wrong image. Requests for an image that is being decoded wait
+/// for that decode instead of starting another one.
+///
+/// The least recently used images are evicted once the cache holds more than
+/// its maximum, or when it is asked to purge under memory pressure.
+///
+/// This class is thread safe. Callbacks are invoked without any lock held.
+///
+class DecodedImageCache {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+
+  struct Key {
+    size_t content_hash = 0;
+    size_t content_size = 0;
+    uint32_t target_width = 0;
+    uint32_t target_height = 0;
+
+    struct Hash {
+      size_t operator()(const Key& key) const;
+    };
+
+    bool operator==(const Key& other) const;
+  };
+
+  using Callback = std::function<void(SkiaGPUObject<SkImage>)>;
+
+  enum class RequestResult {
+    // The image was cached and was returned.
+    kHit,
+    // The image is being decoded. The callback is invoked when it's done.
+    kJoined,
+    // The caller must decode the image and call |Complete| with it.
+    kDecode,
+    // The key is in use by different bytes. The caller must decode the image
+    // and not call |Complete|.
+    kBypass,
+  };
+
+  explicit DecodedImageCache(size_t max_bytes = kDefaultMaxBytes);
+
+  ~DecodedImageCache();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates the key of the image encoded in |content|, or stored
+  ///             in it as pixels described by |info| and |row_bytes|, decoded
+  ///             to the given size. Hashes all of |content|, so call it off
+  ///             the UI thread.
+  ///
+  static Key MakeKey(const SkData& content,
+                     const SkImageInfo& info,
+                     size_t row_bytes,
+                     uint32_t target_width,
+                     uint32_t target_height);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Looks up the image for |key|, or registers the caller as the
+  ///             one decoding it.
+  ///
+  /// @param[in]  key           The key made from |content|.
+  /// @param[in]  content       The bytes the image is decoded from.
+  /// @param[in]  on_decoded    Retained if the request joins a decode in
+  ///                           flight. Invoked with the image, which is null
+  ///                           if decoding failed.
+  /// @param[out] cached_image  Set to the image on a hit.
+  ///
+  RequestResult Request(const Key& key,
+                        sk_sp<SkData> content,
+                        Callback on_decoded,
+                        SkiaGPUObject<SkImage>* cached_image);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Finishes a request that returned |RequestResult::kDecode|.
+  ///             Caches the image and hands it to the requests that joined
+  ///             the decode.
+  ///
+  /// @param[in]  key    The key of the request.
+  /// @param[in]  image  The decoded image, or null if decoding failed, in
+  ///                    which case nothing is cached.
+  /// @param[in]  queue  The queue the image must be released on, if any.
+  ///
+  void Complete(const Key& key,
+                sk_sp<SkImage> image,
+                fml::RefPtr<SkiaUnrefQueue> queue);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Evicts the least recently used images until the cache holds
+  ///             at most |target_bytes|. Decodes in flight are unaffected.
+  ///
+  void Purge(size_t target_bytes = 0);
+
+  size_t GetMaxBytes() const { return max_bytes_; }
+
+  size_t GetCachedBytes() const;
+
+  size_t GetCachedCount() const;
+
+ private:
+  struct Entry {
+    Key key;
+    sk_sp<SkData> content;
+    sk_sp<SkImage> image;
+    fml::RefPtr<SkiaUnrefQueue> queue;
+    size_t bytes = 0;
+  };
+
+  struct PendingDecode {
+    sk_sp<SkData> content;
+    std::vector<Callback> callbacks;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  const size_t max_bytes_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, Key::Hash> index_;
+  std::unordered_map<Key, PendingDecode, Key::Hash> pending_;
+  size_t cached_bytes_ = 0;
+
+  // Must be called with the lock held. The evicted entries are returned, so
+  // that their images are released after the lock is.
+  EntryList EvictLocked(size_t target_bytes);
+
+  // Releases the images of |entries| on their queues.
+  static void Release(EntryList entries);
+
+  void TraceUsageLocked() const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
@@ -0,0 +1,240 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/testing/thread_test.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// Images of 4x4 pixels take 64 bytes, their content another 64.
+constexpr size_t kEntryBytes = 128;
+
+sk_sp<SkData> MakeContent(char fill) {
+  const std::string bytes(64, fill);
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+SkImageInfo MakeInfo() {
+  return SkImageInfo::MakeN32Premul(4, 4);
+}
+
+sk_sp<SkImage> MakeImage(const sk_sp<SkData>& content) {
+  return SkImage::MakeRasterData(MakeInfo(), content, 16);
+}
+
+DecodedImageCache::Key MakeKey(const SkData& content) {
+  return DecodedImageCache::MakeKey(content, MakeInfo(), 16, 4, 4);
+}
+
+bool IsCached(DecodedImageCache& cache, const sk_sp<SkData>& content) {
+  SkiaGPUObject<SkImage> cached_image;
+  return cache.Request(MakeKey(*content), content, nullptr, &cached_image) ==
+         DecodedImageCache::RequestResult::kHit;
+}
+
+}  // namespace
+
+class DecodedImageCacheTest : public ThreadTest {
+ public:
+  DecodedImageCacheTest() {
+    // The unref queue must be created on the thread it unrefs on.
+    auto unref_task_runner = CreateNewThread();
+    fml::AutoResetWaitableEvent latch;
+    unref_task_runner->PostTask([this, unref_task_runner, &latch]() {
+      unref_queue_ = fml::MakeRefCounted<SkiaUnrefQueue>(
+          unref_task_runner, fml::TimeDelta::FromSeconds(0));
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+
+  const fml::RefPtr<SkiaUnrefQueue>& unref_queue() const {
+    return unref_queue_;
+  }
+
+  // Puts the image decoded from |content| in |cache|.
+  void Insert(DecodedImageCache& cache, const sk_sp<SkData>& content) {
+    const auto key = MakeKey(*content);
+    SkiaGPUObject<SkImage> cached_image;
+    ASSERT_EQ(cache.Request(key, content, nullptr, &cached_image),
+              DecodedImageCache::RequestResult::kDecode);
+    cache.Complete(key, MakeImage(content), unref_queue_);
+  }
+
+ private:
+  fml::RefPtr<SkiaUnrefQueue> unref_queue_;
+};
+
+TEST(DecodedImageCache, KeyDependsOnContentAndSize) {
+  auto a = MakeContent('a');
+  auto b = MakeContent('b');
+  const auto key = MakeKey(*a);
+  EXPECT_EQ(key, MakeKey(*MakeContent('a')));
+  EXPECT_FALSE(key == MakeKey(*b));
+  EXPECT_FALSE(key == DecodedImageCache::MakeKey(*a, MakeInfo(), 16, 2, 2));
+  EXPECT_FALSE(key == DecodedImageCache::MakeKey(
+                          *a, SkImageInfo::MakeN32Premul(8, 2), 32, 4, 4));
+}
+
+TEST_F(DecodedImageCacheTest, ReturnsCachedImageForSameContent) {
+  DecodedImageCache cache;
+  auto content = MakeContent('a');
+  const auto key = MakeKey(*content);
+  SkiaGPUObject<SkImage> cached_image;
+  ASSERT_EQ(cache.Request(key, content, nullptr, &cached_image),
+            DecodedImageCache::RequestResult::kDecode);
+  auto image = MakeImage(content);
+  cache.Complete(key, image, unref_queue());
+  EXPECT_EQ(cache.GetCachedCount(), 1u);
+  EXPECT_EQ(cache.GetCachedBytes(), kEntryBytes);
+
+  // Equal bytes in another buffer hit as well.
+  EXPECT_EQ(cache.Request(key, MakeContent('a'), nullptr, &cached_image),
+            DecodedImageCache::RequestResult::kHit);
+  EXPECT_EQ(cached_image.get(), image);
+}
+
+TEST_F(DecodedImageCacheTest, ConcurrentRequestsJoinTheDecodeInFlight) {
+  DecodedImageCache cache;
+  auto content = MakeContent('a');
+  const auto key = MakeKey(*content);
+  std::vector<sk_sp<SkImage>> delivered;
+  auto on_decoded = [&delivered](SkiaGPUObject<SkImage> image) {
+    delivered.push_back(image.get());
+  };
+
+  SkiaGPUObject<SkImage> cached_image;
+  ASSERT_EQ(cache.Request(key, content, on_decoded, &cached_image),
+            DecodedImageCache::RequestResult::kDecode);
+  EXPECT_EQ(cache.Request(key, content, on_decoded, &cached_image),
+            DecodedImageCache::RequestResult::kJoined);
+  EXPECT_EQ(cache.Request(key, content, on_decoded, &cached_image),
+            DecodedImageCache::RequestResult::kJoined);
+  EXPECT_TRUE(delivered.empty());
+
+  auto image = MakeImage(content);
+  cache.Complete(key, image, unref_queue());
+  ASSERT_EQ(delivered.size(), 2u);
+  EXPECT_EQ(delivered[0], image);
+  EXPECT_EQ(delivered[1], image);
+}
+
+TEST_F(DecodedImageCacheTest, FailedDecodesAreNotCached) {
+  DecodedImageCache cache;
+  auto content = MakeContent('a');
+  const auto key = MakeKey(*content);
+  bool delivered_null = false;
+
+  SkiaGPUObject<SkImage> cached_image;
+  ASSERT_EQ(cache.Request(key, content, nullptr, &cached_image),
+            DecodedImageCache::RequestResult::kDecode);
+  ASSERT_EQ(cache.Request(
+                key, content,
+                [&delivered_null](SkiaGPUObject<SkImage> image) {
+                  delivered_null = !image.get();
+                },
+                &cached_image),
+            DecodedImageCache::RequestResult::kJoined);
+  cache.Complete(key, nullptr, nullptr);
+  EXPECT_TRUE(delivered_null);
+  EXPECT_EQ(cache.GetCachedCount(), 0u);
+
+  // The next request decodes again.
+  EXPECT_EQ(cache.Request(key, content, nullptr, &cached_image),
+            DecodedImageCache::RequestResult::kDecode);
+  cache.Complete(key, nullptr, nullptr);
+}
+
+TEST_F(DecodedImageCacheTest, DifferentContentWithSameKeyBypassesTheCache) {
+  DecodedImageCache cache;
+  auto content = MakeContent('a');
+  Insert(cache, content);
+
+  // Pretend that the hashes of different bytes collide.
+  SkiaGPUObject<SkImage> cached_image;
+  EXPECT_EQ(cache.Request(MakeKey(*content), MakeContent('b'), nullptr,
+                          &cached_image),
+            DecodedImageCache::RequestResult::kBypass);
+  EXPECT_FALSE(cached_image.get());
+}
+
+TEST_F(DecodedImageCacheTest, EvictsLeastRecentlyUsedImages) {
+  DecodedImageCache cache(3 * kEntryBytes);
+  auto a = MakeContent('a');
+  auto b = MakeContent('b');
+  auto c = MakeContent('c');
+  auto d = MakeContent('d');
+  Insert(cache, a);
+  Insert(cache, b);
+  Insert(cache, c);
+  EXPECT_EQ(cache.GetCachedCount(), 3u);
+
+  // Using |a| makes |b| the least recently used.
+  EXPECT_TRUE(IsCached(cache, a));
+  Insert(cache, d);
+  EXPECT_EQ(cache.GetCachedCount(), 3u);
+  EXPECT_EQ(cache.GetCachedBytes(), 3 * kEntryBytes);
+  EXPECT_FALSE(IsCached(cache, b));
+  EXPECT_TRUE(IsCached(cache, a));
+  EXPECT_TRUE(IsCached(cache, c));
+  EXPECT_TRUE(IsCached(cache, d));
+}
+
+TEST_F(DecodedImageCacheTest, ImagesLargerThanTheCacheAreNotCached) {
+  DecodedImageCache cache(kEntryBytes - 1);
+  auto content = MakeContent('a');
+  const auto key = MakeKey(*content);
+  SkiaGPUObject<SkImage> cached_image;
+  ASSERT_EQ(cache.Request(key, content, nullptr, &cached_image),
+            DecodedImageCache::RequestResult::kDecode);
+  cache.Complete(key, MakeImage(content), unref_queue());
+  EXPECT_EQ(cache.GetCachedCount(), 0u);
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST_F(DecodedImageCacheTest, PurgesDownToTarget) {
+  DecodedImageCache cache;
+  auto a = MakeContent('a');
+  auto b = MakeContent('b');
+  auto c = MakeContent('c');
+  Insert(cache, a);
+  Insert(cache, b);
+  Insert(cache, c);
+
+  cache.Purge(2 * kEntryBytes);
+  EXPECT_EQ(cache.GetCachedCount(), 2u);
+  EXPECT_FALSE(IsCached(cache, a));
+
+  cache.Purge();
+  EXPECT_EQ(cache.GetCachedCount(), 0u);
+  EXPECT_EQ(cache.GetCachedBytes(), 0u);
+}
+
+TEST_F(DecodedImageCacheTest, PurgeKeepsDecodesInFlight) {
+  DecodedImageCache cache;
+  auto content = MakeContent('a');
+  const auto key = MakeKey(*content);
+  SkiaGPUObject<SkImage> cached_image;
+  ASSERT_EQ(cache.Request(key, content, nullptr, &cached_image),
+            DecodedImageCache::RequestResult::kDecode);
+  cache.Purge();
+  EXPECT_EQ(cache.Request(
+                key, content, [](SkiaGPUObject<SkImage> image) {},
+                &cached_image),
+            DecodedImageCache::RequestResult::kJoined);
+  cache.Complete(key, MakeImage(content), unref_queue());
+  EXPECT_TRUE(IsCached(cache, content));
+}
+
+}  // namespace testing
+}  // namespace flutter
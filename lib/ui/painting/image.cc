@@ -30,7 +30,29 @@ void CanvasImage::RegisterNatives(tonic::DartLibraryNatives* natives) {
 
 CanvasImage::CanvasImage() = default;
 
-CanvasImage::~CanvasImage() = default;
+CanvasImage::~CanvasImage() {
+  ReleaseRetainedBytes();
+}
+
+void CanvasImage::set_image(flutter::SkiaGPUObject<SkImage> image) {
+  ReleaseRetainedBytes();
+  image_ = std::move(image);
+  if (!image_.get()) {
+    return;
+  }
+  hint_freed_delegate_ = UIDartState::Current()->GetHintFreedDelegate();
+  if (hint_freed_delegate_) {
+    retained_bytes_ = GetAllocationSize();
+    hint_freed_delegate_->HintImageRetained(retained_bytes_);
+  }
+}
+
+void CanvasImage::ReleaseRetainedBytes() {
+  if (retained_bytes_ > 0 && hint_freed_delegate_) {
+    hint_freed_delegate_->HintImageReleased(retained_bytes_);
+  }
+  retained_bytes_ = 0;
+}
 
 Dart_Handle CanvasImage::toByteData(int format, Dart_Handle callback) {
   return EncodeImage(this, format, callback);
@@ -41,6 +63,7 @@ void CanvasImage::dispose() {
   if (hint_freed_delegate) {
     hint_freed_delegate->HintFreed(GetAllocationSize());
   }
+  ReleaseRetainedBytes();
   image_.reset();
   ClearDartWrapper();
 }
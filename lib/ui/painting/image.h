@@ -35,9 +35,10 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
   void dispose();
 
   sk_sp<SkImage> image() const { return image_.get(); }
-  void set_image(flutter::SkiaGPUObject<SkImage> image) {
-    image_ = std::move(image);
-  }
+
+  // Must be called on the UI thread so that the bytes of the image are
+  // accounted to the engine of the current isolate.
+  void set_image(flutter::SkiaGPUObject<SkImage> image);
 
   size_t GetAllocationSize() const override;
 
@@ -47,6 +48,11 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
   CanvasImage();
 
   flutter::SkiaGPUObject<SkImage> image_;
+  // The engine that the bytes of |image_| are accounted to.
+  fml::WeakPtr<HintFreedDelegate> hint_freed_delegate_;
+  size_t retained_bytes_ = 0;
+
+  void ReleaseRetainedBytes();
 };
 
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #include "flutter/lib/ui/painting/image_decoder.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "flutter/fml/make_copyable.h"
 #include "third_party/skia/include/codec/SkCodec.h"
@@ -14,10 +15,14 @@ namespace flutter {
 ImageDecoder::ImageDecoder(
     TaskRunners runners,
     std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
-    fml::WeakPtr<IOManager> io_manager)
+    fml::WeakPtr<IOManager> io_manager,
+    std::shared_ptr<DecodedImageCache> decoded_image_cache,
+    AnimatedImageOptions animated_image_options)
     : runners_(std::move(runners)),
       concurrent_task_runner_(std::move(concurrent_task_runner)),
       io_manager_(std::move(io_manager)),
+      decoded_image_cache_(std::move(decoded_image_cache)),
+      animated_image_options_(animated_image_options),
       weak_factory_(this) {
   FML_DCHECK(runners_.IsValid());
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread())
@@ -96,6 +101,39 @@ static sk_sp<SkImage> ImageFromDecompressedData(
                            SkISize::Make(target_width, target_height), flow);
 }
 
+SkISize GetDecodeDimensions(const ImageDescriptor& descriptor,
+                            const SkISize& resized_dimensions,
+                            int* sample_size) {
+  const SkISize source_dimensions = descriptor.image_info().dimensions();
+  *sample_size = 1;
+  if (resized_dimensions.isEmpty() || source_dimensions.isEmpty()) {
+    return source_dimensions;
+  }
+
+  const double scale =
+      std::max(static_cast<double>(resized_dimensions.width()) /
+                   source_dimensions.width(),
+               static_cast<double>(resized_dimensions.height()) /
+                   source_dimensions.height());
+  const SkISize scaled_dimensions = descriptor.get_scaled_dimensions(scale);
+  if (scaled_dimensions != source_dimensions || scale > 0.5) {
+    return scaled_dimensions;
+  }
+
+  // Codecs that cannot scale natively, like PNG and GIF, can still skip whole
+  // pixels while decoding. The largest sample size that keeps both dimensions
+  // at least at the target size leaves only a fractional resize.
+  const int candidate_sample_size = static_cast<int>(1.0 / scale);
+  const SkISize sampled_dimensions =
+      descriptor.get_sampled_dimensions(candidate_sample_size);
+  if (sampled_dimensions.width() < resized_dimensions.width() ||
+      sampled_dimensions.height() < resized_dimensions.height()) {
+    return source_dimensions;
+  }
+  *sample_size = candidate_sample_size;
+  return sampled_dimensions;
+}
+
 sk_sp<SkImage> ImageFromCompressedData(fml::RefPtr<ImageDescriptor> descriptor,
                                        uint32_t target_width,
                                        uint32_t target_height,
@@ -112,11 +150,9 @@ sk_sp<SkImage> ImageFromCompressedData(fml::RefPtr<ImageDescriptor> descriptor,
   const SkISize resized_dimensions = {static_cast<int32_t>(target_width),
                                       static_cast<int32_t>(target_height)};
 
-  auto decode_dimensions = descriptor->get_scaled_dimensions(
-      std::max(static_cast<double>(resized_dimensions.width()) /
-                   source_dimensions.width(),
-               static_cast<double>(resized_dimensions.height()) /
-                   source_dimensions.height()));
+  int sample_size = 1;
+  const SkISize decode_dimensions =
+      GetDecodeDimensions(*descriptor, resized_dimensions, &sample_size);
 
   // If the codec supports efficient sub-pixel decoding, decoded at a resolution
   // close to the target resolution before resizing.
@@ -132,7 +168,11 @@ sk_sp<SkImage> ImageFromCompressedData(fml::RefPtr<ImageDescriptor> descriptor,
     }
 
     const auto& pixmap = scaled_bitmap.pixmap();
-    if (descriptor->get_pixels(pixmap)) {
+    const bool decoded = sample_size > 1
+                             ? descriptor->get_sampled_pixels(pixmap,
+                                                              sample_size)
+                             : descriptor->get_pixels(pixmap);
+    if (decoded) {
       // Marking this as immutable makes the MakeFromBitmap call share
       // the pixels instead of copying.
       scaled_bitmap.setImmutable();
@@ -213,6 +253,66 @@ static SkiaGPUObject<SkImage> UploadRasterImage(
   return result;
 }
 
+// Uploads the decompressed image to the GPU. On the IO thread.
+static SkiaGPUObject<SkImage> UploadDecompressedImage(
+    sk_sp<SkImage> image,
+    const fml::WeakPtr<IOManager>& io_manager,
+    const fml::tracing::TraceFlow& flow) {
+  if (!io_manager) {
+    FML_LOG(ERROR) << "Could not acquire IO manager.";
+    return {};
+  }
+
+  // If the IO manager does not have a resource context, the caller might not
+  // have set one or a software backend could be in use. Either way, just
+  // return the image as-is.
+  if (!io_manager->GetResourceContext()) {
+    return {std::move(image), io_manager->GetSkiaUnrefQueue()};
+  }
+
+  auto uploaded = UploadRasterImage(std::move(image), io_manager, flow);
+  if (!uploaded.get()) {
+    FML_LOG(ERROR) << "Could not upload image to the GPU.";
+  }
+  return uploaded;
+}
+
+namespace {
+
+// A decode that other requests for the same image may be waiting for. Unless
+// it is completed with the image, it is completed with none when it goes
+// away, so that the requests waiting for it don't get stuck when decoding
+// fails or the tasks of the decode are dropped.
+class CachedDecode {
+ public:
+  CachedDecode() = default;
+
+  CachedDecode(std::shared_ptr<DecodedImageCache> cache,
+               const DecodedImageCache::Key& key)
+      : cache_(std::move(cache)), key_(key) {}
+
+  CachedDecode(CachedDecode&&) = default;
+
+  CachedDecode& operator=(CachedDecode&&) = default;
+
+  ~CachedDecode() { Complete(nullptr, nullptr); }
+
+  void Complete(sk_sp<SkImage> image, fml::RefPtr<SkiaUnrefQueue> queue) {
+    if (cache_) {
+      cache_->Complete(key_, std::move(image), std::move(queue));
+      cache_ = nullptr;
+    }
+  }
+
+ private:
+  std::shared_ptr<DecodedImageCache> cache_;
+  DecodedImageCache::Key key_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(CachedDecode);
+};
+
+}  // namespace
+
 void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor,
                           uint32_t target_width,
                           uint32_t target_height,
@@ -243,14 +343,45 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor,
   }
 
   concurrent_task_runner_->PostTask(
-      fml::MakeCopyable([descriptor,                              //
-                         io_manager = io_manager_,                //
-                         io_runner = runners_.GetIOTaskRunner(),  //
-                         result,                                  //
-                         target_width = target_width,             //
-                         target_height = target_height,           //
-                         flow = std::move(flow)                   //
+      fml::MakeCopyable([descriptor,                                  //
+                         io_manager = io_manager_,                    //
+                         io_runner = runners_.GetIOTaskRunner(),      //
+                         decoded_image_cache = decoded_image_cache_,  //
+                         result,                                      //
+                         target_width = target_width,                 //
+                         target_height = target_height,               //
+                         flow = std::move(flow)                       //
   ]() mutable {
+        // Step 0: Reuse the image if it was decoded from the same bytes to
+        // the same size already, or wait for the decode of it in flight.
+        // On Worker.
+
+        CachedDecode cached_decode;
+        if (decoded_image_cache) {
+          const auto key = DecodedImageCache::MakeKey(
+              *descriptor->data(), descriptor->image_info(),
+              descriptor->row_bytes(), target_width, target_height);
+          SkiaGPUObject<SkImage> cached_image;
+          switch (decoded_image_cache->Request(
+              key, descriptor->data(),
+              [result](SkiaGPUObject<SkImage> image) {
+                result(std::move(image),
+                       fml::tracing::TraceFlow("DecodedImageCache::Joined"));
+              },
+              &cached_image)) {
+            case DecodedImageCache::RequestResult::kHit:
+              result(std::move(cached_image), std::move(flow));
+              return;
+            case DecodedImageCache::RequestResult::kJoined:
+              return;
+            case DecodedImageCache::RequestResult::kDecode:
+              cached_decode = CachedDecode(decoded_image_cache, key);
+              break;
+            case DecodedImageCache::RequestResult::kBypass:
+              break;
+          }
+        }
+
         // Step 1: Decompress the image.
         // On Worker.
 
@@ -275,35 +406,105 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor,
         // On IO Thread.
 
         io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+                                               cached_decode =
+                                                   std::move(cached_decode),
                                                flow =
                                                    std::move(flow)]() mutable {
-          if (!io_manager) {
-            FML_LOG(ERROR) << "Could not acquire IO manager.";
-            return result({}, std::move(flow));
-          }
+          auto image = UploadDecompressedImage(std::move(decompressed),
+                                               io_manager, flow);
 
-          // If the IO manager does not have a resource context, the caller
-          // might not have set one or a software backend could be in use.
-          // Either way, just return the image as-is.
-          if (!io_manager->GetResourceContext()) {
-            result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
-                   std::move(flow));
-            return;
+          // Finally, all done.
+          if (image.get()) {
+            cached_decode.Complete(image.get(),
+                                   io_manager->GetSkiaUnrefQueue());
           }
+          result(std::move(image), std::move(flow));
+        }));
+      }),
+      // The framework is waiting to display the image.
+      fml::ConcurrentTaskPriority::kUserVisible);
+}
+
+std::shared_ptr<IncrementalImageDecoder> ImageDecoder::DecodeIncrementally(
+    const ProgressiveImageResult& callback) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+
+  FML_DCHECK(callback);
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  // Intermediate frames decoded while the previous one is still on its way to
+  // the UI thread are skipped. The next frame has all of their pixels anyway.
+  auto frame_in_flight = std::make_shared<std::atomic<bool>>(false);
+
+  return IncrementalImageDecoder::Create(
+      concurrent_task_runner_,
+      [callback,                                //
+       frame_in_flight,                         //
+       io_manager = io_manager_,                //
+       io_runner = runners_.GetIOTaskRunner(),  //
+       ui_runner = runners_.GetUITaskRunner()   //
+  ](const SkBitmap& bitmap, bool is_final) {
+        // Step 1: Take the pixels decoded so far.
+        // On Worker.
+
+        if (!is_final && frame_in_flight->exchange(true)) {
+          return;
+        }
+
+        fml::tracing::TraceFlow flow("ImageDecoder::DecodeIncrementally");
+        sk_sp<SkImage> image;
+        if (!bitmap.isNull()) {
+          // The decoder keeps writing to the pixels of intermediate frames, so
+          // those are copied. The final frame shares them.
+          image = is_final ? SkImage::MakeFromBitmap(bitmap)
+                           : SkImage::MakeRasterCopy(bitmap.pixmap());
+        }
 
-          auto uploaded =
-              UploadRasterImage(std::move(decompressed), io_manager, flow);
+        // Step 2: Update the image to the GPU.
+        // On IO Thread.
 
-          if (!uploaded.get()) {
-            FML_LOG(ERROR) << "Could not upload image to the GPU.";
-            result({}, std::move(flow));
-            return;
+        io_runner->PostTask(fml::MakeCopyable([callback,         //
+                                               frame_in_flight,  //
+                                               io_manager,       //
+                                               ui_runner,        //
+                                               image,            //
+                                               is_final,         //
+                                               flow = std::move(flow)  //
+        ]() mutable {
+          SkiaGPUObject<SkImage> uploaded;
+          if (image) {
+            uploaded =
+                UploadDecompressedImage(std::move(image), io_manager, flow);
           }
 
-          // Finally, all done.
-          result(std::move(uploaded), std::move(flow));
+          // Step 3: Hand the image to the callback.
+          // On UI Thread.
+
+          ui_runner->PostTask(fml::MakeCopyable(
+              [callback, frame_in_flight, is_final,
+               uploaded = std::move(uploaded),
+               flow = std::move(flow)]() mutable {
+                // We are going to terminate the trace flow here. Flows cannot
+                // terminate without a base trace. Add one explicitly.
+                TRACE_EVENT0("flutter", "ImageDecodeCallback");
+                flow.End();
+                if (!is_final) {
+                  frame_in_flight->store(false);
+                }
+                callback(std::move(uploaded), is_final);
+              }));
         }));
-      }));
+      });
+}
+
+const std::shared_ptr<fml::ConcurrentTaskRunner>&
+ImageDecoder::GetConcurrentTaskRunner() const {
+  return concurrent_task_runner_;
+}
+
+const ImageDecoder::AnimatedImageOptions&
+ImageDecoder::GetAnimatedImageOptions() const {
+  return animated_image_options_;
 }
 
 fml::WeakPtr<ImageDecoder> ImageDecoder::GetWeakPtr() const {
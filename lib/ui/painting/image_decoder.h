@@ -15,7 +15,9 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_descriptor.h"
+#include "flutter/lib/ui/painting/incremental_image_decoder.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
@@ -31,10 +33,20 @@ namespace flutter {
 // occur in a frame pipeline.
 class ImageDecoder {
  public:
+  // How the frames of animated images are decoded. See |MultiFrameCodec|.
+  struct AnimatedImageOptions {
+    // The number of frames decoded ahead of the frame requested from Dart.
+    size_t lookahead_frames = 0;
+    // The maximum bytes of uploaded frames kept to replay later loops.
+    size_t max_cached_frame_bytes = 0;
+  };
+
   ImageDecoder(
       TaskRunners runners,
       std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
-      fml::WeakPtr<IOManager> io_manager);
+      fml::WeakPtr<IOManager> io_manager,
+      std::shared_ptr<DecodedImageCache> decoded_image_cache = nullptr,
+      AnimatedImageOptions animated_image_options = {});
 
   ~ImageDecoder();
 
@@ -44,23 +56,53 @@ class ImageDecoder {
   // GPU. All image decompression and resizes are done on a worker thread
   // concurrently. Texture upload is done on the IO thread and the result
   // returned back on the UI thread. On error, the texture is null but the
-  // callback is guaranteed to return on the UI thread.
+  // callback is guaranteed to return on the UI thread. If the decoder has a
+  // cache, images decoded from the same bytes to the same size are shared.
   void Decode(fml::RefPtr<ImageDescriptor> descriptor,
               uint32_t target_width,
               uint32_t target_height,
               const ImageResult& result);
 
+  // Invoked with every image decoded from the bytes received so far, the
+  // final one last. The final image is null if decoding failed.
+  using ProgressiveImageResult =
+      std::function<void(SkiaGPUObject<SkImage>, bool is_final)>;
+
+  // Returns a decoder the encoded bytes of an image can be streamed into as
+  // they arrive. The callback receives the image decoded so far, uploaded to
+  // the GPU, on the UI thread. Intermediate images are skipped while the UI
+  // thread is behind. The callback isn't invoked after the returned decoder is
+  // cancelled.
+  std::shared_ptr<IncrementalImageDecoder> DecodeIncrementally(
+      const ProgressiveImageResult& callback);
+
+  // The task runner and options the codecs of animated images decode their
+  // frames ahead of time with.
+  const std::shared_ptr<fml::ConcurrentTaskRunner>& GetConcurrentTaskRunner()
+      const;
+
+  const AnimatedImageOptions& GetAnimatedImageOptions() const;
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
  private:
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  std::shared_ptr<DecodedImageCache> decoded_image_cache_;
+  const AnimatedImageOptions animated_image_options_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
+// The dimensions the compressed image of |descriptor| is decoded to before it
+// is resized to |resized_dimensions|. Codecs that can scale natively decode
+// close to the target size, others skip all but every |sample_size|th pixel.
+SkISize GetDecodeDimensions(const ImageDescriptor& descriptor,
+                            const SkISize& resized_dimensions,
+                            int* sample_size);
+
 sk_sp<SkImage> ImageFromCompressedData(fml::RefPtr<ImageDescriptor> descriptor,
                                        uint32_t target_width,
                                        uint32_t target_height,
@@ -591,6 +591,62 @@ TEST(ImageDecoderTest, VerifySubpixelDecodingPreservesExifOrientation) {
   assert_image(decode(300, 100));
 }
 
+TEST(ImageDecoderTest, CodecsWithoutNativeScalingAreSampledWhenDownscaling) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  auto codec = SkCodec::MakeFromData(data);
+  ASSERT_TRUE(codec);
+  auto descriptor =
+      fml::MakeRefCounted<ImageDescriptor>(data, std::move(codec));
+  ASSERT_EQ(descriptor->image_info().dimensions(), SkISize::Make(300, 100));
+
+  // PNG cannot scale natively, but can skip pixels.
+  ASSERT_EQ(descriptor->get_scaled_dimensions(0.25),
+            descriptor->image_info().dimensions());
+  ASSERT_EQ(descriptor->get_sampled_dimensions(2), SkISize::Make(150, 50));
+  ASSERT_EQ(descriptor->get_sampled_dimensions(4), SkISize::Make(75, 25));
+
+  SkBitmap sampled;
+  ASSERT_TRUE(sampled.tryAllocPixels(
+      descriptor->image_info().makeDimensions(SkISize::Make(75, 25))));
+  ASSERT_TRUE(descriptor->get_sampled_pixels(sampled.pixmap(), 4));
+  // The sample size must match the dimensions.
+  ASSERT_FALSE(descriptor->get_sampled_pixels(sampled.pixmap(), 2));
+
+  int sample_size = 0;
+  ASSERT_EQ(GetDecodeDimensions(*descriptor, SkISize::Make(75, 25),
+                                &sample_size),
+            SkISize::Make(75, 25));
+  ASSERT_EQ(sample_size, 4);
+  ASSERT_EQ(GetDecodeDimensions(*descriptor, SkISize::Make(70, 20),
+                                &sample_size),
+            SkISize::Make(75, 25));
+  ASSERT_EQ(sample_size, 4);
+  ASSERT_EQ(GetDecodeDimensions(*descriptor, SkISize::Make(200, 20),
+                                &sample_size),
+            SkISize::Make(300, 100));
+  ASSERT_EQ(sample_size, 1);
+
+  auto decode = [descriptor](uint32_t target_width, uint32_t target_height) {
+    return ImageFromCompressedData(descriptor, target_width, target_height,
+                                   fml::tracing::TraceFlow(""));
+  };
+  ASSERT_EQ(decode(75, 25)->dimensions(), SkISize::Make(75, 25));
+  ASSERT_EQ(decode(70, 20)->dimensions(), SkISize::Make(70, 20));
+  ASSERT_EQ(decode(10, 90)->dimensions(), SkISize::Make(10, 90));
+}
+
+TEST(ImageDecoderTest, ImagesWithExifOrientationAreNotSampled) {
+  auto data = OpenFixtureAsSkData("Horizontal.jpg");
+  auto codec = SkCodec::MakeFromData(data);
+  ASSERT_TRUE(codec);
+  auto descriptor =
+      fml::MakeRefCounted<ImageDescriptor>(data, std::move(codec));
+
+  // Sampled decodes would not be oriented. JPEG scales natively instead.
+  ASSERT_TRUE(descriptor->get_sampled_dimensions(2).isEmpty());
+  ASSERT_EQ(descriptor->get_scaled_dimensions(0.5), SkISize::Make(300, 100));
+}
+
 TEST_F(ImageDecoderFixtureTest,
        MultiFrameCodecCanBeCollectedBeforeIOTasksFinish) {
   // This test verifies that the MultiFrameCodec safely shares state between
@@ -12,6 +12,7 @@
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 #include "flutter/lib/ui/painting/single_frame_codec.h"
 #include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/skia/include/codec/SkAndroidCodec.h"
 #include "third_party/tonic/dart_binding_macros.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 
@@ -163,7 +164,14 @@ void ImageDescriptor::instantiateCodec(Dart_Handle codec_handle,
         static_cast<fml::RefPtr<ImageDescriptor>>(this), target_width,
         target_height);
   } else {
-    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(generator_);
+    auto image_decoder = UIDartState::Current()->GetImageDecoder();
+    if (image_decoder) {
+      ui_codec = fml::MakeRefCounted<MultiFrameCodec>(
+          generator_, image_decoder->GetConcurrentTaskRunner(),
+          image_decoder->GetAnimatedImageOptions());
+    } else {
+      ui_codec = fml::MakeRefCounted<MultiFrameCodec>(generator_);
+    }
   }
   ui_codec->AssociateWithDartWrapper(codec_handle);
 }
@@ -194,4 +202,52 @@ bool ImageDescriptor::get_pixels(const SkPixmap& pixmap) const {
   return platform_image_generator_->getPixels(pixmap);
 }
 
+// Returns a codec that can skip pixels while decoding, or null if there is
+// none for the image or it must be oriented. Creating one only parses the
+// header of the image.
+static std::unique_ptr<SkAndroidCodec> MakeSamplingCodec(sk_sp<SkData> data) {
+  auto codec = SkAndroidCodec::MakeFromData(std::move(data));
+  if (!codec || codec->codec()->getOrigin() != kTopLeft_SkEncodedOrigin) {
+    return nullptr;
+  }
+  return codec;
+}
+
+SkISize ImageDescriptor::get_sampled_dimensions(int sample_size) const {
+  if (!generator_ || sample_size < 1) {
+    return SkISize::MakeEmpty();
+  }
+  auto codec = MakeSamplingCodec(buffer_);
+  if (!codec) {
+    return SkISize::MakeEmpty();
+  }
+  return codec->getSampledDimensions(sample_size);
+}
+
+bool ImageDescriptor::get_sampled_pixels(const SkPixmap& pixmap,
+                                         int sample_size) const {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  if (!generator_) {
+    return false;
+  }
+  auto codec = MakeSamplingCodec(buffer_);
+  if (!codec || codec->getSampledDimensions(sample_size) !=
+                    pixmap.info().dimensions()) {
+    return false;
+  }
+  SkAndroidCodec::AndroidOptions options;
+  options.fSampleSize = sample_size;
+  const auto result = codec->getAndroidPixels(
+      pixmap.info(), pixmap.writable_addr(), pixmap.rowBytes(), &options);
+  // Like full decodes, truncated or corrupt images decode to what is there.
+  switch (result) {
+    case SkCodec::kSuccess:
+    case SkCodec::kIncompleteInput:
+    case SkCodec::kErrorInInput:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace flutter
@@ -92,17 +92,28 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
 
   /// Gets the scaled dimensions of this image, if backed by a codec that can
   /// perform efficient subpixel scaling.
-  SkISize get_scaled_dimensions(float scale) {
+  SkISize get_scaled_dimensions(float scale) const {
     if (generator_) {
       return generator_->getScaledDimensions(scale);
     }
     return image_info_.dimensions();
   }
 
+  /// Gets the dimensions of this image when only every |sample_size|th pixel
+  /// in each direction is decoded, for codecs that cannot scale natively like
+  /// PNG and GIF. Empty if the image cannot be sampled, like when it has an
+  /// EXIF orientation.
+  SkISize get_sampled_dimensions(int sample_size) const;
+
   /// Gets pixels for this image transformed based on the EXIF orientation tag,
   /// if applicable.
   bool get_pixels(const SkPixmap& pixmap) const;
 
+  /// Gets the pixels of every |sample_size|th pixel in each direction of this
+  /// image. The pixmap must have the dimensions returned by
+  /// |get_sampled_dimensions|. Only the sampled pixels are decoded.
+  bool get_sampled_pixels(const SkPixmap& pixmap, int sample_size) const;
+
   void dispose() {
     ClearDartWrapper();
     generator_.reset();
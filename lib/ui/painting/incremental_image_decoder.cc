@@ -0,0 +1,388 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/incremental_image_decoder.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkStream.h"
+#include "third_party/skia/src/codec/SkCodecImageGenerator.h"
+
+namespace flutter {
+
+class IncrementalImageDecoder::Buffer {
+ public:
+  // Returns false if the buffer was closed.
+  bool Add(sk_sp<SkData> chunk) {
+    std::scoped_lock lock(mutex_);
+    if (closed_) {
+      return false;
+    }
+    size_ += chunk->size();
+    chunks_.push_back(std::move(chunk));
+    return true;
+  }
+
+  void Close() {
+    std::scoped_lock lock(mutex_);
+    closed_ = true;
+  }
+
+  bool IsClosed() const {
+    std::scoped_lock lock(mutex_);
+    return closed_;
+  }
+
+  size_t GetSize() const {
+    std::scoped_lock lock(mutex_);
+    return size_;
+  }
+
+  size_t GetBufferedBytes() const {
+    std::scoped_lock lock(mutex_);
+    return size_ - discarded_;
+  }
+
+  // Drops the bytes that were read from now on. Only one stream may read the
+  // buffer then.
+  void DiscardReadBytes() {
+    std::scoped_lock lock(mutex_);
+    discard_read_bytes_ = true;
+  }
+
+  // Drops all bytes and ignores the ones added later.
+  void Drop() {
+    std::scoped_lock lock(mutex_);
+    chunks_.clear();
+    discarded_ = size_;
+    closed_ = true;
+  }
+
+  bool IsAtEnd(size_t position) const {
+    std::scoped_lock lock(mutex_);
+    return closed_ && position == size_;
+  }
+
+  // Copies up to |size| bytes at |position| to |destination|, which may be
+  // null to skip them.
+  size_t Read(size_t position, void* destination, size_t size, bool consume) {
+    std::scoped_lock lock(mutex_);
+    if (position < discarded_) {
+      // The bytes were dropped while the codec was reading them.
+      return 0;
+    }
+    const size_t available = size_ - position;
+    // Codecs don't expect reads to come up short before the end of the data,
+    // so reads that can't be satisfied yet read nothing. Codecs report that
+    // as incomplete input and read again once more bytes arrived.
+    if (consume && available < size && !closed_) {
+      return 0;
+    }
+    size = std::min(size, available);
+
+    if (destination) {
+      auto* bytes = static_cast<uint8_t*>(destination);
+      size_t chunk_start = discarded_;
+      size_t copied = 0;
+      for (const auto& chunk : chunks_) {
+        const size_t chunk_end = chunk_start + chunk->size();
+        const size_t from = position + copied;
+        if (from < chunk_end) {
+          const size_t count = std::min(chunk_end - from, size - copied);
+          memcpy(bytes + copied, chunk->bytes() + (from - chunk_start), count);
+          copied += count;
+          if (copied == size) {
+            break;
+          }
+        }
+        chunk_start = chunk_end;
+      }
+    }
+
+    if (consume && discard_read_bytes_) {
+      const size_t end = position + size;
+      while (!chunks_.empty() && discarded_ + chunks_.front()->size() <= end) {
+        discarded_ += chunks_.front()->size();
+        chunks_.pop_front();
+      }
+    }
+    return size;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::deque<sk_sp<SkData>> chunks_;
+  // The number of bytes added, including the discarded ones.
+  size_t size_ = 0;
+  // The number of bytes dropped from the front.
+  size_t discarded_ = 0;
+  bool discard_read_bytes_ = false;
+  bool closed_ = false;
+};
+
+namespace {
+
+// A stream over a buffer that may still be growing.
+class BufferStream final : public SkStream {
+ public:
+  explicit BufferStream(std::shared_ptr<IncrementalImageDecoder::Buffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  // |SkStream|
+  size_t read(void* buffer, size_t size) override {
+    const size_t read = buffer_->Read(position_, buffer, size, true);
+    position_ += read;
+    return read;
+  }
+
+  // |SkStream|
+  size_t peek(void* buffer, size_t size) const override {
+    return buffer_->Read(position_, buffer, size, false);
+  }
+
+  // |SkStream|
+  bool isAtEnd() const override { return buffer_->IsAtEnd(position_); }
+
+ private:
+  const std::shared_ptr<IncrementalImageDecoder::Buffer> buffer_;
+  size_t position_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(BufferStream);
+};
+
+// The formats Skia's codecs can decode incrementally.
+bool DecodesIncrementally(SkEncodedImageFormat format) {
+  return format == SkEncodedImageFormat::kPNG ||
+         format == SkEncodedImageFormat::kGIF;
+}
+
+}  // namespace
+
+std::shared_ptr<IncrementalImageDecoder> IncrementalImageDecoder::Create(
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+    FrameCallback on_frame) {
+  return std::shared_ptr<IncrementalImageDecoder>(new IncrementalImageDecoder(
+      std::move(concurrent_task_runner), std::move(on_frame)));
+}
+
+IncrementalImageDecoder::IncrementalImageDecoder(
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+    FrameCallback on_frame)
+    : concurrent_task_runner_(std::move(concurrent_task_runner)),
+      on_frame_(std::move(on_frame)),
+      buffer_(std::make_shared<Buffer>()) {
+  FML_DCHECK(concurrent_task_runner_);
+  FML_DCHECK(on_frame_);
+}
+
+IncrementalImageDecoder::~IncrementalImageDecoder() = default;
+
+void IncrementalImageDecoder::AddChunk(sk_sp<SkData> chunk) {
+  if (!chunk || chunk->size() == 0 || !buffer_->Add(std::move(chunk))) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  generation_++;
+  ScheduleDecodeLocked();
+}
+
+void IncrementalImageDecoder::Close() {
+  if (buffer_->IsClosed()) {
+    return;
+  }
+  buffer_->Close();
+  std::scoped_lock lock(mutex_);
+  generation_++;
+  ScheduleDecodeLocked();
+}
+
+void IncrementalImageDecoder::Cancel() {
+  {
+    std::scoped_lock lock(mutex_);
+    cancelled_ = true;
+  }
+  buffer_->Drop();
+}
+
+size_t IncrementalImageDecoder::GetBufferedBytes() const {
+  return buffer_->GetBufferedBytes();
+}
+
+void IncrementalImageDecoder::ScheduleDecodeLocked() {
+  if (decoding_ || done_ || cancelled_) {
+    return;
+  }
+  decoding_ = true;
+  concurrent_task_runner_->PostTask(
+      [decoder = shared_from_this()]() { decoder->DecodeNewBytes(); },
+      // Someone is waiting to see the image.
+      fml::ConcurrentTaskPriority::kUserVisible);
+}
+
+void IncrementalImageDecoder::DecodeNewBytes() {
+  while (true) {
+    uint64_t generation;
+    {
+      std::scoped_lock lock(mutex_);
+      if (cancelled_) {
+        decoding_ = false;
+        return;
+      }
+      generation = generation_;
+    }
+
+    const bool finished = DecodePass();
+
+    std::scoped_lock lock(mutex_);
+    done_ = done_ || finished;
+    if (done_ || cancelled_ || generation_ == generation) {
+      decoding_ = false;
+      return;
+    }
+  }
+}
+
+bool IncrementalImageDecoder::DecodePass() {
+  TRACE_EVENT0("flutter", "IncrementalImageDecoder::DecodePass");
+  // Bytes that arrive or a close that happens during the pass schedule
+  // another one.
+  const bool closed = buffer_->IsClosed();
+
+  if (!codec_) {
+    if (!closed && buffer_->GetSize() < SkCodec::MinBufferedBytesNeeded()) {
+      return false;
+    }
+    SkCodec::Result result = SkCodec::kSuccess;
+    codec_ = SkCodec::MakeFromStream(std::make_unique<BufferStream>(buffer_),
+                                     &result);
+    if (!codec_) {
+      // The header may not have arrived in full yet. Every attempt reads the
+      // buffer from the start.
+      if (!closed) {
+        return false;
+      }
+      FML_LOG(ERROR) << "Could not create a codec for the image: "
+                     << SkCodec::ResultToString(result);
+      bitmap_.reset();
+      ReportFrame(true);
+      return true;
+    }
+    // The codec reads the rest of the bytes once, in order.
+    buffer_->DiscardReadBytes();
+  }
+
+  if (!started_incremental_decode_) {
+    if (!DecodesIncrementally(codec_->getEncodedFormat())) {
+      if (!closed) {
+        return false;
+      }
+      if (!DecodeWholeImage()) {
+        bitmap_.reset();
+      }
+      ReportFrame(true);
+      return true;
+    }
+
+    if (bitmap_.isNull() && !AllocateBitmap(codec_->getInfo())) {
+      ReportFrame(true);
+      return true;
+    }
+    switch (codec_->startIncrementalDecode(bitmap_.info(), bitmap_.getPixels(),
+                                           bitmap_.rowBytes())) {
+      case SkCodec::kSuccess:
+        started_incremental_decode_ = true;
+        break;
+      case SkCodec::kIncompleteInput:
+        if (!closed) {
+          return false;
+        }
+        [[fallthrough]];
+      default:
+        FML_LOG(ERROR) << "Could not start decoding the image.";
+        bitmap_.reset();
+        ReportFrame(true);
+        return true;
+    }
+  }
+
+  int rows_decoded = 0;
+  switch (codec_->incrementalDecode(&rows_decoded)) {
+    case SkCodec::kSuccess:
+      ReportFrame(true);
+      return true;
+    case SkCodec::kIncompleteInput:
+      if (!closed) {
+        ReportFrame(false);
+        return false;
+      }
+      [[fallthrough]];
+    case SkCodec::kErrorInInput:
+      // Like for images that aren't streamed, what could be decoded of
+      // truncated or corrupt data is the image.
+      ReportFrame(true);
+      return true;
+    default:
+      FML_LOG(ERROR) << "Could not decode the image.";
+      bitmap_.reset();
+      ReportFrame(true);
+      return true;
+  }
+}
+
+bool IncrementalImageDecoder::AllocateBitmap(const SkImageInfo& info) {
+  const SkImageInfo bitmap_info =
+      info.makeColorType(kN32_SkColorType)
+          .makeAlphaType(info.alphaType() == kOpaque_SkAlphaType
+                             ? kOpaque_SkAlphaType
+                             : kPremul_SkAlphaType);
+  if (!bitmap_.tryAllocPixels(bitmap_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << bitmap_info.computeMinByteSize() << "B";
+    bitmap_.reset();
+    return false;
+  }
+  // Rows that weren't decoded yet are shown as transparent.
+  bitmap_.eraseColor(SK_ColorTRANSPARENT);
+  return true;
+}
+
+bool IncrementalImageDecoder::DecodeWholeImage() {
+  TRACE_EVENT0("flutter", "IncrementalImageDecoder::DecodeWholeImage");
+  // The generator applies the EXIF orientation.
+  std::unique_ptr<SkImageGenerator> generator =
+      SkCodecImageGenerator::MakeFromCodec(std::move(codec_));
+  if (!generator || !AllocateBitmap(generator->getInfo())) {
+    return false;
+  }
+  if (!generator->getPixels(bitmap_.info(), bitmap_.getPixels(),
+                            bitmap_.rowBytes())) {
+    FML_LOG(ERROR) << "Could not decode the image.";
+    return false;
+  }
+  return true;
+}
+
+void IncrementalImageDecoder::ReportFrame(bool is_final) {
+  {
+    std::scoped_lock lock(mutex_);
+    if (cancelled_) {
+      return;
+    }
+  }
+  if (is_final) {
+    // Bytes after the end of the image aren't needed.
+    buffer_->Drop();
+    bitmap_.setImmutable();
+  }
+  on_frame_(bitmap_, is_final);
+  if (is_final) {
+    codec_.reset();
+    bitmap_.reset();
+  }
+}
+
+}  // namespace flutter
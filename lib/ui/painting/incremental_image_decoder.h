@@ -0,0 +1,125 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_DECODER_H_
+#define FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_DECODER_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImageGenerator.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Decodes an image whose encoded bytes arrive in chunks, like from the
+/// network, while they arrive.
+///
+/// Chunks are decoded on the concurrent task runner as they come in. Codecs
+/// that can decode incrementally, like PNG (including interlaced PNG) and GIF,
+/// report the image decoded so far after every batch of chunks. The bytes
+/// they consumed are dropped, so the encoded and the decoded image are never
+/// both held in full. Other codecs, like JPEG, decode the image once all bytes
+/// arrived.
+///
+/// Animated images only yield their first frame. The EXIF orientation is only
+/// applied to images that aren't decoded incrementally.
+///
+/// This class is thread safe.
+///
+class IncrementalImageDecoder
+    : public std::enable_shared_from_this<IncrementalImageDecoder> {
+ public:
+  //----------------------------------------------------------------------------
+  /// Invoked on a worker with the pixels decoded so far. The bitmap may only
+  /// be read during the call and is overwritten afterwards, unless
+  /// |is_final|, in which case it is immutable and isn't touched anymore. The
+  /// final call comes last and its bitmap is null if the image couldn't be
+  /// decoded. Calls don't overlap.
+  ///
+  using FrameCallback = std::function<void(const SkBitmap& bitmap,
+                                           bool is_final)>;
+
+  static std::shared_ptr<IncrementalImageDecoder> Create(
+      std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+      FrameCallback on_frame);
+
+  ~IncrementalImageDecoder();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Appends encoded bytes and schedules decoding them. Chunks
+  ///             added after |Close| are ignored.
+  ///
+  void AddChunk(sk_sp<SkData> chunk);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Signals that all bytes were added. The final frame is
+  ///             reported once they are decoded.
+  ///
+  void Close();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Stops decoding and drops the buffered bytes. No frames are
+  ///             reported afterwards, except for one that is being reported
+  ///             already.
+  ///
+  void Cancel();
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of encoded bytes that were added but haven't been
+  ///             decoded and dropped yet.
+  ///
+  size_t GetBufferedBytes() const;
+
+  // The encoded bytes added so far, which are read by the codec.
+  class Buffer;
+
+ private:
+  const std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  const FrameCallback on_frame_;
+  const std::shared_ptr<Buffer> buffer_;
+
+  std::mutex mutex_;
+  // Incremented whenever there are new bytes to decode.
+  uint64_t generation_ = 0;
+  bool decoding_ = false;
+  bool done_ = false;
+  bool cancelled_ = false;
+
+  // Only accessed by the decode task, which doesn't overlap with itself.
+  std::unique_ptr<SkCodec> codec_;
+  SkBitmap bitmap_;
+  bool started_incremental_decode_ = false;
+
+  IncrementalImageDecoder(
+      std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+      FrameCallback on_frame);
+
+  // Must be called with the lock held.
+  void ScheduleDecodeLocked();
+
+  // Decodes until no new bytes arrived during a pass.
+  void DecodeNewBytes();
+
+  // Returns whether the image was finished.
+  bool DecodePass();
+
+  bool AllocateBitmap(const SkImageInfo& info);
+
+  bool DecodeWholeImage();
+
+  void ReportFrame(bool is_final);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(IncrementalImageDecoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_INCREMENTAL_IMAGE_DECODER_H_
@@ -0,0 +1,171 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/incremental_image_decoder.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/testing/testing.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr size_t kChunkSize = 1024;
+
+struct DecodeResult {
+  SkBitmap bitmap;
+  size_t frame_count = 0;
+};
+
+// Adds the bytes of the fixture to a decoder in chunks, then closes it and
+// waits for the final frame.
+DecodeResult DecodeInChunks(const std::string& fixture_name) {
+  auto mapping = OpenFixtureAsMapping(fixture_name);
+  FML_CHECK(mapping);
+
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  fml::AutoResetWaitableEvent latch;
+  DecodeResult result;
+  auto decoder = IncrementalImageDecoder::Create(
+      loop->GetTaskRunner(),
+      [&result, &latch](const SkBitmap& bitmap, bool is_final) {
+        result.frame_count++;
+        if (is_final) {
+          result.bitmap = bitmap;
+          latch.Signal();
+        }
+      });
+
+  for (size_t offset = 0; offset < mapping->GetSize(); offset += kChunkSize) {
+    decoder->AddChunk(SkData::MakeWithCopy(
+        mapping->GetMapping() + offset,
+        std::min(kChunkSize, mapping->GetSize() - offset)));
+  }
+  decoder->Close();
+  latch.Wait();
+  return result;
+}
+
+void ExpectSamePixelsAsWholeDecode(const std::string& fixture_name,
+                                   const SkBitmap& bitmap) {
+  auto mapping = OpenFixtureAsMapping(fixture_name);
+  ASSERT_TRUE(mapping);
+  auto image = SkImage::MakeFromEncoded(
+      SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize()));
+  ASSERT_TRUE(image);
+  ASSERT_EQ(image->dimensions(), bitmap.dimensions());
+
+  SkBitmap expected;
+  ASSERT_TRUE(expected.tryAllocPixels(bitmap.info()));
+  ASSERT_TRUE(image->readPixels(expected.pixmap(), 0, 0));
+  EXPECT_EQ(memcmp(expected.getPixels(), bitmap.getPixels(),
+                   bitmap.computeByteSize()),
+            0);
+}
+
+}  // namespace
+
+TEST(IncrementalImageDecoderTest, DecodesPngAddedInChunks) {
+  auto result = DecodeInChunks("Horizontal.png");
+  ASSERT_FALSE(result.bitmap.isNull());
+  EXPECT_TRUE(result.bitmap.isImmutable());
+  ExpectSamePixelsAsWholeDecode("Horizontal.png", result.bitmap);
+}
+
+TEST(IncrementalImageDecoderTest, DecodesFirstFrameOfGifAddedInChunks) {
+  auto result = DecodeInChunks("hello_loop_2.gif");
+  ASSERT_FALSE(result.bitmap.isNull());
+  ExpectSamePixelsAsWholeDecode("hello_loop_2.gif", result.bitmap);
+}
+
+TEST(IncrementalImageDecoderTest, DecodesJpegOnceAllBytesWereAdded) {
+  auto result = DecodeInChunks("Horizontal.jpg");
+  ASSERT_FALSE(result.bitmap.isNull());
+  // Only the final frame is reported, with the EXIF orientation applied.
+  EXPECT_EQ(result.frame_count, 1u);
+  EXPECT_EQ(result.bitmap.width(), 600);
+  EXPECT_EQ(result.bitmap.height(), 200);
+}
+
+TEST(IncrementalImageDecoderTest, ReportsNullBitmapForInvalidData) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  fml::AutoResetWaitableEvent latch;
+  bool bitmap_is_null = false;
+  auto decoder = IncrementalImageDecoder::Create(
+      loop->GetTaskRunner(),
+      [&bitmap_is_null, &latch](const SkBitmap& bitmap, bool is_final) {
+        ASSERT_TRUE(is_final);
+        bitmap_is_null = bitmap.isNull();
+        latch.Signal();
+      });
+  const std::string garbage(4 * kChunkSize, 'x');
+  decoder->AddChunk(SkData::MakeWithCopy(garbage.data(), garbage.size()));
+  decoder->Close();
+  latch.Wait();
+  EXPECT_TRUE(bitmap_is_null);
+}
+
+TEST(IncrementalImageDecoderTest, DropsDecodedBytesAndReportsProgress) {
+  auto mapping = OpenFixtureAsMapping("Horizontal.png");
+  ASSERT_TRUE(mapping);
+
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  fml::AutoResetWaitableEvent frame_latch;
+  std::atomic<bool> got_final_frame(false);
+  auto decoder = IncrementalImageDecoder::Create(
+      loop->GetTaskRunner(),
+      [&frame_latch, &got_final_frame](const SkBitmap& bitmap, bool is_final) {
+        if (is_final) {
+          got_final_frame = true;
+        }
+        frame_latch.Signal();
+      });
+
+  // Add the first half of the image.
+  const size_t added = 16 * kChunkSize;
+  ASSERT_LT(added, mapping->GetSize());
+  for (size_t offset = 0; offset < added; offset += kChunkSize) {
+    decoder->AddChunk(
+        SkData::MakeWithCopy(mapping->GetMapping() + offset, kChunkSize));
+  }
+  while (decoder->GetBufferedBytes() >= added) {
+    frame_latch.Wait();
+  }
+  EXPECT_FALSE(got_final_frame);
+
+  decoder->AddChunk(SkData::MakeWithCopy(mapping->GetMapping() + added,
+                                         mapping->GetSize() - added));
+  decoder->Close();
+  while (!got_final_frame) {
+    frame_latch.Wait();
+  }
+  EXPECT_EQ(decoder->GetBufferedBytes(), 0u);
+}
+
+TEST(IncrementalImageDecoderTest, DoesNotReportFramesAfterCancel) {
+  auto mapping = OpenFixtureAsMapping("Horizontal.png");
+  ASSERT_TRUE(mapping);
+
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  std::atomic<size_t> frame_count(0);
+  auto decoder = IncrementalImageDecoder::Create(
+      loop->GetTaskRunner(), [&frame_count](const SkBitmap& bitmap,
+                                            bool is_final) { frame_count++; });
+  decoder->Cancel();
+  decoder->AddChunk(
+      SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize()));
+  decoder->Close();
+  EXPECT_EQ(decoder->GetBufferedBytes(), 0u);
+  EXPECT_EQ(frame_count, 0u);
+}
+
+}  // namespace testing
+}  // namespace flutter
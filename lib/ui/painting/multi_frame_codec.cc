@@ -5,6 +5,7 @@
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "third_party/tonic/logging/dart_invoke.h"
@@ -12,19 +13,41 @@
 namespace flutter {
 
 MultiFrameCodec::MultiFrameCodec(
-    std::shared_ptr<SkCodecImageGenerator> generator)
-    : state_(new State(std::move(generator))) {}
+    std::shared_ptr<SkCodecImageGenerator> generator,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+    ImageDecoder::AnimatedImageOptions options)
+    : state_(new State(std::move(generator),
+                       std::move(concurrent_task_runner),
+                       options)) {
+  // Start decoding so the first frame is ready when it's requested.
+  state_->DecodeAhead();
+}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
-MultiFrameCodec::State::State(std::shared_ptr<SkCodecImageGenerator> generator)
+MultiFrameCodec::State::State(
+    std::shared_ptr<SkCodecImageGenerator> generator,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+    ImageDecoder::AnimatedImageOptions options)
     : generator_(std::move(generator)),
       frameCount_(generator_->getFrameCount()),
       repetitionCount_(generator_->getRepetitionCount()),
-      nextFrameIndex_(0) {}
+      concurrentTaskRunner_(std::move(concurrent_task_runner)),
+      lookaheadFrames_(concurrentTaskRunner_ ? options.lookahead_frames : 0) {
+  // Only cache animations that play more than once and whose frames all fit.
+  // Every frame is decoded to the full size of the image.
+  const size_t frameBytes = generator_->getInfo()
+                                .makeColorType(kN32_SkColorType)
+                                .computeMinByteSize();
+  if (repetitionCount_ != 0 && frameCount_ > 0 && frameBytes > 0 &&
+      frameBytes <= options.max_cached_frame_bytes / frameCount_) {
+    cachedFrames_.resize(frameCount_);
+  }
+}
 
 static void InvokeNextFrameCallback(
-    fml::RefPtr<FrameInfo> frameInfo,
+    SkiaGPUObject<SkImage> skImage,
+    int durationMillis,
     std::unique_ptr<DartPersistentValue> callback,
     size_t trace_id) {
   std::shared_ptr<tonic::DartState> dart_state = callback->dart_state().lock();
@@ -34,9 +57,15 @@ static void InvokeNextFrameCallback(
     return;
   }
   tonic::DartState::Scope scope(dart_state);
-  if (!frameInfo) {
+  if (!skImage.get()) {
     tonic::DartInvoke(callback->value(), {Dart_Null()});
   } else {
+    // The image is created here rather than on the IO thread so that its
+    // bytes are accounted to the isolate's engine.
+    fml::RefPtr<CanvasImage> image = CanvasImage::Create();
+    image->set_image(std::move(skImage));
+    auto frameInfo =
+        fml::MakeRefCounted<FrameInfo>(std::move(image), durationMillis);
     tonic::DartInvoke(callback->value(), {ToDart(frameInfo)});
   }
 }
@@ -74,8 +103,12 @@ static bool CopyToBitmap(SkBitmap* dst,
   return true;
 }
 
-sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
-    fml::WeakPtr<GrDirectContext> resourceContext) {
+MultiFrameCodec::State::DecodedFrame
+MultiFrameCodec::State::DecodeNextFrame() {
+  DecodedFrame decoded;
+  const int frameIndex = nextDecodedFrameIndex_;
+  nextDecodedFrameIndex_ = (nextDecodedFrameIndex_ + 1) % frameCount_;
+
   SkBitmap bitmap = SkBitmap();
   SkImageInfo info = generator_->getInfo().makeColorType(kN32_SkColorType);
   if (info.alphaType() == kUnpremul_SkAlphaType) {
@@ -85,16 +118,16 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
   bitmap.allocPixels(info);
 
   SkCodec::Options options;
-  options.fFrameIndex = nextFrameIndex_;
+  options.fFrameIndex = frameIndex;
   SkCodec::FrameInfo frameInfo{0};
-  generator_->getFrameInfo(nextFrameIndex_, &frameInfo);
+  generator_->getFrameInfo(frameIndex, &frameInfo);
   const int requiredFrameIndex = frameInfo.fRequiredFrame;
   if (requiredFrameIndex != SkCodec::kNoFrame) {
     if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
+      FML_LOG(ERROR) << "Frame " << frameIndex << " depends on frame "
                      << requiredFrameIndex
                      << " and no required frames are cached.";
-      return nullptr;
+      return decoded;
     } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
       FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
                      << " is not cached. Using " << lastRequiredFrameIndex_
@@ -110,16 +143,67 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
 
   if (!generator_->getPixels(info, bitmap.getPixels(), bitmap.rowBytes(),
                              &options)) {
-    FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
-    return nullptr;
+    FML_LOG(ERROR) << "Could not getPixels for frame " << frameIndex;
+    return decoded;
   }
 
   // Hold onto this if we need it to decode future frames.
   if (frameInfo.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
     lastRequiredFrame_ = std::make_unique<SkBitmap>(bitmap);
-    lastRequiredFrameIndex_ = nextFrameIndex_;
+    lastRequiredFrameIndex_ = frameIndex;
+  }
+
+  decoded.bitmap = std::move(bitmap);
+  decoded.durationMillis = frameInfo.fDuration;
+  return decoded;
+}
+
+void MultiFrameCodec::State::DecodeAhead() {
+  if (lookaheadFrames_ == 0) {
+    return;
+  }
+  {
+    std::scoped_lock lock(decodeMutex_);
+    if (lookaheadPending_ || decodingFinished_ ||
+        decodedFrames_.size() >= lookaheadFrames_) {
+      return;
+    }
+    lookaheadPending_ = true;
+  }
+  concurrentTaskRunner_->PostTask([weak_state = weak_from_this()]() {
+    auto state = weak_state.lock();
+    if (!state) {
+      return;
+    }
+    TRACE_EVENT0("flutter", "MultiFrameCodec::DecodeAhead");
+    // Frames are decoded one at a time so that the IO thread can take the
+    // next frame as soon as it's ready.
+    while (true) {
+      std::scoped_lock lock(state->decodeMutex_);
+      if (state->decodingFinished_ ||
+          state->decodedFrames_.size() >= state->lookaheadFrames_) {
+        state->lookaheadPending_ = false;
+        return;
+      }
+      state->decodedFrames_.push_back(state->DecodeNextFrame());
+    }
+  });
+}
+
+MultiFrameCodec::State::DecodedFrame
+MultiFrameCodec::State::TakeNextDecodedFrame() {
+  std::scoped_lock lock(decodeMutex_);
+  if (decodedFrames_.empty()) {
+    return DecodeNextFrame();
   }
+  DecodedFrame decoded = std::move(decodedFrames_.front());
+  decodedFrames_.pop_front();
+  return decoded;
+}
 
+static sk_sp<SkImage> UploadFrame(
+    const SkBitmap& bitmap,
+    const fml::WeakPtr<GrDirectContext>& resourceContext) {
   if (resourceContext) {
     SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
                     bitmap.pixelRef()->rowBytes());
@@ -133,27 +217,61 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
   }
 }
 
+SkiaGPUObject<SkImage> MultiFrameCodec::State::GetNextFrame(
+    fml::WeakPtr<GrDirectContext> resourceContext,
+    fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
+    int* durationMillis) {
+  const int frameIndex = nextFrameIndex_;
+  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+  *durationMillis = 0;
+
+  if (!cachedFrames_.empty() && cachedFrameCount_ == frameCount_) {
+    const CachedFrame& cached = cachedFrames_[frameIndex];
+    *durationMillis = cached.durationMillis;
+    return {cached.image.get(), std::move(unref_queue)};
+  }
+
+  DecodedFrame decoded = TakeNextDecodedFrame();
+  DecodeAhead();
+  if (decoded.bitmap.isNull()) {
+    return {};
+  }
+  sk_sp<SkImage> image = UploadFrame(decoded.bitmap, resourceContext);
+  if (!image) {
+    return {};
+  }
+  *durationMillis = decoded.durationMillis;
+
+  // Frames that failed to decode during an earlier loop are cached by a later
+  // one. Until all frames are cached, the frames are decoded in order.
+  if (!cachedFrames_.empty() && !cachedFrames_[frameIndex].image.get()) {
+    cachedFrames_[frameIndex] = {{image, unref_queue}, decoded.durationMillis};
+    if (++cachedFrameCount_ == frameCount_) {
+      // Later loops only replay the cache, so the decoding state is dropped.
+      std::scoped_lock lock(decodeMutex_);
+      decodingFinished_ = true;
+      decodedFrames_.clear();
+      lastRequiredFrame_.reset();
+    }
+  }
+  return {std::move(image), std::move(unref_queue)};
+}
+
 void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     std::unique_ptr<DartPersistentValue> callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
     fml::WeakPtr<GrDirectContext> resourceContext,
     fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
     size_t trace_id) {
-  fml::RefPtr<FrameInfo> frameInfo = NULL;
-  sk_sp<SkImage> skImage = GetNextFrameImage(resourceContext);
-  if (skImage) {
-    fml::RefPtr<CanvasImage> image = CanvasImage::Create();
-    image->set_image({skImage, std::move(unref_queue)});
-    SkCodec::FrameInfo skFrameInfo{0};
-    generator_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
-    frameInfo =
-        fml::MakeRefCounted<FrameInfo>(std::move(image), skFrameInfo.fDuration);
-  }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+  int durationMillis = 0;
+  SkiaGPUObject<SkImage> skImage = GetNextFrame(
+      std::move(resourceContext), std::move(unref_queue), &durationMillis);
 
   ui_task_runner->PostTask(fml::MakeCopyable(
-      [callback = std::move(callback), frameInfo, trace_id]() mutable {
-        InvokeNextFrameCallback(frameInfo, std::move(callback), trace_id);
+      [callback = std::move(callback), skImage = std::move(skImage),
+       durationMillis, trace_id]() mutable {
+        InvokeNextFrameCallback(std::move(skImage), durationMillis,
+                                std::move(callback), trace_id);
       }));
 }
 
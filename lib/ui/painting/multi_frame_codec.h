@@ -5,15 +5,34 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/lib/ui/painting/codec.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
 namespace flutter {
 
+namespace testing {
+class MultiFrameCodecTest;
+}  // namespace testing
+
 class MultiFrameCodec : public Codec {
  public:
-  MultiFrameCodec(std::shared_ptr<SkCodecImageGenerator> generator);
+  // Frames are decoded on the IO thread when they are requested, unless
+  // |options| asks for |lookahead_frames| to be decoded ahead of time on the
+  // |concurrent_task_runner|. If all frames of a repeating animation fit in
+  // |max_cached_frame_bytes|, the frames uploaded during its first loop are
+  // reused by later loops instead of being decoded again.
+  MultiFrameCodec(std::shared_ptr<SkCodecImageGenerator> generator,
+                  std::shared_ptr<fml::ConcurrentTaskRunner>
+                      concurrent_task_runner = nullptr,
+                  ImageDecoder::AnimatedImageOptions options = {});
 
   ~MultiFrameCodec() override;
 
@@ -36,25 +55,71 @@ class MultiFrameCodec : public Codec {
   // Instead, the MultiFrameCodec creates this object when it is constructed,
   // shares it with the IO task runner's decoding work, and sets the live_
   // member to false when it is destructed.
-  struct State {
-    State(std::shared_ptr<SkCodecImageGenerator> generator);
+  struct State : public std::enable_shared_from_this<State> {
+    State(std::shared_ptr<SkCodecImageGenerator> generator,
+          std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+          ImageDecoder::AnimatedImageOptions options);
 
     const std::shared_ptr<SkCodecImageGenerator> generator_;
     const int frameCount_;
     const int repetitionCount_;
-
-    // The non-const members and functions below here are only read or written
-    // to on the IO thread. They are not safe to access or write on the UI
-    // thread.
-    int nextFrameIndex_;
+    const std::shared_ptr<fml::ConcurrentTaskRunner> concurrentTaskRunner_;
+    const size_t lookaheadFrames_;
+
+    // A frame decoded into CPU memory. The bitmap is empty if decoding failed.
+    struct DecodedFrame {
+      SkBitmap bitmap;
+      int durationMillis = 0;
+    };
+
+    // The members below guard the generator, which decodes the frames in
+    // order. They are read and written on the IO thread and, to decode frames
+    // ahead of time, on the concurrent task runner.
+    std::mutex decodeMutex_;
+    int nextDecodedFrameIndex_ = 0;
     // The last decoded frame that's required to decode any subsequent frames.
     std::unique_ptr<SkBitmap> lastRequiredFrame_;
-
     // The index of the last decoded required frame.
     int lastRequiredFrameIndex_ = -1;
+    // The frames decoded ahead of time, starting with the next frame.
+    std::deque<DecodedFrame> decodedFrames_;
+    bool lookaheadPending_ = false;
+    // Set once every frame is cached and nothing needs decoding anymore.
+    bool decodingFinished_ = false;
 
-    sk_sp<SkImage> GetNextFrameImage(
-        fml::WeakPtr<GrDirectContext> resourceContext);
+    // The non-const members and functions below here are only read or written
+    // to on the IO thread. They are not safe to access or write on the UI
+    // thread.
+    int nextFrameIndex_ = 0;
+
+    // The uploaded frames, indexed by frame, kept while the first loop plays.
+    // Empty if the animation doesn't repeat or its frames don't fit in the
+    // cache.
+    struct CachedFrame {
+      SkiaGPUObject<SkImage> image;
+      int durationMillis = 0;
+    };
+    std::vector<CachedFrame> cachedFrames_;
+    int cachedFrameCount_ = 0;
+
+    // Decodes the frame at |nextDecodedFrameIndex_| and advances it. Must be
+    // called with |decodeMutex_| held.
+    DecodedFrame DecodeNextFrame();
+
+    // Decodes frames on the concurrent task runner until |lookaheadFrames_|
+    // frames wait in |decodedFrames_|. Does nothing if there is no look-ahead.
+    void DecodeAhead();
+
+    // Returns the decoded frame at |nextFrameIndex_|, decoding it now if it
+    // wasn't decoded ahead of time.
+    DecodedFrame TakeNextDecodedFrame();
+
+    // Returns the frame at |nextFrameIndex_| and advances to the following
+    // frame. The image is null if the frame could not be decoded.
+    SkiaGPUObject<SkImage> GetNextFrame(
+        fml::WeakPtr<GrDirectContext> resourceContext,
+        fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
+        int* durationMillis);
 
     void GetNextFrameAndInvokeCallback(
         std::unique_ptr<DartPersistentValue> callback,
@@ -69,6 +134,7 @@ class MultiFrameCodec : public Codec {
 
   FML_FRIEND_MAKE_REF_COUNTED(MultiFrameCodec);
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(MultiFrameCodec);
+  friend class testing::MultiFrameCodecTest;
 };
 
 }  // namespace flutter
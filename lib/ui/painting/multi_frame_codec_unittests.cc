@@ -0,0 +1,144 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/multi_frame_codec.h"
+
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/testing/testing.h"
+#include "flutter/testing/thread_test.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+std::shared_ptr<SkCodecImageGenerator> CreateGifGenerator() {
+  auto gif_mapping = OpenFixtureAsSkData("hello_loop_2.gif");
+  FML_CHECK(gif_mapping);
+  return std::shared_ptr<SkCodecImageGenerator>(
+      static_cast<SkCodecImageGenerator*>(
+          SkCodecImageGenerator::MakeFromEncodedCodec(gif_mapping).release()));
+}
+
+std::vector<uint8_t> ReadPixels(const SkImage& image) {
+  const SkImageInfo info = image.imageInfo();
+  std::vector<uint8_t> pixels(info.computeMinByteSize());
+  FML_CHECK(image.readPixels(
+      SkPixmap(info, pixels.data(), info.minRowBytes()), 0, 0));
+  return pixels;
+}
+
+}  // namespace
+
+class MultiFrameCodecTest : public ThreadTest {
+ public:
+  MultiFrameCodecTest() {
+    // The unref queue must be created on the thread it unrefs on.
+    auto unref_task_runner = CreateNewThread();
+    fml::AutoResetWaitableEvent latch;
+    unref_task_runner->PostTask([this, unref_task_runner, &latch]() {
+      unref_queue_ = fml::MakeRefCounted<SkiaUnrefQueue>(
+          unref_task_runner, fml::TimeDelta::FromSeconds(0));
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+
+  // Takes the next frame of |codec| the way its IO thread task does, without a
+  // resource context.
+  SkiaGPUObject<SkImage> GetNextFrame(MultiFrameCodec& codec,
+                                      int* duration_millis) {
+    return codec.state_->GetNextFrame({}, unref_queue_, duration_millis);
+  }
+
+  size_t GetDecodedFrameCount(MultiFrameCodec& codec) {
+    std::scoped_lock lock(codec.state_->decodeMutex_);
+    return codec.state_->decodedFrames_.size();
+  }
+
+  void WaitForDecodedFrames(MultiFrameCodec& codec, size_t count) {
+    while (GetDecodedFrameCount(codec) < count) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  fml::RefPtr<SkiaUnrefQueue> unref_queue_;
+};
+
+TEST_F(MultiFrameCodecTest, FramesDecodedAheadMatchFramesDecodedOnDemand) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  auto on_demand = fml::MakeRefCounted<MultiFrameCodec>(CreateGifGenerator());
+  auto ahead = fml::MakeRefCounted<MultiFrameCodec>(
+      CreateGifGenerator(), loop->GetTaskRunner(),
+      ImageDecoder::AnimatedImageOptions{2, 0});
+  ASSERT_GT(ahead->frameCount(), 1);
+
+  // Two loops, so that decoding ahead wraps around to the first frame.
+  for (int i = 0; i < 2 * ahead->frameCount(); i++) {
+    WaitForDecodedFrames(*ahead, 2);
+    int expected_duration = 0;
+    int duration = 0;
+    auto expected = GetNextFrame(*on_demand, &expected_duration);
+    auto frame = GetNextFrame(*ahead, &duration);
+    ASSERT_TRUE(expected.get());
+    ASSERT_TRUE(frame.get());
+    EXPECT_EQ(duration, expected_duration);
+    EXPECT_EQ(ReadPixels(*frame.get()), ReadPixels(*expected.get()));
+  }
+}
+
+TEST_F(MultiFrameCodecTest, LaterLoopsReuseCachedFrames) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  auto codec = fml::MakeRefCounted<MultiFrameCodec>(
+      CreateGifGenerator(), loop->GetTaskRunner(),
+      ImageDecoder::AnimatedImageOptions{2, 64 * 1024 * 1024});
+  ASSERT_NE(codec->repetitionCount(), 0);
+
+  std::vector<sk_sp<SkImage>> first_loop;
+  for (int i = 0; i < codec->frameCount(); i++) {
+    int duration = 0;
+    auto frame = GetNextFrame(*codec, &duration);
+    ASSERT_TRUE(frame.get());
+    first_loop.push_back(frame.get());
+  }
+  // Nothing is decoded once all frames are cached.
+  EXPECT_EQ(GetDecodedFrameCount(*codec), 0u);
+
+  for (int i = 0; i < codec->frameCount(); i++) {
+    int duration = 0;
+    auto frame = GetNextFrame(*codec, &duration);
+    EXPECT_EQ(frame.get(), first_loop[i]);
+    EXPECT_GT(duration, 0);
+  }
+}
+
+TEST_F(MultiFrameCodecTest, FramesThatDoNotFitInTheCacheAreDecodedAgain) {
+  auto generator = CreateGifGenerator();
+  const size_t frame_bytes = generator->getInfo().computeMinByteSize();
+  auto codec = fml::MakeRefCounted<MultiFrameCodec>(
+      std::move(generator), nullptr,
+      ImageDecoder::AnimatedImageOptions{0, frame_bytes});
+
+  std::vector<sk_sp<SkImage>> first_loop;
+  for (int i = 0; i < codec->frameCount(); i++) {
+    int duration = 0;
+    first_loop.push_back(GetNextFrame(*codec, &duration).get());
+  }
+  for (int i = 0; i < codec->frameCount(); i++) {
+    int duration = 0;
+    auto frame = GetNextFrame(*codec, &duration);
+    ASSERT_TRUE(frame.get());
+    EXPECT_NE(frame.get(), first_loop[i]);
+    EXPECT_EQ(ReadPixels(*frame.get()), ReadPixels(*first_loop[i]));
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,139 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/progressive_image_decoder.h"
+
+#include "flutter/lib/ui/painting/image.h"
+#include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/tonic/converter/dart_converter.h"
+#include "third_party/tonic/dart_args.h"
+#include "third_party/tonic/dart_binding_macros.h"
+#include "third_party/tonic/logging/dart_invoke.h"
+
+namespace flutter {
+
+static void ProgressiveImageDecoder_constructor(Dart_NativeArguments args) {
+  UIDartState::ThrowIfUIOperationsProhibited();
+  DartCallConstructor(&ProgressiveImageDecoder::Create, args);
+}
+
+IMPLEMENT_WRAPPERTYPEINFO(ui, ProgressiveImageDecoder);
+
+#define FOR_EACH_BINDING(V)            \
+  V(ProgressiveImageDecoder, addChunk) \
+  V(ProgressiveImageDecoder, close)    \
+  V(ProgressiveImageDecoder, dispose)
+
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+
+void ProgressiveImageDecoder::RegisterNatives(
+    tonic::DartLibraryNatives* natives) {
+  natives->Register({{"ProgressiveImageDecoder_constructor",
+                      ProgressiveImageDecoder_constructor, 2, true},
+                     FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
+}
+
+fml::RefPtr<ProgressiveImageDecoder> ProgressiveImageDecoder::Create(
+    Dart_Handle callback) {
+  return fml::MakeRefCounted<ProgressiveImageDecoder>(callback);
+}
+
+ProgressiveImageDecoder::ProgressiveImageDecoder(Dart_Handle callback)
+    : weak_factory_(this) {
+  FML_DCHECK(Dart_IsClosure(callback));
+  auto* dart_state = UIDartState::Current();
+  callback_.Set(dart_state, callback);
+  ui_task_runner_ = dart_state->GetTaskRunners().GetUITaskRunner();
+
+  auto image_decoder = dart_state->GetImageDecoder();
+  if (!image_decoder) {
+    // The callback is told that decoding failed once all bytes were added.
+    return;
+  }
+  decoder_ = image_decoder->DecodeIncrementally(
+      [decoder = weak_factory_.GetWeakPtr()](SkiaGPUObject<SkImage> image,
+                                             bool is_final) {
+        if (decoder) {
+          decoder->OnImage(std::move(image), is_final);
+        }
+      });
+}
+
+ProgressiveImageDecoder::~ProgressiveImageDecoder() {
+  if (decoder_) {
+    decoder_->Cancel();
+  }
+}
+
+void ProgressiveImageDecoder::addChunk(const tonic::Uint8List& chunk) {
+  if (!decoder_ || chunk.num_elements() == 0) {
+    return;
+  }
+  decoder_->AddChunk(SkData::MakeWithCopy(chunk.data(), chunk.num_elements()));
+}
+
+void ProgressiveImageDecoder::close() {
+  if (decoder_) {
+    decoder_->Close();
+    return;
+  }
+  if (callback_.is_empty()) {
+    return;
+  }
+  ui_task_runner_->PostTask([decoder = weak_factory_.GetWeakPtr()]() {
+    if (decoder) {
+      decoder->OnImage({}, true);
+    }
+  });
+}
+
+void ProgressiveImageDecoder::dispose() {
+  if (decoder_) {
+    decoder_->Cancel();
+    decoder_ = nullptr;
+  }
+  // The callback is associated with the Dart isolate and must be released on
+  // the UI thread.
+  callback_.Clear();
+  ClearDartWrapper();
+}
+
+size_t ProgressiveImageDecoder::GetAllocationSize() const {
+  return sizeof(ProgressiveImageDecoder) +
+         (decoder_ ? decoder_->GetBufferedBytes() : 0);
+}
+
+void ProgressiveImageDecoder::OnImage(SkiaGPUObject<SkImage> image,
+                                      bool is_final) {
+  if (callback_.is_empty()) {
+    // Disposed while the image was on its way.
+    return;
+  }
+  auto dart_state = callback_.dart_state().lock();
+  if (!dart_state) {
+    // The isolate could have died in the meantime.
+    return;
+  }
+  tonic::DartState::Scope scope(dart_state);
+
+  // The callback may dispose this object, which may release the last
+  // reference to it.
+  fml::RefPtr<ProgressiveImageDecoder> protect(this);
+
+  Dart_Handle dart_image = Dart_Null();
+  if (image.get()) {
+    auto canvas_image = CanvasImage::Create();
+    canvas_image->set_image(std::move(image));
+    dart_image = tonic::ToDart(std::move(canvas_image));
+  }
+
+  Dart_Handle callback = callback_.Get();
+  if (is_final) {
+    decoder_ = nullptr;
+    callback_.Clear();
+  }
+  tonic::DartInvoke(callback, {dart_image, tonic::ToDart(is_final)});
+}
+
+}  // namespace flutter
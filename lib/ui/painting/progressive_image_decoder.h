@@ -0,0 +1,63 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PROGRESSIVE_IMAGE_DECODER_H_
+#define FLUTTER_LIB_UI_PAINTING_PROGRESSIVE_IMAGE_DECODER_H_
+
+#include <memory>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/lib/ui/dart_wrapper.h"
+#include "flutter/lib/ui/painting/incremental_image_decoder.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/tonic/dart_library_natives.h"
+#include "third_party/tonic/dart_persistent_value.h"
+#include "third_party/tonic/typed_data/typed_list.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// The Dart handle to an |IncrementalImageDecoder|. Encoded bytes are added
+/// from Dart as they arrive and the callback is invoked on the UI thread with
+/// every image decoded from them so far.
+///
+class ProgressiveImageDecoder
+    : public RefCountedDartWrappable<ProgressiveImageDecoder> {
+  DEFINE_WRAPPERTYPEINFO();
+  FML_FRIEND_MAKE_REF_COUNTED(ProgressiveImageDecoder);
+
+ public:
+  static fml::RefPtr<ProgressiveImageDecoder> Create(Dart_Handle callback);
+
+  ~ProgressiveImageDecoder() override;
+
+  void addChunk(const tonic::Uint8List& chunk);
+
+  void close();
+
+  void dispose();
+
+  // |DartWrappable|
+  size_t GetAllocationSize() const override;
+
+  static void RegisterNatives(tonic::DartLibraryNatives* natives);
+
+ private:
+  tonic::DartPersistentValue callback_;
+  std::shared_ptr<IncrementalImageDecoder> decoder_;
+  fml::RefPtr<fml::TaskRunner> ui_task_runner_;
+  fml::WeakPtrFactory<ProgressiveImageDecoder> weak_factory_;
+
+  explicit ProgressiveImageDecoder(Dart_Handle callback);
+
+  void OnImage(SkiaGPUObject<SkImage> image, bool is_final);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ProgressiveImageDecoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PROGRESSIVE_IMAGE_DECODER_H_
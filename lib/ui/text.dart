@@ -1926,6 +1926,25 @@ class Paragraph extends NativeFieldWrapperClass2 {
   void layout(ParagraphConstraints constraints) => _layout(constraints.width);
   void _layout(double width) native 'Paragraph_layout';
 
+  /// Lays out each of the given paragraphs with the constraints at the same
+  /// index in `constraints`.
+  ///
+  /// This has the same effect as calling [layout] on each paragraph in turn,
+  /// but the engine spreads the work over several threads, so laying out many
+  /// paragraphs at once takes less time on devices with several cores. All
+  /// the paragraphs have been laid out when this method returns.
+  ///
+  /// The two lists must have the same length.
+  static void layoutAll(List<Paragraph> paragraphs, List<ParagraphConstraints> constraints) {
+    assert(paragraphs.length == constraints.length);
+    final Float64List widths = Float64List(constraints.length);
+    for (int index = 0; index < constraints.length; index += 1) {
+      widths[index] = constraints[index].width;
+    }
+    _layoutAll(paragraphs, widths);
+  }
+  static void _layoutAll(List<Paragraph> paragraphs, Float64List widths) native 'Paragraph_layoutAll';
+
   List<TextBox> _decodeTextBoxes(Float32List encoded) {
     final int count = encoded.length ~/ 5;
     final List<TextBox> boxes = <TextBox>[];
@@ -68,8 +68,14 @@ std::shared_ptr<txt::FontCollection> FontCollection::GetFontCollection() const {
   return collection_;
 }
 
-void FontCollection::SetupDefaultFontManager() {
-  collection_->SetupDefaultFontManager();
+void FontCollection::SetLayoutTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  layout_task_runner_ = std::move(task_runner);
+}
+
+std::shared_ptr<fml::ConcurrentTaskRunner>
+FontCollection::GetLayoutTaskRunner() const {
+  return layout_task_runner_;
 }
 
 void FontCollection::RegisterFonts(
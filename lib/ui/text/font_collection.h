@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "flutter/assets/asset_manager.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "txt/font_collection.h"
@@ -29,7 +30,13 @@ class FontCollection {
 
   std::shared_ptr<txt::FontCollection> GetFontCollection() const;
 
-  void SetupDefaultFontManager();
+  // The task runner that |Paragraph.layoutAll| spreads the layout of
+  // paragraphs using this collection over. Paragraphs are laid out on the
+  // calling thread if there is none.
+  void SetLayoutTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetLayoutTaskRunner() const;
 
   void RegisterFonts(std::shared_ptr<AssetManager> asset_manager);
 
@@ -42,6 +49,7 @@ class FontCollection {
  private:
   std::shared_ptr<txt::FontCollection> collection_;
   sk_sp<txt::DynamicFontManager> dynamic_font_manager_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> layout_task_runner_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(FontCollection);
 };
@@ -4,10 +4,23 @@
 
 #include "flutter/lib/ui/text/paragraph.h"
 
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/text/font_collection.h"
+#include "flutter/lib/ui/ui_dart_state.h"
+#include "flutter/lib/ui/window/platform_configuration.h"
 #include "third_party/tonic/converter/dart_converter.h"
 #include "third_party/tonic/dart_args.h"
 #include "third_party/tonic/dart_binding_macros.h"
@@ -37,7 +50,17 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, Paragraph);
   V(Paragraph, getPositionForOffset)    \
   V(Paragraph, computeLineMetrics)
 
-DART_BIND_ALL(Paragraph, FOR_EACH_BINDING)
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+
+static void Paragraph_layoutAll(Dart_NativeArguments args) {
+  UIDartState::ThrowIfUIOperationsProhibited();
+  tonic::DartCallStatic(&Paragraph::layoutAll, args);
+}
+
+void Paragraph::RegisterNatives(tonic::DartLibraryNatives* natives) {
+  natives->Register({{"Paragraph_layoutAll", Paragraph_layoutAll, 2, true},
+                     FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
+}
 
 Paragraph::Paragraph(std::unique_ptr<txt::Paragraph> paragraph)
     : m_paragraph(std::move(paragraph)) {}
@@ -87,6 +110,82 @@ void Paragraph::layout(double width) {
   m_paragraph->Layout(width);
 }
 
+void Paragraph::layoutAll(const std::vector<Paragraph*>& paragraphs,
+                          const tonic::Float64List& widths) {
+  FML_DCHECK(paragraphs.size() == static_cast<size_t>(widths.num_elements()));
+  const size_t count =
+      std::min(paragraphs.size(), static_cast<size_t>(widths.num_elements()));
+  TRACE_EVENT1("flutter", "Paragraph::layoutAll", "count",
+               std::to_string(count).c_str());
+
+  // A paragraph can only be laid out on one thread at a time. If it is listed
+  // more than once, the later entries are laid out on this thread once the
+  // others are done so that the last width wins, as with sequential layouts.
+  std::vector<size_t> concurrent;
+  std::vector<size_t> repeated;
+  std::unordered_set<Paragraph*> seen;
+  for (size_t i = 0; i < count; i++) {
+    if (!paragraphs[i]) {
+      continue;
+    }
+    if (seen.insert(paragraphs[i]).second) {
+      concurrent.push_back(i);
+    } else {
+      repeated.push_back(i);
+    }
+  }
+
+  std::shared_ptr<fml::ConcurrentTaskRunner> task_runner =
+      UIDartState::Current()
+          ->platform_configuration()
+          ->client()
+          ->GetFontCollection()
+          .GetLayoutTaskRunner();
+
+  // Workers and this thread take paragraphs from the list until it's empty.
+  // This thread helps out so that the layouts make progress even when all the
+  // workers are busy. It returns once every paragraph is laid out, so helpers
+  // that only run later find nothing left to do. They share the state so that
+  // it outlives this call.
+  struct LayoutAllState {
+    explicit LayoutAllState(size_t count) : laid_out(count) {}
+    std::vector<std::pair<Paragraph*, double>> work;
+    std::atomic_size_t next{0};
+    fml::CountDownLatch laid_out;
+  };
+  auto state = std::make_shared<LayoutAllState>(concurrent.size());
+  state->work.reserve(concurrent.size());
+  for (size_t index : concurrent) {
+    state->work.emplace_back(paragraphs[index], widths[index]);
+  }
+  auto layout_concurrent = [](LayoutAllState& state) {
+    for (size_t i = state.next++; i < state.work.size(); i = state.next++) {
+      state.work[i].first->layout(state.work[i].second);
+      state.laid_out.CountDown();
+    }
+  };
+
+  const size_t helper_count =
+      task_runner ? std::min<size_t>(
+                        concurrent.size() / 2,
+                        std::max(std::thread::hardware_concurrency(), 2u) - 1)
+                  : 0;
+  for (size_t i = 0; i < helper_count; i++) {
+    task_runner->PostTask(
+        [state, layout_concurrent]() {
+          TRACE_EVENT0("flutter", "Paragraph::layoutAll::Worker");
+          layout_concurrent(*state);
+        },
+        fml::ConcurrentTaskPriority::kUserVisible);
+  }
+  layout_concurrent(*state);
+  state->laid_out.Wait();
+
+  for (size_t index : repeated) {
+    paragraphs[index]->layout(widths[index]);
+  }
+}
+
 void Paragraph::paint(Canvas* canvas, double x, double y) {
   SkCanvas* sk_canvas = canvas->canvas();
   if (!sk_canvas) {
@@ -5,6 +5,8 @@
 #ifndef FLUTTER_LIB_UI_TEXT_PARAGRAPH_H_
 #define FLUTTER_LIB_UI_TEXT_PARAGRAPH_H_
 
+#include <vector>
+
 #include "flutter/fml/message_loop.h"
 #include "flutter/lib/ui/dart_wrapper.h"
 #include "flutter/lib/ui/painting/canvas.h"
@@ -43,6 +45,12 @@ class Paragraph : public RefCountedDartWrappable<Paragraph> {
   void layout(double width);
   void paint(Canvas* canvas, double x, double y);
 
+  // Lays out each paragraph with the width at the same index. The layouts are
+  // spread over the worker threads of the font collection's layout task runner
+  // and are all done when this returns.
+  static void layoutAll(const std::vector<Paragraph*>& paragraphs,
+                        const tonic::Float64List& widths);
+
   tonic::Float32List getRectsForRange(unsigned start,
                                       unsigned end,
                                       unsigned boxHeightStyle,
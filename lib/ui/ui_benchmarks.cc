@@ -4,11 +4,14 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/common/settings.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
 #include "flutter/lib/ui/window/platform_message_response_dart.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/dart_isolate_runner.h"
 #include "flutter/testing/fixture_test.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/codec/SkCodec.h"
 
 #include <future>
 
@@ -37,10 +40,9 @@ static void BM_PlatformMessageResponseDartComplete(
   while (state.KeepRunning()) {
     state.PauseTiming();
     bool successful = isolate->RunInIsolateScope([&]() -> bool {
-      // Simulate a message of 3 MB
-      std::vector<uint8_t> data(3 << 20, 0);
+      std::vector<uint8_t> data(state.range(0), 0);
       std::unique_ptr<fml::Mapping> mapping =
-          std::make_unique<fml::DataMapping>(data);
+          std::make_unique<fml::DataMapping>(std::move(data));
 
       Dart_Handle library = Dart_RootLibrary();
       Dart_Handle closure =
@@ -57,9 +59,9 @@ static void BM_PlatformMessageResponseDartComplete(
     FML_CHECK(successful);
     state.ResumeTiming();
 
-    // We skip timing everything above because the copy triggered by
-    // message->Complete is a task posted on the UI thread. The following wait
-    // for a UI task would let us know when that copy is done.
+    // We skip timing everything above because handing the response to Dart
+    // is a task posted on the UI thread by message->Complete. The following
+    // wait for a UI task would let us know when that is done.
     std::promise<bool> completed;
     task_runners.GetUITaskRunner()->PostTask(
         [&completed] { completed.set_value(true); });
@@ -68,6 +70,141 @@ static void BM_PlatformMessageResponseDartComplete(
 }
 
 BENCHMARK(BM_PlatformMessageResponseDartComplete)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 16 << 20)
+    ->Unit(benchmark::kMicrosecond);
+
+// Measures surfacing a platform message payload to Dart, which is what
+// dispatching a message or completing a response does on the UI thread.
+// Writable payloads are shared with Dart, read-only ones are copied.
+static void BM_PlatformMessageWrapByteData(benchmark::State& state,  // NOLINT
+                                           bool writable) {
+  // Outlives the isolate, which may still refer to it from external typed
+  // data until it shuts down.
+  const size_t size = state.range(0);
+  std::vector<uint8_t> payload(size, 0);
+
+  ThreadHost thread_host("test",
+                         ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  TaskRunners task_runners("test", thread_host.platform_thread->GetTaskRunner(),
+                           thread_host.raster_thread->GetTaskRunner(),
+                           thread_host.ui_thread->GetTaskRunner(),
+                           thread_host.io_thread->GetTaskRunner());
+  Fixture fixture;
+  auto settings = fixture.CreateSettingsForFixture();
+  auto vm_ref = DartVMRef::Create(settings);
+  auto isolate =
+      testing::RunDartCodeInIsolate(vm_ref, settings, task_runners, "main", {},
+                                    testing::GetFixturesPath(), {});
+
+  bool successful = isolate->RunInIsolateScope([&]() -> bool {
+    while (state.KeepRunning()) {
+      Dart_EnterScope();
+      Dart_Handle byte_data =
+          WrapByteData(std::make_unique<fml::NonOwnedMapping>(
+              payload.data(), size, nullptr, writable));
+      benchmark::DoNotOptimize(byte_data);
+      Dart_ExitScope();
+    }
+    return true;
+  });
+  FML_CHECK(successful);
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK_CAPTURE(BM_PlatformMessageWrapByteData, Copied, false)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 16 << 20)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_PlatformMessageWrapByteData, External, true)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 16 << 20)
+    ->Unit(benchmark::kMicrosecond);
+
+static fml::RefPtr<ImageDescriptor> CreateImageDescriptorForFixture(
+    const char* fixture_name) {
+  auto mapping = testing::OpenFixtureAsMapping(fixture_name);
+  FML_CHECK(mapping);
+  auto data = SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
+  auto codec = SkCodec::MakeFromData(data);
+  FML_CHECK(codec);
+  return fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                              std::move(codec));
+}
+
+// Decodes an image to a thumbnail that is |state.range(0)| pixels wide.
+// "IntermediateBytes" is the size of the bitmap decoded before the final
+// resize, which dominates the peak memory of a decode.
+static void BM_ImageFromCompressedData(benchmark::State& state,  // NOLINT
+                                       const char* fixture_name,
+                                       bool subsample) {
+  auto descriptor = CreateImageDescriptorForFixture(fixture_name);
+  const SkISize source_dimensions = descriptor->image_info().dimensions();
+  const int target_width = state.range(0);
+  const int target_height = std::max<int>(
+      1, target_width * source_dimensions.height() / source_dimensions.width());
+  const SkISize target_dimensions =
+      SkISize::Make(target_width, target_height);
+
+  SkISize intermediate_dimensions = source_dimensions;
+  if (subsample) {
+    int sample_size = 1;
+    intermediate_dimensions =
+        GetDecodeDimensions(*descriptor, target_dimensions, &sample_size);
+  }
+
+  while (state.KeepRunning()) {
+    sk_sp<SkImage> image;
+    if (subsample) {
+      image = ImageFromCompressedData(descriptor, target_width, target_height,
+                                      fml::tracing::TraceFlow(""));
+    } else {
+      // What decoding did before it used the native scaling of codecs.
+      SkBitmap bitmap;
+      FML_CHECK(bitmap.tryAllocPixels(
+          descriptor->image_info().makeDimensions(target_dimensions)));
+      FML_CHECK(descriptor->image()->scalePixels(
+          bitmap.pixmap(), kLow_SkFilterQuality,
+          SkImage::kDisallow_CachingHint));
+      bitmap.setImmutable();
+      image = SkImage::MakeFromBitmap(bitmap);
+    }
+    FML_CHECK(image && image->dimensions() == target_dimensions);
+    benchmark::DoNotOptimize(image);
+  }
+  state.counters["IntermediateBytes"] =
+      descriptor->image_info().makeDimensions(intermediate_dimensions)
+          .computeMinByteSize();
+}
+
+BENCHMARK_CAPTURE(BM_ImageFromCompressedData,
+                  JpegFullDecode,
+                  "DashInNooglerHat.jpg",
+                  false)
+    ->Arg(200)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ImageFromCompressedData,
+                  JpegSubsampled,
+                  "DashInNooglerHat.jpg",
+                  true)
+    ->Arg(200)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ImageFromCompressedData,
+                  PngFullDecode,
+                  "Horizontal.png",
+                  false)
+    ->Arg(30)
+    ->Arg(100)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ImageFromCompressedData,
+                  PngSubsampled,
+                  "Horizontal.png",
+                  true)
+    ->Arg(30)
+    ->Arg(100)
     ->Unit(benchmark::kMicrosecond);
 
 }  // namespace flutter
@@ -8,20 +8,41 @@
 
 namespace flutter {
 
+namespace {
+
+std::unique_ptr<fml::Mapping> CreateEmptyMapping() {
+  return std::make_unique<fml::NonOwnedMapping>(nullptr, 0u);
+}
+
+}  // namespace
+
 PlatformMessage::PlatformMessage(std::string channel,
                                  std::vector<uint8_t> data,
                                  fml::RefPtr<PlatformMessageResponse> response)
+    : PlatformMessage(std::move(channel),
+                      std::make_unique<fml::DataMapping>(std::move(data)),
+                      std::move(response)) {}
+PlatformMessage::PlatformMessage(std::string channel,
+                                 std::unique_ptr<fml::Mapping> data,
+                                 fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
-      data_(std::move(data)),
+      data_(data ? std::move(data) : CreateEmptyMapping()),
       hasData_(true),
       response_(std::move(response)) {}
 PlatformMessage::PlatformMessage(std::string channel,
                                  fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
-      data_(),
+      data_(CreateEmptyMapping()),
       hasData_(false),
       response_(std::move(response)) {}
 
 PlatformMessage::~PlatformMessage() = default;
 
+std::unique_ptr<fml::Mapping> PlatformMessage::ReleaseData() {
+  std::unique_ptr<fml::Mapping> data = std::move(data_);
+  data_ = CreateEmptyMapping();
+  hasData_ = false;
+  return data;
+}
+
 }  // namespace flutter
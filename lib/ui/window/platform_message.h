@@ -5,9 +5,11 @@
 #ifndef FLUTTER_LIB_UI_PLATFORM_PLATFORM_MESSAGE_H_
 #define FLUTTER_LIB_UI_PLATFORM_PLATFORM_MESSAGE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/lib/ui/window/platform_message_response.h"
@@ -20,9 +22,13 @@ class PlatformMessage : public fml::RefCountedThreadSafe<PlatformMessage> {
 
  public:
   const std::string& channel() const { return channel_; }
-  const std::vector<uint8_t>& data() const { return data_; }
+  const fml::Mapping& data() const { return *data_; }
   bool hasData() { return hasData_; }
 
+  // Transfers ownership of the payload to the caller, leaving the message
+  // empty. This lets the payload be handed to Dart without copying it.
+  std::unique_ptr<fml::Mapping> ReleaseData();
+
   const fml::RefPtr<PlatformMessageResponse>& response() const {
     return response_;
   }
@@ -31,12 +37,15 @@ class PlatformMessage : public fml::RefCountedThreadSafe<PlatformMessage> {
   PlatformMessage(std::string channel,
                   std::vector<uint8_t> data,
                   fml::RefPtr<PlatformMessageResponse> response);
+  PlatformMessage(std::string channel,
+                  std::unique_ptr<fml::Mapping> data,
+                  fml::RefPtr<PlatformMessageResponse> response);
   PlatformMessage(std::string channel,
                   fml::RefPtr<PlatformMessageResponse> response);
   ~PlatformMessage();
 
   std::string channel_;
-  std::vector<uint8_t> data_;
+  std::unique_ptr<fml::Mapping> data_;
   bool hasData_;
   fml::RefPtr<PlatformMessageResponse> response_;
 };
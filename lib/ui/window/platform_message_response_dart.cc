@@ -14,6 +14,37 @@
 
 namespace flutter {
 
+namespace {
+
+// Below this size, copying the payload is cheaper than allocating and
+// finalizing an external typed data.
+constexpr size_t kExternalSizeThreshold = 1000;
+
+void FinalizeMapping(void* isolate_callback_data,
+                     Dart_WeakPersistentHandle handle,
+                     void* peer) {
+  delete reinterpret_cast<fml::Mapping*>(peer);
+}
+
+}  // namespace
+
+Dart_Handle WrapByteData(std::unique_ptr<fml::Mapping> mapping) {
+  const size_t size = mapping->GetSize();
+  if (size < kExternalSizeThreshold || !mapping->IsWritable()) {
+    return tonic::DartByteData::Create(mapping->GetMapping(), size);
+  }
+  // Dart can't tell apart memory it may write to from memory it may not, so
+  // only mappings that allow writes are shared with it.
+  void* bytes = const_cast<uint8_t*>(mapping->GetMapping());
+  fml::Mapping* peer = mapping.release();
+  Dart_Handle byte_data = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, peer, size, FinalizeMapping);
+  if (Dart_IsError(byte_data)) {
+    delete peer;
+  }
+  return byte_data;
+}
+
 PlatformMessageResponseDart::PlatformMessageResponseDart(
     tonic::DartPersistentValue callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner)
@@ -42,8 +73,7 @@ void PlatformMessageResponseDart::Complete(std::unique_ptr<fml::Mapping> data) {
         }
         tonic::DartState::Scope scope(dart_state);
 
-        Dart_Handle byte_buffer =
-            tonic::DartByteData::Create(data->GetMapping(), data->GetSize());
+        Dart_Handle byte_buffer = WrapByteData(std::move(data));
         tonic::DartInvoke(callback.Release(), {byte_buffer});
       }));
 }
@@ -11,6 +11,12 @@
 
 namespace flutter {
 
+// Creates a Dart ByteData holding the contents of |mapping|. Small payloads
+// are copied into the Dart heap. Larger ones are handed to Dart without a copy
+// as external typed data that deletes |mapping| when it is garbage collected,
+// unless the mapping isn't writable, in which case they are copied too.
+Dart_Handle WrapByteData(std::unique_ptr<fml::Mapping> mapping);
+
 class PlatformMessageResponseDart : public PlatformMessageResponse {
   FML_FRIEND_MAKE_REF_COUNTED(PlatformMessageResponseDart);
 
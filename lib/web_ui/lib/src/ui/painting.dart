@@ -702,3 +702,48 @@ class ImageDescriptor {
     });
   }
 }
+
+typedef ProgressiveImageCallback = void Function(Image? image, bool isFinal);
+
+// The web decodes the image once all chunks were added.
+class ProgressiveImageDecoder {
+  ProgressiveImageDecoder(ProgressiveImageCallback callback)
+      : _callback = callback;
+
+  ProgressiveImageCallback? _callback;
+  final List<Uint8List> _chunks = <Uint8List>[];
+  int _length = 0;
+
+  void addChunk(Uint8List chunk) {
+    _chunks.add(Uint8List.fromList(chunk));
+    _length += chunk.length;
+  }
+
+  void close() {
+    final Uint8List bytes = Uint8List(_length);
+    int offset = 0;
+    for (final Uint8List chunk in _chunks) {
+      bytes.setAll(offset, chunk);
+      offset += chunk.length;
+    }
+    _chunks.clear();
+    _decode(bytes);
+  }
+
+  Future<void> _decode(Uint8List bytes) async {
+    Image? image;
+    try {
+      final Codec codec = await instantiateImageCodec(bytes);
+      image = (await codec.getNextFrame()).image;
+    } catch (_) {
+      image = null;
+    }
+    _callback?.call(image, true);
+    _callback = null;
+  }
+
+  void dispose() {
+    _chunks.clear();
+    _callback = null;
+  }
+}
@@ -66,23 +66,10 @@ std::weak_ptr<DartIsolate> DartIsolate::CreateRootIsolate(
     std::string advisory_script_entrypoint,
     Dart_IsolateFlags* flags,
     const fml::closure& isolate_create_callback,
-    const fml::closure& isolate_shutdown_callback) {
+    const fml::closure& isolate_shutdown_callback,
+    DartIsolate* spawning_isolate) {
   TRACE_EVENT0("flutter", "DartIsolate::CreateRootIsolate");
 
-  // The child isolate preparer is null but will be set when the isolate is
-  // being prepared to run.
-  auto isolate_group_data =
-      std::make_unique<std::shared_ptr<DartIsolateGroupData>>(
-          std::shared_ptr<DartIsolateGroupData>(new DartIsolateGroupData(
-              settings,                     // settings
-              std::move(isolate_snapshot),  // isolate snapshot
-              advisory_script_uri,          // advisory URI
-              advisory_script_entrypoint,   // advisory entrypoint
-              nullptr,                      // child isolate preparer
-              isolate_create_callback,      // isolate create callback
-              isolate_shutdown_callback     // isolate shutdown callback
-              )));
-
   auto isolate_data = std::make_unique<std::shared_ptr<DartIsolate>>(
       std::shared_ptr<DartIsolate>(new DartIsolate(
           settings,                        // settings
@@ -98,12 +85,34 @@ std::weak_ptr<DartIsolate> DartIsolate::CreateRootIsolate(
           )));
 
   DartErrorString error;
-  Dart_Isolate vm_isolate =
-      CreateDartIsolateGroup(std::move(isolate_group_data),
-                             std::move(isolate_data), flags, error.error());
-
-  if (error) {
-    FML_LOG(ERROR) << "CreateDartIsolateGroup failed: " << error.str();
+  Dart_Isolate vm_isolate = nullptr;
+  if (spawning_isolate) {
+    (*isolate_data)->is_spawned_ = true;
+    vm_isolate = CreateDartIsolateInGroup(
+        *spawning_isolate, std::move(isolate_data), error.error());
+    if (error) {
+      FML_LOG(ERROR) << "CreateDartIsolateInGroup failed: " << error.str();
+    }
+  } else {
+    // The child isolate preparer is null but will be set when the isolate is
+    // being prepared to run.
+    auto isolate_group_data =
+        std::make_unique<std::shared_ptr<DartIsolateGroupData>>(
+            std::shared_ptr<DartIsolateGroupData>(new DartIsolateGroupData(
+                settings,                     // settings
+                std::move(isolate_snapshot),  // isolate snapshot
+                advisory_script_uri,          // advisory URI
+                advisory_script_entrypoint,   // advisory entrypoint
+                nullptr,                      // child isolate preparer
+                isolate_create_callback,      // isolate create callback
+                isolate_shutdown_callback     // isolate shutdown callback
+                )));
+    vm_isolate =
+        CreateDartIsolateGroup(std::move(isolate_group_data),
+                               std::move(isolate_data), flags, error.error());
+    if (error) {
+      FML_LOG(ERROR) << "CreateDartIsolateGroup failed: " << error.str();
+    }
   }
 
   if (vm_isolate == nullptr) {
@@ -326,8 +335,8 @@ bool DartIsolate::LoadKernel(std::shared_ptr<const fml::Mapping> mapping,
     return false;
   }
 
-  // Mapping must be retained until isolate shutdown.
-  kernel_buffers_.push_back(mapping);
+  // Mapping must be retained until isolate group shutdown.
+  GetIsolateGroupData().AddKernelBuffer(mapping);
 
   Dart_Handle library =
       Dart_LoadLibraryFromKernel(mapping->GetMapping(), mapping->GetSize());
@@ -365,11 +374,16 @@ bool DartIsolate::LoadKernel(std::shared_ptr<const fml::Mapping> mapping,
 
   tonic::DartState::Scope scope(this);
 
-  // Use root library provided by kernel in favor of one provided by snapshot.
-  Dart_SetRootLibrary(Dart_Null());
+  // The program is shared by the isolates of a group, so an isolate that was
+  // spawned into a group whose program is loaded already has nothing to load.
+  if (!is_spawned_ || Dart_IsNull(Dart_RootLibrary())) {
+    // Use root library provided by kernel in favor of one provided by
+    // snapshot.
+    Dart_SetRootLibrary(Dart_Null());
 
-  if (!LoadKernel(mapping, last_piece)) {
-    return false;
+    if (!LoadKernel(mapping, last_piece)) {
+      return false;
+    }
   }
 
   if (!last_piece) {
@@ -390,7 +404,8 @@ bool DartIsolate::LoadKernel(std::shared_ptr<const fml::Mapping> mapping,
   // executed leads to crashes.
   if (GetIsolateGroupData().GetChildIsolatePreparer() == nullptr) {
     GetIsolateGroupData().SetChildIsolatePreparer(
-        [buffers = kernel_buffers_](DartIsolate* isolate) {
+        [buffers = GetIsolateGroupData().GetKernelBuffers()](
+            DartIsolate* isolate) {
           for (uint64_t i = 0; i < buffers.size(); i++) {
             bool last_piece = i + 1 == buffers.size();
             const std::shared_ptr<const fml::Mapping>& buffer = buffers.at(i);
@@ -808,6 +823,38 @@ Dart_Isolate DartIsolate::CreateDartIsolateGroup(
   return isolate;
 }
 
+Dart_Isolate DartIsolate::CreateDartIsolateInGroup(
+    DartIsolate& spawning_isolate,
+    std::unique_ptr<std::shared_ptr<DartIsolate>> isolate_data,
+    char** error) {
+  TRACE_EVENT0("flutter", "DartIsolate::CreateDartIsolateInGroup");
+
+  // The new isolate shares the group data of the spawning isolate, which is
+  // collected along with the last isolate of the group.
+  Dart_Isolate isolate = Dart_CreateIsolateInGroup(
+      spawning_isolate.isolate(),
+      (*isolate_data)->GetAdvisoryScriptEntrypoint().c_str(),
+      reinterpret_cast<Dart_IsolateShutdownCallback>(
+          DartIsolate::DartIsolateShutdownCallback),
+      reinterpret_cast<Dart_IsolateCleanupCallback>(
+          DartIsolate::DartIsolateCleanupCallback),
+      isolate_data.get(), error);
+
+  if (isolate == nullptr) {
+    return nullptr;
+  }
+
+  // Ownership of the isolate data object has been transferred to the Dart VM.
+  std::shared_ptr<DartIsolate> embedder_isolate(*isolate_data);
+  isolate_data.release();
+
+  if (!InitializeIsolate(std::move(embedder_isolate), isolate, error)) {
+    return nullptr;
+  }
+
+  return isolate;
+}
+
 bool DartIsolate::InitializeIsolate(
     std::shared_ptr<DartIsolate> embedder_isolate,
     Dart_Isolate isolate,
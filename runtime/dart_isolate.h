@@ -182,6 +182,15 @@ class DartIsolate : public UIDartState {
   ///                                         isolate is still running at this
   ///                                         point and an isolate scope is
   ///                                         current.
+  /// @param[in]  spawning_isolate            The root isolate of another
+  ///                                         engine to create this isolate in
+  ///                                         the group of, or null to create
+  ///                                         it in a new group. Isolates in a
+  ///                                         group share the group data, the
+  ///                                         heap and the loaded program, so
+  ///                                         the settings, snapshot and
+  ///                                         callbacks passed in are ignored in
+  ///                                         favor of those of the group.
   ///
   /// @return     A weak pointer to the root Dart isolate. The caller must
   ///             ensure that the isolate is not referenced for long periods of
@@ -203,7 +212,8 @@ class DartIsolate : public UIDartState {
       std::string advisory_script_entrypoint,
       Dart_IsolateFlags* flags,
       const fml::closure& isolate_create_callback,
-      const fml::closure& isolate_shutdown_callback);
+      const fml::closure& isolate_shutdown_callback,
+      DartIsolate* spawning_isolate = nullptr);
 
   // |UIDartState|
   ~DartIsolate() override;
@@ -397,7 +407,8 @@ class DartIsolate : public UIDartState {
   friend class DartVM;
 
   Phase phase_ = Phase::Unknown;
-  std::vector<std::shared_ptr<const fml::Mapping>> kernel_buffers_;
+  // Whether this isolate was created in the group of another root isolate.
+  bool is_spawned_ = false;
   std::vector<std::unique_ptr<AutoFireClosure>> shutdown_callbacks_;
   fml::RefPtr<fml::TaskRunner> message_handling_task_runner_;
   const bool may_insecurely_connect_to_all_domains_;
@@ -455,6 +466,11 @@ class DartIsolate : public UIDartState {
       Dart_IsolateFlags* flags,
       char** error);
 
+  static Dart_Isolate CreateDartIsolateInGroup(
+      DartIsolate& spawning_isolate,
+      std::unique_ptr<std::shared_ptr<DartIsolate>> isolate_data,
+      char** error);
+
   static bool InitializeIsolate(std::shared_ptr<DartIsolate> embedder_isolate,
                                 Dart_Isolate isolate,
                                 char** error);
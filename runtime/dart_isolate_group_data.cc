@@ -64,4 +64,16 @@ void DartIsolateGroupData::SetChildIsolatePreparer(
   child_isolate_preparer_ = value;
 }
 
+void DartIsolateGroupData::AddKernelBuffer(
+    const std::shared_ptr<const fml::Mapping>& buffer) {
+  std::scoped_lock lock(kernel_buffers_mutex_);
+  kernel_buffers_.push_back(buffer);
+}
+
+std::vector<std::shared_ptr<const fml::Mapping>>
+DartIsolateGroupData::GetKernelBuffers() const {
+  std::scoped_lock lock(kernel_buffers_mutex_);
+  return kernel_buffers_;
+}
+
 }  // namespace flutter
@@ -7,9 +7,11 @@
 
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "flutter/common/settings.h"
 #include "flutter/fml/closure.h"
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/memory/ref_ptr.h"
 
 namespace flutter {
@@ -53,6 +55,13 @@ class DartIsolateGroupData {
 
   void SetChildIsolatePreparer(const ChildIsolatePreparer& value);
 
+  // The kernel buffers of the program loaded in the group. They are retained
+  // until the group is collected because isolates spawned into the group keep
+  // using the program after the isolate that loaded it is gone.
+  void AddKernelBuffer(const std::shared_ptr<const fml::Mapping>& buffer);
+
+  std::vector<std::shared_ptr<const fml::Mapping>> GetKernelBuffers() const;
+
  private:
   const Settings settings_;
   const fml::RefPtr<const DartSnapshot> isolate_snapshot_;
@@ -62,6 +71,8 @@ class DartIsolateGroupData {
   ChildIsolatePreparer child_isolate_preparer_;
   const fml::closure isolate_create_callback_;
   const fml::closure isolate_shutdown_callback_;
+  mutable std::mutex kernel_buffers_mutex_;
+  std::vector<std::shared_ptr<const fml::Mapping>> kernel_buffers_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(DartIsolateGroupData);
 };
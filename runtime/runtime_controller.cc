@@ -37,6 +37,42 @@ RuntimeController::RuntimeController(
     const fml::closure& p_isolate_create_callback,
     const fml::closure& p_isolate_shutdown_callback,
     std::shared_ptr<const fml::Mapping> p_persistent_isolate_data)
+    : RuntimeController(p_client,
+                        p_vm,
+                        std::move(p_isolate_snapshot),
+                        p_task_runners,
+                        std::move(p_snapshot_delegate),
+                        std::move(p_hint_freed_delegate),
+                        std::move(p_io_manager),
+                        std::move(p_unref_queue),
+                        std::move(p_image_decoder),
+                        std::move(p_advisory_script_uri),
+                        std::move(p_advisory_script_entrypoint),
+                        idle_notification_callback,
+                        p_platform_data,
+                        p_isolate_create_callback,
+                        p_isolate_shutdown_callback,
+                        std::move(p_persistent_isolate_data),
+                        nullptr) {}
+
+RuntimeController::RuntimeController(
+    RuntimeDelegate& p_client,
+    DartVM* p_vm,
+    fml::RefPtr<const DartSnapshot> p_isolate_snapshot,
+    TaskRunners p_task_runners,
+    fml::WeakPtr<SnapshotDelegate> p_snapshot_delegate,
+    fml::WeakPtr<HintFreedDelegate> p_hint_freed_delegate,
+    fml::WeakPtr<IOManager> p_io_manager,
+    fml::RefPtr<SkiaUnrefQueue> p_unref_queue,
+    fml::WeakPtr<ImageDecoder> p_image_decoder,
+    std::string p_advisory_script_uri,
+    std::string p_advisory_script_entrypoint,
+    const std::function<void(int64_t)>& idle_notification_callback,
+    const PlatformData& p_platform_data,
+    const fml::closure& p_isolate_create_callback,
+    const fml::closure& p_isolate_shutdown_callback,
+    std::shared_ptr<const fml::Mapping> p_persistent_isolate_data,
+    DartIsolate* spawning_isolate)
     : client_(p_client),
       vm_(p_vm),
       isolate_snapshot_(std::move(p_isolate_snapshot)),
@@ -71,7 +107,8 @@ RuntimeController::RuntimeController(
           p_advisory_script_entrypoint,                   //
           nullptr,                                        //
           isolate_create_callback_,                       //
-          isolate_shutdown_callback_                      //
+          isolate_shutdown_callback_,                     //
+          spawning_isolate                                //
           )
           .lock();
 
@@ -139,6 +176,37 @@ std::unique_ptr<RuntimeController> RuntimeController::Clone() const {
       ));
 }
 
+std::unique_ptr<RuntimeController> RuntimeController::Spawn(
+    RuntimeDelegate& client,
+    fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+    fml::WeakPtr<HintFreedDelegate> hint_freed_delegate,
+    fml::WeakPtr<IOManager> io_manager,
+    fml::RefPtr<SkiaUnrefQueue> unref_queue,
+    fml::WeakPtr<ImageDecoder> image_decoder,
+    const PlatformData& platform_data) const {
+  TRACE_EVENT0("flutter", "RuntimeController::Spawn");
+  std::shared_ptr<DartIsolate> spawning_isolate = root_isolate_.lock();
+  return std::unique_ptr<RuntimeController>(new RuntimeController(
+      client,                          //
+      vm_,                             //
+      isolate_snapshot_,               //
+      task_runners_,                   //
+      std::move(snapshot_delegate),    //
+      std::move(hint_freed_delegate),  //
+      std::move(io_manager),           //
+      std::move(unref_queue),          //
+      std::move(image_decoder),        //
+      advisory_script_uri_,            //
+      advisory_script_entrypoint_,     //
+      idle_notification_callback_,     //
+      platform_data,                   //
+      isolate_create_callback_,        //
+      isolate_shutdown_callback_,      //
+      persistent_isolate_data_,        //
+      spawning_isolate.get()           //
+      ));
+}
+
 bool RuntimeController::FlushRuntimeStateToIsolate() {
   return SetViewportMetrics(platform_data_.viewport_metrics) &&
          SetLocales(platform_data_.locale_data) &&
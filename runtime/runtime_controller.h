@@ -141,6 +141,45 @@ class RuntimeController : public PlatformConfigurationClient {
   ///
   std::unique_ptr<RuntimeController> Clone() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Create a runtime controller for another engine whose root
+  ///             isolate is created in the isolate group of the root isolate
+  ///             of this one. The new isolate shares the heap and the loaded
+  ///             program with this one, which makes it much cheaper to create
+  ///             than a new isolate group, but it has its own window data and
+  ///             must still be run with an entrypoint. The isolate group
+  ///             outlives this runtime controller if the new one is still
+  ///             alive. If this runtime controller has no root isolate, the new
+  ///             one is created in a new isolate group.
+  ///
+  /// @param[in]  client               The runtime delegate of the other engine.
+  /// @param[in]  snapshot_delegate    The snapshot delegate of the other
+  ///                                  engine.
+  /// @param[in]  hint_freed_delegate  The hint freed delegate of the other
+  ///                                  engine.
+  /// @param[in]  io_manager           The IO manager used by the new isolate.
+  /// @param[in]  unref_queue          The Skia unref queue used by the new
+  ///                                  isolate.
+  /// @param[in]  image_decoder        The image decoder of the other engine.
+  /// @param[in]  platform_data        The window data of the other engine.
+  ///
+  /// @return     The runtime controller for the other engine.
+  ///
+  std::unique_ptr<RuntimeController> Spawn(
+      RuntimeDelegate& client,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+      fml::WeakPtr<HintFreedDelegate> hint_freed_delegate,
+      fml::WeakPtr<IOManager> io_manager,
+      fml::RefPtr<SkiaUnrefQueue> unref_queue,
+      fml::WeakPtr<ImageDecoder> image_decoder,
+      const PlatformData& platform_data) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      The Dart VM the root isolate of this runtime controller runs
+  ///             in.
+  ///
+  DartVM* GetDartVM() const { return vm_; }
+
   //----------------------------------------------------------------------------
   /// @brief      Forward the specified viewport metrics to the running isolate.
   ///             If the isolate is not running, these metrics will be saved and
@@ -486,6 +525,27 @@ class RuntimeController : public PlatformConfigurationClient {
   const fml::closure isolate_shutdown_callback_;
   std::shared_ptr<const fml::Mapping> persistent_isolate_data_;
 
+  // Creates the root isolate in the group of |spawning_isolate|, or in a new
+  // group if it is null.
+  RuntimeController(
+      RuntimeDelegate& client,
+      DartVM* vm,
+      fml::RefPtr<const DartSnapshot> isolate_snapshot,
+      TaskRunners task_runners,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+      fml::WeakPtr<HintFreedDelegate> hint_freed_delegate,
+      fml::WeakPtr<IOManager> io_manager,
+      fml::RefPtr<SkiaUnrefQueue> unref_queue,
+      fml::WeakPtr<ImageDecoder> image_decoder,
+      std::string advisory_script_uri,
+      std::string advisory_script_entrypoint,
+      const std::function<void(int64_t)>& idle_notification_callback,
+      const PlatformData& platform_data,
+      const fml::closure& isolate_create_callback,
+      const fml::closure& isolate_shutdown_callback,
+      std::shared_ptr<const fml::Mapping> persistent_isolate_data,
+      DartIsolate* spawning_isolate);
+
   PlatformConfiguration* GetPlatformConfigurationIfAvailable();
 
   bool FlushRuntimeStateToIsolate();
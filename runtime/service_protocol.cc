@@ -37,6 +37,15 @@ const std::string_view ServiceProtocol::kGetSkSLsExtensionName =
 const std::string_view
     ServiceProtocol::kEstimateRasterCacheMemoryExtensionName =
         "_flutter.estimateRasterCacheMemory";
+const std::string_view ServiceProtocol::kGetMemoryUsageExtensionName =
+    "_flutter.getMemoryUsage";
+const std::string_view ServiceProtocol::kSetMemoryBudgetExtensionName =
+    "_flutter.setMemoryBudget";
+const std::string_view ServiceProtocol::kPurgeMemoryExtensionName =
+    "_flutter.purgeMemory";
+const std::string_view
+    ServiceProtocol::kGetSkSLPrecompileProgressExtensionName =
+        "_flutter.getSkSLPrecompileProgress";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -56,6 +65,10 @@ ServiceProtocol::ServiceProtocol()
           kGetDisplayRefreshRateExtensionName,
           kGetSkSLsExtensionName,
           kEstimateRasterCacheMemoryExtensionName,
+          kGetMemoryUsageExtensionName,
+          kSetMemoryBudgetExtensionName,
+          kPurgeMemoryExtensionName,
+          kGetSkSLPrecompileProgressExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
 
@@ -29,6 +29,10 @@ class ServiceProtocol {
   static const std::string_view kGetDisplayRefreshRateExtensionName;
   static const std::string_view kGetSkSLsExtensionName;
   static const std::string_view kEstimateRasterCacheMemoryExtensionName;
+  static const std::string_view kGetMemoryUsageExtensionName;
+  static const std::string_view kSetMemoryBudgetExtensionName;
+  static const std::string_view kPurgeMemoryExtensionName;
+  static const std::string_view kGetSkSLPrecompileProgressExtensionName;
 
   class Handler {
    public:
@@ -44,16 +44,47 @@ Engine::Engine(
     std::unique_ptr<Animator> animator,
     fml::WeakPtr<IOManager> io_manager,
     std::unique_ptr<RuntimeController> runtime_controller)
+    : Engine(delegate,
+             dispatcher_maker,
+             std::move(image_decoder_task_runner),
+             std::move(task_runners),
+             std::move(settings),
+             std::move(animator),
+             std::move(io_manager),
+             std::make_shared<FontCollection>(),
+             std::make_shared<DecodedImageCache>(),
+             std::move(runtime_controller)) {}
+
+Engine::Engine(
+    Delegate& delegate,
+    const PointerDataDispatcherMaker& dispatcher_maker,
+    std::shared_ptr<fml::ConcurrentTaskRunner> image_decoder_task_runner,
+    TaskRunners task_runners,
+    Settings settings,
+    std::unique_ptr<Animator> animator,
+    fml::WeakPtr<IOManager> io_manager,
+    std::shared_ptr<FontCollection> font_collection,
+    std::shared_ptr<DecodedImageCache> decoded_image_cache,
+    std::unique_ptr<RuntimeController> runtime_controller)
     : delegate_(delegate),
       settings_(std::move(settings)),
       animator_(std::move(animator)),
       runtime_controller_(std::move(runtime_controller)),
       activity_running_(true),
       have_surface_(false),
-      image_decoder_(task_runners, image_decoder_task_runner, io_manager),
+      font_collection_(std::move(font_collection)),
+      decoded_image_cache_(std::move(decoded_image_cache)),
+      image_decoder_(task_runners,
+                     image_decoder_task_runner,
+                     io_manager,
+                     decoded_image_cache_,
+                     {settings_.animated_image_lookahead_frames,
+                      settings_.animated_image_frame_cache_bytes}),
       task_runners_(std::move(task_runners)),
+      memory_accounting_(delegate.GetMemoryAccounting()),
       weak_factory_(this) {
   pointer_data_dispatcher_ = dispatcher_maker(*this);
+  font_collection_->SetLayoutTaskRunner(std::move(image_decoder_task_runner));
 }
 
 Engine::Engine(Delegate& delegate,
@@ -95,7 +126,48 @@ Engine::Engine(Delegate& delegate,
   );
 }
 
-Engine::~Engine() = default;
+std::unique_ptr<Engine> Engine::Spawn(
+    Delegate& delegate,
+    const PointerDataDispatcherMaker& dispatcher_maker,
+    const PlatformData& platform_data,
+    Settings settings,
+    std::unique_ptr<Animator> animator,
+    fml::WeakPtr<IOManager> io_manager,
+    fml::RefPtr<SkiaUnrefQueue> unref_queue,
+    fml::WeakPtr<SnapshotDelegate> snapshot_delegate) const {
+  TRACE_EVENT0("flutter", "Engine::Spawn");
+  auto result = std::make_unique<Engine>(
+      delegate,                                                          //
+      dispatcher_maker,                                                  //
+      runtime_controller_->GetDartVM()->GetConcurrentWorkerTaskRunner(),  //
+      task_runners_,                                                     //
+      std::move(settings),                                               //
+      std::move(animator),                                               //
+      io_manager,                                                        //
+      font_collection_,                                                  //
+      decoded_image_cache_,                                              //
+      nullptr                                                            //
+  );
+  result->is_spawned_ = true;
+  result->runtime_controller_ = runtime_controller_->Spawn(
+      *result,                              // runtime delegate
+      std::move(snapshot_delegate),         // snapshot delegate
+      result->GetWeakPtr(),                 // hint freed delegate
+      std::move(io_manager),                // io manager
+      std::move(unref_queue),               // Skia unref queue
+      result->image_decoder_.GetWeakPtr(),  // image decoder
+      platform_data                         // platform data
+  );
+  return result;
+}
+
+Engine::~Engine() {
+  // Shutting down the isolate runs the finalizers of the images it still
+  // holds, which report their release to this engine's memory accounting.
+  // So the isolate goes first, while the rest of the engine is still around.
+  pointer_data_dispatcher_.reset();
+  runtime_controller_.reset();
+}
 
 float Engine::GetDisplayRefreshRate() const {
   return animator_->GetDisplayRefreshRate();
@@ -105,9 +177,10 @@ fml::WeakPtr<Engine> Engine::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
 }
 
-void Engine::SetupDefaultFontManager() {
+void Engine::SetupDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
   TRACE_EVENT0("flutter", "Engine::SetupDefaultFontManager");
-  font_collection_.SetupDefaultFontManager();
+  font_collection_->GetFontCollection()->SetDefaultFontManager(
+      std::move(font_manager));
 }
 
 bool Engine::UpdateAssetManager(
@@ -122,11 +195,14 @@ bool Engine::UpdateAssetManager(
     return false;
   }
 
-  // Using libTXT as the text engine.
-  font_collection_.RegisterFonts(asset_manager_);
+  // Using libTXT as the text engine. Spawned engines use the fonts of the
+  // engine they were spawned from.
+  if (!is_spawned_) {
+    font_collection_->RegisterFonts(asset_manager_);
 
-  if (settings_.use_test_fonts) {
-    font_collection_.RegisterTestFonts();
+    if (settings_.use_test_fonts) {
+      font_collection_->RegisterTestFonts();
+    }
   }
 
   return true;
@@ -253,6 +329,18 @@ void Engine::HintFreed(size_t size) {
   hint_freed_bytes_since_last_idle_ += size;
 }
 
+void Engine::HintImageRetained(size_t size) {
+  if (memory_accounting_) {
+    memory_accounting_->AddUsage(MemoryCategory::kImages, size);
+  }
+}
+
+void Engine::HintImageReleased(size_t size) {
+  if (memory_accounting_) {
+    memory_accounting_->RemoveUsage(MemoryCategory::kImages, size);
+  }
+}
+
 void Engine::NotifyIdle(int64_t deadline) {
   auto trace_event = std::to_string(deadline - Dart_TimelineGetMicros());
   TRACE_EVENT1("flutter", "Engine::NotifyIdle", "deadline_now_delta",
@@ -339,7 +427,8 @@ void Engine::DispatchPlatformMessage(fml::RefPtr<PlatformMessage> message) {
 
 bool Engine::HandleLifecyclePlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string state(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string state(reinterpret_cast<const char*>(data.GetMapping()),
+                    data.GetSize());
   if (state == "AppLifecycleState.paused" ||
       state == "AppLifecycleState.detached") {
     activity_running_ = false;
@@ -366,7 +455,8 @@ bool Engine::HandleNavigationPlatformMessage(
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject()) {
     return false;
   }
@@ -384,7 +474,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject()) {
     return false;
   }
@@ -424,7 +515,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
 
 void Engine::HandleSettingsPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string jsonData(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string jsonData(reinterpret_cast<const char*>(data.GetMapping()),
+                       data.GetSize());
   if (runtime_controller_->SetUserSettingsData(std::move(jsonData)) &&
       have_surface_) {
     ScheduleFrame();
@@ -516,7 +608,7 @@ void Engine::SetNeedsReportTimings(bool needs_reporting) {
 }
 
 FontCollection& Engine::GetFontCollection() {
-  return font_collection_;
+  return *font_collection_;
 }
 
 void Engine::DoDispatchPacket(std::unique_ptr<PointerDataPacket> packet,
@@ -537,8 +629,8 @@ void Engine::HandleAssetPlatformMessage(fml::RefPtr<PlatformMessage> message) {
     return;
   }
   const auto& data = message->data();
-  std::string asset_name(reinterpret_cast<const char*>(data.data()),
-                         data.size());
+  std::string asset_name(reinterpret_cast<const char*>(data.GetMapping()),
+                         data.GetSize());
 
   if (asset_manager_) {
     std::unique_ptr<fml::Mapping> asset_mapping =
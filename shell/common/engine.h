@@ -10,9 +10,11 @@
 
 #include "flutter/assets/asset_manager.h"
 #include "flutter/common/task_runners.h"
+#include "flutter/flow/memory_accounting.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/lib/ui/hint_freed_delegate.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_decoder.h"
 #include "flutter/lib/ui/semantics/custom_accessibility_action.h"
 #include "flutter/lib/ui/semantics/semantics_node.h"
@@ -29,6 +31,7 @@
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/run_configuration.h"
 #include "flutter/shell/common/shell_io_manager.h"
+#include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkPicture.h"
 
 namespace flutter {
@@ -249,6 +252,13 @@ class Engine final : public RuntimeDelegate,
     virtual std::unique_ptr<std::vector<std::string>>
     ComputePlatformResolvedLocale(
         const std::vector<std::string>& supported_locale_data) = 0;
+
+    //--------------------------------------------------------------------------
+    /// @brief      The memory accounting of the shell, which the engine reports
+    ///             the bytes of images referenced from Dart to. May be null, in
+    ///             which case images are not accounted.
+    ///
+    virtual std::shared_ptr<MemoryAccounting> GetMemoryAccounting() = 0;
   };
 
   //----------------------------------------------------------------------------
@@ -265,6 +275,23 @@ class Engine final : public RuntimeDelegate,
          fml::WeakPtr<IOManager> io_manager,
          std::unique_ptr<RuntimeController> runtime_controller);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Creates an instance of the engine with a supplied
+  ///             `RuntimeController` that uses the given font collection
+  ///             and decoded image cache, which may be shared with other
+  ///             engines.
+  ///
+  Engine(Delegate& delegate,
+         const PointerDataDispatcherMaker& dispatcher_maker,
+         std::shared_ptr<fml::ConcurrentTaskRunner> image_decoder_task_runner,
+         TaskRunners task_runners,
+         Settings settings,
+         std::unique_ptr<Animator> animator,
+         fml::WeakPtr<IOManager> io_manager,
+         std::shared_ptr<FontCollection> font_collection,
+         std::shared_ptr<DecodedImageCache> decoded_image_cache,
+         std::unique_ptr<RuntimeController> runtime_controller);
+
   //----------------------------------------------------------------------------
   /// @brief      Creates an instance of the engine. This is done by the Shell
   ///             on the UI task runner.
@@ -319,6 +346,46 @@ class Engine final : public RuntimeDelegate,
          fml::RefPtr<SkiaUnrefQueue> unref_queue,
          fml::WeakPtr<SnapshotDelegate> snapshot_delegate);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Creates an engine that shares the isolate group and the font
+  ///             collection of this one. This is done by the Shell on the UI
+  ///             task runner when spawning a shell from the shell of this
+  ///             engine.
+  ///
+  ///             The root isolate of the new engine is created in the isolate
+  ///             group of the root isolate of this engine, so it shares its
+  ///             heap and loaded program, and is much cheaper to create than
+  ///             the root isolate of a new engine. It must still be run with a
+  ///             run configuration. The new engine uses the fonts registered by
+  ///             this engine rather than registering those of its own assets.
+  ///
+  ///             This engine may be collected before the new one.
+  ///
+  /// @param      delegate           The delegate of the new engine. This is
+  ///                                the spawned shell.
+  /// @param      dispatcher_maker   The pointer data dispatcher maker of the
+  ///                                platform view of the new engine.
+  /// @param[in]  platform_data      The window data of the new engine.
+  /// @param[in]  settings           The settings of the new engine.
+  /// @param[in]  animator           The animator of the new engine.
+  /// @param[in]  io_manager         The IO manager used by the new engine,
+  ///                                which is usually shared with this one.
+  /// @param[in]  unref_queue        The Skia unref queue of the IO manager.
+  /// @param[in]  snapshot_delegate  The snapshot delegate of the rasterizer of
+  ///                                the new engine.
+  ///
+  /// @return     The new engine.
+  ///
+  std::unique_ptr<Engine> Spawn(
+      Delegate& delegate,
+      const PointerDataDispatcherMaker& dispatcher_maker,
+      const PlatformData& platform_data,
+      Settings settings,
+      std::unique_ptr<Animator> animator,
+      fml::WeakPtr<IOManager> io_manager,
+      fml::RefPtr<SkiaUnrefQueue> unref_queue,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate) const;
+
   //----------------------------------------------------------------------------
   /// @brief      Destroys the engine engine. Called by the shell on the UI task
   ///             runner. The running root isolate is terminated and will no
@@ -402,7 +469,11 @@ class Engine final : public RuntimeDelegate,
   //----------------------------------------------------------------------------
   /// @brief      Setup default font manager according to specific platform.
   ///
-  void SetupDefaultFontManager();
+  /// @param[in]  font_manager  The default font manager of the platform.
+  ///                           Creating it enumerates the system fonts, so
+  ///                           the shell does that off the UI thread.
+  ///
+  void SetupDefaultFontManager(sk_sp<SkFontMgr> font_manager);
 
   //----------------------------------------------------------------------------
   /// @brief      Updates the asset manager referenced by the root isolate of a
@@ -471,6 +542,12 @@ class Engine final : public RuntimeDelegate,
   // |HintFreedDelegate|
   void HintFreed(size_t size) override;
 
+  // |HintFreedDelegate|
+  void HintImageRetained(size_t size) override;
+
+  // |HintFreedDelegate|
+  void HintImageReleased(size_t size) override;
+
   //----------------------------------------------------------------------------
   /// @brief      Notifies the engine that the UI task runner is not expected to
   ///             undertake a new frame workload till a specified timepoint. The
@@ -757,6 +834,15 @@ class Engine final : public RuntimeDelegate,
   // |RuntimeDelegate|
   FontCollection& GetFontCollection() override;
 
+  //----------------------------------------------------------------------------
+  /// @brief      The cache of the images this engine decodes, which is shared
+  ///             with the engines spawned from it. It must be purged under
+  ///             memory pressure.
+  ///
+  const std::shared_ptr<DecodedImageCache>& GetDecodedImageCache() const {
+    return decoded_image_cache_;
+  }
+
   // |PointerDataDispatcher::Delegate|
   void DoDispatchPacket(std::unique_ptr<PointerDataPacket> packet,
                         uint64_t trace_flow_id) override;
@@ -800,9 +886,14 @@ class Engine final : public RuntimeDelegate,
   std::shared_ptr<AssetManager> asset_manager_;
   bool activity_running_;
   bool have_surface_;
-  FontCollection font_collection_;
+  std::shared_ptr<FontCollection> font_collection_;
+  // Whether the font collection is shared with the engine this one was spawned
+  // from, which registers the fonts of its assets.
+  bool is_spawned_ = false;
+  std::shared_ptr<DecodedImageCache> decoded_image_cache_;
   ImageDecoder image_decoder_;
   TaskRunners task_runners_;
+  std::shared_ptr<MemoryAccounting> memory_accounting_;
   size_t hint_freed_bytes_since_last_idle_ = 0;
   fml::WeakPtrFactory<Engine> weak_factory_;
 
@@ -32,6 +32,7 @@ class MockDelegate : public Engine::Delegate {
   MOCK_METHOD1(ComputePlatformResolvedLocale,
                std::unique_ptr<std::vector<std::string>>(
                    const std::vector<std::string>&));
+  MOCK_METHOD0(GetMemoryAccounting, std::shared_ptr<MemoryAccounting>());
 };
 
 class MockResponse : public PlatformMessageResponse {
@@ -4,6 +4,7 @@
 
 #include "flutter/shell/common/persistent_cache.h"
 
+#include <algorithm>
 #include <future>
 #include <memory>
 #include <string>
@@ -15,7 +16,9 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/thread_local.h"
 #include "flutter/fml/trace_event.h"
+#include "flutter/shell/common/persistent_shaping_cache.h"
 #include "flutter/shell/version/version.h"
 #include "rapidjson/document.h"
 #include "third_party/skia/include/utils/SkBase64.h"
@@ -85,15 +88,21 @@ bool PersistentCache::Purge() {
   FML_CHECK(GetWorkerTaskRunner());
 
   std::promise<bool> removed;
-  GetWorkerTaskRunner()->PostTask(
-      [&removed, cache_directory = cache_directory_]() {
-        if (cache_directory->is_valid()) {
-          FML_LOG(INFO) << "Purge persistent cache.";
-          removed.set_value(RemoveFilesInDirectory(*cache_directory));
-        } else {
-          removed.set_value(false);
-        }
-      });
+  GetWorkerTaskRunner()->PostTask([&removed, cache_directory = cache_directory_,
+                                   cache_archive = cache_archive_,
+                                   sksl_cache_archive = sksl_cache_archive_,
+                                   shaping_cache_archive =
+                                       shaping_cache_archive_]() {
+    if (cache_directory->is_valid()) {
+      FML_LOG(INFO) << "Purge persistent cache.";
+      removed.set_value(RemoveFilesInDirectory(*cache_directory));
+      cache_archive->Clear();
+      sksl_cache_archive->Clear();
+      shaping_cache_archive->Clear();
+    } else {
+      removed.set_value(false);
+    }
+  });
   return removed.get_future().get();
 }
 
@@ -123,7 +132,7 @@ static void FreeOldCacheDirectory(const fml::UniqueFD& cache_base_dir) {
 static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     const std::string& global_cache_base_path,
     bool read_only,
-    bool cache_sksl) {
+    const char* subdir_name = nullptr) {
   fml::UniqueFD cache_base_dir;
   if (global_cache_base_path.length()) {
     cache_base_dir = fml::OpenDirectory(global_cache_base_path.c_str(), false,
@@ -136,8 +145,8 @@ static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
     FreeOldCacheDirectory(cache_base_dir);
     std::vector<std::string> components = {
         kEngineComponent, GetFlutterEngineVersion(), "skia", GetSkiaVersion()};
-    if (cache_sksl) {
-      components.push_back(PersistentCache::kSkSLSubdirName);
+    if (subdir_name) {
+      components.push_back(subdir_name);
     }
     return std::make_shared<fml::UniqueFD>(
         CreateDirectory(cache_base_dir, components,
@@ -171,14 +180,40 @@ sk_sp<SkData> ParseBase64(const std::string& input) {
 }
 
 std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
+  std::vector<SkSLEntry> entries = LoadSkSLEntries();
+  std::vector<SkSLCache> result;
+  result.reserve(entries.size());
+  for (auto& entry : entries) {
+    result.push_back(std::move(entry.shader));
+  }
+  return result;
+}
+
+std::vector<PersistentCache::SkSLEntry> PersistentCache::LoadSkSLEntries() {
   TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
-  std::vector<PersistentCache::SkSLCache> result;
-  fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
-                                       const std::string& filename) {
+  std::vector<SkSLEntry> result;
+  for (auto& shader : sksl_cache_archive_->LoadAll()) {
+    const uint32_t first_use_frame =
+        sksl_cache_archive_->GetFirstUseFrame(*shader.first);
+    result.push_back({std::move(shader), first_use_frame});
+  }
+  fml::FileVisitor visitor = [this, &result](const fml::UniqueFD& directory,
+                                             const std::string& filename) {
+    // Entries that were stored as one file per key after the archive was
+    // opened are still picked up, but not the archive itself.
+    if (filename.rfind(ShaderCacheArchive::kFileName, 0) == 0) {
+      return true;
+    }
     sk_sp<SkData> key = ParseBase32(filename);
+    // Read-only archives import these files without removing them, and
+    // already returned them above.
+    if (key != nullptr && sksl_cache_archive_->Load(*key) != nullptr) {
+      return true;
+    }
     sk_sp<SkData> data = LoadFile(directory, filename);
     if (key != nullptr && data != nullptr) {
-      result.push_back({key, data});
+      result.push_back(
+          {{key, data}, ShaderCacheArchive::kUnknownFirstUseFrame});
     } else {
       FML_LOG(ERROR) << "Failed to load: " << filename;
     }
@@ -213,11 +248,25 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
     if (parse_result != rapidjson::ParseErrorCode::kParseErrorNone) {
       FML_LOG(ERROR) << "Failed to parse json file: " << kAssetFileName;
     } else {
+      // The frames are optional and keyed like the data.
+      const rapidjson::Value* first_use_frames = nullptr;
+      auto frames = json_doc.FindMember("firstUseFrames");
+      if (frames != json_doc.MemberEnd() && frames->value.IsObject()) {
+        first_use_frames = &frames->value;
+      }
       for (auto& item : json_doc["data"].GetObject()) {
         sk_sp<SkData> key = ParseBase32(item.name.GetString());
         sk_sp<SkData> sksl = ParseBase64(item.value.GetString());
+        uint32_t first_use_frame = ShaderCacheArchive::kUnknownFirstUseFrame;
+        if (first_use_frames != nullptr) {
+          auto frame = first_use_frames->FindMember(item.name);
+          if (frame != first_use_frames->MemberEnd() &&
+              frame->value.IsUint()) {
+            first_use_frame = frame->value.GetUint();
+          }
+        }
         if (key != nullptr && sksl != nullptr) {
-          result.push_back({key, sksl});
+          result.push_back({{key, sksl}, first_use_frame});
         } else {
           FML_LOG(ERROR) << "Failed to load: " << item.name.GetString();
         }
@@ -225,14 +274,28 @@ std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
     }
   }
 
+  std::stable_sort(result.begin(), result.end(),
+                   [](const SkSLEntry& a, const SkSLEntry& b) {
+                     return a.first_use_frame < b.first_use_frame;
+                   });
   return result;
 }
 
 PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
-      cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
+      cache_directory_(MakeCacheDirectory(cache_base_path_, read_only)),
       sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+          MakeCacheDirectory(cache_base_path_, read_only, kSkSLSubdirName)),
+      shaping_cache_directory_(
+          MakeCacheDirectory(cache_base_path_, read_only, kShapingSubdirName)),
+      cache_archive_(
+          std::make_shared<ShaderCacheArchive>(cache_directory_, read_only)),
+      sksl_cache_archive_(
+          std::make_shared<ShaderCacheArchive>(sksl_cache_directory_,
+                                               read_only)),
+      shaping_cache_archive_(
+          std::make_shared<ShaderCacheArchive>(shaping_cache_directory_,
+                                               read_only)) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
@@ -264,17 +327,26 @@ sk_sp<SkData> PersistentCache::load(const SkData& key) {
   if (!IsValid()) {
     return nullptr;
   }
-  auto file_name = SkKeyToFilePath(key);
-  if (file_name.size() == 0) {
-    return nullptr;
-  }
-  auto result = PersistentCache::LoadFile(*cache_directory_, file_name);
+  auto result = cache_archive_->Load(key);
   if (result != nullptr) {
     TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
   }
   return result;
 }
 
+static void PersistentCacheRunOnWorker(fml::RefPtr<fml::TaskRunner> worker,
+                                       fml::closure task) {
+  if (!worker) {
+    FML_LOG(WARNING)
+        << "The persistent cache has no available workers. Performing the task "
+           "on the current thread. This slow operation is going to occur on a "
+           "frame workload.";
+    task();
+  } else {
+    worker->PostTask(std::move(task));
+  }
+}
+
 static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
                                  std::shared_ptr<fml::UniqueFD> cache_directory,
                                  std::string key,
@@ -293,18 +365,53 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
               << "Could not write cache contents to persistent store.";
         }
       });
+  PersistentCacheRunOnWorker(std::move(worker), std::move(task));
+}
 
-  if (!worker) {
-    FML_LOG(WARNING)
-        << "The persistent cache has no available workers. Performing the task "
-           "on the current thread. This slow operation is going to occur on a "
-           "frame workload.";
-    task();
+static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
+                                 std::shared_ptr<ShaderCacheArchive> archive,
+                                 sk_sp<SkData> key,
+                                 sk_sp<SkData> value,
+                                 uint32_t first_use_frame) {
+  auto task = [archive, key, value, first_use_frame]() {
+    TRACE_EVENT0("flutter", "PersistentCacheStore");
+    if (!archive->Store(*key, *value, first_use_frame)) {
+      FML_DLOG(WARNING)
+          << "Could not write cache contents to persistent store.";
+      return;
+    }
+    if (archive->NeedsCompaction()) {
+      archive->Compact();
+    }
+  };
+  PersistentCacheRunOnWorker(std::move(worker), std::move(task));
+}
+
+// The index of the frame drawn on the current thread, if there is one.
+FML_THREAD_LOCAL fml::ThreadLocalUniquePtr<uint32_t> tls_frame_index;
+
+static uint32_t GetFrameIndexForCurrentThread() {
+  uint32_t* frame_index = tls_frame_index.get();
+  return frame_index ? *frame_index : ShaderCacheArchive::kUnknownFirstUseFrame;
+}
+
+static void SetFrameIndexForCurrentThread(uint32_t frame_index) {
+  if (!tls_frame_index.get()) {
+    tls_frame_index.reset(new uint32_t(frame_index));
   } else {
-    worker->PostTask(std::move(task));
+    *tls_frame_index.get() = frame_index;
   }
 }
 
+PersistentCache::ScopedFrame::ScopedFrame(uint32_t frame_index)
+    : previous_frame_index_(GetFrameIndexForCurrentThread()) {
+  SetFrameIndexForCurrentThread(frame_index);
+}
+
+PersistentCache::ScopedFrame::~ScopedFrame() {
+  SetFrameIndexForCurrentThread(previous_frame_index_);
+}
+
 // |GrContextOptions::PersistentCache|
 void PersistentCache::store(const SkData& key, const SkData& data) {
   stored_new_shaders_ = true;
@@ -317,22 +424,15 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
-  auto file_name = SkKeyToFilePath(key);
-
-  if (file_name.size() == 0) {
-    return;
-  }
-
-  auto mapping = std::make_unique<fml::DataMapping>(
-      std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
-
-  if (mapping == nullptr || mapping->GetSize() == 0) {
+  if (key.size() == 0 || data.size() == 0) {
     return;
   }
 
   PersistentCacheStore(GetWorkerTaskRunner(),
-                       cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
-                       std::move(file_name), std::move(mapping));
+                       cache_sksl_ ? sksl_cache_archive_ : cache_archive_,
+                       SkData::MakeWithCopy(key.data(), key.size()),
+                       SkData::MakeWithCopy(data.data(), data.size()),
+                       GetFrameIndexForCurrentThread());
 }
 
 void PersistentCache::DumpSkp(const SkData& data) {
@@ -355,8 +455,21 @@ void PersistentCache::DumpSkp(const SkData& data) {
 
 void PersistentCache::AddWorkerTaskRunner(
     fml::RefPtr<fml::TaskRunner> task_runner) {
-  std::scoped_lock lock(worker_task_runners_mutex_);
-  worker_task_runners_.insert(task_runner);
+  {
+    std::scoped_lock lock(worker_task_runners_mutex_);
+    worker_task_runners_.insert(task_runner);
+    if (shaping_cache_) {
+      shaping_cache_->SetWorkerTaskRunner(*worker_task_runners_.begin());
+    }
+  }
+
+  // Reclaim the space of superseded entries left over from earlier runs.
+  for (const auto& archive :
+       {cache_archive_, sksl_cache_archive_, shaping_cache_archive_}) {
+    if (archive->NeedsCompaction()) {
+      task_runner->PostTask([archive]() { archive->Compact(); });
+    }
+  }
 }
 
 void PersistentCache::RemoveWorkerTaskRunner(
@@ -366,6 +479,21 @@ void PersistentCache::RemoveWorkerTaskRunner(
   if (found != worker_task_runners_.end()) {
     worker_task_runners_.erase(found);
   }
+  if (shaping_cache_) {
+    shaping_cache_->SetWorkerTaskRunner(
+        worker_task_runners_.empty() ? nullptr : *worker_task_runners_.begin());
+  }
+}
+
+std::shared_ptr<PersistentShapingCache> PersistentCache::GetShapingCache() {
+  std::scoped_lock lock(worker_task_runners_mutex_);
+  if (!shaping_cache_) {
+    shaping_cache_ = std::make_shared<PersistentShapingCache>(
+        shaping_cache_archive_, worker_task_runners_.empty()
+                                    ? nullptr
+                                    : *worker_task_runners_.begin());
+  }
+  return shaping_cache_;
 }
 
 fml::RefPtr<fml::TaskRunner> PersistentCache::GetWorkerTaskRunner() const {
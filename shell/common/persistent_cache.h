@@ -5,6 +5,7 @@
 #ifndef FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_H_
 #define FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_H_
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -13,14 +14,18 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/shell/common/shader_cache_archive.h"
 #include "third_party/skia/include/gpu/GrContextOptions.h"
 
 namespace flutter {
 
+class PersistentShapingCache;
+
 /// A cache of SkData that gets stored to disk.
 ///
 /// This is mainly used for Shaders but is also written to by Dart.  It is
-/// thread-safe for reading and writing from multiple threads.
+/// thread-safe for reading and writing from multiple threads. Entries are
+/// kept in a |ShaderCacheArchive| per cache directory.
 class PersistentCache : public GrContextOptions::PersistentCache {
  public:
   // Mutable static switch that can be set before GetCacheForProcess. If true,
@@ -54,6 +59,25 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // frame so we can know if Skia tries to compile new shaders in that frame.
   bool StoredNewShaders() const { return stored_new_shaders_; }
   void ResetStoredNewShaders() { stored_new_shaders_ = false; }
+
+  // Marks the frame a rasterizer draws on the current thread while it is in
+  // scope. Shaders that Skia stores on that thread meanwhile record the
+  // frame's index as their first use so that later runs can precompile them
+  // before that frame. Each rasterizer counts its own frames, since the
+  // shells of a process draw theirs independently. Shaders stored outside of
+  // a frame record |ShaderCacheArchive::kUnknownFirstUseFrame|.
+  class ScopedFrame {
+   public:
+    explicit ScopedFrame(uint32_t frame_index);
+
+    ~ScopedFrame();
+
+   private:
+    const uint32_t previous_frame_index_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
+  };
+
   void DumpSkp(const SkData& data);
   bool IsDumpingSkp() const { return is_dumping_skp_; }
   void SetIsDumpingSkp(bool value) { is_dumping_skp_ = value; }
@@ -62,14 +86,43 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // Return whether the purge is successful.
   bool Purge();
 
+  // The archives holding the entries of the cache directory and of its SkSL
+  // subdirectory.
+  ShaderCacheArchive* GetArchive() const { return cache_archive_.get(); }
+  ShaderCacheArchive* GetSkSLArchive() const {
+    return sksl_cache_archive_.get();
+  }
+
+  // The archive of the shaping subdirectory, which holds the layouts of words
+  // kept by |PersistentShapingCache|.
+  const std::shared_ptr<ShaderCacheArchive>& GetShapingArchive() const {
+    return shaping_cache_archive_;
+  }
+
+  // The shaping cache backed by the shaping archive, created on first use. It
+  // stores on the workers of this cache, so it keeps working as shells come
+  // and go.
+  std::shared_ptr<PersistentShapingCache> GetShapingCache();
+
   // |GrContextOptions::PersistentCache|
   sk_sp<SkData> load(const SkData& key) override;
 
   using SkSLCache = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
 
+  struct SkSLEntry {
+    SkSLCache shader;
+    // |ShaderCacheArchive::kUnknownFirstUseFrame| if it wasn't recorded.
+    uint32_t first_use_frame;
+  };
+
   /// Load all the SkSL shader caches in the right directory.
   std::vector<SkSLCache> LoadSkSLs();
 
+  /// Load all the SkSL shader caches along with the frame each was first used
+  /// in, ordered by that frame. Shaders without a recorded frame come last,
+  /// in the order they were found.
+  std::vector<SkSLEntry> LoadSkSLEntries();
+
   /// Set the asset manager from which PersistentCache can load SkLSs. A nullptr
   /// can be provided to clear the asset manager.
   static void SetAssetManager(std::shared_ptr<AssetManager> value);
@@ -79,6 +132,7 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   static void MarkStrategySet() { strategy_set_ = true; }
 
   static constexpr char kSkSLSubdirName[] = "sksl";
+  static constexpr char kShapingSubdirName[] = "shaping";
   static constexpr char kAssetFileName[] = "io.flutter.shaders.json";
 
  private:
@@ -102,8 +156,14 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
   const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  const std::shared_ptr<fml::UniqueFD> shaping_cache_directory_;
+  const std::shared_ptr<ShaderCacheArchive> cache_archive_;
+  const std::shared_ptr<ShaderCacheArchive> sksl_cache_archive_;
+  const std::shared_ptr<ShaderCacheArchive> shaping_cache_archive_;
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
+  // Guarded by |worker_task_runners_mutex_|.
+  std::shared_ptr<PersistentShapingCache> shaping_cache_;
 
   bool stored_new_shaders_ = false;
   bool is_dumping_skp_ = false;
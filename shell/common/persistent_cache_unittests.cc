@@ -14,12 +14,17 @@
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/log_settings.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/shell/common/persistent_shaping_cache.h"
 #include "flutter/shell/common/shell_test.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/version/version.h"
 #include "flutter/testing/testing.h"
 #include "include/core/SkPicture.h"
+#include "minikin/FontFamily.h"
+#include "minikin/Layout.h"
 
 namespace flutter {
 namespace testing {
@@ -211,6 +216,199 @@ TEST_F(ShellTest, CanLoadSkSLsFromAsset) {
   fml::UnlinkFile(asset_dir.fd(), PersistentCache::kAssetFileName);
 }
 
+TEST_F(ShellTest, PersistentCacheKeepsEntriesInArchive) {
+  // Avoid polluting unit tests output with the warning about storing on the
+  // current thread since there are no workers.
+  fml::LogSettings error_only = {fml::LOG_ERROR};
+  fml::ScopedSetLogSettings scoped_set_log_settings(error_only);
+
+  fml::ScopedTemporaryDirectory base_dir;
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  const std::string key_string = "key";
+  const std::string value_string = "value";
+  auto key = SkData::MakeWithCopy(key_string.data(), key_string.size());
+  auto value = SkData::MakeWithCopy(value_string.data(), value_string.size());
+  GrContextOptions::PersistentCache* cache =
+      PersistentCache::GetCacheForProcess();
+  cache->store(*key, *value);
+  CheckTextSkData(cache->load(*key), value_string);
+
+  // The entry is found again by a new cache for the same directory.
+  PersistentCache::ResetCacheForProcess();
+  cache = PersistentCache::GetCacheForProcess();
+  CheckTextSkData(cache->load(*key), value_string);
+  ASSERT_EQ(
+      PersistentCache::GetCacheForProcess()->GetArchive()->GetEntryCount(),
+      1u);
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(ShellTest, StoredShadersRecordTheFrameDrawnOnTheirThread) {
+  // Avoid polluting unit tests output with the warning about storing on the
+  // current thread since there are no workers.
+  fml::LogSettings error_only = {fml::LOG_ERROR};
+  fml::ScopedSetLogSettings scoped_set_log_settings(error_only);
+
+  fml::ScopedTemporaryDirectory base_dir;
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+  GrContextOptions::PersistentCache* cache =
+      PersistentCache::GetCacheForProcess();
+  ShaderCacheArchive* archive =
+      PersistentCache::GetCacheForProcess()->GetArchive();
+  auto make_data = [](const std::string& string) {
+    return SkData::MakeWithCopy(string.data(), string.size());
+  };
+
+  cache->store(*make_data("outside"), *make_data("v"));
+  {
+    PersistentCache::ScopedFrame frame(3);
+    cache->store(*make_data("frame"), *make_data("v"));
+    {
+      PersistentCache::ScopedFrame other_frame(7);
+      cache->store(*make_data("other frame"), *make_data("v"));
+    }
+    cache->store(*make_data("frame again"), *make_data("v"));
+
+    // Another shell's thread isn't drawing this frame.
+    fml::Thread other_thread("other raster");
+    fml::AutoResetWaitableEvent latch;
+    other_thread.GetTaskRunner()->PostTask([&]() {
+      cache->store(*make_data("other thread"), *make_data("v"));
+      latch.Signal();
+    });
+    latch.Wait();
+  }
+
+  EXPECT_EQ(archive->GetFirstUseFrame(*make_data("outside")),
+            ShaderCacheArchive::kUnknownFirstUseFrame);
+  EXPECT_EQ(archive->GetFirstUseFrame(*make_data("frame")), 3u);
+  EXPECT_EQ(archive->GetFirstUseFrame(*make_data("other frame")), 7u);
+  EXPECT_EQ(archive->GetFirstUseFrame(*make_data("frame again")), 3u);
+  EXPECT_EQ(archive->GetFirstUseFrame(*make_data("other thread")),
+            ShaderCacheArchive::kUnknownFirstUseFrame);
+
+  // Cleanup
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(ShellTest, LoadsSkSLsInFirstUseOrder) {
+  fml::LogSettings warning_only = {fml::LOG_WARNING};
+  fml::ScopedSetLogSettings scoped_set_log_settings(warning_only);
+
+  fml::ScopedTemporaryDirectory base_dir;
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+  ShaderCacheArchive* archive =
+      PersistentCache::GetCacheForProcess()->GetSkSLArchive();
+  auto make_data = [](const std::string& string) {
+    return SkData::MakeWithCopy(string.data(), string.size());
+  };
+  ASSERT_TRUE(archive->Store(*make_data("D"), *make_data("w")));
+  ASSERT_TRUE(archive->Store(*make_data("C"), *make_data("z"), 5));
+
+  // "IE" and "II" are the Base32 encodings of "A" and "B". Only "B" has a
+  // first use frame.
+  const std::string kTestJson =
+      "{\n"
+      "  \"data\": {\n"
+      "    \"IE\": \"eA==\",\n"
+      "    \"II\": \"eQ==\"\n"
+      "  },\n"
+      "  \"firstUseFrames\": {\n"
+      "    \"II\": 2\n"
+      "  }\n"
+      "}\n";
+  fml::ScopedTemporaryDirectory asset_dir;
+  ASSERT_TRUE(fml::WriteAtomically(
+      asset_dir.fd(), PersistentCache::kAssetFileName,
+      fml::DataMapping(std::vector<uint8_t>{kTestJson.begin(),
+                                            kTestJson.end()})));
+  auto asset_manager = std::make_shared<AssetManager>();
+  asset_manager->PushBack(
+      std::make_unique<DirectoryAssetBundle>(fml::OpenDirectory(
+          asset_dir.path().c_str(), false, fml::FilePermission::kRead)));
+  PersistentCache::SetAssetManager(asset_manager);
+
+  auto entries = PersistentCache::GetCacheForProcess()->LoadSkSLEntries();
+  ASSERT_EQ(entries.size(), 4u);
+  CheckTextSkData(entries[0].shader.first, "B");
+  EXPECT_EQ(entries[0].first_use_frame, 2u);
+  CheckTextSkData(entries[1].shader.first, "C");
+  EXPECT_EQ(entries[1].first_use_frame, 5u);
+  // Shaders without a frame keep the order they were found in.
+  CheckTextSkData(entries[2].shader.first, "D");
+  CheckTextSkData(entries[3].shader.first, "A");
+  EXPECT_EQ(entries[3].first_use_frame,
+            ShaderCacheArchive::kUnknownFirstUseFrame);
+
+  // Cleanup.
+  PersistentCache::SetAssetManager(nullptr);
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(ShellTest, ReadOnlyCacheLoadsLegacySkSLsOnce) {
+  fml::ScopedTemporaryDirectory base_dir;
+  auto sksl_dir = fml::CreateDirectory(
+      base_dir.fd(),
+      {"flutter_engine", GetFlutterEngineVersion(), "skia", GetSkiaVersion(),
+       PersistentCache::kSkSLSubdirName},
+      fml::FilePermission::kReadWrite);
+  // "IE" is the Base32 encoding of "A".
+  ASSERT_TRUE(fml::WriteAtomically(sksl_dir, "IE",
+                                   fml::DataMapping(std::string("x"))));
+
+  PersistentCache::gIsReadOnly = true;
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  // The archive imports the file without removing it, and the file is not
+  // loaded a second time from the directory.
+  auto entries = PersistentCache::GetCacheForProcess()->LoadSkSLEntries();
+  ASSERT_EQ(entries.size(), 1u);
+  CheckTextSkData(entries[0].shader.first, "A");
+  CheckTextSkData(entries[0].shader.second, "x");
+  EXPECT_TRUE(fml::FileExists(sksl_dir, "IE"));
+
+  // Cleanup.
+  PersistentCache::gIsReadOnly = false;
+  PersistentCache::ResetCacheForProcess();
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
+TEST_F(ShellTest, ShapingCacheKeepsStoringAfterShellIsDestroyed) {
+  fml::ScopedTemporaryDirectory base_dir;
+  PersistentCache::SetCacheDirectoryPath(base_dir.path());
+  PersistentCache::ResetCacheForProcess();
+
+  auto settings = CreateSettingsForFixture();
+  settings.persistent_shaping_cache = true;
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  std::shared_ptr<PersistentShapingCache> shaping_cache =
+      PersistentCache::GetCacheForProcess()->GetShapingCache();
+  DestroyShell(std::move(shell));
+
+  // Layouts shaped while no shell is around are stored by the next one.
+  shaping_cache->store("key", "layout");
+  shell = CreateShell(settings);
+  ASSERT_EQ(PersistentCache::GetCacheForProcess()->GetShapingCache(),
+            shaping_cache);
+  WaitForIO(shell.get());
+  const auto& archive =
+      PersistentCache::GetCacheForProcess()->GetShapingArchive();
+  EXPECT_EQ(archive->GetEntryCount(), 1u);
+  DestroyShell(std::move(shell));
+
+  // Cleanup.
+  minikin::Layout::setPersistentStore(nullptr);
+  minikin::FontFamily::setPersistentStore(nullptr);
+  fml::RemoveFilesInDirectory(base_dir.fd());
+}
+
 TEST_F(ShellTest, CanRemoveOldPersistentCache) {
   fml::ScopedTemporaryDirectory base_dir;
   ASSERT_TRUE(base_dir.fd().is_valid());
@@ -0,0 +1,153 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/persistent_shaping_cache.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+PersistentShapingCache::PersistentShapingCache(
+    std::shared_ptr<ShaderCacheArchive> archive,
+    fml::RefPtr<fml::TaskRunner> worker_task_runner,
+    size_t max_bytes)
+    : archive_(std::move(archive)),
+      max_bytes_(max_bytes),
+      worker_task_runner_(std::move(worker_task_runner)) {
+  FML_DCHECK(archive_);
+  // Only forgets the entries. The file is truncated by the next store.
+  if (archive_->GetFileSize() > max_bytes_) {
+    archive_->Clear();
+  }
+}
+
+PersistentShapingCache::~PersistentShapingCache() = default;
+
+void PersistentShapingCache::SetWorkerTaskRunner(
+    fml::RefPtr<fml::TaskRunner> worker_task_runner) {
+  std::scoped_lock lock(pending_mutex_);
+  if (worker_task_runner_ == worker_task_runner) {
+    return;
+  }
+  worker_task_runner_ = std::move(worker_task_runner);
+  if (!pending_.empty() || eviction_pending_) {
+    ScheduleStoreLocked();
+  }
+}
+
+// |minikin::PersistentStore|
+bool PersistentShapingCache::load(const std::string& key, std::string* value) {
+  if (!archive_->IsValid()) {
+    return false;
+  }
+  sk_sp<SkData> data =
+      archive_->Load(*SkData::MakeWithoutCopy(key.data(), key.size()));
+  if (data == nullptr) {
+    return false;
+  }
+  value->assign(static_cast<const char*>(data->data()), data->size());
+  std::scoped_lock lock(used_keys_mutex_);
+  used_keys_.insert(key);
+  return true;
+}
+
+// |minikin::PersistentStore|
+void PersistentShapingCache::store(std::string key, std::string value) {
+  if (full_ || !archive_->IsValid()) {
+    return;
+  }
+
+  std::scoped_lock lock(pending_mutex_);
+  const size_t bytes =
+      ShaderCacheArchive::GetRecordSize(key.size(), value.size());
+  // The archive file is only created by the first store.
+  const size_t file_size = std::max(archive_->GetFileSize(),
+                                    ShaderCacheArchive::GetEmptyFileSize());
+  if (file_size + pending_bytes_ + bytes > max_bytes_) {
+    full_ = true;
+    if (!evicted_) {
+      evicted_ = true;
+      eviction_pending_ = true;
+      if (pending_.empty()) {
+        ScheduleStoreLocked();
+      }
+    }
+    return;
+  }
+  {
+    std::scoped_lock used_keys_lock(used_keys_mutex_);
+    used_keys_.insert(key);
+  }
+  pending_.emplace_back(std::move(key), std::move(value));
+  pending_bytes_ += bytes;
+  // The task posted for the first pending layout stores the others too.
+  if (pending_.size() == 1 && !eviction_pending_) {
+    ScheduleStoreLocked();
+  }
+}
+
+void PersistentShapingCache::ScheduleStoreLocked() {
+  if (!worker_task_runner_) {
+    return;
+  }
+  worker_task_runner_->PostTask(
+      [weak_cache =
+           std::weak_ptr<PersistentShapingCache>(shared_from_this())]() {
+        if (auto cache = weak_cache.lock()) {
+          cache->StorePending();
+        }
+      });
+}
+
+void PersistentShapingCache::StorePending() {
+  TRACE_EVENT0("flutter", "PersistentShapingCache::StorePending");
+  std::vector<std::pair<std::string, std::string>> pending;
+  bool evict;
+  {
+    std::scoped_lock lock(pending_mutex_);
+    pending.swap(pending_);
+    evict = eviction_pending_;
+    eviction_pending_ = false;
+  }
+  if (evict) {
+    TRACE_EVENT0("flutter", "PersistentShapingCache::Evict");
+    std::unordered_set<std::string> used_keys;
+    {
+      std::scoped_lock lock(used_keys_mutex_);
+      used_keys = used_keys_;
+    }
+    if (archive_->Compact([&used_keys](const std::string& key) {
+          return used_keys.find(key) != used_keys.end();
+        })) {
+      // Stores check the budget against the compacted archive.
+      full_ = false;
+    }
+  }
+  for (const auto& entry : pending) {
+    if (!archive_->Store(
+            *SkData::MakeWithoutCopy(entry.first.data(), entry.first.size()),
+            *SkData::MakeWithoutCopy(entry.second.data(),
+                                     entry.second.size()))) {
+      FML_DLOG(WARNING) << "Could not write shaped text to persistent store.";
+      break;
+    }
+  }
+  {
+    // The archive file has grown by the bytes that were pending.
+    std::scoped_lock lock(pending_mutex_);
+    pending_bytes_ = 0;
+    for (const auto& entry : pending_) {
+      pending_bytes_ += ShaderCacheArchive::GetRecordSize(entry.first.size(),
+                                                          entry.second.size());
+    }
+  }
+  if (archive_->NeedsCompaction()) {
+    archive_->Compact();
+  }
+}
+
+}  // namespace flutter
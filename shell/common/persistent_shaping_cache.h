@@ -0,0 +1,98 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PERSISTENT_SHAPING_CACHE_H_
+#define FLUTTER_SHELL_COMMON_PERSISTENT_SHAPING_CACHE_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/shell/common/shader_cache_archive.h"
+#include "minikin/PersistentStore.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Keeps the layouts of words shaped by libtxt and the coverage of fonts in
+/// the shaping archive of the |PersistentCache|, so that the text laid out by
+/// the first frames of a run isn't shaped again in the next runs, and the
+/// character maps of its fonts aren't parsed again.
+///
+/// Entries are looked up in the mapped archive on the threads that lay out
+/// text. Entries to store are collected and appended to the archive in
+/// batches on the worker task runner, which can be replaced since the cache is
+/// shared by all the shells of the process and outlives their threads. Without
+/// a worker, entries are kept until one is set.
+///
+/// The archive doesn't grow past |max_bytes|. The first time in a run that an
+/// entry doesn't fit, the entries that were neither loaded nor stored during
+/// the run are dropped from the archive, so that words and fonts that are no
+/// longer used don't hold the budget for good. Should the archive still be
+/// full, nothing more is stored until the next run. An archive that is past
+/// |max_bytes| when the cache is created, as after the budget was lowered, is
+/// cleared.
+///
+class PersistentShapingCache
+    : public minikin::PersistentStore,
+      public std::enable_shared_from_this<PersistentShapingCache> {
+ public:
+  static constexpr size_t kDefaultMaxBytes = 1024 * 1024;
+
+  PersistentShapingCache(std::shared_ptr<ShaderCacheArchive> archive,
+                         fml::RefPtr<fml::TaskRunner> worker_task_runner,
+                         size_t max_bytes = kDefaultMaxBytes);
+
+  ~PersistentShapingCache() override;
+
+  // Stores the pending entries on |worker_task_runner| from now on, in case a
+  // batch was posted to a worker that went away before running it.
+  void SetWorkerTaskRunner(fml::RefPtr<fml::TaskRunner> worker_task_runner);
+
+  // |minikin::PersistentStore|
+  bool load(const std::string& key, std::string* value) override;
+
+  // |minikin::PersistentStore|
+  void store(std::string key, std::string value) override;
+
+ private:
+  const std::shared_ptr<ShaderCacheArchive> archive_;
+  const size_t max_bytes_;
+
+  // Set once storing another layout would grow the archive past |max_bytes_|.
+  std::atomic<bool> full_ = false;
+
+  std::mutex pending_mutex_;
+  fml::RefPtr<fml::TaskRunner> worker_task_runner_;
+  std::vector<std::pair<std::string, std::string>> pending_;
+  size_t pending_bytes_ = 0;
+  // Whether the unused entries are to be dropped by the next |StorePending|,
+  // and whether they were already dropped during this run.
+  bool eviction_pending_ = false;
+  bool evicted_ = false;
+
+  // The keys loaded or stored during this run.
+  std::mutex used_keys_mutex_;
+  std::unordered_set<std::string> used_keys_;
+
+  // Posts a task that stores the pending layouts, if there is a worker. Must
+  // be called with |pending_mutex_| held.
+  void ScheduleStoreLocked();
+
+  // Drops the unused entries from the archive if that was asked for, then
+  // appends the pending layouts to it. Runs on the worker.
+  void StorePending();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PersistentShapingCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PERSISTENT_SHAPING_CACHE_H_
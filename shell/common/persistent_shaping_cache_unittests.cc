@@ -0,0 +1,181 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/persistent_shaping_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+std::shared_ptr<ShaderCacheArchive> OpenArchive(
+    const fml::ScopedTemporaryDirectory& dir) {
+  return std::make_shared<ShaderCacheArchive>(
+      std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+          dir.path().c_str(), false, fml::FilePermission::kReadWrite)),
+      false);
+}
+
+// Waits for the tasks posted to |task_runner| so far.
+void Flush(const fml::RefPtr<fml::TaskRunner>& task_runner) {
+  fml::AutoResetWaitableEvent latch;
+  task_runner->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+}
+
+}  // namespace
+
+TEST(PersistentShapingCache, StoredLayoutsAreLoadedInLaterRuns) {
+  fml::ScopedTemporaryDirectory dir;
+  fml::Thread worker("io");
+  {
+    auto cache = std::make_shared<PersistentShapingCache>(
+        OpenArchive(dir), worker.GetTaskRunner());
+    std::string value;
+    EXPECT_FALSE(cache->load("hello", &value));
+    cache->store("hello", "layout of hello");
+    cache->store("world", "layout of world");
+    Flush(worker.GetTaskRunner());
+    EXPECT_TRUE(cache->load("hello", &value));
+    EXPECT_EQ(value, "layout of hello");
+  }
+
+  auto cache = std::make_shared<PersistentShapingCache>(
+      OpenArchive(dir), worker.GetTaskRunner());
+  std::string value;
+  EXPECT_TRUE(cache->load("world", &value));
+  EXPECT_EQ(value, "layout of world");
+}
+
+TEST(PersistentShapingCache, StopsStoringPastTheByteBudget) {
+  fml::ScopedTemporaryDirectory dir;
+  fml::Thread worker("io");
+  auto archive = OpenArchive(dir);
+  auto cache = std::make_shared<PersistentShapingCache>(
+      archive, worker.GetTaskRunner(), 256);
+  cache->store("small", "fits");
+  cache->store("large", std::string(512, 'x'));
+  // Layouts that would fit are not stored either once the budget is spent.
+  cache->store("later", "fits");
+  Flush(worker.GetTaskRunner());
+
+  std::string value;
+  EXPECT_TRUE(cache->load("small", &value));
+  EXPECT_FALSE(cache->load("large", &value));
+  EXPECT_FALSE(cache->load("later", &value));
+  EXPECT_LE(archive->GetFileSize(), 256u);
+}
+
+TEST(PersistentShapingCache, ByteBudgetCountsTheArchiveFormat) {
+  fml::ScopedTemporaryDirectory dir;
+  fml::Thread worker("io");
+  auto archive = OpenArchive(dir);
+  const size_t max_bytes = ShaderCacheArchive::GetEmptyFileSize() +
+                           ShaderCacheArchive::GetRecordSize(1, 10);
+  auto cache = std::make_shared<PersistentShapingCache>(
+      archive, worker.GetTaskRunner(), max_bytes);
+  cache->store("a", std::string(10, 'x'));
+  // Only a byte of key and value, but the record header doesn't fit.
+  cache->store("b", "");
+  Flush(worker.GetTaskRunner());
+
+  std::string value;
+  EXPECT_TRUE(cache->load("a", &value));
+  EXPECT_FALSE(cache->load("b", &value));
+  EXPECT_EQ(archive->GetFileSize(), max_bytes);
+}
+
+TEST(PersistentShapingCache, ArchivesPastTheByteBudgetAreCleared) {
+  fml::ScopedTemporaryDirectory dir;
+  fml::Thread worker("io");
+  {
+    auto cache = std::make_shared<PersistentShapingCache>(
+        OpenArchive(dir), worker.GetTaskRunner());
+    cache->store("old", std::string(512, 'x'));
+    Flush(worker.GetTaskRunner());
+  }
+
+  auto cache = std::make_shared<PersistentShapingCache>(
+      OpenArchive(dir), worker.GetTaskRunner(), 256);
+  std::string value;
+  EXPECT_FALSE(cache->load("old", &value));
+  cache->store("new", "fits");
+  Flush(worker.GetTaskRunner());
+  EXPECT_TRUE(cache->load("new", &value));
+}
+
+TEST(PersistentShapingCache, EntriesUnusedInARunAreEvictedWhenFull) {
+  fml::ScopedTemporaryDirectory dir;
+  fml::Thread worker("io");
+  const std::string layout(100, 'x');
+  const size_t max_bytes = ShaderCacheArchive::GetEmptyFileSize() +
+                           3 * ShaderCacheArchive::GetRecordSize(3, 100);
+  {
+    auto cache = std::make_shared<PersistentShapingCache>(
+        OpenArchive(dir), worker.GetTaskRunner(), max_bytes);
+    cache->store("aaa", layout);
+    cache->store("bbb", layout);
+    cache->store("ccc", layout);
+    Flush(worker.GetTaskRunner());
+  }
+
+  // As after an update that changed the fonts, most of the stored entries
+  // are not used by the next run, which has the same budget.
+  auto archive = OpenArchive(dir);
+  EXPECT_EQ(archive->GetFileSize(), max_bytes);
+  auto cache = std::make_shared<PersistentShapingCache>(
+      archive, worker.GetTaskRunner(), max_bytes);
+  std::string value;
+  EXPECT_TRUE(cache->load("aaa", &value));
+  // Doesn't fit, and makes room for later entries.
+  cache->store("ddd", layout);
+  Flush(worker.GetTaskRunner());
+  EXPECT_FALSE(cache->load("ddd", &value));
+  cache->store("ddd", layout);
+  cache->store("eee", layout);
+  Flush(worker.GetTaskRunner());
+
+  EXPECT_TRUE(cache->load("aaa", &value));
+  EXPECT_TRUE(cache->load("ddd", &value));
+  EXPECT_TRUE(cache->load("eee", &value));
+  EXPECT_FALSE(cache->load("bbb", &value));
+  EXPECT_FALSE(cache->load("ccc", &value));
+  EXPECT_EQ(archive->GetFileSize(), max_bytes);
+}
+
+TEST(PersistentShapingCache, KeepsStoringAfterTheWorkerGoesAway) {
+  fml::ScopedTemporaryDirectory dir;
+  auto first_worker = std::make_unique<fml::Thread>("first io");
+  auto cache = std::make_shared<PersistentShapingCache>(
+      OpenArchive(dir), first_worker->GetTaskRunner());
+  // The batch is dropped by the terminated worker.
+  first_worker.reset();
+  cache->store("dropped", "layout of dropped");
+
+  // Without a worker, layouts wait for the next one.
+  cache->SetWorkerTaskRunner(nullptr);
+  cache->store("waiting", "layout of waiting");
+
+  fml::Thread second_worker("second io");
+  cache->SetWorkerTaskRunner(second_worker.GetTaskRunner());
+  Flush(second_worker.GetTaskRunner());
+  std::string value;
+  EXPECT_TRUE(cache->load("dropped", &value));
+  EXPECT_TRUE(cache->load("waiting", &value));
+
+  cache->store("later", "layout of later");
+  Flush(second_worker.GetTaskRunner());
+  EXPECT_TRUE(cache->load("later", &value));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -5,6 +5,9 @@
 
 #include "flutter/shell/common/rasterizer.h"
 
+#include <algorithm>
+#include <map>
+#include <mutex>
 #include <utility>
 
 #include "flutter/fml/time/time_delta.h"
@@ -12,6 +15,7 @@
 #include "flutter/shell/common/persistent_cache.h"
 #include "flutter/shell/common/serialization_callbacks.h"
 #include "third_party/skia/include/core/SkEncodedImageFormat.h"
+#include "third_party/skia/include/core/SkGraphics.h"
 #include "third_party/skia/include/core/SkImageEncoder.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
 #include "third_party/skia/include/core/SkSerialProcs.h"
@@ -37,6 +41,49 @@ namespace flutter {
 // used within this interval.
 static constexpr std::chrono::milliseconds kSkiaCleanupExpiration(15000);
 
+// The memory categories whose memory is owned by the rasterizer.
+static constexpr MemoryCategory kRasterizerMemoryCategories[] = {
+    MemoryCategory::kRasterCache,
+    MemoryCategory::kRenderTargets,
+    MemoryCategory::kTextAtlases,
+    MemoryCategory::kResourceCache,
+};
+
+// The share of the frame budget a batch of shader precompilation between
+// frames may take.
+static constexpr double kShaderPrecompileBatchBudgetRatio = 0.25;
+
+// Skia's glyph cache, and so its limit, is shared by every engine in the
+// process. The text atlas budgets of all rasterizers are kept here and the
+// largest one is applied, so that an engine with a small budget doesn't evict
+// the glyphs of the others. The limit Skia started with comes back once no
+// rasterizer has a budget.
+static void SetFontCacheBudget(const Rasterizer* rasterizer,
+                               std::optional<size_t> budget) {
+  static std::mutex mutex;
+  static std::map<const Rasterizer*, size_t>* budgets =
+      new std::map<const Rasterizer*, size_t>();
+  static std::optional<size_t> default_limit;
+
+  std::scoped_lock lock(mutex);
+  if (!default_limit) {
+    default_limit = SkGraphics::GetFontCacheLimit();
+  }
+  if (budget) {
+    (*budgets)[rasterizer] = budget.value();
+  } else if (budgets->erase(rasterizer) == 0) {
+    return;
+  }
+  size_t limit = default_limit.value();
+  if (!budgets->empty()) {
+    limit = 0;
+    for (const auto& entry : *budgets) {
+      limit = std::max(limit, entry.second);
+    }
+  }
+  SkGraphics::SetFontCacheLimit(limit);
+}
+
 Rasterizer::Rasterizer(Delegate& delegate)
     : delegate_(delegate),
       compositor_context_(std::make_unique<flutter::CompositorContext>(
@@ -44,6 +91,8 @@ Rasterizer::Rasterizer(Delegate& delegate)
       user_override_resource_cache_bytes_(false),
       weak_factory_(this) {
   FML_DCHECK(compositor_context_);
+  ApplySettings();
+  RegisterMemoryHandlers();
 }
 
 #if defined(LEGACY_FUCHSIA_EMBEDDER)
@@ -56,10 +105,237 @@ Rasterizer::Rasterizer(
       user_override_resource_cache_bytes_(false),
       weak_factory_(this) {
   FML_DCHECK(compositor_context_);
+  ApplySettings();
+  RegisterMemoryHandlers();
 }
 #endif
 
-Rasterizer::~Rasterizer() = default;
+Rasterizer::~Rasterizer() {
+  if (memory_accounting_) {
+    for (MemoryCategory category : kRasterizerMemoryCategories) {
+      memory_accounting_->ClearHandler(category);
+    }
+    SetFontCacheBudget(this, std::nullopt);
+  }
+}
+
+void Rasterizer::ApplySettings() {
+  const Settings& settings = delegate_.GetSettings();
+  auto& raster_cache = compositor_context_->raster_cache();
+  raster_cache.SetMaxBytes(settings.raster_cache_max_bytes);
+  raster_cache.SetRetainedFrames(settings.raster_cache_retained_frames);
+  if (settings.enable_async_raster_cache) {
+    raster_cache.SetAsyncTaskRunner(delegate_.GetConcurrentWorkerTaskRunner());
+  }
+  if (settings.software_raster_tile_count > 1) {
+    tiled_rasterizer_ = std::make_unique<TiledPictureRasterizer>(
+        delegate_.GetConcurrentWorkerTaskRunner(),
+        settings.software_raster_tile_count);
+  }
+}
+
+void Rasterizer::RegisterMemoryHandlers() {
+  memory_accounting_ = delegate_.GetMemoryAccounting();
+  if (!memory_accounting_) {
+    return;
+  }
+  // The accounting may call the handlers on any thread, so they hop to the
+  // raster thread before touching the rasterizer.
+  auto raster_task_runner = delegate_.GetTaskRunners().GetRasterTaskRunner();
+  auto weak_this = weak_factory_.GetWeakPtr();
+  for (MemoryCategory category : kRasterizerMemoryCategories) {
+    MemoryAccounting::Handler handler;
+    handler.budget_changed = [raster_task_runner, weak_this,
+                              category](std::optional<size_t> budget) {
+      fml::TaskRunner::RunNowOrPostTask(
+          raster_task_runner, [weak_this, category, budget]() {
+            if (weak_this) {
+              weak_this->ApplyMemoryBudget(category, budget);
+            }
+          });
+    };
+    handler.purge = [raster_task_runner, weak_this,
+                     category](size_t target_bytes) {
+      fml::TaskRunner::RunNowOrPostTask(
+          raster_task_runner, [weak_this, category, target_bytes]() {
+            if (weak_this) {
+              weak_this->PurgeMemory(category, target_bytes);
+            }
+          });
+    };
+    memory_accounting_->SetHandler(category, std::move(handler));
+  }
+}
+
+void Rasterizer::ReportMemoryUsage() const {
+  if (!memory_accounting_) {
+    return;
+  }
+  const auto& raster_cache = compositor_context_->raster_cache();
+  memory_accounting_->SetUsage(MemoryCategory::kRasterCache,
+                               raster_cache.EstimateLayerCacheByteSize() +
+                                   raster_cache.EstimatePictureCacheByteSize());
+
+  size_t render_target_bytes = 0;
+  size_t resource_cache_bytes = 0;
+  if (surface_) {
+    if (auto* external_view_embedder = surface_->GetExternalViewEmbedder()) {
+      render_target_bytes = external_view_embedder->GetRenderTargetCacheBytes();
+    }
+    if (auto* context = surface_->GetContext()) {
+      context->getResourceCacheUsage(nullptr, &resource_cache_bytes);
+    }
+  }
+  memory_accounting_->SetUsage(MemoryCategory::kRenderTargets,
+                               render_target_bytes);
+  memory_accounting_->SetUsage(MemoryCategory::kResourceCache,
+                               resource_cache_bytes);
+
+  // Skia doesn't expose the size of its GPU glyph atlases. They are filled
+  // from its glyph cache, whose size is the closest available measure.
+  memory_accounting_->SetUsage(MemoryCategory::kTextAtlases,
+                               SkGraphics::GetFontCacheUsed());
+}
+
+void Rasterizer::ApplyMemoryBudget(MemoryCategory category,
+                                   std::optional<size_t> budget) {
+  switch (category) {
+    case MemoryCategory::kRasterCache:
+      compositor_context_->raster_cache().SetMaxBytes(
+          budget.value_or(delegate_.GetSettings().raster_cache_max_bytes));
+      break;
+    case MemoryCategory::kResourceCache:
+      // Without a budget, the last limit stays in place until the platform
+      // sets a new one.
+      if (budget) {
+        SetResourceCacheMaxBytes(budget.value(), true);
+      }
+      break;
+    case MemoryCategory::kTextAtlases:
+      // The glyph cache is shared by all engines in the process, so this
+      // only raises its limit if no other engine has a larger budget.
+      SetFontCacheBudget(this, budget);
+      break;
+    case MemoryCategory::kRenderTargets:
+    case MemoryCategory::kImages:
+      // No native limit, these are purged when they go over budget.
+      break;
+  }
+}
+
+void Rasterizer::PurgeMemory(MemoryCategory category, size_t target_bytes) {
+  TRACE_EVENT1("flutter", "Rasterizer::PurgeMemory", "category",
+               MemoryCategoryToString(category));
+  switch (category) {
+    case MemoryCategory::kRasterCache:
+      compositor_context_->raster_cache().PurgeToBytes(target_bytes);
+      break;
+    case MemoryCategory::kResourceCache:
+      if (auto* context = surface_ ? surface_->GetContext() : nullptr) {
+        size_t resource_bytes = 0;
+        context->getResourceCacheUsage(nullptr, &resource_bytes);
+        if (resource_bytes > target_bytes) {
+          // Resources still in use by the GPU can't be purged, so this may
+          // free less than asked.
+          context->purgeUnlockedResources(resource_bytes - target_bytes, true);
+        }
+      }
+      break;
+    case MemoryCategory::kTextAtlases:
+      if (SkGraphics::GetFontCacheUsed() > target_bytes) {
+        SkGraphics::PurgeFontCache();
+      }
+      break;
+    case MemoryCategory::kRenderTargets:
+      if (auto* external_view_embedder =
+              surface_ ? surface_->GetExternalViewEmbedder() : nullptr) {
+        if (external_view_embedder->GetRenderTargetCacheBytes() >
+            target_bytes) {
+          external_view_embedder->PurgeRenderTargetCache();
+        }
+      }
+      break;
+    case MemoryCategory::kImages:
+      break;
+  }
+  ReportMemoryUsage();
+}
+
+void Rasterizer::StartShaderPrecompilation() {
+  GrDirectContext* context = surface_->GetContext();
+  if (!context) {
+    return;
+  }
+  // Skia compiles programs into the cache of the context, so shaders are
+  // precompiled again for every new surface.
+  shader_precompiler_ = std::make_unique<ShaderPrecompiler>(
+      PersistentCache::GetCacheForProcess()->LoadSkSLEntries(),
+      [context](const SkData& key, const SkData& sksl) {
+        return context->precompileShader(key, sksl);
+      });
+  ScheduleShaderPrecompileBatch();
+}
+
+void Rasterizer::PrecompileShadersUsedBy(uint32_t frame_index) {
+  if (!shader_precompiler_ || shader_precompiler_->IsDone()) {
+    return;
+  }
+  delegate_.GetIsGpuDisabledSyncSwitch()->Execute(
+      fml::SyncSwitch::Handlers().SetIfFalse([&] {
+        auto context_switch = surface_->MakeRenderContextCurrent();
+        if (context_switch->GetResult()) {
+          shader_precompiler_->CompileShadersUsedBy(frame_index);
+        }
+      }));
+}
+
+void Rasterizer::ScheduleShaderPrecompileBatch() {
+  if (shader_precompile_batch_pending_ || !shader_precompiler_ ||
+      shader_precompiler_->IsDone()) {
+    return;
+  }
+  shader_precompile_batch_pending_ = true;
+  // Frames are drawn by tasks on the same runner, so they get to run between
+  // batches.
+  delegate_.GetTaskRunners().GetRasterTaskRunner()->PostTask(
+      [weak_this = weak_factory_.GetWeakPtr()]() {
+        if (weak_this) {
+          weak_this->RunShaderPrecompileBatch();
+        }
+      });
+}
+
+void Rasterizer::RunShaderPrecompileBatch() {
+  shader_precompile_batch_pending_ = false;
+  if (!surface_ || !shader_precompiler_) {
+    return;
+  }
+  bool compiled = false;
+  delegate_.GetIsGpuDisabledSyncSwitch()->Execute(
+      fml::SyncSwitch::Handlers().SetIfFalse([&] {
+        auto context_switch = surface_->MakeRenderContextCurrent();
+        if (!context_switch->GetResult()) {
+          return;
+        }
+        const auto budget = fml::TimeDelta::FromMillisecondsF(
+            delegate_.GetFrameBudget().count() *
+            kShaderPrecompileBatchBudgetRatio);
+        shader_precompiler_->CompileBatch(fml::TimePoint::Now() + budget);
+        compiled = true;
+      }));
+  // While the GPU is unavailable, the next frame picks up where this left
+  // off.
+  if (compiled) {
+    ScheduleShaderPrecompileBatch();
+  }
+}
+
+ShaderPrecompiler::Progress Rasterizer::GetShaderPrecompileProgress() const {
+  if (!shader_precompiler_) {
+    return {};
+  }
+  return shader_precompiler_->GetProgress();
+}
 
 fml::TaskRunnerAffineWeakPtr<Rasterizer> Rasterizer::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
@@ -77,6 +353,7 @@ void Rasterizer::Setup(std::unique_ptr<Surface> surface) {
                              user_override_resource_cache_bytes_);
   }
   compositor_context_->OnGrContextCreated();
+  StartShaderPrecompilation();
   if (surface_->GetExternalViewEmbedder() &&
       surface_->GetExternalViewEmbedder()->SupportsDynamicThreadMerging() &&
       !raster_thread_merger_) {
@@ -99,6 +376,7 @@ void Rasterizer::Setup(std::unique_ptr<Surface> surface) {
 
 void Rasterizer::Teardown() {
   compositor_context_->OnGrContextDestroyed();
+  shader_precompiler_.reset();
   surface_.reset();
   last_layer_tree_.reset();
 
@@ -108,6 +386,7 @@ void Rasterizer::Teardown() {
     raster_thread_merger_->UnMergeNow();
     raster_thread_merger_->SetMergeUnmergeCallback(nullptr);
   }
+  ReportMemoryUsage();
 }
 
 void Rasterizer::EnableThreadMergerIfNeeded() {
@@ -135,6 +414,7 @@ void Rasterizer::NotifyLowMemoryWarning() const {
     return;
   }
   context->performDeferredCleanup(std::chrono::milliseconds(0));
+  ReportMemoryUsage();
 }
 
 flutter::TextureRegistry* Rasterizer::GetTextureRegistry() {
@@ -335,6 +615,8 @@ RasterStatus Rasterizer::DoDraw(
 
   PersistentCache* persistent_cache = PersistentCache::GetCacheForProcess();
   persistent_cache->ResetStoredNewShaders();
+  PersistentCache::ScopedFrame scoped_frame(frame_index_);
+  PrecompileShadersUsedBy(frame_index_);
 
   RasterStatus raster_status = DrawToSurface(*layer_tree);
   if (raster_status == RasterStatus::kSuccess) {
@@ -351,6 +633,8 @@ RasterStatus Rasterizer::DoDraw(
         ScreenshotLastLayerTree(ScreenshotType::SkiaPicture, false);
     persistent_cache->DumpSkp(*screenshot.data);
   }
+  frame_index_++;
+  ScheduleShaderPrecompileBatch();
 
   // TODO(liyuqian): in Fuchsia, the rasterization doesn't finish when
   // Rasterizer::DoDraw finishes. Future work is needed to adapt the timestamp
@@ -450,8 +734,20 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   SkMatrix root_surface_transformation =
       embedder_root_canvas ? SkMatrix{} : surface_->GetRootTransformation();
 
-  auto root_surface_canvas =
-      embedder_root_canvas ? embedder_root_canvas : frame->SkiaCanvas();
+  // Software frames may be recorded and then rendered by multiple threads.
+  sk_sp<SkSurface> tiled_surface;
+  if (tiled_rasterizer_ && external_view_embedder == nullptr &&
+      surface_->GetContext() == nullptr) {
+    tiled_surface = frame->SkiaSurface();
+  }
+
+  SkCanvas* root_surface_canvas = frame->SkiaCanvas();
+  if (embedder_root_canvas) {
+    root_surface_canvas = embedder_root_canvas;
+  } else if (tiled_surface) {
+    root_surface_canvas = tiled_rasterizer_->BeginRecording(
+        SkISize::Make(tiled_surface->width(), tiled_surface->height()));
+  }
 
   auto compositor_frame = compositor_context_->AcquireFrame(
       surface_->GetContext(),       // skia GrContext
@@ -464,11 +760,45 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
-    RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
+    // Only repaint what changed since the last frame if the surface still holds
+    // (most of) the last frame. External view embedders composite the root
+    // surface with their own surfaces, so they always get the full frame.
+    std::unique_ptr<FrameDamage> damage;
+    const auto& existing_damage = frame->framebuffer_info().existing_damage;
+    if (external_view_embedder == nullptr && existing_damage.has_value() &&
+        last_layer_tree_ && last_layer_tree_.get() != &layer_tree) {
+      damage = std::make_unique<FrameDamage>();
+      damage->SetPreviousLayerTree(last_layer_tree_.get());
+      damage->AddAdditionalDamage(*existing_damage);
+    }
+
+    RasterStatus raster_status =
+        compositor_frame->Raster(layer_tree, false, damage.get());
     if (raster_status == RasterStatus::kFailed ||
         raster_status == RasterStatus::kSkipAndRetry) {
+      if (tiled_surface) {
+        tiled_rasterizer_->DiscardRecording();
+      }
       return raster_status;
     }
+
+    if (tiled_surface) {
+      const SkIRect tiled_damage =
+          damage && damage->GetBufferDamage()
+              ? *damage->GetBufferDamage()
+              : SkIRect::MakeWH(tiled_surface->width(),
+                                tiled_surface->height());
+      if (!tiled_rasterizer_->Rasterize(tiled_surface.get(), tiled_damage)) {
+        return RasterStatus::kFailed;
+      }
+    }
+
+    if (damage) {
+      SurfaceFrame::SubmitInfo submit_info;
+      submit_info.frame_damage = damage->GetFrameDamage();
+      submit_info.buffer_damage = damage->GetBufferDamage();
+      frame->set_submit_info(submit_info);
+    }
     if (external_view_embedder != nullptr) {
       FML_DCHECK(!frame->IsSubmitted());
       external_view_embedder->SubmitFrame(surface_->GetContext(),
@@ -483,10 +813,14 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
       TRACE_EVENT0("flutter", "PerformDeferredSkiaCleanup");
       surface_->GetContext()->performDeferredCleanup(kSkiaCleanupExpiration);
     }
+    ReportMemoryUsage();
 
     return raster_status;
   }
 
+  if (tiled_surface) {
+    tiled_rasterizer_->DiscardRecording();
+  }
   return RasterStatus::kFailed;
 }
 
@@ -506,7 +840,7 @@ static sk_sp<SkData> ScreenshotLayerTreeAsPicture(
   auto frame = compositor_context.ACQUIRE_FRAME(
       nullptr, recorder.getRecordingCanvas(), nullptr,
       root_surface_transformation, false, true, nullptr);
-  frame->Raster(*tree, true);
+  frame->Raster(*tree, true, nullptr);
 
 #if defined(OS_FUCHSIA)
   SkSerialProcs procs = {0};
@@ -573,7 +907,7 @@ sk_sp<SkData> Rasterizer::ScreenshotLayerTreeAsImage(
       surface_context, canvas, nullptr, root_surface_transformation, false,
       true, nullptr);
   canvas->clear(SK_ColorTRANSPARENT);
-  frame->Raster(*tree, true);
+  frame->Raster(*tree, true, nullptr);
   canvas->flush();
 
   // Prepare an image from the surface, this image may potentially be on th GPU.
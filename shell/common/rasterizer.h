@@ -12,8 +12,11 @@
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/compositor_context.h"
 #include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/memory_accounting.h"
 #include "flutter/flow/surface.h"
+#include "flutter/flow/tiled_picture_rasterizer.h"
 #include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/raster_thread_merger.h"
 #include "flutter/fml/synchronization/sync_switch.h"
@@ -22,6 +25,7 @@
 #include "flutter/fml/time/time_point.h"
 #include "flutter/lib/ui/snapshot_delegate.h"
 #include "flutter/shell/common/pipeline.h"
+#include "flutter/shell/common/shader_precompiler.h"
 
 namespace flutter {
 
@@ -85,6 +89,19 @@ class Rasterizer final : public SnapshotDelegate {
     /// is critical that GPU operations are not processed.
     virtual std::shared_ptr<fml::SyncSwitch> GetIsGpuDisabledSyncSwitch()
         const = 0;
+
+    /// The settings used to launch the shell.
+    virtual const Settings& GetSettings() const = 0;
+
+    /// Task runner for work that can run on any worker thread, such as
+    /// populating the raster cache off the raster thread.
+    virtual std::shared_ptr<fml::ConcurrentTaskRunner>
+    GetConcurrentWorkerTaskRunner() = 0;
+
+    /// The memory accounting of the shell. The rasterizer reports the raster
+    /// cache, render targets, text atlases and Skia's resource cache to it,
+    /// and purges them under pressure. May be null.
+    virtual std::shared_ptr<MemoryAccounting> GetMemoryAccounting() = 0;
   };
 
   //----------------------------------------------------------------------------
@@ -420,6 +437,18 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   void DisableThreadMergerIfNeeded();
 
+  //----------------------------------------------------------------------------
+  /// @brief      Returns how far the precompilation of the SkSL shaders of the
+  ///             persistent cache has come. The shaders are precompiled for
+  ///             the context of the surface passed to `Rasterizer::Setup`,
+  ///             before the frames that used them in earlier runs and in
+  ///             batches between frames otherwise.
+  ///
+  /// @return     The progress, which has no shaders if there is no surface or
+  ///             it has no GPU context.
+  ///
+  ShaderPrecompiler::Progress GetShaderPrecompileProgress() const;
+
  private:
   Delegate& delegate_;
   std::unique_ptr<Surface> surface_;
@@ -433,7 +462,17 @@ class Rasterizer final : public SnapshotDelegate {
   fml::closure next_frame_callback_;
   bool user_override_resource_cache_bytes_;
   std::optional<size_t> max_cache_bytes_;
+  // Set if software frames are rendered by multiple threads.
+  std::unique_ptr<flutter::TiledPictureRasterizer> tiled_rasterizer_;
   fml::RefPtr<fml::RasterThreadMerger> raster_thread_merger_;
+  std::shared_ptr<MemoryAccounting> memory_accounting_;
+  // Precompiles the SkSL shaders of the persistent cache for the context of
+  // |surface_|.
+  std::unique_ptr<ShaderPrecompiler> shader_precompiler_;
+  bool shader_precompile_batch_pending_ = false;
+  // The index of the next frame to draw, counted from the creation of the
+  // rasterizer. Shaders record the frame they were first used in.
+  uint32_t frame_index_ = 0;
   fml::TaskRunnerAffineWeakPtrFactory<Rasterizer> weak_factory_;
 
   // |SnapshotDelegate|
@@ -459,6 +498,31 @@ class Rasterizer final : public SnapshotDelegate {
 
   void FireNextFrameCallbackIfPresent();
 
+  // Configures the compositor from the settings.
+  void ApplySettings();
+
+  // Installs the handlers of the categories owned by the rasterizer in the
+  // memory accounting of the shell.
+  void RegisterMemoryHandlers();
+
+  // Reports the current usage of the categories owned by the rasterizer.
+  void ReportMemoryUsage() const;
+
+  void ApplyMemoryBudget(MemoryCategory category, std::optional<size_t> budget);
+
+  void PurgeMemory(MemoryCategory category, size_t target_bytes);
+
+  void StartShaderPrecompilation();
+
+  // Compiles the shaders that frame |frame_index| used in earlier runs.
+  void PrecompileShadersUsedBy(uint32_t frame_index);
+
+  // Posts a task that compiles the next batch of shaders, unless one is
+  // pending already.
+  void ScheduleShaderPrecompileBatch();
+
+  void RunShaderPrecompileBatch();
+
   static bool NoDiscard(const flutter::LayerTree& layer_tree) { return false; }
 
   FML_DISALLOW_COPY_AND_ASSIGN(Rasterizer);
@@ -0,0 +1,616 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shader_cache_archive.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/base32.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'L', 'T', 'S', 'H', 'A', 'D', 'R'};
+constexpr uint32_t kVersion = 2;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  // Incremented whenever the file is replaced.
+  uint32_t generation;
+};
+
+constexpr uint32_t kRecordTag = 0x52435346;  // "FSCR"
+
+// Followed by the key and then the value.
+struct RecordHeader {
+  uint32_t tag;
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t first_use_frame;
+  // Of the key and the value, to detect records that were only partly
+  // written when the process died.
+  uint32_t checksum;
+};
+
+// Compacting rewrites the whole file, so only do it once superseded records
+// take at least this much space and at least as much as live ones.
+constexpr size_t kCompactionMinDeadBytes = 64 * 1024;
+
+uint32_t Checksum(const uint8_t* data, size_t size) {
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+std::shared_ptr<fml::FileMapping> MapFile(const fml::UniqueFD& file,
+                                          bool writable) {
+  auto mapping =
+      writable ? std::make_shared<fml::FileMapping>(
+                     file, std::initializer_list<fml::FileMapping::Protection>{
+                               fml::FileMapping::Protection::kRead,
+                               fml::FileMapping::Protection::kWrite})
+               : std::make_shared<fml::FileMapping>(file);
+  if (!mapping->IsValid()) {
+    return nullptr;
+  }
+  return mapping;
+}
+
+void ReleaseMapping(const void* ptr, void* context) {
+  delete reinterpret_cast<std::shared_ptr<fml::FileMapping>*>(context);
+}
+
+// Holds the lock on |file| while in scope, if it can be taken. Archives go on
+// without it where locks aren't supported, as other processes are unlikely to
+// share their directory there.
+class ScopedFileLock {
+ public:
+  explicit ScopedFileLock(const fml::UniqueFD& file)
+      : file_(file), locked_(file.is_valid() && fml::LockFile(file)) {}
+
+  ~ScopedFileLock() {
+    if (locked_) {
+      fml::UnlockFile(file_);
+    }
+  }
+
+ private:
+  const fml::UniqueFD& file_;
+  const bool locked_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ScopedFileLock);
+};
+
+}  // namespace
+
+ShaderCacheArchive::ShaderCacheArchive(
+    std::shared_ptr<fml::UniqueFD> directory,
+    bool read_only)
+    : directory_(std::move(directory)),
+      read_only_(read_only),
+      compaction_min_dead_bytes_(kCompactionMinDeadBytes) {
+  if (!IsValid()) {
+    return;
+  }
+  TRACE_EVENT0("flutter", "ShaderCacheArchive::Open");
+  std::scoped_lock write_lock(write_mutex_);
+  if (!read_only_) {
+    lock_file_ = fml::OpenFile(*directory_, kLockFileName, true,
+                               fml::FilePermission::kReadWrite);
+  }
+  ScopedFileLock file_lock(lock_file_);
+  Open();
+  ImportLegacyEntries();
+}
+
+ShaderCacheArchive::~ShaderCacheArchive() = default;
+
+bool ShaderCacheArchive::IsValid() const {
+  return directory_ && directory_->is_valid();
+}
+
+void ShaderCacheArchive::Open() {
+  file_ = read_only_ ? fml::OpenFileReadOnly(*directory_, kFileName)
+                     : fml::OpenFile(*directory_, kFileName, true,
+                                     fml::FilePermission::kReadWrite);
+  std::shared_ptr<fml::FileMapping> mapping;
+  if (file_.is_valid()) {
+    mapping = MapFile(file_, !read_only_);
+  }
+
+  std::scoped_lock lock(mutex_);
+  records_.clear();
+  mapping_.reset();
+  file_size_ = 0;
+  live_bytes_ = 0;
+  dead_bytes_ = 0;
+  if (!mapping) {
+    return;
+  }
+  const uint8_t* data = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+  size_t offset = 0;
+  FileHeader file_header;
+  if (size >= sizeof(FileHeader)) {
+    ::memcpy(&file_header, data, sizeof(FileHeader));
+    if (::memcmp(file_header.magic, kMagic, sizeof(kMagic)) == 0 &&
+        file_header.version == kVersion) {
+      offset = sizeof(FileHeader);
+      generation_ = file_header.generation;
+    }
+  }
+  while (offset != 0 && size - offset >= sizeof(RecordHeader)) {
+    RecordHeader header;
+    ::memcpy(&header, data + offset, sizeof(RecordHeader));
+    const size_t record_size =
+        sizeof(RecordHeader) + header.key_size + header.value_size;
+    if (header.tag != kRecordTag || header.key_size == 0 ||
+        record_size > size - offset) {
+      break;
+    }
+    const uint8_t* key = data + offset + sizeof(RecordHeader);
+    if (Checksum(key, header.key_size + header.value_size) != header.checksum) {
+      break;
+    }
+    Record record;
+    record.value_offset = offset + sizeof(RecordHeader) + header.key_size;
+    record.value_size = header.value_size;
+    record.record_size = record_size;
+    record.first_use_frame = header.first_use_frame;
+    auto found = records_.find(
+        std::string(reinterpret_cast<const char*>(key), header.key_size));
+    if (found != records_.end()) {
+      live_bytes_ -= found->second.record_size;
+      dead_bytes_ += found->second.record_size;
+      found->second = record;
+    } else {
+      records_.emplace(
+          std::string(reinterpret_cast<const char*>(key), header.key_size),
+          record);
+    }
+    live_bytes_ += record_size;
+    offset += record_size;
+  }
+  mapping_ = std::move(mapping);
+  file_size_ = offset;
+
+  if (offset == size || read_only_) {
+    return;
+  }
+  if (offset == 0) {
+    if (size != 0) {
+      FML_LOG(WARNING) << "Discarding a shader cache archive that could not be "
+                          "read.";
+    }
+    ResetFileLocked();
+    return;
+  }
+  // The end of the file holds a record that was only partly written. Drop it
+  // so that new records are appended after the last complete one. No process
+  // reads past the last complete record, so the file can be truncated.
+  FML_LOG(WARNING) << "Dropping " << size - offset
+                   << " bytes at the end of the shader cache archive.";
+  if (fml::TruncateFile(file_, offset)) {
+    mapping_ = MapFile(file_, true);
+  }
+}
+
+void ShaderCacheArchive::SyncLocked() {
+  if (read_only_) {
+    return;
+  }
+  fml::UniqueFD file = fml::OpenFile(*directory_, kFileName, false,
+                                     fml::FilePermission::kReadWrite);
+  std::shared_ptr<fml::FileMapping> mapping;
+  if (file.is_valid()) {
+    mapping = MapFile(file, true);
+  }
+  {
+    // Records are only ever appended to a file, which gets a new generation
+    // when it is replaced.
+    std::scoped_lock lock(mutex_);
+    if (mapping && file_size_ >= sizeof(FileHeader) &&
+        mapping->GetSize() == file_size_) {
+      FileHeader file_header;
+      ::memcpy(&file_header, mapping->GetMapping(), sizeof(FileHeader));
+      if (file_header.generation == generation_) {
+        file_ = std::move(file);
+        return;
+      }
+    }
+  }
+  Open();
+}
+
+void ShaderCacheArchive::ImportLegacyEntries() {
+  std::vector<std::pair<std::string, std::string>> legacy_files;
+  fml::VisitFiles(*directory_, [&legacy_files](const fml::UniqueFD& directory,
+                                               const std::string& filename) {
+    std::pair<bool, std::string> key = fml::Base32Decode(filename);
+    if (key.first && !key.second.empty() &&
+        !fml::IsDirectory(directory, filename.c_str())) {
+      legacy_files.push_back({std::move(key.second), filename});
+    }
+    return true;
+  });
+  if (legacy_files.empty()) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "ShaderCacheArchive::ImportLegacyEntries");
+  for (const auto& [key, filename] : legacy_files) {
+    std::unique_ptr<fml::FileMapping> file =
+        fml::FileMapping::CreateReadOnly(*directory_, filename);
+    const bool has_value = file && file->GetSize() != 0;
+    if (read_only_) {
+      std::scoped_lock lock(mutex_);
+      if (has_value && records_.find(key) == records_.end()) {
+        imported_[key] =
+            SkData::MakeWithCopy(file->GetMapping(), file->GetSize());
+      }
+      continue;
+    }
+    bool already_stored;
+    {
+      std::scoped_lock lock(mutex_);
+      already_stored = records_.find(key) != records_.end();
+    }
+    if (!has_value || already_stored ||
+        StoreLocked(key, file->GetMapping(), file->GetSize(),
+                    kUnknownFirstUseFrame)) {
+      fml::UnlinkFile(*directory_, filename.c_str());
+    }
+  }
+}
+
+bool ShaderCacheArchive::ResetFileLocked() {
+  FileHeader header = {};
+  ::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.generation = generation_ + 1;
+
+  records_.clear();
+  mapping_.reset();
+  file_size_ = 0;
+  live_bytes_ = 0;
+  dead_bytes_ = 0;
+  compaction_min_dead_bytes_ = kCompactionMinDeadBytes;
+
+  // Other processes may have the file mapped, so it is replaced rather than
+  // truncated. Some platforms can't replace a file that is open.
+  file_.reset();
+  const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&header);
+  if (!fml::WriteAtomically(
+          *directory_, kFileName,
+          fml::DataMapping(std::vector<uint8_t>(
+              header_bytes, header_bytes + sizeof(FileHeader))))) {
+    return false;
+  }
+  file_ = fml::OpenFile(*directory_, kFileName, false,
+                        fml::FilePermission::kReadWrite);
+  if (!file_.is_valid()) {
+    return false;
+  }
+  std::shared_ptr<fml::FileMapping> mapping = MapFile(file_, true);
+  if (!mapping || mapping->GetSize() != sizeof(FileHeader)) {
+    return false;
+  }
+  mapping_ = std::move(mapping);
+  file_size_ = sizeof(FileHeader);
+  generation_ = header.generation;
+  return true;
+}
+
+bool ShaderCacheArchive::StoreLocked(const std::string& key,
+                                     const uint8_t* value,
+                                     size_t size,
+                                     uint32_t first_use_frame) {
+  if (!file_.is_valid()) {
+    file_ = fml::OpenFile(*directory_, kFileName, true,
+                          fml::FilePermission::kReadWrite);
+    if (!file_.is_valid()) {
+      return false;
+    }
+  }
+  if (file_size_ < sizeof(FileHeader)) {
+    std::scoped_lock lock(mutex_);
+    if (!ResetFileLocked()) {
+      return false;
+    }
+  }
+
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = records_.find(key);
+    if (found != records_.end()) {
+      first_use_frame =
+          std::min(first_use_frame, found->second.first_use_frame);
+    }
+  }
+
+  const size_t record_size = GetRecordSize(key.size(), size);
+  const size_t offset = file_size_;
+  if (!fml::TruncateFile(file_, offset + record_size)) {
+    return false;
+  }
+  std::shared_ptr<fml::FileMapping> mapping = MapFile(file_, true);
+  if (!mapping || mapping->GetSize() != offset + record_size) {
+    return false;
+  }
+
+  uint8_t* destination = mapping->GetMutableMapping() + offset;
+  ::memcpy(destination + sizeof(RecordHeader), key.data(), key.size());
+  ::memcpy(destination + sizeof(RecordHeader) + key.size(), value, size);
+  RecordHeader header;
+  header.tag = kRecordTag;
+  header.key_size = key.size();
+  header.value_size = size;
+  header.first_use_frame = first_use_frame;
+  header.checksum =
+      Checksum(destination + sizeof(RecordHeader), key.size() + size);
+  ::memcpy(destination, &header, sizeof(RecordHeader));
+
+  Record record;
+  record.value_offset = offset + sizeof(RecordHeader) + key.size();
+  record.value_size = size;
+  record.record_size = record_size;
+  record.first_use_frame = first_use_frame;
+
+  std::scoped_lock lock(mutex_);
+  auto found = records_.find(key);
+  if (found != records_.end()) {
+    live_bytes_ -= found->second.record_size;
+    dead_bytes_ += found->second.record_size;
+    found->second = record;
+  } else {
+    records_.emplace(key, record);
+  }
+  live_bytes_ += record_size;
+  mapping_ = std::move(mapping);
+  file_size_ = offset + record_size;
+  return true;
+}
+
+bool ShaderCacheArchive::Store(const SkData& key,
+                               const SkData& value,
+                               uint32_t first_use_frame) {
+  if (read_only_ || !IsValid() || key.size() == 0) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "ShaderCacheArchive::Store");
+  std::scoped_lock write_lock(write_mutex_);
+  ScopedFileLock file_lock(lock_file_);
+  SyncLocked();
+  return StoreLocked(
+      std::string(reinterpret_cast<const char*>(key.bytes()), key.size()),
+      value.bytes(), value.size(), first_use_frame);
+}
+
+sk_sp<SkData> ShaderCacheArchive::MakeValue(
+    const std::shared_ptr<fml::FileMapping>& mapping,
+    const Record& record) const {
+  // The value points into the mapping, which is kept alive until Skia is done
+  // with the value even if the archive has been remapped since.
+  return SkData::MakeWithProc(mapping->GetMapping() + record.value_offset,
+                              record.value_size, ReleaseMapping,
+                              new std::shared_ptr<fml::FileMapping>(mapping));
+}
+
+sk_sp<SkData> ShaderCacheArchive::Load(const SkData& key) const {
+  std::string key_string(reinterpret_cast<const char*>(key.bytes()),
+                         key.size());
+  std::scoped_lock lock(mutex_);
+  auto found = records_.find(key_string);
+  // The file isn't mapped while it is being compacted.
+  if (found != records_.end() && mapping_) {
+    return MakeValue(mapping_, found->second);
+  }
+  auto imported = imported_.find(key_string);
+  if (imported != imported_.end()) {
+    return imported->second;
+  }
+  return nullptr;
+}
+
+std::vector<ShaderCacheArchive::Entry> ShaderCacheArchive::LoadAll() const {
+  std::scoped_lock lock(mutex_);
+  std::vector<std::pair<const std::string*, const Record*>> records;
+  if (mapping_) {
+    records.reserve(records_.size());
+    for (const auto& item : records_) {
+      records.push_back({&item.first, &item.second});
+    }
+  }
+  // Walk the file front to back.
+  std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+    return a.second->value_offset < b.second->value_offset;
+  });
+
+  std::vector<Entry> entries;
+  entries.reserve(records.size() + imported_.size());
+  for (const auto& [key, record] : records) {
+    entries.push_back({SkData::MakeWithCopy(key->data(), key->size()),
+                       MakeValue(mapping_, *record)});
+  }
+  for (const auto& [key, value] : imported_) {
+    entries.push_back({SkData::MakeWithCopy(key.data(), key.size()), value});
+  }
+  return entries;
+}
+
+uint32_t ShaderCacheArchive::GetFirstUseFrame(const SkData& key) const {
+  std::string key_string(reinterpret_cast<const char*>(key.bytes()),
+                         key.size());
+  std::scoped_lock lock(mutex_);
+  auto found = records_.find(key_string);
+  if (found == records_.end()) {
+    return kUnknownFirstUseFrame;
+  }
+  return found->second.first_use_frame;
+}
+
+size_t ShaderCacheArchive::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  return records_.size() + imported_.size();
+}
+
+size_t ShaderCacheArchive::GetFileSize() const {
+  std::scoped_lock lock(mutex_);
+  return file_size_;
+}
+
+// static
+size_t ShaderCacheArchive::GetRecordSize(size_t key_size, size_t value_size) {
+  return sizeof(RecordHeader) + key_size + value_size;
+}
+
+// static
+size_t ShaderCacheArchive::GetEmptyFileSize() {
+  return sizeof(FileHeader);
+}
+
+bool ShaderCacheArchive::NeedsCompaction() const {
+  if (read_only_) {
+    return false;
+  }
+  std::scoped_lock lock(mutex_);
+  return dead_bytes_ >= compaction_min_dead_bytes_ &&
+         dead_bytes_ >= live_bytes_;
+}
+
+bool ShaderCacheArchive::Compact(
+    const std::function<bool(const std::string& key)>& retain) {
+  if (read_only_ || !IsValid()) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "ShaderCacheArchive::Compact");
+  std::scoped_lock write_lock(write_mutex_);
+  ScopedFileLock file_lock(lock_file_);
+  SyncLocked();
+
+  // Stores wait on the write lock, so the records can't change until the
+  // compacted file replaces the current one. Loads carry on meanwhile.
+  std::vector<std::pair<std::string, Record>> records;
+  std::shared_ptr<fml::FileMapping> mapping;
+  uint32_t generation;
+  {
+    std::scoped_lock lock(mutex_);
+    if (!mapping_ || file_size_ < sizeof(FileHeader) ||
+        (dead_bytes_ == 0 && !retain)) {
+      return true;
+    }
+    for (const auto& item : records_) {
+      if (!retain || retain(item.first)) {
+        records.push_back(item);
+      }
+    }
+    mapping = mapping_;
+    generation = generation_ + 1;
+  }
+  std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+    return a.second.value_offset < b.second.value_offset;
+  });
+
+  std::vector<uint8_t> buffer;
+  buffer.reserve(sizeof(FileHeader) + (file_size_ - sizeof(FileHeader)));
+  buffer.insert(buffer.end(), mapping->GetMapping(),
+                mapping->GetMapping() + sizeof(FileHeader));
+  size_t live_bytes = 0;
+  for (auto& [key, record] : records) {
+    const size_t record_offset =
+        record.value_offset - key.size() - sizeof(RecordHeader);
+    const size_t new_offset = buffer.size();
+    buffer.insert(buffer.end(), mapping->GetMapping() + record_offset,
+                  mapping->GetMapping() + record_offset + record.record_size);
+    record.value_offset = new_offset + sizeof(RecordHeader) + key.size();
+    live_bytes += record.record_size;
+  }
+  const size_t file_size = buffer.size();
+  FileHeader file_header;
+  ::memcpy(&file_header, buffer.data(), sizeof(FileHeader));
+  file_header.generation = generation;
+  ::memcpy(buffer.data(), &file_header, sizeof(FileHeader));
+
+  // Unmap and close the current file first since some platforms can't replace
+  // a file that is mapped or open. Loads miss until the new file is mapped.
+  mapping.reset();
+  {
+    std::scoped_lock lock(mutex_);
+    mapping_.reset();
+  }
+  file_.reset();
+  const bool written = fml::WriteAtomically(
+      *directory_, kFileName, fml::DataMapping(std::move(buffer)));
+  file_ = fml::OpenFile(*directory_, kFileName, false,
+                        fml::FilePermission::kReadWrite);
+  if (!written) {
+    FML_LOG(ERROR) << "Could not compact the shader cache archive.";
+    std::scoped_lock lock(mutex_);
+    if (file_.is_valid()) {
+      mapping_ = MapFile(file_, true);
+    }
+    if (!mapping_ || mapping_->GetSize() != file_size_) {
+      // The current file can't be read back either.
+      records_.clear();
+      mapping_.reset();
+      file_size_ = 0;
+      live_bytes_ = 0;
+      dead_bytes_ = 0;
+      return false;
+    }
+    // Replacing the file fails for as long as values loaded from it are
+    // alive on some platforms, so don't try again after every store.
+    compaction_min_dead_bytes_ = 2 * dead_bytes_;
+    return false;
+  }
+  std::shared_ptr<fml::FileMapping> compacted = MapFile(file_, true);
+  if (!compacted || compacted->GetSize() != file_size) {
+    // Start over rather than index a file that doesn't match the records.
+    std::scoped_lock lock(mutex_);
+    return file_.is_valid() && ResetFileLocked();
+  }
+
+  std::scoped_lock lock(mutex_);
+  records_.clear();
+  for (auto& [key, record] : records) {
+    records_.emplace(std::move(key), record);
+  }
+  mapping_ = std::move(compacted);
+  file_size_ = file_size;
+  generation_ = generation;
+  live_bytes_ = live_bytes;
+  dead_bytes_ = 0;
+  compaction_min_dead_bytes_ = kCompactionMinDeadBytes;
+  return true;
+}
+
+void ShaderCacheArchive::Clear() {
+  std::scoped_lock write_lock(write_mutex_);
+  file_.reset();
+  if (!read_only_) {
+    // The lock file was removed too, and other processes lock a new one.
+    lock_file_ = fml::OpenFile(*directory_, kLockFileName, true,
+                               fml::FilePermission::kReadWrite);
+  }
+  std::scoped_lock lock(mutex_);
+  mapping_.reset();
+  records_.clear();
+  imported_.clear();
+  file_size_ = 0;
+  live_bytes_ = 0;
+  dead_bytes_ = 0;
+  compaction_min_dead_bytes_ = kCompactionMinDeadBytes;
+}
+
+}  // namespace flutter
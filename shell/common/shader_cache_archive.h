@@ -0,0 +1,169 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_SHADER_CACHE_ARCHIVE_H_
+#define FLUTTER_SHELL_COMMON_SHADER_CACHE_ARCHIVE_H_
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// A key-value store for the persistent shader cache that keeps all entries
+/// of a directory in a single file.
+///
+/// The file is a header followed by records appended one after the other.
+/// Each record holds a key, a value and the index of the frame the entry was
+/// first used in, and supersedes earlier records with the same key. The file
+/// is memory mapped and indexed by key when the archive is opened, so that a
+/// lookup is a hash probe into mapped memory and loading every entry is a
+/// single sequential read. Superseded records are
+/// dropped when the archive is compacted, which rewrites the file.
+///
+/// Entries that earlier engines stored as one file per key, named by the
+/// Base32 encoding of the key, are imported into the archive when it is
+/// opened. Read-only archives keep them in memory instead.
+///
+/// Processes that share the directory take an advisory lock on a file next to
+/// the archive while they change it, and first pick up the records the others
+/// appended. The file is only ever replaced rather than truncated, since the
+/// other processes may still have it mapped.
+///
+/// All methods are thread safe. |Store|, |Compact| and |Clear| do file IO
+/// and should be called on a worker thread. Values returned by |Load| and
+/// |LoadAll| stay valid after the archive changes or goes away.
+///
+class ShaderCacheArchive {
+ public:
+  using Entry = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
+
+  static constexpr char kFileName[] = "shaders.archive";
+  static constexpr char kLockFileName[] = "shaders.archive.lock";
+
+  // The first use frame of entries that were stored without one.
+  static constexpr uint32_t kUnknownFirstUseFrame =
+      std::numeric_limits<uint32_t>::max();
+
+  ShaderCacheArchive(std::shared_ptr<fml::UniqueFD> directory, bool read_only);
+
+  ~ShaderCacheArchive();
+
+  bool IsValid() const;
+
+  sk_sp<SkData> Load(const SkData& key) const;
+
+  // Returns all entries in the order they were first stored.
+  std::vector<Entry> LoadAll() const;
+
+  size_t GetEntryCount() const;
+
+  // The index of the frame the entry was first used in, or
+  // |kUnknownFirstUseFrame|. When an entry is stored again, the earlier frame
+  // is kept.
+  uint32_t GetFirstUseFrame(const SkData& key) const;
+
+  // Appends an entry to the archive file. Returns false if the archive is
+  // read-only or the file could not be written.
+  bool Store(const SkData& key,
+             const SkData& value,
+             uint32_t first_use_frame = kUnknownFirstUseFrame);
+
+  // Whether enough of the archive file is taken by superseded records for a
+  // call to |Compact| to be worthwhile.
+  bool NeedsCompaction() const;
+
+  // Rewrites the archive file with only the records that are still live and,
+  // if |retain| is set, whose key it returns true for.
+  bool Compact(const std::function<bool(const std::string& key)>& retain =
+                   nullptr);
+
+  // Forgets all entries, for use after the files of the directory were
+  // removed.
+  void Clear();
+
+  // The size of the archive file, including superseded records.
+  size_t GetFileSize() const;
+
+  // The bytes a record with a key and a value of these sizes takes in the
+  // archive file.
+  static size_t GetRecordSize(size_t key_size, size_t value_size);
+
+  // The size of an archive file without records.
+  static size_t GetEmptyFileSize();
+
+ private:
+  struct Record {
+    size_t value_offset = 0;
+    size_t value_size = 0;
+    size_t record_size = 0;
+    uint32_t first_use_frame = kUnknownFirstUseFrame;
+  };
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const bool read_only_;
+
+  // Serializes writes to the archive file. Always acquired before |mutex_|
+  // and before the lock on |lock_file_|.
+  std::mutex write_mutex_;
+  fml::UniqueFD file_;
+  // Locked while the archive file is changed. Not opened for read-only
+  // archives.
+  fml::UniqueFD lock_file_;
+
+  // Guards the state below, which readers see.
+  mutable std::mutex mutex_;
+  std::shared_ptr<fml::FileMapping> mapping_;
+  std::unordered_map<std::string, Record> records_;
+  // Entries of a read-only archive that were imported from legacy files.
+  std::unordered_map<std::string, sk_sp<SkData>> imported_;
+  size_t file_size_ = 0;
+  // Changed whenever the file is replaced, so that other processes know to
+  // index it again.
+  uint32_t generation_ = 0;
+  size_t live_bytes_ = 0;
+  size_t dead_bytes_ = 0;
+  // Raised after a failed compaction so that it isn't retried until enough
+  // more records were superseded.
+  size_t compaction_min_dead_bytes_;
+
+  // Maps the archive file and indexes its records, dropping any incomplete
+  // record at the end.
+  void Open();
+
+  // Indexes the archive file again if another process changed it since it
+  // was indexed. Must be called with the file lock held.
+  void SyncLocked();
+
+  void ImportLegacyEntries();
+
+  bool StoreLocked(const std::string& key,
+                   const uint8_t* value,
+                   size_t size,
+                   uint32_t first_use_frame);
+
+  // Replaces the archive file with one without records. Must be called with
+  // |mutex_| held.
+  bool ResetFileLocked();
+
+  sk_sp<SkData> MakeValue(const std::shared_ptr<fml::FileMapping>& mapping,
+                          const Record& record) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ShaderCacheArchive);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_SHADER_CACHE_ARCHIVE_H_
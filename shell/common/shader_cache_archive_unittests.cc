@@ -0,0 +1,310 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shader_cache_archive.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "flutter/fml/base32.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/log_settings.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+sk_sp<SkData> MakeData(const std::string& string) {
+  return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+std::string ToString(const sk_sp<SkData>& data) {
+  if (!data) {
+    return "<null>";
+  }
+  return std::string(reinterpret_cast<const char*>(data->bytes()),
+                     data->size());
+}
+
+std::shared_ptr<fml::UniqueFD> OpenDirectory(
+    const fml::ScopedTemporaryDirectory& dir) {
+  return std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+}
+
+}  // namespace
+
+TEST(ShaderCacheArchive, StoredEntriesSurviveReopening) {
+  fml::ScopedTemporaryDirectory dir;
+  {
+    ShaderCacheArchive archive(OpenDirectory(dir), false);
+    ASSERT_TRUE(archive.IsValid());
+    EXPECT_EQ(archive.Load(*MakeData("a")), nullptr);
+    ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData("apple")));
+    ASSERT_TRUE(archive.Store(*MakeData("b"), *MakeData("banana")));
+    EXPECT_EQ(ToString(archive.Load(*MakeData("a"))), "apple");
+  }
+
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  EXPECT_EQ(archive.GetEntryCount(), 2u);
+  EXPECT_EQ(ToString(archive.Load(*MakeData("a"))), "apple");
+  EXPECT_EQ(ToString(archive.Load(*MakeData("b"))), "banana");
+
+  auto entries = archive.LoadAll();
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(ToString(entries[0].first), "a");
+  EXPECT_EQ(ToString(entries[0].second), "apple");
+  EXPECT_EQ(ToString(entries[1].first), "b");
+  EXPECT_EQ(ToString(entries[1].second), "banana");
+
+  // Everything lives in one file, next to the empty lock file.
+  size_t file_count = 0;
+  fml::VisitFiles(dir.fd(), [&file_count](const fml::UniqueFD& directory,
+                                          const std::string& filename) {
+    if (filename != ShaderCacheArchive::kLockFileName) {
+      EXPECT_EQ(filename, ShaderCacheArchive::kFileName);
+      file_count++;
+    }
+    return true;
+  });
+  EXPECT_EQ(file_count, 1u);
+}
+
+TEST(ShaderCacheArchive, LoadedValuesOutliveTheArchive) {
+  fml::ScopedTemporaryDirectory dir;
+  sk_sp<SkData> value;
+  {
+    ShaderCacheArchive archive(OpenDirectory(dir), false);
+    ASSERT_TRUE(archive.Store(*MakeData("key"), *MakeData("value")));
+    value = archive.Load(*MakeData("key"));
+    // Storing remaps the file, which must not affect loaded values.
+    ASSERT_TRUE(archive.Store(*MakeData("other"), *MakeData("other value")));
+  }
+  EXPECT_EQ(ToString(value), "value");
+}
+
+TEST(ShaderCacheArchive, CompactionDropsSupersededEntries) {
+  fml::ScopedTemporaryDirectory dir;
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  const std::string large(16 << 10, 'x');
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(
+        archive.Store(*MakeData("key"), *MakeData(large + std::to_string(i))));
+  }
+  ASSERT_TRUE(archive.Store(*MakeData("small"), *MakeData("value")));
+  EXPECT_TRUE(archive.NeedsCompaction());
+
+  sk_sp<SkData> before = archive.Load(*MakeData("key"));
+  const size_t size_before = archive.GetFileSize();
+  ASSERT_TRUE(archive.Compact());
+  EXPECT_FALSE(archive.NeedsCompaction());
+  EXPECT_LT(archive.GetFileSize(), size_before / 4);
+
+  EXPECT_EQ(ToString(before), large + "7");
+  EXPECT_EQ(ToString(archive.Load(*MakeData("key"))), large + "7");
+  EXPECT_EQ(ToString(archive.Load(*MakeData("small"))), "value");
+
+  // Stores after compaction append to the compacted file.
+  ASSERT_TRUE(archive.Store(*MakeData("new"), *MakeData("entry")));
+  ShaderCacheArchive reopened(OpenDirectory(dir), false);
+  EXPECT_EQ(reopened.GetEntryCount(), 3u);
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("key"))), large + "7");
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("new"))), "entry");
+}
+
+TEST(ShaderCacheArchive, CompactionDropsEntriesThatAreNotRetained) {
+  fml::ScopedTemporaryDirectory dir;
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  ASSERT_TRUE(archive.Store(*MakeData("kept"), *MakeData("value")));
+  ASSERT_TRUE(archive.Store(*MakeData("dropped"), *MakeData("value")));
+  const size_t size_before = archive.GetFileSize();
+  ASSERT_TRUE(archive.Compact(
+      [](const std::string& key) { return key == "kept"; }));
+  EXPECT_EQ(archive.GetFileSize(),
+            size_before - ShaderCacheArchive::GetRecordSize(7, 5));
+  EXPECT_EQ(ToString(archive.Load(*MakeData("kept"))), "value");
+  EXPECT_EQ(archive.Load(*MakeData("dropped")), nullptr);
+
+  ShaderCacheArchive reopened(OpenDirectory(dir), false);
+  EXPECT_EQ(reopened.GetEntryCount(), 1u);
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("kept"))), "value");
+}
+
+TEST(ShaderCacheArchive, KeepsEarliestFirstUseFrame) {
+  fml::ScopedTemporaryDirectory dir;
+  {
+    ShaderCacheArchive archive(OpenDirectory(dir), false);
+    ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData("apple"), 7));
+    ASSERT_TRUE(archive.Store(*MakeData("b"), *MakeData("banana")));
+    ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData("apricot"), 12));
+    EXPECT_EQ(archive.GetFirstUseFrame(*MakeData("a")), 7u);
+    ASSERT_TRUE(archive.Compact());
+  }
+
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  EXPECT_EQ(ToString(archive.Load(*MakeData("a"))), "apricot");
+  EXPECT_EQ(archive.GetFirstUseFrame(*MakeData("a")), 7u);
+  EXPECT_EQ(archive.GetFirstUseFrame(*MakeData("b")),
+            ShaderCacheArchive::kUnknownFirstUseFrame);
+  EXPECT_EQ(archive.GetFirstUseFrame(*MakeData("c")),
+            ShaderCacheArchive::kUnknownFirstUseFrame);
+}
+
+TEST(ShaderCacheArchive, PartlyWrittenRecordsAreDropped) {
+  fml::ScopedTemporaryDirectory dir;
+  size_t complete_size;
+  {
+    ShaderCacheArchive archive(OpenDirectory(dir), false);
+    ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData("apple")));
+    complete_size = archive.GetFileSize();
+    ASSERT_TRUE(archive.Store(*MakeData("b"), *MakeData("banana")));
+  }
+  {
+    // Simulate dying halfway through writing the second record.
+    auto file = fml::OpenFile(dir.fd(), ShaderCacheArchive::kFileName, false,
+                              fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(fml::TruncateFile(file, complete_size + 10));
+  }
+
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  EXPECT_EQ(archive.GetEntryCount(), 1u);
+  EXPECT_EQ(archive.GetFileSize(), complete_size);
+  EXPECT_EQ(ToString(archive.Load(*MakeData("a"))), "apple");
+  EXPECT_EQ(archive.Load(*MakeData("b")), nullptr);
+
+  ASSERT_TRUE(archive.Store(*MakeData("c"), *MakeData("cherry")));
+  ShaderCacheArchive reopened(OpenDirectory(dir), false);
+  EXPECT_EQ(reopened.GetEntryCount(), 2u);
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("c"))), "cherry");
+}
+
+TEST(ShaderCacheArchive, ImportsLegacyEntries) {
+  fml::ScopedTemporaryDirectory dir;
+  // "IE" is the Base32 encoding of "A".
+  ASSERT_TRUE(fml::WriteAtomically(dir.fd(), "IE",
+                                   fml::DataMapping(std::string("x"))));
+  ASSERT_TRUE(fml::WriteAtomically(dir.fd(), "shader_dump_1.skp",
+                                   fml::DataMapping(std::string("skp"))));
+
+  {
+    ShaderCacheArchive archive(OpenDirectory(dir), true);
+    EXPECT_EQ(ToString(archive.Load(*MakeData("A"))), "x");
+    EXPECT_FALSE(archive.Store(*MakeData("B"), *MakeData("y")));
+    // Read-only archives leave the directory untouched.
+    EXPECT_TRUE(fml::FileExists(dir.fd(), "IE"));
+    EXPECT_FALSE(fml::FileExists(dir.fd(), ShaderCacheArchive::kFileName));
+  }
+
+  {
+    ShaderCacheArchive archive(OpenDirectory(dir), false);
+    EXPECT_EQ(ToString(archive.Load(*MakeData("A"))), "x");
+    EXPECT_FALSE(fml::FileExists(dir.fd(), "IE"));
+    EXPECT_TRUE(fml::FileExists(dir.fd(), "shader_dump_1.skp"));
+  }
+
+  ShaderCacheArchive archive(OpenDirectory(dir), true);
+  EXPECT_EQ(ToString(archive.Load(*MakeData("A"))), "x");
+}
+
+TEST(ShaderCacheArchive, BacksOffAfterFailedCompaction) {
+  // Silence the error logged for the failed compaction.
+  fml::LogSettings fatal_only = {fml::LOG_FATAL};
+  fml::ScopedSetLogSettings scoped_set_log_settings(fatal_only);
+
+  fml::ScopedTemporaryDirectory dir;
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  const std::string value(40 * 1024, 'v');
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData(value)));
+  }
+  ASSERT_TRUE(archive.NeedsCompaction());
+
+  // The compacted file can't be written while a directory takes its
+  // temporary name.
+  const std::string temp_name =
+      std::string(ShaderCacheArchive::kFileName) + ".temp";
+  ASSERT_TRUE(fml::CreateDirectory(dir.fd(), {temp_name},
+                                   fml::FilePermission::kReadWrite)
+                  .is_valid());
+  EXPECT_FALSE(archive.Compact());
+  EXPECT_EQ(ToString(archive.Load(*MakeData("a"))), value);
+  EXPECT_FALSE(archive.NeedsCompaction());
+  ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData(value)));
+  EXPECT_FALSE(archive.NeedsCompaction());
+
+  // Once twice as many records were superseded, compaction is tried again.
+  ASSERT_TRUE(fml::UnlinkDirectory(dir.fd(), temp_name.c_str()));
+  ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData(value)));
+  ASSERT_TRUE(archive.NeedsCompaction());
+  EXPECT_TRUE(archive.Compact());
+  EXPECT_FALSE(archive.NeedsCompaction());
+  EXPECT_EQ(ToString(archive.Load(*MakeData("a"))), value);
+}
+
+TEST(ShaderCacheArchive, ArchivesSharingADirectoryKeepEachOthersEntries) {
+  // Each archive stands in for a process that uses the directory.
+  fml::ScopedTemporaryDirectory dir;
+  ShaderCacheArchive first(OpenDirectory(dir), false);
+  ShaderCacheArchive second(OpenDirectory(dir), false);
+  ASSERT_TRUE(first.Store(*MakeData("a"), *MakeData("apple")));
+  ASSERT_TRUE(second.Store(*MakeData("b"), *MakeData("banana")));
+  ASSERT_TRUE(first.Store(*MakeData("c"), *MakeData("cherry")));
+  // Each store picks up the records appended before it.
+  EXPECT_EQ(ToString(second.Load(*MakeData("a"))), "apple");
+  EXPECT_EQ(ToString(first.Load(*MakeData("b"))), "banana");
+
+  // A compaction by one keeps the records of the other, and the other
+  // appends to the compacted file.
+  ASSERT_TRUE(first.Store(*MakeData("a"), *MakeData("apricot")));
+  ASSERT_TRUE(second.Compact());
+  ASSERT_TRUE(first.Store(*MakeData("d"), *MakeData("date")));
+
+  ShaderCacheArchive reopened(OpenDirectory(dir), false);
+  EXPECT_EQ(reopened.GetEntryCount(), 4u);
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("a"))), "apricot");
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("b"))), "banana");
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("c"))), "cherry");
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("d"))), "date");
+  EXPECT_EQ(reopened.GetFileSize(), first.GetFileSize());
+}
+
+TEST(ShaderCacheArchive, ConcurrentStoresToASharedDirectoryAreKept) {
+  fml::ScopedTemporaryDirectory dir;
+  ShaderCacheArchive first(OpenDirectory(dir), false);
+  ShaderCacheArchive second(OpenDirectory(dir), false);
+  auto store = [](ShaderCacheArchive* archive, const std::string& prefix) {
+    for (int i = 0; i < 100; i++) {
+      ASSERT_TRUE(archive->Store(*MakeData(prefix + std::to_string(i)),
+                                 *MakeData("value")));
+    }
+  };
+  std::thread first_thread(store, &first, "first");
+  std::thread second_thread(store, &second, "second");
+  first_thread.join();
+  second_thread.join();
+
+  ShaderCacheArchive reopened(OpenDirectory(dir), false);
+  EXPECT_EQ(reopened.GetEntryCount(), 200u);
+}
+
+TEST(ShaderCacheArchive, ClearForgetsEntries) {
+  fml::ScopedTemporaryDirectory dir;
+  ShaderCacheArchive archive(OpenDirectory(dir), false);
+  ASSERT_TRUE(archive.Store(*MakeData("a"), *MakeData("apple")));
+  ASSERT_TRUE(fml::RemoveFilesInDirectory(dir.fd()));
+  archive.Clear();
+  EXPECT_EQ(archive.GetEntryCount(), 0u);
+  EXPECT_EQ(archive.Load(*MakeData("a")), nullptr);
+
+  ASSERT_TRUE(archive.Store(*MakeData("b"), *MakeData("banana")));
+  ShaderCacheArchive reopened(OpenDirectory(dir), false);
+  EXPECT_EQ(reopened.GetEntryCount(), 1u);
+  EXPECT_EQ(ToString(reopened.Load(*MakeData("b"))), "banana");
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,86 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shader_precompiler.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+ShaderPrecompiler::ShaderPrecompiler(
+    std::vector<PersistentCache::SkSLEntry> shaders,
+    CompileCallback compile)
+    : shaders_(std::move(shaders)), compile_(std::move(compile)) {
+  std::stable_sort(shaders_.begin(), shaders_.end(),
+                   [](const PersistentCache::SkSLEntry& a,
+                      const PersistentCache::SkSLEntry& b) {
+                     return a.first_use_frame < b.first_use_frame;
+                   });
+  progress_.total = shaders_.size();
+  if (!shaders_.empty()) {
+    TRACE_EVENT_ASYNC_BEGIN0("flutter", "ShaderPrecompiler", this);
+  }
+}
+
+ShaderPrecompiler::~ShaderPrecompiler() {
+  if (!IsDone()) {
+    TRACE_EVENT_ASYNC_END0("flutter", "ShaderPrecompiler", this);
+  }
+}
+
+bool ShaderPrecompiler::IsDone() const {
+  return next_ == shaders_.size();
+}
+
+void ShaderPrecompiler::CompileNext() {
+  PersistentCache::SkSLEntry& entry = shaders_[next_++];
+  if (compile_(*entry.shader.first, *entry.shader.second)) {
+    progress_.compiled++;
+  } else {
+    progress_.failed++;
+  }
+  // Compiled shaders live in the context, so the SkSL isn't needed anymore.
+  entry.shader = {};
+}
+
+void ShaderPrecompiler::CompileShadersUsedBy(uint32_t frame_index) {
+  if (IsDone() || shaders_[next_].first_use_frame > frame_index) {
+    return;
+  }
+  TRACE_EVENT1("flutter", "ShaderPrecompiler::CompileShadersUsedBy", "frame",
+               std::to_string(frame_index).c_str());
+  while (!IsDone() && shaders_[next_].first_use_frame <= frame_index) {
+    CompileNext();
+  }
+  TraceProgress();
+}
+
+bool ShaderPrecompiler::CompileBatch(fml::TimePoint deadline) {
+  if (IsDone()) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "ShaderPrecompiler::CompileBatch");
+  do {
+    CompileNext();
+  } while (!IsDone() && fml::TimePoint::Now() < deadline);
+  TraceProgress();
+  return !IsDone();
+}
+
+void ShaderPrecompiler::TraceProgress() const {
+  FML_TRACE_COUNTER("flutter", "ShaderPrecompiler",
+                    reinterpret_cast<int64_t>(this), "Compiled",
+                    progress_.compiled, "Failed", progress_.failed,
+                    "Remaining", progress_.GetRemaining());
+  if (IsDone()) {
+    TRACE_EVENT_ASYNC_END0("flutter", "ShaderPrecompiler", this);
+    FML_LOG(INFO) << "Found " << progress_.total
+                  << " SkSL shaders; precompiled " << progress_.compiled;
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,76 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_SHADER_PRECOMPILER_H_
+#define FLUTTER_SHELL_COMMON_SHADER_PRECOMPILER_H_
+
+#include <functional>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_point.h"
+#include "flutter/shell/common/persistent_cache.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Compiles the SkSL shaders of the persistent cache ahead of their first use.
+///
+/// Shaders are compiled in the order of the frame they were first used in.
+/// Before each frame, the rasterizer compiles the shaders that frame used in
+/// earlier runs, since the frame would otherwise compile them while drawing.
+/// The other shaders are compiled in batches between frames, each of which
+/// stops once its deadline passes.
+///
+/// This class is not thread safe. It is used on the thread of the context
+/// the shaders are compiled for, which the caller makes current.
+///
+class ShaderPrecompiler {
+ public:
+  /// Compiles a shader into the program cache of a context. Returns false if
+  /// the shader could not be compiled.
+  using CompileCallback =
+      std::function<bool(const SkData& key, const SkData& sksl)>;
+
+  struct Progress {
+    size_t total = 0;
+    size_t compiled = 0;
+    size_t failed = 0;
+
+    size_t GetRemaining() const { return total - compiled - failed; }
+  };
+
+  ShaderPrecompiler(std::vector<PersistentCache::SkSLEntry> shaders,
+                    CompileCallback compile);
+
+  ~ShaderPrecompiler();
+
+  bool IsDone() const;
+
+  const Progress& GetProgress() const { return progress_; }
+
+  /// Compiles the remaining shaders that were first used in a frame up to and
+  /// including |frame_index|.
+  void CompileShadersUsedBy(uint32_t frame_index);
+
+  /// Compiles remaining shaders in order until |deadline| passes, but at least
+  /// one. Returns whether shaders remain.
+  bool CompileBatch(fml::TimePoint deadline);
+
+ private:
+  std::vector<PersistentCache::SkSLEntry> shaders_;
+  const CompileCallback compile_;
+  size_t next_ = 0;
+  Progress progress_;
+
+  void CompileNext();
+
+  void TraceProgress() const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ShaderPrecompiler);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_SHADER_PRECOMPILER_H_
@@ -0,0 +1,129 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shader_precompiler.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+PersistentCache::SkSLEntry MakeEntry(const std::string& key,
+                                     uint32_t first_use_frame) {
+  return {{SkData::MakeWithCopy(key.data(), key.size()),
+           SkData::MakeWithCopy(key.data(), key.size())},
+          first_use_frame};
+}
+
+class RecordingCompiler {
+ public:
+  ShaderPrecompiler::CompileCallback GetCallback() {
+    return [this](const SkData& key, const SkData& sksl) {
+      compiled_.emplace_back(reinterpret_cast<const char*>(key.bytes()),
+                             key.size());
+      return compiled_.back() != failing_key_;
+    };
+  }
+
+  void SetFailingKey(std::string key) { failing_key_ = std::move(key); }
+
+  const std::vector<std::string>& compiled() const { return compiled_; }
+
+ private:
+  std::vector<std::string> compiled_;
+  std::string failing_key_;
+};
+
+constexpr uint32_t kUnknown = ShaderCacheArchive::kUnknownFirstUseFrame;
+
+}  // namespace
+
+TEST(ShaderPrecompiler, CompilesInFirstUseOrder) {
+  RecordingCompiler compiler;
+  ShaderPrecompiler precompiler(
+      {MakeEntry("late", 30), MakeEntry("unknown", kUnknown),
+       MakeEntry("first", 0), MakeEntry("early", 2)},
+      compiler.GetCallback());
+  EXPECT_FALSE(precompiler.IsDone());
+
+  const fml::TimePoint far_future =
+      fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(60);
+  EXPECT_FALSE(precompiler.CompileBatch(far_future));
+  EXPECT_TRUE(precompiler.IsDone());
+  EXPECT_EQ(compiler.compiled(),
+            (std::vector<std::string>{"first", "early", "late", "unknown"}));
+}
+
+TEST(ShaderPrecompiler, CompilesShadersUsedByFrame) {
+  RecordingCompiler compiler;
+  ShaderPrecompiler precompiler(
+      {MakeEntry("a", 0), MakeEntry("b", 0), MakeEntry("c", 1),
+       MakeEntry("d", 4), MakeEntry("e", kUnknown)},
+      compiler.GetCallback());
+
+  precompiler.CompileShadersUsedBy(0);
+  EXPECT_EQ(compiler.compiled(), (std::vector<std::string>{"a", "b"}));
+
+  precompiler.CompileShadersUsedBy(3);
+  EXPECT_EQ(compiler.compiled(), (std::vector<std::string>{"a", "b", "c"}));
+
+  // Shaders whose first use is unknown are left for batches.
+  precompiler.CompileShadersUsedBy(1000);
+  EXPECT_EQ(compiler.compiled().size(), 4u);
+  EXPECT_FALSE(precompiler.IsDone());
+  EXPECT_EQ(precompiler.GetProgress().GetRemaining(), 1u);
+}
+
+TEST(ShaderPrecompiler, BatchCompilesAtLeastOneShader) {
+  RecordingCompiler compiler;
+  ShaderPrecompiler precompiler(
+      {MakeEntry("a", 0), MakeEntry("b", 1), MakeEntry("c", 2)},
+      compiler.GetCallback());
+
+  // A deadline in the past still makes progress.
+  const fml::TimePoint past = fml::TimePoint::Now();
+  EXPECT_TRUE(precompiler.CompileBatch(past));
+  EXPECT_EQ(compiler.compiled(), (std::vector<std::string>{"a"}));
+  EXPECT_TRUE(precompiler.CompileBatch(past));
+  EXPECT_FALSE(precompiler.CompileBatch(past));
+  EXPECT_TRUE(precompiler.IsDone());
+  EXPECT_FALSE(precompiler.CompileBatch(past));
+  EXPECT_EQ(compiler.compiled().size(), 3u);
+}
+
+TEST(ShaderPrecompiler, ReportsProgress) {
+  RecordingCompiler compiler;
+  compiler.SetFailingKey("b");
+  ShaderPrecompiler precompiler(
+      {MakeEntry("a", 0), MakeEntry("b", 0), MakeEntry("c", kUnknown)},
+      compiler.GetCallback());
+  EXPECT_EQ(precompiler.GetProgress().total, 3u);
+  EXPECT_EQ(precompiler.GetProgress().GetRemaining(), 3u);
+
+  precompiler.CompileShadersUsedBy(0);
+  EXPECT_EQ(precompiler.GetProgress().compiled, 1u);
+  EXPECT_EQ(precompiler.GetProgress().failed, 1u);
+  EXPECT_EQ(precompiler.GetProgress().GetRemaining(), 1u);
+
+  precompiler.CompileBatch(fml::TimePoint::Now());
+  EXPECT_EQ(precompiler.GetProgress().compiled, 2u);
+  EXPECT_EQ(precompiler.GetProgress().GetRemaining(), 0u);
+}
+
+TEST(ShaderPrecompiler, NothingToCompile) {
+  RecordingCompiler compiler;
+  ShaderPrecompiler precompiler({}, compiler.GetCallback());
+  EXPECT_TRUE(precompiler.IsDone());
+  precompiler.CompileShadersUsedBy(0);
+  EXPECT_FALSE(precompiler.CompileBatch(fml::TimePoint::Now()));
+  EXPECT_TRUE(compiler.compiled().empty());
+}
+
+}  // namespace testing
+}  // namespace flutter
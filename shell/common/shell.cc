@@ -6,6 +6,7 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <cstdlib>
 #include <memory>
 #include <sstream>
 #include <vector>
@@ -23,15 +24,19 @@
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/shell/common/engine.h"
 #include "flutter/shell/common/persistent_cache.h"
+#include "flutter/shell/common/persistent_shaping_cache.h"
 #include "flutter/shell/common/skia_event_tracer_impl.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/common/vsync_waiter.h"
+#include "minikin/FontFamily.h"
+#include "minikin/Layout.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 #include "third_party/skia/include/core/SkGraphics.h"
 #include "third_party/skia/include/utils/SkBase64.h"
 #include "third_party/tonic/common/log.h"
+#include "txt/platform.h"
 
 namespace flutter {
 
@@ -47,15 +52,55 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     Settings settings,
     fml::RefPtr<const DartSnapshot> isolate_snapshot,
     const Shell::CreateCallback<PlatformView>& on_create_platform_view,
-    const Shell::CreateCallback<Rasterizer>& on_create_rasterizer) {
+    const Shell::CreateCallback<Rasterizer>& on_create_rasterizer,
+    const Shell* spawning_shell) {
   if (!task_runners.IsValid()) {
     FML_LOG(ERROR) << "Task runners to run the shell were invalid.";
     return nullptr;
   }
 
+  const fml::TimePoint startup_start = fml::TimePoint::Now();
   auto shell =
       std::unique_ptr<Shell>(new Shell(std::move(vm), task_runners, settings));
 
+  // The subsystems are created concurrently on their threads. Their only
+  // dependencies are:
+  //
+  //   * The resource context, which is created by the platform view.
+  //   * The engine, which refers to the IO manager, the rasterizer and the
+  //     vsync waiter of the platform view.
+  //   * The default font manager, which must be set up on the UI thread after
+  //     the engine is created.
+  //
+  // Stages that don't have dependencies start right away. Stages that do have
+  // dependencies wait only for what they need.
+  //
+  // A spawned shell shares the IO manager, the font collection and the
+  // isolate group of the shell it is spawned from, so it only creates the
+  // platform view, the rasterizer and the engine.
+  StartupStageTimings& timings = shell->startup_stage_timings_;
+
+  std::future<DefaultFontManager> default_font_manager_future;
+  if (spawning_shell) {
+    // The IO manager checks this switch before touching the GPU.
+    shell->is_gpu_disabled_sync_switch_ =
+        spawning_shell->is_gpu_disabled_sync_switch_;
+  } else {
+    // Enumerating the system fonts is slow and doesn't depend on anything, so
+    // do it on a worker while the other subsystems are created.
+    auto default_font_manager_promise =
+        std::make_shared<std::promise<DefaultFontManager>>();
+    default_font_manager_future = default_font_manager_promise->get_future();
+    shell->GetDartVM()->GetConcurrentWorkerTaskRunner()->PostTask(
+        [default_font_manager_promise]() {
+          TRACE_EVENT0("flutter", "ShellSetupDefaultFontManager");
+          const fml::TimePoint start = fml::TimePoint::Now();
+          sk_sp<SkFontMgr> font_manager = txt::GetDefaultFontManager();
+          default_font_manager_promise->set_value(
+              {std::move(font_manager), fml::TimePoint::Now() - start});
+        });
+  }
+
   // Create the rasterizer on the raster thread.
   std::promise<std::unique_ptr<Rasterizer>> rasterizer_promise;
   auto rasterizer_future = rasterizer_promise.get_future();
@@ -64,16 +109,20 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   fml::TaskRunner::RunNowOrPostTask(
       task_runners.GetRasterTaskRunner(), [&rasterizer_promise,  //
                                            &snapshot_delegate_promise,
+                                           &timings,              //
                                            on_create_rasterizer,  //
                                            shell = shell.get()    //
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupGPUSubsystem");
+        const fml::TimePoint start = fml::TimePoint::Now();
         std::unique_ptr<Rasterizer> rasterizer(on_create_rasterizer(*shell));
+        timings.rasterizer = fml::TimePoint::Now() - start;
         snapshot_delegate_promise.set_value(rasterizer->GetSnapshotDelegate());
         rasterizer_promise.set_value(std::move(rasterizer));
       });
 
   // Create the platform view on the platform thread (this thread).
+  const fml::TimePoint platform_view_start = fml::TimePoint::Now();
   auto platform_view = on_create_platform_view(*shell.get());
   if (!platform_view || !platform_view->GetWeakPtr()) {
     return nullptr;
@@ -85,12 +134,14 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   if (!vsync_waiter) {
     return nullptr;
   }
+  timings.platform_view = fml::TimePoint::Now() - platform_view_start;
 
   // Create the IO manager on the IO thread. The IO manager must be initialized
   // first because it has state that the other subsystems depend on. It must
   // first be booted and the necessary references obtained to initialize the
-  // other subsystems.
-  std::promise<std::unique_ptr<ShellIOManager>> io_manager_promise;
+  // other subsystems. Those references are handed out before the resource
+  // context is created, so that the engine can be created meanwhile.
+  std::promise<std::shared_ptr<ShellIOManager>> io_manager_promise;
   auto io_manager_future = io_manager_promise.get_future();
   std::promise<fml::WeakPtr<ShellIOManager>> weak_io_manager_promise;
   auto weak_io_manager_future = weak_io_manager_promise.get_future();
@@ -106,19 +157,41 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   // https://github.com/flutter/flutter/issues/42948
   fml::TaskRunner::RunNowOrPostTask(
       io_task_runner,
-      [&io_manager_promise,                                               //
-       &weak_io_manager_promise,                                          //
-       &unref_queue_promise,                                              //
-       platform_view = platform_view->GetWeakPtr(),                       //
-       io_task_runner,                                                    //
-       is_backgrounded_sync_switch = shell->GetIsGpuDisabledSyncSwitch()  //
+      [&io_manager_promise,                                                //
+       &weak_io_manager_promise,                                           //
+       &unref_queue_promise,                                               //
+       &timings,                                                           //
+       platform_view = platform_view->GetWeakPtr(),                        //
+       io_task_runner,                                                     //
+       is_backgrounded_sync_switch = shell->GetIsGpuDisabledSyncSwitch(),  //
+       spawning_io_manager =                                               //
+           spawning_shell ? spawning_shell->io_manager_ : nullptr          //
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupIOSubsystem");
-        auto io_manager = std::make_unique<ShellIOManager>(
-            platform_view.getUnsafe()->CreateResourceContext(),
-            is_backgrounded_sync_switch, io_task_runner);
+        if (spawning_io_manager) {
+          weak_io_manager_promise.set_value(spawning_io_manager->GetWeakPtr());
+          unref_queue_promise.set_value(
+              spawning_io_manager->GetSkiaUnrefQueue());
+          io_manager_promise.set_value(spawning_io_manager);
+          return;
+        }
+        const fml::TimePoint start = fml::TimePoint::Now();
+        auto io_manager = std::make_shared<ShellIOManager>(
+            nullptr, is_backgrounded_sync_switch, io_task_runner);
         weak_io_manager_promise.set_value(io_manager->GetWeakPtr());
         unref_queue_promise.set_value(io_manager->GetSkiaUnrefQueue());
+        auto resource_context =
+            platform_view.getUnsafe()->CreateResourceContext();
+        if (!resource_context) {
+#ifndef OS_FUCHSIA
+          FML_DLOG(WARNING)
+              << "The IO manager was initialized without a resource "
+                 "context. Async texture uploads will be disabled. "
+                 "Expect performance degradation.";
+#endif  // OS_FUCHSIA
+        }
+        io_manager->NotifyResourceContextAvailable(std::move(resource_context));
+        timings.io_manager = fml::TimePoint::Now() - start;
         io_manager_promise.set_value(std::move(io_manager));
       });
 
@@ -135,42 +208,66 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
                          shell = shell.get(),                             //
                          &dispatcher_maker,                               //
                          &platform_data,                                  //
+                         &timings,                                        //
                          isolate_snapshot = std::move(isolate_snapshot),  //
                          vsync_waiter = std::move(vsync_waiter),          //
                          &weak_io_manager_future,                         //
                          &snapshot_delegate_future,                       //
-                         &unref_queue_future                              //
+                         &unref_queue_future,                             //
+                         spawning_shell                                   //
   ]() mutable {
         TRACE_EVENT0("flutter", "ShellSetupUISubsystem");
         const auto& task_runners = shell->GetTaskRunners();
+        auto io_manager = weak_io_manager_future.get();
+        auto unref_queue = unref_queue_future.get();
+        auto snapshot_delegate = snapshot_delegate_future.get();
+        const fml::TimePoint start = fml::TimePoint::Now();
 
         // The animator is owned by the UI thread but it gets its vsync pulses
         // from the platform.
         auto animator = std::make_unique<Animator>(*shell, task_runners,
                                                    std::move(vsync_waiter));
 
+        if (spawning_shell) {
+          engine_promise.set_value(spawning_shell->engine_->Spawn(
+              *shell,                        //
+              dispatcher_maker,              //
+              platform_data,                 //
+              shell->GetSettings(),          //
+              std::move(animator),           //
+              std::move(io_manager),         //
+              std::move(unref_queue),        //
+              std::move(snapshot_delegate)   //
+              ));
+          timings.engine = fml::TimePoint::Now() - start;
+          return;
+        }
+
         engine_promise.set_value(std::make_unique<Engine>(
-            *shell,                         //
-            dispatcher_maker,               //
-            *shell->GetDartVM(),            //
-            std::move(isolate_snapshot),    //
-            task_runners,                   //
-            platform_data,                  //
-            shell->GetSettings(),           //
-            std::move(animator),            //
-            weak_io_manager_future.get(),   //
-            unref_queue_future.get(),       //
-            snapshot_delegate_future.get()  //
+            *shell,                        //
+            dispatcher_maker,              //
+            *shell->GetDartVM(),           //
+            std::move(isolate_snapshot),   //
+            task_runners,                  //
+            platform_data,                 //
+            shell->GetSettings(),          //
+            std::move(animator),           //
+            std::move(io_manager),         //
+            std::move(unref_queue),        //
+            std::move(snapshot_delegate)   //
             ));
+        timings.engine = fml::TimePoint::Now() - start;
       }));
 
-  if (!shell->Setup(std::move(platform_view),  //
-                    engine_future.get(),       //
-                    rasterizer_future.get(),   //
-                    io_manager_future.get())   //
+  if (!shell->Setup(std::move(platform_view),                //
+                    engine_future.get(),                     //
+                    rasterizer_future.get(),                 //
+                    io_manager_future.get(),                 //
+                    std::move(default_font_manager_future))  //
   ) {
     return nullptr;
   }
+  timings.total = fml::TimePoint::Now() - startup_start;
 
   return shell;
 }
@@ -314,7 +411,8 @@ std::unique_ptr<Shell> Shell::Create(
                                             settings,                     //
                                             std::move(isolate_snapshot),  //
                                             on_create_platform_view,      //
-                                            on_create_rasterizer          //
+                                            on_create_rasterizer,         //
+                                            /*spawning_shell=*/nullptr    //
         );
         latch.Signal();
       }));
@@ -327,6 +425,7 @@ Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
       settings_(std::move(settings)),
       vm_(std::move(vm)),
       is_gpu_disabled_sync_switch_(new fml::SyncSwitch()),
+      memory_accounting_(std::make_shared<MemoryAccounting>()),
       weak_factory_gpu_(nullptr),
       weak_factory_(this) {
   FML_CHECK(vm_) << "Must have access to VM to create a shell.";
@@ -375,11 +474,30 @@ Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
       task_runners_.GetIOTaskRunner(),
       std::bind(&Shell::OnServiceProtocolGetSkSLs, this, std::placeholders::_1,
                 std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetSkSLPrecompileProgressExtensionName] = {
+          task_runners_.GetRasterTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetSkSLPrecompileProgress, this,
+                    std::placeholders::_1, std::placeholders::_2)};
   service_protocol_handlers_
       [ServiceProtocol::kEstimateRasterCacheMemoryExtensionName] = {
           task_runners_.GetRasterTaskRunner(),
           std::bind(&Shell::OnServiceProtocolEstimateRasterCacheMemory, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  // The memory accounting is thread safe, so these don't need to wait for a
+  // busy UI or raster thread.
+  service_protocol_handlers_[ServiceProtocol::kGetMemoryUsageExtensionName] = {
+      task_runners_.GetIOTaskRunner(),
+      std::bind(&Shell::OnServiceProtocolGetMemoryUsage, this,
+                std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_[ServiceProtocol::kSetMemoryBudgetExtensionName] =
+      {task_runners_.GetIOTaskRunner(),
+       std::bind(&Shell::OnServiceProtocolSetMemoryBudget, this,
+                 std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_[ServiceProtocol::kPurgeMemoryExtensionName] = {
+      task_runners_.GetIOTaskRunner(),
+      std::bind(&Shell::OnServiceProtocolPurgeMemory, this,
+                std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -413,8 +531,12 @@ Shell::~Shell() {
       fml::MakeCopyable([io_manager = std::move(io_manager_),
                          platform_view = platform_view_.get(),
                          &io_latch]() mutable {
+        // Shells spawned from this one may still use the IO manager and its
+        // resource context. The IO manager is only ever released on the IO
+        // thread, so this is the last reference if it is unique here.
+        const bool is_last_io_manager_reference = io_manager.use_count() == 1;
         io_manager.reset();
-        if (platform_view) {
+        if (platform_view && is_last_io_manager_reference) {
           platform_view->ReleaseResourceContext();
         }
         io_latch.Signal();
@@ -435,6 +557,34 @@ Shell::~Shell() {
   platform_latch.Wait();
 }
 
+std::unique_ptr<Shell> Shell::Spawn(
+    RunConfiguration run_configuration,
+    const CreateCallback<PlatformView>& on_create_platform_view,
+    const CreateCallback<Rasterizer>& on_create_rasterizer) const {
+  TRACE_EVENT0("flutter", "Shell::Spawn");
+  FML_DCHECK(is_setup_);
+  FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
+
+  auto vm = DartVMRef::Create(settings_);
+  FML_CHECK(vm) << "The VM of a running shell must be available.";
+  auto isolate_snapshot = vm->GetVMData()->GetIsolateSnapshot();
+  std::unique_ptr<Shell> result =
+      CreateShellOnPlatformThread(std::move(vm),                //
+                                  task_runners_,                //
+                                  PlatformData{},               //
+                                  settings_,                    //
+                                  std::move(isolate_snapshot),  //
+                                  on_create_platform_view,      //
+                                  on_create_rasterizer,         //
+                                  this                          //
+      );
+  if (!result) {
+    return nullptr;
+  }
+  result->RunEngine(std::move(run_configuration));
+  return result;
+}
+
 void Shell::NotifyLowMemoryWarning() const {
   auto trace_id = fml::tracing::TraceNonce();
   TRACE_EVENT_ASYNC_BEGIN0("flutter", "Shell::NotifyLowMemoryWarning",
@@ -445,6 +595,10 @@ void Shell::NotifyLowMemoryWarning() const {
   // running.
   ::Dart_NotifyLowMemory();
 
+  if (auto decoded_image_cache = decoded_image_cache_.lock()) {
+    decoded_image_cache->Purge();
+  }
+
   task_runners_.GetRasterTaskRunner()->PostTask(
       [rasterizer = rasterizer_->GetWeakPtr(), trace_id = trace_id]() {
         if (rasterizer) {
@@ -532,7 +686,8 @@ bool Shell::IsSetup() const {
 bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
                   std::unique_ptr<Engine> engine,
                   std::unique_ptr<Rasterizer> rasterizer,
-                  std::unique_ptr<ShellIOManager> io_manager) {
+                  std::shared_ptr<ShellIOManager> io_manager,
+                  std::future<DefaultFontManager> default_font_manager) {
   if (is_setup_) {
     return false;
   }
@@ -551,14 +706,39 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
   weak_engine_ = engine_->GetWeakPtr();
   weak_rasterizer_ = rasterizer_->GetWeakPtr();
   weak_platform_view_ = platform_view_->GetWeakPtr();
+  decoded_image_cache_ = engine_->GetDecodedImageCache();
+
+  // Images referenced from Dart are freed by finalizers once Dart no longer
+  // references them, so the best the engine can do under pressure is to drop
+  // the images only the decoded image cache holds on to and ask the VM to
+  // collect garbage. This affects all isolates in the VM.
+  memory_accounting_->SetHandler(
+      MemoryCategory::kImages,
+      {nullptr, [cache = decoded_image_cache_](size_t target_bytes) {
+         if (auto decoded_image_cache = cache.lock()) {
+           decoded_image_cache->Purge(target_bytes);
+         }
+         ::Dart_NotifyLowMemory();
+       }});
 
   // Setup the time-consuming default font manager right after engine created.
-  fml::TaskRunner::RunNowOrPostTask(task_runners_.GetUITaskRunner(),
-                                    [engine = weak_engine_] {
-                                      if (engine) {
-                                        engine->SetupDefaultFontManager();
-                                      }
-                                    });
+  // Tasks posted to the UI task runner later, like running the isolate, can
+  // rely on it being set up. The engine goes away before the shell, so the
+  // shell is alive as long as the engine is. Spawned shells don't have one
+  // because the font collection they share is set up already.
+  if (default_font_manager.valid()) {
+    fml::TaskRunner::RunNowOrPostTask(
+        task_runners_.GetUITaskRunner(),
+        fml::MakeCopyable([this, engine = weak_engine_,
+                           default_font_manager =
+                               std::move(default_font_manager)]() mutable {
+          if (engine) {
+            DefaultFontManager result = default_font_manager.get();
+            engine->SetupDefaultFontManager(std::move(result.font_manager));
+            startup_stage_timings_.font_manager = result.creation_time;
+          }
+        }));
+  }
 
   is_setup_ = true;
 
@@ -574,6 +754,14 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
     PersistentCache::GetCacheForProcess()->Purge();
   }
 
+  if (settings_.persistent_shaping_cache) {
+    // The store is shared by the shells of the process and outlives this one.
+    auto shaping_cache =
+        PersistentCache::GetCacheForProcess()->GetShapingCache();
+    minikin::Layout::setPersistentStore(shaping_cache);
+    minikin::FontFamily::setPersistentStore(shaping_cache);
+  }
+
   // TODO(gw280): The WeakPtr here asserts that we are derefing it on the
   // same thread as it was created on. Shell is constructed on the platform
   // thread but we need to call into the Engine on the UI thread, so we need
@@ -593,6 +781,10 @@ const TaskRunners& Shell::GetTaskRunners() const {
   return task_runners_;
 }
 
+const Shell::StartupStageTimings& Shell::GetStartupStageTimings() const {
+  return startup_stage_timings_;
+}
+
 fml::TaskRunnerAffineWeakPtr<Rasterizer> Shell::GetRasterizer() const {
   FML_DCHECK(is_setup_);
   return weak_rasterizer_;
@@ -1099,7 +1291,8 @@ void Shell::HandleEngineSkiaMessage(fml::RefPtr<PlatformMessage> message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return;
   auto root = document.GetObject();
@@ -1264,6 +1457,18 @@ fml::TimePoint Shell::GetLatestFrameTargetTime() const {
   return latest_frame_target_time_.value();
 }
 
+// |Rasterizer::Delegate|
+std::shared_ptr<fml::ConcurrentTaskRunner>
+Shell::GetConcurrentWorkerTaskRunner() {
+  return vm_->GetConcurrentWorkerTaskRunner();
+}
+
+// |Engine::Delegate|
+// |Rasterizer::Delegate|
+std::shared_ptr<MemoryAccounting> Shell::GetMemoryAccounting() {
+  return memory_accounting_;
+}
+
 // |ServiceProtocol::Handler|
 fml::RefPtr<fml::TaskRunner> Shell::GetServiceProtocolHandlerTaskRunner(
     std::string_view method) const {
@@ -1455,9 +1660,12 @@ bool Shell::OnServiceProtocolGetSkSLs(
   response->AddMember("type", "GetSkSLs", response->GetAllocator());
 
   rapidjson::Value shaders_json(rapidjson::kObjectType);
+  rapidjson::Value frames_json(rapidjson::kObjectType);
   PersistentCache* persistent_cache = PersistentCache::GetCacheForProcess();
-  std::vector<PersistentCache::SkSLCache> sksls = persistent_cache->LoadSkSLs();
-  for (const auto& sksl : sksls) {
+  std::vector<PersistentCache::SkSLEntry> entries =
+      persistent_cache->LoadSkSLEntries();
+  for (const auto& entry : entries) {
+    const PersistentCache::SkSLCache& sksl = entry.shader;
     size_t b64_size =
         SkBase64::Encode(sksl.second->data(), sksl.second->size(), nullptr);
     sk_sp<SkData> b64_data = SkData::MakeUninitialized(b64_size + 1);
@@ -1465,11 +1673,35 @@ bool Shell::OnServiceProtocolGetSkSLs(
     SkBase64::Encode(sksl.second->data(), sksl.second->size(), b64_char);
     b64_char[b64_size] = 0;  // make it null terminated for printing
     rapidjson::Value shader_value(b64_char, response->GetAllocator());
-    rapidjson::Value shader_key(PersistentCache::SkKeyToFilePath(*sksl.first),
-                                response->GetAllocator());
+    const std::string key = PersistentCache::SkKeyToFilePath(*sksl.first);
+    rapidjson::Value shader_key(key, response->GetAllocator());
+    if (entry.first_use_frame != ShaderCacheArchive::kUnknownFirstUseFrame) {
+      rapidjson::Value frame_key(key, response->GetAllocator());
+      frames_json.AddMember(frame_key,
+                            rapidjson::Value(entry.first_use_frame),
+                            response->GetAllocator());
+    }
     shaders_json.AddMember(shader_key, shader_value, response->GetAllocator());
   }
   response->AddMember("SkSLs", shaders_json, response->GetAllocator());
+  response->AddMember("firstUseFrames", frames_json, response->GetAllocator());
+  return true;
+}
+
+bool Shell::OnServiceProtocolGetSkSLPrecompileProgress(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetRasterTaskRunner()->RunsTasksOnCurrentThread());
+  const ShaderPrecompiler::Progress progress =
+      rasterizer_->GetShaderPrecompileProgress();
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "SkSLPrecompileProgress", allocator);
+  response->AddMember<uint64_t>("total", progress.total, allocator);
+  response->AddMember<uint64_t>("compiled", progress.compiled, allocator);
+  response->AddMember<uint64_t>("failed", progress.failed, allocator);
+  response->AddMember<uint64_t>("remaining", progress.GetRemaining(),
+                                allocator);
   return true;
 }
 
@@ -1487,6 +1719,135 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   response->AddMember<uint64_t>("pictureBytes",
                                 raster_cache.EstimatePictureCacheByteSize(),
                                 response->GetAllocator());
+  response->AddMember<uint64_t>("maxBytes", raster_cache.max_bytes(),
+                                response->GetAllocator());
+  const auto& metrics = raster_cache.metrics();
+  response->AddMember<uint64_t>("hitCount", metrics.hit_count,
+                                response->GetAllocator());
+  response->AddMember<uint64_t>("missCount", metrics.miss_count,
+                                response->GetAllocator());
+  response->AddMember<uint64_t>("evictionCount", metrics.eviction_count,
+                                response->GetAllocator());
+  return true;
+}
+
+// Parses the memory category named by the 'category' parameter, or sets a
+// parameter error on |response|.
+static std::optional<MemoryCategory> GetMemoryCategoryParameter(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  if (params.count("category") == 0) {
+    ServiceProtocolParameterError(response, "'category' parameter is missing.");
+    return std::nullopt;
+  }
+  auto category =
+      MemoryCategoryFromString(std::string{params.at("category")});
+  if (!category) {
+    ServiceProtocolParameterError(response,
+                                  "'category' parameter is not a known "
+                                  "memory category.");
+  }
+  return category;
+}
+
+// Parses a parameter holding a number of bytes, or sets a parameter error on
+// |response|.
+static std::optional<size_t> GetBytesParameter(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    std::string_view name,
+    rapidjson::Document* response) {
+  const std::string value{params.at(name)};
+  if (value.empty() ||
+      value.find_first_not_of("0123456789") != std::string::npos) {
+    ServiceProtocolParameterError(
+        response, "'" + std::string{name} + "' parameter is not a number.");
+    return std::nullopt;
+  }
+  return static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+}
+
+static void AddMemoryUsage(const MemoryAccounting::Usage& usage,
+                           rapidjson::Value& value,
+                           rapidjson::Document::AllocatorType& allocator) {
+  value.AddMember("category",
+                  rapidjson::StringRef(MemoryCategoryToString(usage.category)),
+                  allocator);
+  value.AddMember<uint64_t>("bytes", usage.bytes, allocator);
+  if (usage.budget) {
+    value.AddMember<uint64_t>("budget", usage.budget.value(), allocator);
+  }
+}
+
+bool Shell::OnServiceProtocolGetMemoryUsage(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "MemoryUsage", allocator);
+
+  size_t total_bytes = 0;
+  rapidjson::Value categories(rapidjson::kArrayType);
+  for (const auto& usage : memory_accounting_->GetAllUsage()) {
+    rapidjson::Value category(rapidjson::kObjectType);
+    AddMemoryUsage(usage, category, allocator);
+    categories.PushBack(category, allocator);
+    total_bytes += usage.bytes;
+  }
+  response->AddMember("categories", categories, allocator);
+  response->AddMember<uint64_t>("totalBytes", total_bytes, allocator);
+  return true;
+}
+
+bool Shell::OnServiceProtocolSetMemoryBudget(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  auto category = GetMemoryCategoryParameter(params, response);
+  if (!category) {
+    return false;
+  }
+
+  std::optional<size_t> budget;
+  if (params.count("budget") != 0) {
+    budget = GetBytesParameter(params, "budget", response);
+    if (!budget) {
+      return false;
+    }
+  }
+  memory_accounting_->SetBudget(category.value(), budget);
+
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "MemoryUsage", allocator);
+  AddMemoryUsage(memory_accounting_->GetUsage(category.value()), *response,
+                 allocator);
+  return true;
+}
+
+bool Shell::OnServiceProtocolPurgeMemory(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  auto category = GetMemoryCategoryParameter(params, response);
+  if (!category) {
+    return false;
+  }
+
+  size_t target_bytes = 0;
+  if (params.count("targetBytes") != 0) {
+    auto target = GetBytesParameter(params, "targetBytes", response);
+    if (!target) {
+      return false;
+    }
+    target_bytes = target.value();
+  }
+  // Purges happen asynchronously on the thread that owns the memory. The new
+  // usage is reported there once they are done.
+  memory_accounting_->Purge(category.value(), target_bytes);
+
+  response->SetObject();
+  response->AddMember("type", "Success", response->GetAllocator());
   return true;
 }
 
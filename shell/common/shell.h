@@ -6,12 +6,14 @@
 #define SHELL_COMMON_SHELL_H_
 
 #include <functional>
+#include <future>
 #include <mutex>
 #include <string_view>
 #include <unordered_map>
 
 #include "flutter/common/settings.h"
 #include "flutter/common/task_runners.h"
+#include "flutter/flow/memory_accounting.h"
 #include "flutter/flow/surface.h"
 #include "flutter/flow/texture.h"
 #include "flutter/fml/closure.h"
@@ -210,6 +212,34 @@ class Shell final : public PlatformView::Delegate,
       const CreateCallback<Rasterizer>& on_create_rasterizer,
       DartVMRef vm);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a lightweight shell that runs on the same task runners
+  ///             as this one and shares the IO manager (along with its resource
+  ///             context), the font collection and the isolate group of this
+  ///             one. Only the platform view, the rasterizer and the engine
+  ///             with its root isolate are created for the new shell, which
+  ///             makes it much cheaper in time and memory than a shell created
+  ///             with `Create`. This is meant for embedders that show several
+  ///             views of the same application.
+  ///
+  ///             Must be called on the platform task runner. The new shell is
+  ///             run with the given configuration before this method returns,
+  ///             and it may outlive this shell.
+  ///
+  /// @param[in]  run_configuration        The configuration to run the engine
+  ///                                      of the new shell with.
+  /// @param[in]  on_create_platform_view  The callback that must return a
+  ///                                      platform view for the new shell.
+  /// @param[in]  on_create_rasterizer     The callback that must return a
+  ///                                      rasterizer for the new shell.
+  ///
+  /// @return     The new shell, or nullptr if it could not be created.
+  ///
+  std::unique_ptr<Shell> Spawn(
+      RunConfiguration run_configuration,
+      const CreateCallback<PlatformView>& on_create_platform_view,
+      const CreateCallback<Rasterizer>& on_create_rasterizer) const;
+
   //----------------------------------------------------------------------------
   /// @brief      Destroys the shell. This is a synchronous operation and
   ///             synchronous barrier blocks are introduced on the various
@@ -234,7 +264,7 @@ class Shell final : public PlatformView::Delegate,
   //------------------------------------------------------------------------------
   /// @return     The settings used to launch this shell.
   ///
-  const Settings& GetSettings() const;
+  const Settings& GetSettings() const override;
 
   //------------------------------------------------------------------------------
   /// @brief      If callers wish to interact directly with any shell
@@ -250,6 +280,38 @@ class Shell final : public PlatformView::Delegate,
   ///
   const TaskRunners& GetTaskRunners() const override;
 
+  //----------------------------------------------------------------------------
+  /// @brief      How long each stage of bringing up the shell took. Stages on
+  ///             different threads run concurrently, so the durations may add
+  ///             up to more than the time it took to create the shell.
+  ///
+  struct StartupStageTimings {
+    /// Creating the platform view and its vsync waiter on the platform
+    /// thread.
+    fml::TimeDelta platform_view;
+    /// Creating the rasterizer on the raster thread.
+    fml::TimeDelta rasterizer;
+    /// Creating the IO manager and the resource context on the IO thread.
+    fml::TimeDelta io_manager;
+    /// Creating the engine on the UI thread once the subsystems it refers to
+    /// are available.
+    fml::TimeDelta engine;
+    /// Creating the default font manager on a concurrent worker.
+    fml::TimeDelta font_manager;
+    /// Creating the shell, from the start of the first stage until all the
+    /// stages the shell waits for are done.
+    fml::TimeDelta total;
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      The shell doesn't wait for the default font manager, which is
+  ///             installed on the UI task runner in the order of the tasks
+  ///             posted there. Its duration is only set once that happens.
+  ///
+  /// @return     The durations of the stages of creating the shell.
+  ///
+  const StartupStageTimings& GetStartupStageTimings() const;
+
   //----------------------------------------------------------------------------
   /// @brief      Rasterizers may only be accessed on the GPU task runner.
   ///
@@ -290,7 +352,7 @@ class Shell final : public PlatformView::Delegate,
   //----------------------------------------------------------------------------
   /// @brief      Used by embedders to notify that there is a low memory
   ///             warning. The shell will attempt to purge caches. Current, only
-  ///             the rasterizer cache is purged.
+  ///             the rasterizer cache and the decoded image cache are purged.
   void NotifyLowMemoryWarning() const;
 
   //----------------------------------------------------------------------------
@@ -361,6 +423,16 @@ class Shell final : public PlatformView::Delegate,
   /// @brief     Accessor for the disable GPU SyncSwitch
   std::shared_ptr<fml::SyncSwitch> GetIsGpuDisabledSyncSwitch() const override;
 
+  //----------------------------------------------------------------------------
+  /// @brief      The memory accounting of this shell. It tracks the bytes held
+  ///             by the engine in each category of memory, and can be used
+  ///             from any thread to set per category budgets, request targeted
+  ///             purges and observe memory pressure.
+  ///
+  /// @return     The memory accounting of this shell. Never null.
+  ///
+  std::shared_ptr<MemoryAccounting> GetMemoryAccounting() override;
+
   //----------------------------------------------------------------------------
   /// @brief      Get a pointer to the Dart VM used by this running shell
   ///             instance.
@@ -382,8 +454,11 @@ class Shell final : public PlatformView::Delegate,
   std::unique_ptr<PlatformView> platform_view_;  // on platform task runner
   std::unique_ptr<Engine> engine_;               // on UI task runner
   std::unique_ptr<Rasterizer> rasterizer_;       // on GPU task runner
-  std::unique_ptr<ShellIOManager> io_manager_;   // on IO task runner
+  std::shared_ptr<ShellIOManager> io_manager_;   // on IO task runner
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
+  std::shared_ptr<MemoryAccounting> memory_accounting_;
+  // Owned by the engine and the engines spawned from it. Thread safe.
+  std::weak_ptr<DecodedImageCache> decoded_image_cache_;
 
   fml::WeakPtr<Engine> weak_engine_;  // to be shared across threads
   fml::TaskRunnerAffineWeakPtr<Rasterizer>
@@ -398,6 +473,7 @@ class Shell final : public PlatformView::Delegate,
                      >
       service_protocol_handlers_;
   bool is_setup_ = false;
+  StartupStageTimings startup_stage_timings_;
   uint64_t next_pointer_flow_id_ = 0;
 
   bool first_frame_rasterized_ = false;
@@ -435,6 +511,13 @@ class Shell final : public PlatformView::Delegate,
   // How many frames have been timed since last report.
   size_t UnreportedFramesCount() const;
 
+  // The default font manager, which is created on a concurrent worker, along
+  // with how long that took.
+  struct DefaultFontManager {
+    sk_sp<SkFontMgr> font_manager;
+    fml::TimeDelta creation_time;
+  };
+
   Shell(DartVMRef vm, TaskRunners task_runners, Settings settings);
 
   static std::unique_ptr<Shell> CreateShellOnPlatformThread(
@@ -444,12 +527,14 @@ class Shell final : public PlatformView::Delegate,
       Settings settings,
       fml::RefPtr<const DartSnapshot> isolate_snapshot,
       const Shell::CreateCallback<PlatformView>& on_create_platform_view,
-      const Shell::CreateCallback<Rasterizer>& on_create_rasterizer);
+      const Shell::CreateCallback<Rasterizer>& on_create_rasterizer,
+      const Shell* spawning_shell);
 
   bool Setup(std::unique_ptr<PlatformView> platform_view,
              std::unique_ptr<Engine> engine,
              std::unique_ptr<Rasterizer> rasterizer,
-             std::unique_ptr<ShellIOManager> io_manager);
+             std::shared_ptr<ShellIOManager> io_manager,
+             std::future<DefaultFontManager> default_font_manager);
 
   void ReportTimings();
 
@@ -547,6 +632,10 @@ class Shell final : public PlatformView::Delegate,
   // |Rasterizer::Delegate|
   fml::TimePoint GetLatestFrameTargetTime() const override;
 
+  // |Rasterizer::Delegate|
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentWorkerTaskRunner()
+      override;
+
   // |ServiceProtocol::Handler|
   fml::RefPtr<fml::TaskRunner> GetServiceProtocolHandlerTaskRunner(
       std::string_view method) const override;
@@ -594,6 +683,8 @@ class Shell final : public PlatformView::Delegate,
   // Service protocol handler
   //
   // The returned SkSLs are base64 encoded. Decode before storing them to files.
+  // The frame each SkSL was first used in is returned under the same key, if
+  // it was recorded.
   bool OnServiceProtocolGetSkSLs(
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
@@ -603,6 +694,35 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  bool OnServiceProtocolGetMemoryUsage(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
+  // Service protocol handler
+  //
+  // Sets the budget of the memory category given by the 'category' parameter
+  // to the 'budget' parameter in bytes, or removes it if 'budget' is missing.
+  bool OnServiceProtocolSetMemoryBudget(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
+  // Service protocol handler
+  //
+  // Purges the memory category given by the 'category' parameter down to the
+  // optional 'targetBytes' parameter, which defaults to 0.
+  bool OnServiceProtocolPurgeMemory(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
+  // Service protocol handler
+  //
+  // Returns how many of the SkSL shaders of the persistent cache the
+  // rasterizer has precompiled so far.
+  bool OnServiceProtocolGetSkSLPrecompileProgress(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // For accessing the Shell via the raster thread, necessary for various
   // rasterizer callbacks.
   std::unique_ptr<fml::TaskRunnerAffineWeakPtrFactory<Shell>> weak_factory_gpu_;
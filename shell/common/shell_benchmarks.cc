@@ -7,16 +7,42 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/thread.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/shell/common/shell_pool.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/elf_loader.h"
 #include "flutter/testing/testing.h"
 
 namespace flutter {
 
-static void StartupAndShutdownShell(benchmark::State& state,
-                                    bool measure_startup,
-                                    bool measure_shutdown) {
+static Settings CreateSettingsForFixture(
+    const fml::UniqueFD& assets_dir,
+    testing::ELFAOTSymbols& aot_symbols) {
+  Settings settings = {};
+  settings.task_observer_add = [](intptr_t, fml::closure) {};
+  settings.task_observer_remove = [](intptr_t) {};
+
+  if (DartVM::IsRunningPrecompiledCode()) {
+    aot_symbols = testing::LoadELFSymbolFromFixturesIfNeccessary();
+    FML_CHECK(testing::PrepareSettingsForAOTWithSymbols(settings, aot_symbols))
+        << "Could not setup settings with AOT symbols.";
+  } else {
+    settings.application_kernels = [&assets_dir]() {
+      std::vector<std::unique_ptr<const fml::Mapping>> kernel_mappings;
+      kernel_mappings.emplace_back(
+          fml::FileMapping::CreateReadOnly(assets_dir, "kernel_blob.bin"));
+      return kernel_mappings;
+    };
+  }
+  return settings;
+}
+
+static void StartupAndShutdownShell(
+    benchmark::State& state,
+    bool measure_startup,
+    bool measure_shutdown,
+    Shell::StartupStageTimings* startup_stage_timings = nullptr) {
   auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
                                        fml::FilePermission::kRead);
   std::unique_ptr<Shell> shell;
@@ -25,23 +51,7 @@ static void StartupAndShutdownShell(benchmark::State& state,
 
   {
     benchmarking::ScopedPauseTiming pause(state, !measure_startup);
-    Settings settings = {};
-    settings.task_observer_add = [](intptr_t, fml::closure) {};
-    settings.task_observer_remove = [](intptr_t) {};
-
-    if (DartVM::IsRunningPrecompiledCode()) {
-      aot_symbols = testing::LoadELFSymbolFromFixturesIfNeccessary();
-      FML_CHECK(
-          testing::PrepareSettingsForAOTWithSymbols(settings, aot_symbols))
-          << "Could not setup settings with AOT symbols.";
-    } else {
-      settings.application_kernels = [&]() {
-        std::vector<std::unique_ptr<const fml::Mapping>> kernel_mappings;
-        kernel_mappings.emplace_back(
-            fml::FileMapping::CreateReadOnly(assets_dir, "kernel_blob.bin"));
-        return kernel_mappings;
-      };
-    }
+    Settings settings = CreateSettingsForFixture(assets_dir, aot_symbols);
 
     thread_host = std::make_unique<ThreadHost>(
         "io.flutter.bench.", ThreadHost::Type::Platform |
@@ -79,6 +89,18 @@ static void StartupAndShutdownShell(benchmark::State& state,
     latch.Wait();
   }
 
+  if (startup_stage_timings) {
+    // The default font manager was set up before the UI task above ran.
+    const auto& timings = shell->GetStartupStageTimings();
+    auto& sum = *startup_stage_timings;
+    sum.platform_view = sum.platform_view + timings.platform_view;
+    sum.rasterizer = sum.rasterizer + timings.rasterizer;
+    sum.io_manager = sum.io_manager + timings.io_manager;
+    sum.engine = sum.engine + timings.engine;
+    sum.font_manager = sum.font_manager + timings.font_manager;
+    sum.total = sum.total + timings.total;
+  }
+
   {
     benchmarking::ScopedPauseTiming pause(state, !measure_shutdown);
     // Shutdown must occur synchronously on the platform thread.
@@ -97,9 +119,23 @@ static void StartupAndShutdownShell(benchmark::State& state,
 }
 
 static void BM_ShellInitialization(benchmark::State& state) {
+  Shell::StartupStageTimings timings;
   while (state.KeepRunning()) {
-    StartupAndShutdownShell(state, true, false);
+    StartupAndShutdownShell(state, true, false, &timings);
   }
+
+  // Report the average duration of each stage, which run concurrently, to see
+  // which of them the startup waits for.
+  auto report = [&state](const char* name, fml::TimeDelta duration) {
+    state.counters[name] = benchmark::Counter(
+        duration.ToMillisecondsF(), benchmark::Counter::kAvgIterations);
+  };
+  report("platform_view_ms", timings.platform_view);
+  report("rasterizer_ms", timings.rasterizer);
+  report("io_manager_ms", timings.io_manager);
+  report("engine_ms", timings.engine);
+  report("font_manager_ms", timings.font_manager);
+  report("total_ms", timings.total);
 }
 
 BENCHMARK(BM_ShellInitialization);
@@ -120,4 +156,57 @@ static void BM_ShellInitializationAndShutdown(benchmark::State& state) {
 
 BENCHMARK(BM_ShellInitializationAndShutdown);
 
+// Creates shells the way a pool does, along with their threads, to compare
+// against handing them out of a pool.
+static std::unique_ptr<PooledShell> CreatePooledShell(
+    const Settings& settings) {
+  return PooledShell::Create(
+      "io.flutter.bench.", settings,
+      [](Shell& shell) {
+        return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+      },
+      [](Shell& shell) { return std::make_unique<Rasterizer>(shell); });
+}
+
+static void BM_ShellCreationCold(benchmark::State& state) {
+  auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
+                                       fml::FilePermission::kRead);
+  testing::ELFAOTSymbols aot_symbols;
+  const Settings settings = CreateSettingsForFixture(assets_dir, aot_symbols);
+
+  while (state.KeepRunning()) {
+    auto shell = CreatePooledShell(settings);
+    FML_CHECK(shell);
+    benchmarking::ScopedPauseTiming pause(state, true);
+    shell.reset();
+  }
+}
+
+BENCHMARK(BM_ShellCreationCold)->Unit(benchmark::kMicrosecond);
+
+static void BM_ShellCreationFromPool(benchmark::State& state) {
+  auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
+                                       fml::FilePermission::kRead);
+  testing::ELFAOTSymbols aot_symbols;
+  const Settings settings = CreateSettingsForFixture(assets_dir, aot_symbols);
+  fml::Thread refill_thread("io.flutter.bench.shell_pool");
+  ShellPool<PooledShell> pool(
+      1, [&settings]() { return CreatePooledShell(settings); },
+      refill_thread.GetTaskRunner());
+
+  while (state.KeepRunning()) {
+    {
+      // Only measure handing out a shell, not refilling the pool.
+      benchmarking::ScopedPauseTiming pause(state, true);
+      pool.WaitForRefills();
+    }
+    auto shell = pool.Take();
+    FML_CHECK(shell);
+    benchmarking::ScopedPauseTiming pause(state, true);
+    shell.reset();
+  }
+}
+
+BENCHMARK(BM_ShellCreationFromPool)->Unit(benchmark::kMicrosecond);
+
 }  // namespace flutter
@@ -66,15 +66,7 @@ ShellIOManager::ShellIOManager(
           fml::TimeDelta::FromMilliseconds(8),
           GetResourceContext())),
       is_gpu_disabled_sync_switch_(is_gpu_disabled_sync_switch),
-      weak_factory_(this) {
-  if (!resource_context_) {
-#ifndef OS_FUCHSIA
-    FML_DLOG(WARNING) << "The IO manager was initialized without a resource "
-                         "context. Async texture uploads will be disabled. "
-                         "Expect performance degradation.";
-#endif  // OS_FUCHSIA
-  }
-}
+      weak_factory_(this) {}
 
 ShellIOManager::~ShellIOManager() {
   // Last chance to drain the IO queue as the platform side reference to the
@@ -101,6 +93,7 @@ void ShellIOManager::UpdateResourceContext(
           ? std::make_unique<fml::WeakPtrFactory<GrDirectContext>>(
                 resource_context_.get())
           : nullptr;
+  unref_queue_->UpdateResourceContext(GetResourceContext());
 }
 
 fml::WeakPtr<ShellIOManager> ShellIOManager::GetWeakPtr() {
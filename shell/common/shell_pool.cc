@@ -0,0 +1,58 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shell_pool.h"
+
+#include <atomic>
+
+#include "flutter/fml/synchronization/waitable_event.h"
+
+namespace flutter {
+
+std::unique_ptr<PooledShell> PooledShell::Create(
+    const std::string& thread_label,
+    const Settings& settings,
+    const Shell::CreateCallback<PlatformView>& on_create_platform_view,
+    const Shell::CreateCallback<Rasterizer>& on_create_rasterizer) {
+  static std::atomic<size_t> shell_count = 0;
+
+  auto thread_host = std::make_unique<ThreadHost>(
+      thread_label + std::to_string(shell_count++) + ".",
+      ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+          ThreadHost::Type::IO | ThreadHost::Type::UI);
+
+  TaskRunners task_runners(thread_label,
+                           thread_host->platform_thread->GetTaskRunner(),
+                           thread_host->raster_thread->GetTaskRunner(),
+                           thread_host->ui_thread->GetTaskRunner(),
+                           thread_host->io_thread->GetTaskRunner());
+
+  auto shell = Shell::Create(std::move(task_runners), settings,
+                             on_create_platform_view, on_create_rasterizer);
+  if (!shell) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<PooledShell>(
+      new PooledShell(std::move(thread_host), std::move(shell)));
+}
+
+PooledShell::PooledShell(std::unique_ptr<ThreadHost> thread_host,
+                         std::unique_ptr<Shell> shell)
+    : thread_host_(std::move(thread_host)), shell_(std::move(shell)) {}
+
+PooledShell::~PooledShell() {
+  // The shell must be collected on its platform thread, which must still be
+  // running at that point.
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      thread_host_->platform_thread->GetTaskRunner(), [this, &latch]() {
+        shell_.reset();
+        latch.Signal();
+      });
+  latch.Wait();
+  thread_host_.reset();
+}
+
+}  // namespace flutter
@@ -0,0 +1,224 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_SHELL_POOL_H_
+#define FLUTTER_SHELL_COMMON_SHELL_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/shell/common/shell.h"
+#include "flutter/shell/common/thread_host.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// Keeps a number of shells that were created ahead of time, so that handing
+/// one out doesn't pay for creating threads, acquiring the VM, setting up the
+/// isolate snapshot and the default font manager.
+///
+/// Pooled shells are idle. Whoever takes one binds the surface by notifying
+/// the platform view that it was created, and runs the engine with the
+/// entrypoint of their choice.
+///
+/// |T| owns a shell along with whatever the shell needs, like the threads it
+/// runs on. The factory of the pool creates them on the refill task runner,
+/// except when the pool is empty, in which case |Take| creates one itself.
+/// Shells that were handed out are replaced in the background.
+///
+/// This class is thread safe.
+///
+template <class T>
+class ShellPool {
+ public:
+  using Factory = std::function<std::unique_ptr<T>()>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a pool and starts filling it on |refill_task_runner|.
+  ///
+  /// @param[in]  capacity            The number of idle shells to keep.
+  /// @param[in]  factory             Creates a shell, or returns nullptr if
+  ///                                 it couldn't. Failed refills aren't
+  ///                                 retried until the next |Take|.
+  /// @param[in]  refill_task_runner  The task runner the factory is called on
+  ///                                 to fill the pool.
+  ///
+  ShellPool(size_t capacity,
+            Factory factory,
+            fml::RefPtr<fml::TaskRunner> refill_task_runner)
+      : state_(std::make_shared<State>(capacity,
+                                       std::move(factory),
+                                       std::move(refill_task_runner))) {
+    std::scoped_lock lock(state_->mutex);
+    ScheduleRefills(state_);
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Collects the idle shells. Waits for a shell the factory is
+  ///             creating, but not for refills that haven't started.
+  ///
+  ~ShellPool() {
+    std::deque<std::unique_ptr<T>> idle;
+    {
+      std::unique_lock lock(state_->mutex);
+      state_->shutting_down = true;
+      state_->changed.wait(lock,
+                           [state = state_.get()] { return !state->creating; });
+      idle.swap(state_->idle);
+    }
+  }
+
+  size_t GetCapacity() const { return state_->capacity; }
+
+  size_t GetIdleCount() const {
+    std::scoped_lock lock(state_->mutex);
+    return state_->idle.size();
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Hands out an idle shell and schedules its replacement. If
+  ///             there is no idle shell, one is created on the calling thread.
+  ///
+  /// @return     The shell, or nullptr if it couldn't be created.
+  ///
+  std::unique_ptr<T> Take() {
+    {
+      std::scoped_lock lock(state_->mutex);
+      if (!state_->idle.empty()) {
+        TRACE_EVENT0("flutter", "ShellPool::TakeIdle");
+        std::unique_ptr<T> shell = std::move(state_->idle.front());
+        state_->idle.pop_front();
+        ScheduleRefills(state_);
+        return shell;
+      }
+      ScheduleRefills(state_);
+    }
+    TRACE_EVENT0("flutter", "ShellPool::TakeCold");
+    return state_->factory();
+  }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Waits until the scheduled refills are done. The pool is full
+  ///             afterwards unless the factory failed.
+  ///
+  void WaitForRefills() const {
+    std::unique_lock lock(state_->mutex);
+    state_->changed.wait(
+        lock, [state = state_.get()] { return state->pending_refills == 0; });
+  }
+
+ private:
+  // Refill tasks may outlive the pool, so they share its state.
+  struct State {
+    const size_t capacity;
+    const Factory factory;
+    const fml::RefPtr<fml::TaskRunner> refill_task_runner;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::unique_ptr<T>> idle;
+    size_t pending_refills = 0;
+    bool creating = false;
+    bool shutting_down = false;
+
+    State(size_t p_capacity,
+          Factory p_factory,
+          fml::RefPtr<fml::TaskRunner> p_refill_task_runner)
+        : capacity(p_capacity),
+          factory(std::move(p_factory)),
+          refill_task_runner(std::move(p_refill_task_runner)) {}
+  };
+
+  const std::shared_ptr<State> state_;
+
+  // Must be called with the lock of |state| held.
+  static void ScheduleRefills(const std::shared_ptr<State>& state) {
+    while (state->idle.size() + state->pending_refills < state->capacity) {
+      state->pending_refills++;
+      state->refill_task_runner->PostTask([state]() { Refill(state); });
+    }
+  }
+
+  static void Refill(const std::shared_ptr<State>& state) {
+    {
+      std::scoped_lock lock(state->mutex);
+      if (state->shutting_down) {
+        state->pending_refills--;
+        state->changed.notify_all();
+        return;
+      }
+      // Refills share one task runner, so they don't overlap.
+      state->creating = true;
+    }
+
+    std::unique_ptr<T> shell;
+    {
+      TRACE_EVENT0("flutter", "ShellPool::Refill");
+      shell = state->factory();
+    }
+
+    std::unique_lock lock(state->mutex);
+    if (state->shutting_down) {
+      lock.unlock();
+      shell.reset();
+      lock.lock();
+    } else if (shell) {
+      state->idle.push_back(std::move(shell));
+    }
+    state->creating = false;
+    state->pending_refills--;
+    state->changed.notify_all();
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ShellPool);
+};
+
+//------------------------------------------------------------------------------
+/// A shell along with the threads it runs on, for use in a |ShellPool|.
+///
+class PooledShell {
+ public:
+  //----------------------------------------------------------------------------
+  /// @brief      Creates the threads of a shell and the shell on them. Can be
+  ///             called on any thread.
+  ///
+  /// @param[in]  thread_label  The prefix of the names of the threads. The
+  ///                           threads of each shell get a unique name.
+  ///
+  /// @return     The shell, or nullptr if it couldn't be created.
+  ///
+  static std::unique_ptr<PooledShell> Create(
+      const std::string& thread_label,
+      const Settings& settings,
+      const Shell::CreateCallback<PlatformView>& on_create_platform_view,
+      const Shell::CreateCallback<Rasterizer>& on_create_rasterizer);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Collects the shell on its platform thread, then its threads.
+  ///             Must not be called on one of the threads of the shell.
+  ///
+  ~PooledShell();
+
+  Shell& GetShell() const { return *shell_; }
+
+ private:
+  std::unique_ptr<ThreadHost> thread_host_;
+  std::unique_ptr<Shell> shell_;
+
+  PooledShell(std::unique_ptr<ThreadHost> thread_host,
+              std::unique_ptr<Shell> shell);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PooledShell);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_SHELL_POOL_H_
@@ -0,0 +1,152 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/shell_pool.h"
+
+#include <atomic>
+#include <thread>
+
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// Stands in for a shell, counting how many are alive.
+class FakeShell {
+ public:
+  explicit FakeShell(std::atomic<int>& alive) : alive_(alive) { alive_++; }
+
+  ~FakeShell() { alive_--; }
+
+ private:
+  std::atomic<int>& alive_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FakeShell);
+};
+
+}  // namespace
+
+TEST(ShellPool, FillsToCapacityOnRefillTaskRunner) {
+  fml::Thread refill_thread("refill");
+  std::atomic<int> alive = 0;
+  std::atomic<int> created_on_refill_thread = 0;
+  auto refill_task_runner = refill_thread.GetTaskRunner();
+  {
+    ShellPool<FakeShell> pool(
+        3,
+        [&]() {
+          if (refill_task_runner->RunsTasksOnCurrentThread()) {
+            created_on_refill_thread++;
+          }
+          return std::make_unique<FakeShell>(alive);
+        },
+        refill_task_runner);
+    pool.WaitForRefills();
+    EXPECT_EQ(pool.GetCapacity(), 3u);
+    EXPECT_EQ(pool.GetIdleCount(), 3u);
+    EXPECT_EQ(alive, 3);
+    EXPECT_EQ(created_on_refill_thread, 3);
+  }
+  EXPECT_EQ(alive, 0);
+}
+
+TEST(ShellPool, TakeHandsOutIdleShellAndRefills) {
+  fml::Thread refill_thread("refill");
+  std::atomic<int> alive = 0;
+  std::atomic<int> created = 0;
+  ShellPool<FakeShell> pool(
+      2,
+      [&]() {
+        created++;
+        return std::make_unique<FakeShell>(alive);
+      },
+      refill_thread.GetTaskRunner());
+  pool.WaitForRefills();
+
+  auto shell = pool.Take();
+  ASSERT_TRUE(shell);
+  EXPECT_EQ(created, 2);
+
+  pool.WaitForRefills();
+  EXPECT_EQ(pool.GetIdleCount(), 2u);
+  EXPECT_EQ(created, 3);
+  EXPECT_EQ(alive, 3);
+}
+
+TEST(ShellPool, TakeCreatesShellWhenEmpty) {
+  fml::Thread refill_thread("refill");
+  std::atomic<int> alive = 0;
+  const auto taking_thread = std::this_thread::get_id();
+  std::atomic<int> created_on_taking_thread = 0;
+  ShellPool<FakeShell> pool(
+      0,
+      [&]() {
+        if (std::this_thread::get_id() == taking_thread) {
+          created_on_taking_thread++;
+        }
+        return std::make_unique<FakeShell>(alive);
+      },
+      refill_thread.GetTaskRunner());
+
+  auto shell = pool.Take();
+  ASSERT_TRUE(shell);
+  EXPECT_EQ(created_on_taking_thread, 1);
+  EXPECT_EQ(pool.GetIdleCount(), 0u);
+}
+
+TEST(ShellPool, FailedRefillsAreRetriedOnTake) {
+  fml::Thread refill_thread("refill");
+  std::atomic<int> alive = 0;
+  std::atomic<bool> fail = true;
+  ShellPool<FakeShell> pool(
+      1,
+      [&]() -> std::unique_ptr<FakeShell> {
+        if (fail) {
+          return nullptr;
+        }
+        return std::make_unique<FakeShell>(alive);
+      },
+      refill_thread.GetTaskRunner());
+  pool.WaitForRefills();
+  EXPECT_EQ(pool.GetIdleCount(), 0u);
+
+  EXPECT_FALSE(pool.Take());
+  pool.WaitForRefills();
+  EXPECT_EQ(pool.GetIdleCount(), 0u);
+
+  fail = false;
+  EXPECT_TRUE(pool.Take());
+  pool.WaitForRefills();
+  EXPECT_EQ(pool.GetIdleCount(), 1u);
+}
+
+TEST(ShellPool, DestructionWaitsForShellBeingCreated) {
+  fml::Thread refill_thread("refill");
+  std::atomic<int> alive = 0;
+  fml::AutoResetWaitableEvent started;
+  fml::AutoResetWaitableEvent finish;
+  auto pool = std::make_unique<ShellPool<FakeShell>>(
+      1,
+      [&]() {
+        started.Signal();
+        finish.Wait();
+        return std::make_unique<FakeShell>(alive);
+      },
+      refill_thread.GetTaskRunner());
+  started.Wait();
+
+  std::thread collector([&pool]() { pool.reset(); });
+  finish.Signal();
+  collector.join();
+
+  // The shell that was being created is discarded.
+  EXPECT_EQ(alive, 0);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -253,6 +253,19 @@ void ShellTest::OnServiceProtocol(
           case ServiceProtocolEnum::kRunInView:
             shell->OnServiceProtocolRunInView(params, response);
             break;
+          case ServiceProtocolEnum::kGetMemoryUsage:
+            shell->OnServiceProtocolGetMemoryUsage(params, response);
+            break;
+          case ServiceProtocolEnum::kSetMemoryBudget:
+            shell->OnServiceProtocolSetMemoryBudget(params, response);
+            break;
+          case ServiceProtocolEnum::kPurgeMemory:
+            shell->OnServiceProtocolPurgeMemory(params, response);
+            break;
+          case ServiceProtocolEnum::kGetSkSLPrecompileProgress:
+            shell->OnServiceProtocolGetSkSLPrecompileProgress(params,
+                                                              response);
+            break;
         }
         finished.set_value(true);
       });
@@ -90,6 +90,10 @@ class ShellTest : public FixtureTest {
     kEstimateRasterCacheMemory,
     kSetAssetBundlePath,
     kRunInView,
+    kGetMemoryUsage,
+    kSetMemoryBudget,
+    kPurgeMemory,
+    kGetSkSLPrecompileProgress,
   };
 
   // Helper method to test private method Shell::OnServiceProtocolGetSkSLs.
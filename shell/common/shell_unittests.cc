@@ -24,6 +24,7 @@
 #include "flutter/shell/common/persistent_cache.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/rasterizer.h"
+#include "flutter/shell/common/shell_pool.h"
 #include "flutter/shell/common/shell_test.h"
 #include "flutter/shell/common/shell_test_external_view_embedder.h"
 #include "flutter/shell/common/shell_test_platform_view.h"
@@ -143,6 +144,36 @@ TEST_F(ShellTest, InitializeWithDifferentThreads) {
   ASSERT_FALSE(DartVMRef::IsInstanceRunning());
 }
 
+TEST_F(ShellTest, ReportsStartupStageTimings) {
+  Settings settings = CreateSettingsForFixture();
+  ThreadHost thread_host("io.flutter.test." + GetCurrentTestName() + ".",
+                         ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  TaskRunners task_runners("test", thread_host.platform_thread->GetTaskRunner(),
+                           thread_host.raster_thread->GetTaskRunner(),
+                           thread_host.ui_thread->GetTaskRunner(),
+                           thread_host.io_thread->GetTaskRunner());
+  auto shell = CreateShell(std::move(settings), task_runners);
+  ASSERT_TRUE(ValidateShell(shell.get()));
+
+  // The default font manager is installed on the UI task runner after the
+  // shell is created.
+  fml::AutoResetWaitableEvent latch;
+  task_runners.GetUITaskRunner()->PostTask([&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  const auto& timings = shell->GetStartupStageTimings();
+  EXPECT_GT(timings.platform_view.ToNanoseconds(), 0);
+  EXPECT_GT(timings.rasterizer.ToNanoseconds(), 0);
+  EXPECT_GT(timings.io_manager.ToNanoseconds(), 0);
+  EXPECT_GT(timings.engine.ToNanoseconds(), 0);
+  EXPECT_GT(timings.font_manager.ToNanoseconds(), 0);
+  EXPECT_GE(timings.total, timings.platform_view);
+  EXPECT_GE(timings.total, timings.engine);
+
+  DestroyShell(std::move(shell), std::move(task_runners));
+}
+
 TEST_F(ShellTest, InitializeWithSingleThread) {
   ASSERT_FALSE(DartVMRef::IsInstanceRunning());
   Settings settings = CreateSettingsForFixture();
@@ -248,6 +279,120 @@ TEST_F(ShellTest, FixturesAreFunctional) {
   ASSERT_FALSE(DartVMRef::IsInstanceRunning());
 }
 
+TEST_F(ShellTest, PooledShellRunsTheEntrypointItIsGiven) {
+  auto settings = CreateSettingsForFixture();
+  const std::string thread_label =
+      "io.flutter.test." + GetCurrentTestName() + ".";
+  fml::Thread refill_thread(thread_label + "pool");
+  auto pool = std::make_unique<ShellPool<PooledShell>>(
+      1,
+      [&settings, &thread_label]() {
+        return PooledShell::Create(
+            thread_label, settings,
+            [](Shell& shell) {
+              auto task_runners = shell.GetTaskRunners();
+              return ShellTestPlatformView::Create(
+                  shell, task_runners, std::make_shared<ShellTestVsyncClock>(),
+                  [task_runners]() {
+                    return static_cast<std::unique_ptr<VsyncWaiter>>(
+                        std::make_unique<VsyncWaiterFallback>(task_runners));
+                  },
+                  ShellTestPlatformView::BackendType::kDefaultBackend,
+                  nullptr);
+            },
+            [](Shell& shell) { return std::make_unique<Rasterizer>(shell); });
+      },
+      refill_thread.GetTaskRunner());
+  pool->WaitForRefills();
+  ASSERT_EQ(pool->GetIdleCount(), 1u);
+
+  auto pooled_shell = pool->Take();
+  ASSERT_TRUE(pooled_shell);
+  Shell* shell = &pooled_shell->GetShell();
+  ASSERT_TRUE(ValidateShell(shell));
+
+  // Bind the surface and the entrypoint.
+  PlatformViewNotifyCreated(shell);
+  auto configuration = RunConfiguration::InferFromSettings(settings);
+  ASSERT_TRUE(configuration.IsValid());
+  configuration.SetEntrypoint("fixturesAreFunctionalMain");
+
+  fml::AutoResetWaitableEvent main_latch;
+  AddNativeCallback(
+      "SayHiFromFixturesAreFunctionalMain",
+      CREATE_NATIVE_ENTRY([&main_latch](auto args) { main_latch.Signal(); }));
+
+  RunEngine(shell, std::move(configuration));
+  main_latch.Wait();
+
+  pool->WaitForRefills();
+  EXPECT_EQ(pool->GetIdleCount(), 1u);
+
+  pooled_shell.reset();
+  pool.reset();
+  ASSERT_FALSE(DartVMRef::IsInstanceRunning());
+}
+
+TEST_F(ShellTest, SpawnedShellSharesTheIOManagerAndRunsItsEntrypoint) {
+  auto settings = CreateSettingsForFixture();
+  auto shell = CreateShell(settings);
+  ASSERT_TRUE(ValidateShell(shell.get()));
+
+  fml::AutoResetWaitableEvent main_latch;
+  AddNativeCallback(
+      "SayHiFromFixturesAreFunctionalMain",
+      CREATE_NATIVE_ENTRY([&main_latch](auto args) { main_latch.Signal(); }));
+
+  auto configuration = RunConfiguration::InferFromSettings(settings);
+  ASSERT_TRUE(configuration.IsValid());
+  configuration.SetEntrypoint("fixturesAreFunctionalMain");
+  RunEngine(shell.get(), std::move(configuration));
+  main_latch.Wait();
+
+  std::unique_ptr<Shell> spawn;
+  fml::AutoResetWaitableEvent spawn_latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetPlatformTaskRunner(), [&]() {
+        auto configuration = RunConfiguration::InferFromSettings(settings);
+        configuration.SetEntrypoint("fixturesAreFunctionalMain");
+        spawn = shell->Spawn(
+            std::move(configuration),
+            [](Shell& shell) {
+              auto task_runners = shell.GetTaskRunners();
+              return ShellTestPlatformView::Create(
+                  shell, task_runners, std::make_shared<ShellTestVsyncClock>(),
+                  [task_runners]() {
+                    return static_cast<std::unique_ptr<VsyncWaiter>>(
+                        std::make_unique<VsyncWaiterFallback>(task_runners));
+                  },
+                  ShellTestPlatformView::BackendType::kDefaultBackend,
+                  nullptr);
+            },
+            [](Shell& shell) { return std::make_unique<Rasterizer>(shell); });
+        spawn_latch.Signal();
+      });
+  spawn_latch.Wait();
+  ASSERT_TRUE(ValidateShell(spawn.get()));
+  main_latch.Wait();
+
+  fml::AutoResetWaitableEvent io_latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetIOTaskRunner(),
+      [&io_latch, io_manager = shell->GetIOManager(),
+       spawn_io_manager = spawn->GetIOManager()]() {
+        EXPECT_TRUE(spawn_io_manager);
+        EXPECT_EQ(spawn_io_manager.get(), io_manager.get());
+        io_latch.Signal();
+      });
+  io_latch.Wait();
+
+  // The spawned shell outlives the shell it was spawned from.
+  DestroyShell(std::move(shell));
+  ASSERT_TRUE(DartVMRef::IsInstanceRunning());
+  DestroyShell(std::move(spawn));
+  ASSERT_FALSE(DartVMRef::IsInstanceRunning());
+}
+
 TEST_F(ShellTest, SecondaryIsolateBindingsAreSetupViaShellSettings) {
   ASSERT_FALSE(DartVMRef::IsInstanceRunning());
   auto settings = CreateSettingsForFixture();
@@ -1852,16 +1997,39 @@ TEST_F(ShellTest, OnServiceProtocolGetSkSLsWorks) {
   document.Accept(writer);
   DestroyShell(std::move(shell));
 
+  // The legacy files carry no first use frames.
   const std::string expected_json1 =
-      "{\"type\":\"GetSkSLs\",\"SkSLs\":{\"II\":\"eQ==\",\"IE\":\"eA==\"}}";
+      "{\"type\":\"GetSkSLs\",\"SkSLs\":{\"II\":\"eQ==\",\"IE\":\"eA==\"},"
+      "\"firstUseFrames\":{}}";
   const std::string expected_json2 =
-      "{\"type\":\"GetSkSLs\",\"SkSLs\":{\"IE\":\"eA==\",\"II\":\"eQ==\"}}";
+      "{\"type\":\"GetSkSLs\",\"SkSLs\":{\"IE\":\"eA==\",\"II\":\"eQ==\"},"
+      "\"firstUseFrames\":{}}";
   bool json_is_expected = (expected_json1 == buffer.GetString()) ||
                           (expected_json2 == buffer.GetString());
   ASSERT_TRUE(json_is_expected) << buffer.GetString() << " is not equal to "
                                 << expected_json1 << " or " << expected_json2;
 }
 
+TEST_F(ShellTest, OnServiceProtocolGetSkSLPrecompileProgressWorks) {
+  Settings settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document document;
+  OnServiceProtocol(
+      shell.get(), ServiceProtocolEnum::kGetSkSLPrecompileProgress,
+      shell->GetTaskRunners().GetRasterTaskRunner(), empty_params, &document);
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  document.Accept(writer);
+  DestroyShell(std::move(shell));
+
+  // Without a surface, there is nothing to precompile for.
+  const std::string expected_json =
+      "{\"type\":\"SkSLPrecompileProgress\",\"total\":0,\"compiled\":0,"
+      "\"failed\":0,\"remaining\":0}";
+  ASSERT_EQ(buffer.GetString(), expected_json);
+}
+
 TEST_F(ShellTest, RasterizerScreenshot) {
   Settings settings = CreateSettingsForFixture();
   auto configuration = RunConfiguration::InferFromSettings(settings);
@@ -2004,13 +2172,66 @@ TEST_F(ShellTest, OnServiceProtocolEstimateRasterCacheMemoryWorks) {
   document.Accept(writer);
   std::string expected_json =
       "{\"type\":\"EstimateRasterCacheMemory\",\"layerBytes\":40000,\"picture"
-      "Bytes\":400}";
+      "Bytes\":400,\"maxBytes\":0,\"hitCount\":1,\"missCount\":3,"
+      "\"evictionCount\":0}";
   std::string actual_json = buffer.GetString();
   ASSERT_EQ(actual_json, expected_json);
 
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, OnServiceProtocolSetMemoryBudgetAppliesToRasterCache) {
+  Settings settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  auto io_task_runner = shell->GetTaskRunners().GetIOTaskRunner();
+
+  ServiceProtocol::Handler::ServiceProtocolMap params;
+  params["category"] = "rasterCache";
+  params["budget"] = "1024";
+  rapidjson::Document set_document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kSetMemoryBudget,
+                    io_task_runner, params, &set_document);
+  ASSERT_TRUE(set_document.HasMember("budget"));
+  ASSERT_EQ(set_document["budget"].GetUint64(), 1024u);
+
+  // The budget is applied on the raster thread.
+  std::promise<size_t> max_bytes;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetRasterTaskRunner(), [&shell, &max_bytes]() {
+        max_bytes.set_value(shell->GetRasterizer()
+                                ->compositor_context()
+                                ->raster_cache()
+                                .max_bytes());
+      });
+  ASSERT_EQ(max_bytes.get_future().get(), 1024u);
+
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document get_document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kGetMemoryUsage,
+                    io_task_runner, empty_params, &get_document);
+  ASSERT_STREQ(get_document["type"].GetString(), "MemoryUsage");
+  const auto& categories = get_document["categories"];
+  ASSERT_EQ(categories.Size(), kMemoryCategoryCount);
+  ASSERT_STREQ(categories[0]["category"].GetString(), "rasterCache");
+  ASSERT_EQ(categories[0]["budget"].GetUint64(), 1024u);
+  ASSERT_FALSE(categories[1].HasMember("budget"));
+
+  params.erase("budget");
+  rapidjson::Document remove_document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kSetMemoryBudget,
+                    io_task_runner, params, &remove_document);
+  ASSERT_FALSE(remove_document.HasMember("budget"));
+
+  ServiceProtocol::Handler::ServiceProtocolMap bad_params;
+  bad_params["category"] = "everything";
+  rapidjson::Document error_document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kPurgeMemory,
+                    io_task_runner, bad_params, &error_document);
+  ASSERT_TRUE(error_document.HasMember("code"));
+
+  DestroyShell(std::move(shell));
+}
+
 TEST_F(ShellTest, DiscardLayerTreeOnResize) {
   auto settings = CreateSettingsForFixture();
 
@@ -305,6 +305,18 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.verbose_logging =
       command_line.HasOption(FlagForSwitch(Switch::VerboseLogging));
 
+  settings.enable_async_raster_cache =
+      command_line.HasOption(FlagForSwitch(Switch::EnableAsyncRasterCache));
+
+  GetSwitchValue(command_line, Switch::SoftwareRasterTileCount,
+                 &settings.software_raster_tile_count);
+
+  GetSwitchValue(command_line, Switch::AnimatedImageLookaheadFrames,
+                 &settings.animated_image_lookahead_frames);
+
+  GetSwitchValue(command_line, Switch::AnimatedImageFrameCacheBytes,
+                 &settings.animated_image_frame_cache_bytes);
+
   command_line.GetOptionValue(FlagForSwitch(Switch::FlutterAssetsDir),
                               &settings.assets_path);
 
@@ -401,6 +413,9 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.purge_persistent_cache =
       command_line.HasOption(FlagForSwitch(Switch::PurgePersistentCache));
 
+  settings.persistent_shaping_cache =
+      command_line.HasOption(FlagForSwitch(Switch::PersistentShapingCache));
+
   return settings;
 }
 
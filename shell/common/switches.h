@@ -103,6 +103,23 @@ DEF_SWITCH(SkiaDeterministicRendering,
            "Skips the call to SkGraphics::Init(), thus avoiding swapping out "
            "some Skia function pointers based on available CPU features. This "
            "is used to obtain 100% deterministic behavior in Skia rendering.")
+DEF_SWITCH(EnableAsyncRasterCache,
+           "enable-async-raster-cache",
+           "Rasterize pictures into the raster cache on a worker thread "
+           "instead of the raster thread. Frames draw the pictures directly "
+           "until they are cached.")
+DEF_SWITCH(SoftwareRasterTileCount,
+           "software-raster-tile-count",
+           "When rendering in software, split each frame into this many tiles "
+           "that are rendered in parallel on worker threads.")
+DEF_SWITCH(AnimatedImageLookaheadFrames,
+           "animated-image-lookahead-frames",
+           "Decode this many frames of animated images ahead of time on worker "
+           "threads.")
+DEF_SWITCH(AnimatedImageFrameCacheBytes,
+           "animated-image-frame-cache-bytes",
+           "Keep the frames of repeating animated images that fit in this many "
+           "bytes so later loops are drawn without decoding them again.")
 DEF_SWITCH(FlutterAssetsDir,
            "flutter-assets-dir",
            "Path to the Flutter assets directory.")
@@ -152,6 +169,11 @@ DEF_SWITCH(PurgePersistentCache,
            "purge-persistent-cache",
            "Remove all existing persistent cache. This is mainly for debugging "
            "purposes such as reproducing the shader compilation jank.")
+DEF_SWITCH(PersistentShapingCache,
+           "persistent-shaping-cache",
+           "Keep the layouts of shaped words and the glyph coverage of fonts "
+           "in the persistent cache, so that text laid out at launch does not "
+           "need to be shaped again in the next launches.")
 DEF_SWITCH(
     TraceSystrace,
     "trace-systrace",
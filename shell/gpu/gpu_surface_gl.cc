@@ -81,14 +81,8 @@ GPUSurfaceGL::GPUSurfaceGL(GPUSurfaceGLDelegate* delegate,
 
   valid_ = true;
 
-  std::vector<PersistentCache::SkSLCache> caches =
-      PersistentCache::GetCacheForProcess()->LoadSkSLs();
-  int compiled_count = 0;
-  for (const auto& cache : caches) {
-    compiled_count += context_->precompileShader(*cache.first, *cache.second);
-  }
-  FML_LOG(INFO) << "Found " << caches.size() << " SkSL shaders; precompiled "
-                << compiled_count;
+  // The SkSL shaders of the persistent cache are precompiled by the
+  // rasterizer, in between frames.
 
   delegate_->GLContextClearCurrent();
 }
@@ -198,6 +192,7 @@ bool GPUSurfaceGL::CreateOrUpdateSurfaces(const SkISize& size) {
   // Either way, we need to get rid of previous surface.
   onscreen_surface_ = nullptr;
   fbo_id_ = 0;
+  damage_history_.clear();
 
   if (size.isEmpty()) {
     FML_LOG(ERROR) << "Cannot create surfaces of empty size.";
@@ -266,15 +261,44 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceGL::AcquireFrame(const SkISize& size) {
   SurfaceFrame::SubmitCallback submit_callback =
       [weak = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) {
-        return weak ? weak->PresentSurface(canvas) : false;
+        return weak ? weak->PresentSurface(surface_frame, canvas) : false;
       };
 
-  return std::make_unique<SurfaceFrame>(
+  SurfaceFrame::FramebufferInfo framebuffer_info;
+  framebuffer_info.existing_damage =
+      ExistingDamage(root_surface_transformation);
+
+  auto frame = std::make_unique<SurfaceFrame>(
       surface, delegate_->SurfaceSupportsReadback(), submit_callback,
       std::move(context_switch));
+  frame->set_framebuffer_info(framebuffer_info);
+  return frame;
+}
+
+std::optional<SkIRect> GPUSurfaceGL::ExistingDamage(
+    const SkMatrix& root_surface_transformation) {
+  if (root_surface_transformation != last_root_surface_transformation_) {
+    last_root_surface_transformation_ = root_surface_transformation;
+    damage_history_.clear();
+  }
+
+  const uint32_t age = delegate_->GLContextFBOAge();
+  // An age of 1 only makes sense if a frame was presented to this surface.
+  if (age == 0 || age > damage_history_.size()) {
+    return std::nullopt;
+  }
+
+  // The framebuffer is missing the changes of every frame presented since it
+  // was last rendered into.
+  SkIRect existing_damage = SkIRect::MakeEmpty();
+  for (uint32_t i = 0; i < age - 1; i++) {
+    existing_damage.join(damage_history_[i]);
+  }
+  return existing_damage;
 }
 
-bool GPUSurfaceGL::PresentSurface(SkCanvas* canvas) {
+bool GPUSurfaceGL::PresentSurface(const SurfaceFrame& surface_frame,
+                                  SkCanvas* canvas) {
   if (delegate_ == nullptr || canvas == nullptr || context_ == nullptr) {
     return false;
   }
@@ -284,7 +308,25 @@ bool GPUSurfaceGL::PresentSurface(SkCanvas* canvas) {
     onscreen_surface_->getCanvas()->flush();
   }
 
-  if (!delegate_->GLContextPresent(fbo_id_)) {
+  const SkIRect surface_rect =
+      SkIRect::MakeWH(onscreen_surface_->width(), onscreen_surface_->height());
+  const SurfaceFrame::SubmitInfo& submit_info = surface_frame.submit_info();
+  GLPresentInfo present_info = {
+      fbo_id_,                                           // fbo_id
+      submit_info.frame_damage.value_or(surface_rect),   // frame_damage
+      submit_info.buffer_damage.value_or(surface_rect),  // buffer_damage
+  };
+
+  // Only a handful of buffers are in flight at any time, so there is no need
+  // to remember the damage of more frames than that.
+  static constexpr size_t kMaxDamageHistory = 4;
+  damage_history_.push_front(present_info.frame_damage);
+  if (damage_history_.size() > kMaxDamageHistory) {
+    damage_history_.pop_back();
+  }
+
+  if (!delegate_->GLContextPresent(present_info)) {
+    damage_history_.clear();
     return false;
   }
 
@@ -5,8 +5,10 @@
 #ifndef SHELL_GPU_GPU_SURFACE_GL_H_
 #define SHELL_GPU_GPU_SURFACE_GL_H_
 
+#include <deque>
 #include <functional>
 #include <memory>
+#include <optional>
 
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/gl_context_switch.h"
@@ -64,6 +66,12 @@ class GPUSurfaceGL : public Surface {
   // external view embedder is present.
   const bool render_to_surface_;
   bool valid_ = false;
+  // The damage of the most recently presented frames, newest first. Used
+  // together with the age of the framebuffer to determine how much of it must
+  // be repainted. Cleared whenever the onscreen surface or the root surface
+  // transformation changes.
+  std::deque<SkIRect> damage_history_;
+  SkMatrix last_root_surface_transformation_;
   fml::TaskRunnerAffineWeakPtrFactory<GPUSurfaceGL> weak_factory_;
 
   bool CreateOrUpdateSurfaces(const SkISize& size);
@@ -72,7 +80,10 @@ class GPUSurfaceGL : public Surface {
       const SkISize& untransformed_size,
       const SkMatrix& root_surface_transformation);
 
-  bool PresentSurface(SkCanvas* canvas);
+  std::optional<SkIRect> ExistingDamage(
+      const SkMatrix& root_surface_transformation);
+
+  bool PresentSurface(const SurfaceFrame& surface_frame, SkCanvas* canvas);
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceGL);
 };
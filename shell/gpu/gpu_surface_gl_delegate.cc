@@ -16,6 +16,10 @@ bool GPUSurfaceGLDelegate::GLContextFBOResetAfterPresent() const {
   return false;
 }
 
+uint32_t GPUSurfaceGLDelegate::GLContextFBOAge() const {
+  return 0;
+}
+
 bool GPUSurfaceGLDelegate::SurfaceSupportsReadback() const {
   return true;
 }
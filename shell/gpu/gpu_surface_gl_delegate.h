@@ -10,6 +10,7 @@
 #include "flutter/fml/macros.h"
 #include "flutter/shell/gpu/gpu_surface_delegate.h"
 #include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/gpu/gl/GrGLInterface.h"
 
 namespace flutter {
@@ -21,6 +22,17 @@ struct GLFrameInfo {
   uint32_t height;
 };
 
+struct GLPresentInfo {
+  // The ID of the framebuffer that is being presented.
+  uint32_t fbo_id;
+
+  // The area of the frame that changed since the previously presented frame.
+  SkIRect frame_damage;
+
+  // The area of the framebuffer that was repainted.
+  SkIRect buffer_damage;
+};
+
 class GPUSurfaceGLDelegate : public GPUSurfaceDelegate {
  public:
   ~GPUSurfaceGLDelegate() override;
@@ -37,7 +49,7 @@ class GPUSurfaceGLDelegate : public GPUSurfaceDelegate {
 
   // Called to present the main GL surface. This is only called for the main GL
   // context and not any of the contexts dedicated for IO.
-  virtual bool GLContextPresent(uint32_t fbo_id) = 0;
+  virtual bool GLContextPresent(const GLPresentInfo& present_info) = 0;
 
   // The ID of the main window bound framebuffer. Typically FBO0.
   virtual intptr_t GLContextFBO(GLFrameInfo frame_info) const = 0;
@@ -49,6 +61,13 @@ class GPUSurfaceGLDelegate : public GPUSurfaceDelegate {
   // rendering subsequent frames.
   virtual bool GLContextFBOResetAfterPresent() const;
 
+  // The age of the buffer backing the main window bound framebuffer, as
+  // defined by EGL_EXT_buffer_age: 0 if its contents are undefined, 1 if it
+  // holds the previously presented frame, 2 if it holds the frame before that,
+  // etc. If the age is known, only the parts of the frame that changed since
+  // the buffer was last presented are repainted. Defaults to 0.
+  virtual uint32_t GLContextFBOAge() const;
+
   // Indicates whether or not the surface supports pixel readback as used in
   // circumstances such as a BackdropFilter.
   virtual bool SurfaceSupportsReadback() const;
@@ -56,6 +56,11 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  SurfaceFrame::FramebufferInfo framebuffer_info;
+  if (backing_store->generationID() == last_presented_generation_id_) {
+    framebuffer_info.existing_damage = SkIRect::MakeEmpty();
+  }
+
   SurfaceFrame::SubmitCallback on_submit =
       [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) -> bool {
@@ -66,10 +71,20 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    sk_sp<SkSurface> surface = surface_frame.SkiaSurface();
+    const SkIRect damage = surface_frame.submit_info().buffer_damage.value_or(
+        SkIRect::MakeWH(surface->width(), surface->height()));
+    if (!self->delegate_->PresentBackingStore(surface, damage)) {
+      self->last_presented_generation_id_ = 0;
+      return false;
+    }
+    self->last_presented_generation_id_ = surface->generationID();
+    return true;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  auto frame = std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  frame->set_framebuffer_info(framebuffer_info);
+  return frame;
 }
 
 // |Surface|
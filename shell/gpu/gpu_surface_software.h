@@ -41,6 +41,10 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  // The generation ID of the backing store right after it was last presented.
+  // If the delegate hands out the same, unmodified backing store for the next
+  // frame, only the parts of the frame that changed need to be repainted.
+  uint32_t last_presented_generation_id_ = 0;
   fml::TaskRunnerAffineWeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
@@ -47,11 +47,16 @@ class GPUSurfaceSoftwareDelegate : public GPUSurfaceDelegate {
   ///             backing store and the platform must display it on-screen.
   ///
   /// @param[in]  backing_store  The software backing store to present.
+  /// @param[in]  damage         The area of the backing store that changed
+  ///                            since it was last presented. Platforms that
+  ///                            copy the backing store may limit the copy to
+  ///                            this area.
   ///
   /// @return     Returns if the platform could present the backing store onto
   ///             the screen.
   ///
-  virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store) = 0;
+  virtual bool PresentBackingStore(sk_sp<SkSurface> backing_store,
+                                   const SkIRect& damage) = 0;
 };
 
 }  // namespace flutter
@@ -103,7 +103,8 @@ sk_sp<SkSurface> AndroidSurfaceSoftware::AcquireBackingStore(
 }
 
 bool AndroidSurfaceSoftware::PresentBackingStore(
-    sk_sp<SkSurface> backing_store) {
+    sk_sp<SkSurface> backing_store,
+    const SkIRect& damage) {
   TRACE_EVENT0("flutter", "AndroidSurfaceSoftware::PresentBackingStore");
   if (!IsValid() || backing_store == nullptr) {
     return false;
@@ -20,7 +20,19 @@ std::unique_ptr<fml::Mapping> GetMappingFromNSData(NSData* data) {
 }
 
 NSData* GetNSDataFromMapping(std::unique_ptr<fml::Mapping> mapping) {
-  return [NSData dataWithBytes:mapping->GetMapping() length:mapping->GetSize()];
+  const size_t size = mapping->GetSize();
+  if (size == 0) {
+    return [NSData data];
+  }
+  // NSData is immutable, so it can take over the mapping instead of copying
+  // its contents.
+  void* bytes = const_cast<uint8_t*>(mapping->GetMapping());
+  fml::Mapping* owned_mapping = mapping.release();
+  return [[[NSData alloc] initWithBytesNoCopy:bytes
+                                       length:size
+                                  deallocator:^(void* bytes, NSUInteger length) {
+                                    delete owned_mapping;
+                                  }] autorelease];
 }
 
 }  // namespace flutter
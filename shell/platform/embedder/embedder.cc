@@ -43,9 +43,11 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/thread.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/shell/common/persistent_cache.h"
 #include "flutter/shell/common/rasterizer.h"
+#include "flutter/shell/common/shell_pool.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/platform/embedder/embedder.h"
 #include "flutter/shell/platform/embedder/embedder_engine.h"
@@ -110,8 +112,8 @@ static bool IsSoftwareRendererConfigValid(const FlutterRendererConfig* config) {
 
   const FlutterSoftwareRendererConfig* software_config = &config->software;
 
-  if (SAFE_ACCESS(software_config, surface_present_callback, nullptr) ==
-      nullptr) {
+  if (!SAFE_EXISTS_ONE_OF(software_config, surface_present_callback,
+                          surface_present_with_damage_callback)) {
     return false;
   }
 
@@ -135,6 +137,13 @@ static bool IsRendererValid(const FlutterRendererConfig* config) {
   return false;
 }
 
+static FlutterRect ToFlutterRect(const SkIRect& rect) {
+  return FlutterRect{static_cast<double>(rect.left()),
+                     static_cast<double>(rect.top()),
+                     static_cast<double>(rect.right()),
+                     static_cast<double>(rect.bottom())};
+}
+
 #if OS_LINUX || OS_WIN
 static void* DefaultGLProcResolver(const char* name) {
   static fml::RefPtr<fml::NativeLibrary> proc_library =
@@ -166,15 +175,19 @@ InferOpenGLPlatformViewCreationCallback(
   auto gl_clear_current = [ptr = config->open_gl.clear_current,
                            user_data]() -> bool { return ptr(user_data); };
 
-  auto gl_present = [present = config->open_gl.present,
-                     present_with_info = config->open_gl.present_with_info,
-                     user_data](uint32_t fbo_id) -> bool {
+  auto gl_present =
+      [present = config->open_gl.present,
+       present_with_info = config->open_gl.present_with_info,
+       user_data](const flutter::GLPresentInfo& gl_present_info) -> bool {
     if (present) {
       return present(user_data);
     } else {
       FlutterPresentInfo present_info = {};
       present_info.struct_size = sizeof(FlutterPresentInfo);
-      present_info.fbo_id = fbo_id;
+      present_info.fbo_id = gl_present_info.fbo_id;
+      present_info.frame_damage = ToFlutterRect(gl_present_info.frame_damage);
+      present_info.buffer_damage =
+          ToFlutterRect(gl_present_info.buffer_damage);
       return present_with_info(user_data, &present_info);
     }
   };
@@ -240,6 +253,12 @@ InferOpenGLPlatformViewCreationCallback(
 #endif
   }
 
+  std::function<uint32_t(void)> gl_fbo_age_callback = nullptr;
+  if (SAFE_ACCESS(open_gl_config, fbo_age_callback, nullptr) != nullptr) {
+    gl_fbo_age_callback = [ptr = config->open_gl.fbo_age_callback,
+                           user_data]() { return ptr(user_data); };
+  }
+
   bool fbo_reset_after_present =
       SAFE_ACCESS(open_gl_config, fbo_reset_after_present, false);
 
@@ -251,6 +270,7 @@ InferOpenGLPlatformViewCreationCallback(
       gl_make_resource_current_callback,   // gl_make_resource_current_callback
       gl_surface_transformation_callback,  // gl_surface_transformation_callback
       gl_proc_resolver,                    // gl_proc_resolver
+      gl_fbo_age_callback,                 // gl_fbo_age_callback
   };
 
   return fml::MakeCopyable(
@@ -280,10 +300,20 @@ InferSoftwarePlatformViewCreationCallback(
     return nullptr;
   }
 
+  const FlutterSoftwareRendererConfig* software_config = &config->software;
   auto software_present_backing_store =
-      [ptr = config->software.surface_present_callback, user_data](
-          const void* allocation, size_t row_bytes, size_t height) -> bool {
-    return ptr(user_data, allocation, row_bytes, height);
+      [ptr = SAFE_ACCESS(software_config, surface_present_callback, nullptr),
+       ptr_with_damage = SAFE_ACCESS(software_config,
+                                     surface_present_with_damage_callback,
+                                     nullptr),
+       user_data](const void* allocation, size_t row_bytes, size_t height,
+                  const SkIRect& damage) -> bool {
+    if (ptr) {
+      return ptr(user_data, allocation, row_bytes, height);
+    }
+    FlutterRect flutter_damage = ToFlutterRect(damage);
+    return ptr_with_damage(user_data, allocation, row_bytes, height,
+                           &flutter_damage);
   };
 
   flutter::EmbedderSurfaceSoftware::SoftwareDispatchTable
@@ -711,10 +741,14 @@ FlutterEngineResult FlutterEngineRun(size_t version,
   return FlutterEngineRunInitialized(*engine_out);
 }
 
-FlutterEngineResult FlutterEngineInitialize(size_t version,
+// Initializes an engine. Without custom task runners, the calling thread
+// becomes the platform thread of the engine unless |create_platform_thread| is
+// set.
+static FlutterEngineResult InitializeEngine(size_t version,
                                             const FlutterRendererConfig* config,
                                             const FlutterProjectArgs* args,
                                             void* user_data,
+                                            bool create_platform_thread,
                                             FLUTTER_API_SYMBOL(FlutterEngine) *
                                                 engine_out) {
   // Step 0: Figure out arguments for shell creation.
@@ -799,6 +833,12 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   settings.assets_path = args->assets_path;
   settings.leak_vm = !SAFE_ACCESS(args, shutdown_dart_vm_when_done, false);
   settings.old_gen_heap_size = SAFE_ACCESS(args, dart_old_gen_heap_size, -1);
+  settings.raster_cache_max_bytes =
+      SAFE_ACCESS(args, raster_cache_max_bytes, 0);
+  settings.raster_cache_retained_frames =
+      SAFE_ACCESS(args, raster_cache_retained_frames, 0);
+  settings.software_raster_tile_count =
+      SAFE_ACCESS(args, software_raster_tile_count, 0);
 
   if (!flutter::DartVM::IsRunningPrecompiledCode()) {
     // Verify the assets path contains Dart 2 kernel assets.
@@ -922,9 +962,11 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
           const FlutterPlatformMessage incoming_message = {
               sizeof(FlutterPlatformMessage),  // struct_size
               message->channel().c_str(),      // channel
-              message->data().data(),          // message
-              message->data().size(),          // message_size
+              message->data().GetMapping(),    // message
+              message->data().GetSize(),       // message_size
               handle,                          // response_handle
+              nullptr,                         // user_data
+              nullptr,                         // message_collect_callback
           };
           handle->message = std::move(message);
           return ptr(&incoming_message, user_data);
@@ -1078,7 +1120,8 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
 
   auto thread_host =
       flutter::EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
-          SAFE_ACCESS(args, custom_task_runners, nullptr));
+          SAFE_ACCESS(args, custom_task_runners, nullptr),
+          create_platform_thread);
 
   if (!thread_host || !thread_host->IsValid()) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments,
@@ -1120,12 +1163,36 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
       external_texture_callback      //
   );
 
+  if (SAFE_ACCESS(args, memory_pressure_callback, nullptr) != nullptr) {
+    embedder_engine->SetMemoryPressureCallback(
+        [ptr = args->memory_pressure_callback,
+         user_data](const flutter::MemoryAccounting::Usage& usage) {
+          FlutterMemoryUsage embedder_usage = {};
+          embedder_usage.struct_size = sizeof(FlutterMemoryUsage);
+          embedder_usage.category =
+              static_cast<FlutterMemoryCategory>(usage.category);
+          embedder_usage.bytes = usage.bytes;
+          embedder_usage.has_budget = usage.budget.has_value();
+          embedder_usage.budget = usage.budget.value_or(0);
+          ptr(&embedder_usage, user_data);
+        });
+  }
+
   // Release the ownership of the embedder engine to the caller.
   *engine_out = reinterpret_cast<FLUTTER_API_SYMBOL(FlutterEngine)>(
       embedder_engine.release());
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineInitialize(size_t version,
+                                            const FlutterRendererConfig* config,
+                                            const FlutterProjectArgs* args,
+                                            void* user_data,
+                                            FLUTTER_API_SYMBOL(FlutterEngine) *
+                                                engine_out) {
+  return InitializeEngine(version, config, args, user_data, false, engine_out);
+}
+
 FlutterEngineResult FlutterEngineRunInitialized(
     FLUTTER_API_SYMBOL(FlutterEngine) engine) {
   if (!engine) {
@@ -1136,12 +1203,13 @@ FlutterEngineResult FlutterEngineRunInitialized(
 
   // The engine must not already be running. Initialize may only be called
   // once on an engine instance.
-  if (embedder_engine->IsValid()) {
+  if (embedder_engine->IsRunning()) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
   }
 
-  // Step 1: Launch the shell.
-  if (!embedder_engine->LaunchShell()) {
+  // Step 1: Launch the shell, unless the engine came from a pool that already
+  // launched it.
+  if (!embedder_engine->IsValid() && !embedder_engine->LaunchShell()) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments,
                               "Could not launch the engine using supplied "
                               "initialization arguments.");
@@ -1164,6 +1232,120 @@ FlutterEngineResult FlutterEngineRunInitialized(
   return kSuccess;
 }
 
+struct _FlutterEnginePool {
+  // The engines are launched on this thread, so it must outlive |engines|.
+  // Engines don't use it once launched.
+  fml::Thread launch_thread;
+  std::unique_ptr<flutter::ShellPool<flutter::EmbedderEngine>> engines;
+
+  _FlutterEnginePool() : launch_thread("io.flutter.engine_pool") {}
+};
+
+// Initializes an engine and launches its shell, without notifying the
+// platform view or running the root isolate. The engine gets a platform thread
+// of its own, since the thread it is launched on may go away before it does.
+static std::unique_ptr<flutter::EmbedderEngine> LaunchPooledEngine(
+    const FlutterRendererConfig* config,
+    const FlutterProjectArgs* args,
+    void* user_data) {
+  FLUTTER_API_SYMBOL(FlutterEngine) engine = nullptr;
+  if (InitializeEngine(FLUTTER_ENGINE_VERSION, config, args, user_data, true,
+                       &engine) != kSuccess) {
+    return nullptr;
+  }
+  std::unique_ptr<flutter::EmbedderEngine> embedder_engine(
+      reinterpret_cast<flutter::EmbedderEngine*>(engine));
+  if (!embedder_engine->LaunchShell()) {
+    FML_LOG(ERROR) << "Could not launch a pooled engine using supplied "
+                      "initialization arguments.";
+    return nullptr;
+  }
+  return embedder_engine;
+}
+
+FlutterEngineResult FlutterEnginePoolCreate(size_t version,
+                                            const FlutterRendererConfig* config,
+                                            const FlutterProjectArgs* args,
+                                            void* user_data,
+                                            size_t warm_engine_count,
+                                            FlutterEnginePool* pool_out) {
+  if (version != FLUTTER_ENGINE_VERSION) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidLibraryVersion,
+        "Flutter embedder version mismatch. There has been a breaking change. "
+        "Please consult the changelog and update the embedder.");
+  }
+
+  if (config == nullptr || args == nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "The renderer configuration or project arguments were missing.");
+  }
+
+  if (pool_out == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "The pool out parameter was missing.");
+  }
+
+  // Launching an engine waits for tasks on its platform and render task
+  // runners, which the embedder can't run without a handle to the engine.
+  if (SAFE_ACCESS(args, custom_task_runners, nullptr) != nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments, "Engine pools do not support custom task runners.");
+  }
+
+  auto pool = std::make_unique<_FlutterEnginePool>();
+  using EnginePool = flutter::ShellPool<flutter::EmbedderEngine>;
+  pool->engines = std::make_unique<EnginePool>(
+      warm_engine_count,
+      [config, args, user_data]() {
+        return LaunchPooledEngine(config, args, user_data);
+      },
+      pool->launch_thread.GetTaskRunner());
+
+  *pool_out = pool.release();
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEnginePoolAcquireEngine(
+    FlutterEnginePool pool,
+    const char* dart_entrypoint,
+    FLUTTER_API_SYMBOL(FlutterEngine) * engine_out) {
+  if (pool == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Pool handle was invalid.");
+  }
+
+  if (engine_out == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "The engine out parameter was missing.");
+  }
+
+  auto embedder_engine = pool->engines->Take();
+  if (!embedder_engine) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Could not launch the engine using supplied "
+                              "initialization arguments.");
+  }
+
+  if (dart_entrypoint != nullptr && dart_entrypoint[0] != '\0') {
+    embedder_engine->SetDartEntrypoint(dart_entrypoint);
+  }
+
+  *engine_out = reinterpret_cast<FLUTTER_API_SYMBOL(FlutterEngine)>(
+      embedder_engine.release());
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEnginePoolCollect(FlutterEnginePool pool) {
+  if (pool == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Pool handle was invalid.");
+  }
+
+  // Collects the engines before the thread that launches them.
+  delete pool;
+  return kSuccess;
+}
+
 FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineDeinitialize(FLUTTER_API_SYMBOL(FlutterEngine)
                                                   engine) {
@@ -1355,6 +1537,22 @@ FlutterEngineResult FlutterEngineSendPointerEvent(
                                   "running Flutter application.");
 }
 
+// Wraps a buffer that the embedder lets the engine (and Dart code) use, and
+// write to, until |collect_callback| is invoked.
+static std::unique_ptr<fml::Mapping> CreateEmbedderOwnedMapping(
+    const uint8_t* data,
+    size_t size,
+    VoidCallback collect_callback,
+    void* user_data) {
+  return std::make_unique<fml::NonOwnedMapping>(
+      data, size,
+      [collect_callback, user_data](const uint8_t* data, size_t size) {
+        collect_callback(user_data);
+      },
+      true  // is_writable
+  );
+}
+
 FlutterEngineResult FlutterEngineSendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const FlutterPlatformMessage* flutter_message) {
@@ -1388,10 +1586,24 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
     response = response_handle->message->response();
   }
 
+  VoidCallback collect_callback =
+      SAFE_ACCESS(flutter_message, message_collect_callback, nullptr);
+  void* user_data = SAFE_ACCESS(flutter_message, user_data, nullptr);
+
   fml::RefPtr<flutter::PlatformMessage> message;
   if (message_size == 0) {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
         flutter_message->channel, response);
+    if (collect_callback != nullptr) {
+      collect_callback(user_data);
+    }
+  } else if (collect_callback != nullptr) {
+    // The embedder owns the buffer, so it can be handed to Dart as is.
+    message = fml::MakeRefCounted<flutter::PlatformMessage>(
+        flutter_message->channel,
+        CreateEmbedderOwnedMapping(message_data, message_size,
+                                   collect_callback, user_data),
+        response);
   } else {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
         flutter_message->channel,
@@ -1483,6 +1695,45 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineSendPlatformMessageResponseNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    const uint8_t* data,
+    size_t data_length,
+    VoidCallback data_collect_callback,
+    void* user_data) {
+  if (handle == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid response handle.");
+  }
+
+  if (data_collect_callback == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Data collect callback was null.");
+  }
+
+  if (data_length != 0 && data == nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "Data size was non zero but the pointer to the data was null.");
+  }
+
+  auto response = handle->message->response();
+
+  if (response && data_length != 0) {
+    response->Complete(CreateEmbedderOwnedMapping(
+        data, data_length, data_collect_callback, user_data));
+  } else {
+    if (response) {
+      response->CompleteEmpty();
+    }
+    data_collect_callback(user_data);
+  }
+
+  delete handle;
+
+  return kSuccess;
+}
+
 FlutterEngineResult __FlutterEngineFlushPendingTasksNow() {
   fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
   return kSuccess;
@@ -1932,6 +2183,92 @@ FlutterEngineResult FlutterEngineNotifyLowMemoryWarning(
                    "Could not dispatch the low memory notification message.");
 }
 
+static_assert(static_cast<int>(kFlutterMemoryCategoryRasterCache) ==
+                  static_cast<int>(flutter::MemoryCategory::kRasterCache) &&
+              static_cast<int>(kFlutterMemoryCategoryImages) ==
+                  static_cast<int>(flutter::MemoryCategory::kImages) &&
+              static_cast<int>(kFlutterMemoryCategoryRenderTargets) ==
+                  static_cast<int>(flutter::MemoryCategory::kRenderTargets) &&
+              static_cast<int>(kFlutterMemoryCategoryTextAtlases) ==
+                  static_cast<int>(flutter::MemoryCategory::kTextAtlases) &&
+              static_cast<int>(kFlutterMemoryCategoryResourceCache) ==
+                  static_cast<int>(flutter::MemoryCategory::kResourceCache),
+              "Embedder memory categories must match the engine's.");
+
+static bool IsValidMemoryCategory(FlutterMemoryCategory category) {
+  return category >= kFlutterMemoryCategoryRasterCache &&
+         category <= kFlutterMemoryCategoryResourceCache;
+}
+
+FlutterEngineResult FlutterEngineGetMemoryUsage(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterMemoryCategory category,
+    FlutterMemoryUsage* usage_out) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (!IsValidMemoryCategory(category)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid memory category specified.");
+  }
+
+  if (usage_out == nullptr ||
+      usage_out->struct_size < sizeof(FlutterMemoryUsage)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid memory usage struct specified.");
+  }
+
+  const auto usage = engine->GetShell().GetMemoryAccounting()->GetUsage(
+      static_cast<flutter::MemoryCategory>(category));
+  usage_out->category = category;
+  usage_out->bytes = usage.bytes;
+  usage_out->has_budget = usage.budget.has_value();
+  usage_out->budget = usage.budget.value_or(0);
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineSetMemoryBudget(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterMemoryCategory category,
+    bool has_budget,
+    uint64_t budget) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (!IsValidMemoryCategory(category)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid memory category specified.");
+  }
+
+  engine->GetShell().GetMemoryAccounting()->SetBudget(
+      static_cast<flutter::MemoryCategory>(category),
+      has_budget ? std::optional<size_t>(budget) : std::nullopt);
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEnginePurgeMemory(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterMemoryCategory category,
+    uint64_t target_bytes) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (!IsValidMemoryCategory(category)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid memory category specified.");
+  }
+
+  engine->GetShell().GetMemoryAccounting()->Purge(
+      static_cast<flutter::MemoryCategory>(category), target_bytes);
+  return kSuccess;
+}
+
 FlutterEngineResult FlutterEnginePostCallbackOnAllNativeThreads(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     FlutterNativeThreadCallback callback,
@@ -334,6 +334,16 @@ typedef struct {
   double y;
 } FlutterPoint;
 
+/// Callback for when a software surface is presented. Like
+/// `SoftwareSurfacePresentCallback` but the embedder is also passed the area of
+/// the buffer that changed since the previous present.
+typedef bool (*SoftwareSurfacePresentWithDamageCallback)(
+    void* /* user data */,
+    const void* /* allocation */,
+    size_t /* row bytes */,
+    size_t /* height */,
+    const FlutterRect* /* damage */);
+
 /// A structure to represent a rounded rectangle.
 typedef struct {
   FlutterRect rect;
@@ -367,6 +377,13 @@ typedef struct {
   size_t struct_size;
   /// Id of the fbo backing the surface that was presented.
   uint32_t fbo_id;
+  /// The area of the frame that changed since the previously presented frame.
+  /// Covers the whole surface if the engine could not determine what changed.
+  FlutterRect frame_damage;
+  /// The area of the fbo that was repainted. Only this area needs to be
+  /// swapped or copied (for example with `eglSwapBuffersWithDamageKHR`). Covers
+  /// the whole surface if the engine repainted the entire frame.
+  FlutterRect buffer_damage;
 } FlutterPresentInfo;
 
 /// Callback for when a surface is presented.
@@ -432,6 +449,14 @@ typedef struct {
   /// `FlutterPresentInfo` struct that the embedder can use to release any
   /// resources. The return value indicates success of the present call.
   BoolPresentInfoCallback present_with_info;
+  /// This is an optional callback. It returns the age of the buffer backing
+  /// the fbo that the next frame will be rendered into, with the same meaning
+  /// as `EGL_EXT_buffer_age`: 0 if its contents are undefined, 1 if it holds
+  /// the previously presented frame, 2 if it holds the frame before that, and
+  /// so on. When the age is known, the engine only repaints the parts of the
+  /// frame that changed since the buffer was last presented. If this callback
+  /// is not specified, every frame is repainted in its entirety.
+  UIntCallback fbo_age_callback;
 } FlutterOpenGLRendererConfig;
 
 typedef struct {
@@ -440,8 +465,14 @@ typedef struct {
   /// The callback presented to the embedder to present a fully populated buffer
   /// to the user. The pixel format of the buffer is the native 32-bit RGBA
   /// format. The buffer is owned by the Flutter engine and must be copied in
-  /// this callback if needed.
+  /// this callback if needed. Specifying one (and only one) of
+  /// `surface_present_callback` or `surface_present_with_damage_callback` is
+  /// required.
   SoftwareSurfacePresentCallback surface_present_callback;
+  /// Like `surface_present_callback` but the embedder is also passed the area
+  /// of the buffer that changed since the previous present. Only the pixels in
+  /// this area need to be copied to the screen.
+  SoftwareSurfacePresentWithDamageCallback surface_present_with_damage_callback;
 } FlutterSoftwareRendererConfig;
 
 typedef struct {
@@ -570,6 +601,28 @@ typedef struct {
   /// `FlutterEngineSendPlatformMessageResponse` will cause a memory leak. It is
   /// not safe to send multiple responses on a single response object.
   const FlutterPlatformMessageResponseHandle* response_handle;
+  /// An opaque baton passed back to the embedder when the
+  /// `message_collect_callback` is invoked. The engine does not interpret this
+  /// field in any way.
+  void* user_data;
+  /// This is an optional field that is only read by
+  /// `FlutterEngineSendPlatformMessage`.
+  ///
+  /// When specified, the engine takes over the `message` buffer instead of
+  /// copying it and hands it to Dart code directly. The embedder must keep the
+  /// buffer alive and not modify it till this callback is invoked with
+  /// `user_data`, once the message is no longer needed by the engine or any
+  /// isolate. The callback may be made on any thread. Dart code may modify the
+  /// buffer, so it must not have page protections that restrict writing to it.
+  ///
+  /// When NOT specified, the engine copies the buffer and the embedder is free
+  /// to collect it as soon as `FlutterEngineSendPlatformMessage` returns.
+  ///
+  /// @attention      The message_collect_callback is not invoked if
+  ///                 `FlutterEngineSendPlatformMessage` returns
+  ///                 kInvalidArguments. In that case, it is the embedders
+  ///                 responsibility to collect the buffer.
+  VoidCallback message_collect_callback;
 } FlutterPlatformMessage;
 
 typedef void (*FlutterPlatformMessageCallback)(
@@ -963,6 +1016,41 @@ typedef const FlutterLocale* (*FlutterComputePlatformResolvedLocaleCallback)(
     const FlutterLocale** /* supported_locales*/,
     size_t /* Number of locales*/);
 
+/// The categories of memory tracked by the engine. Each category can be given
+/// a budget. When a category goes over its budget, the engine purges that
+/// category only and notifies the embedder.
+typedef enum {
+  /// Layers and pictures rasterized ahead of time to speed up later frames.
+  kFlutterMemoryCategoryRasterCache,
+  /// Decoded images that are referenced from Dart.
+  kFlutterMemoryCategoryImages,
+  /// Render targets kept between frames for platform view compositing.
+  kFlutterMemoryCategoryRenderTargets,
+  /// Glyphs cached for text rendering. This cache is shared by all engines in
+  /// the process.
+  kFlutterMemoryCategoryTextAtlases,
+  /// GPU resources cached by Skia between frames.
+  kFlutterMemoryCategoryResourceCache,
+} FlutterMemoryCategory;
+
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterMemoryUsage).
+  size_t struct_size;
+  FlutterMemoryCategory category;
+  /// The bytes currently held by the category.
+  uint64_t bytes;
+  /// Whether the category has a budget.
+  bool has_budget;
+  /// The budget of the category in bytes. Only valid if `has_budget` is true.
+  uint64_t budget;
+} FlutterMemoryUsage;
+
+/// Called when a memory category goes over its budget, after the engine was
+/// asked to purge it. May be called on any thread.
+typedef void (*FlutterMemoryPressureCallback)(
+    const FlutterMemoryUsage* /* usage */,
+    void* /* user data */);
+
 typedef int64_t FlutterEngineDartPort;
 
 typedef enum {
@@ -1318,6 +1406,29 @@ typedef struct {
   /// matches what the platform would natively resolve to as possible.
   FlutterComputePlatformResolvedLocaleCallback
       compute_platform_resolved_locale_callback;
+
+  /// The maximum number of bytes that images in the raster cache may use, or 0
+  /// for no limit. When the limit is exceeded, the cache evicts the entries
+  /// that are cheapest to rasterize again. Content that can never fit within
+  /// the limit is not cached.
+  size_t raster_cache_max_bytes;
+
+  /// The number of frames an unused entry is kept in the raster cache before
+  /// it is evicted. Defaults to 0, which evicts entries as soon as a frame
+  /// does not use them. Retaining entries avoids rasterizing the same content
+  /// repeatedly when the application alternates between a few states.
+  size_t raster_cache_retained_frames;
+
+  /// When using the software renderer, the number of tiles each frame is split
+  /// into. The tiles are rendered in parallel on the engine's worker threads,
+  /// and only tiles that changed since the last presented frame are rendered.
+  /// 0 or 1 renders frames on the raster thread only.
+  size_t software_raster_tile_count;
+
+  /// A callback invoked when a memory category goes over the budget set with
+  /// `FlutterEngineSetMemoryBudget`. The `user_data` passed to
+  /// `FlutterEngineRun` is passed to it. May be NULL.
+  FlutterMemoryPressureCallback memory_pressure_callback;
 } FlutterProjectArgs;
 
 //------------------------------------------------------------------------------
@@ -1429,6 +1540,86 @@ FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineRunInitialized(
     FLUTTER_API_SYMBOL(FlutterEngine) engine);
 
+/// A pool of engines that are launched ahead of time.
+typedef struct _FlutterEnginePool* FlutterEnginePool;
+
+//------------------------------------------------------------------------------
+/// @brief      Creates a pool that keeps a number of engines launched ahead of
+///             time. Launching an engine creates its threads, acquires the
+///             Dart VM and sets up the isolate snapshot and fonts, which makes
+///             up most of the time it takes to run an engine. Engines acquired
+///             from the pool only need to be bound to their surface and have
+///             their root isolate run by `FlutterEngineRunInitialized`.
+///
+///             The pool launches engines in the background, on a thread it
+///             owns. Each engine gets a platform thread of its own, on which
+///             it calls back into the embedder. Calls the embedder makes to
+///             the engine from other threads are forwarded to that thread.
+///             Custom task runners are not supported, since the embedder
+///             would have to run the tasks of engines it has no handle to.
+///
+/// @warning    The renderer configuration and project arguments must remain
+///             valid until the pool is collected. All engines of the pool
+///             share the same user data baton.
+///
+/// @param[in]  version            The Flutter embedder API version. Must be
+///                                FLUTTER_ENGINE_VERSION.
+/// @param[in]  config             The renderer configuration of the engines.
+/// @param[in]  args               The Flutter project arguments of the
+///                                engines.
+/// @param      user_data          A user data baton passed back to embedders
+///                                in callbacks.
+/// @param[in]  warm_engine_count  The number of launched engines to keep.
+/// @param[out] pool_out           The pool on successful creation.
+///
+/// @return     The result of the call to create the pool.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEnginePoolCreate(size_t version,
+                                            const FlutterRendererConfig* config,
+                                            const FlutterProjectArgs* args,
+                                            void* user_data,
+                                            size_t warm_engine_count,
+                                            FlutterEnginePool* pool_out);
+
+//------------------------------------------------------------------------------
+/// @brief      Hands out a launched engine from the pool and starts launching
+///             its replacement. If no launched engine is available, one is
+///             launched on the calling thread.
+///
+///             The engine is initialized but not running. It must be run via
+///             `FlutterEngineRunInitialized` and collected via
+///             `FlutterEngineShutdown`, like engines that were initialized via
+///             `FlutterEngineInitialize`.
+///
+/// @param[in]  pool             The pool to take the engine from.
+/// @param[in]  dart_entrypoint  The entrypoint of the root isolate of the
+///                              engine, or NULL for the
+///                              `FlutterProjectArgs::custom_dart_entrypoint`
+///                              of the pool.
+/// @param[out] engine_out       The engine handle.
+///
+/// @return     The result of the call to acquire an engine.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEnginePoolAcquireEngine(
+    FlutterEnginePool pool,
+    const char* dart_entrypoint,
+    FLUTTER_API_SYMBOL(FlutterEngine) * engine_out);
+
+//------------------------------------------------------------------------------
+/// @brief      Collects the pool along with the engines it has not handed out.
+///             Engines that were acquired from the pool are not affected.
+///
+///             This waits for an engine being launched in the background.
+///
+/// @param[in]  pool  The pool to collect.
+///
+/// @return     The result of the call to collect the pool.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEnginePoolCollect(FlutterEnginePool pool);
+
 FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineSendWindowMetricsEvent(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
@@ -1518,6 +1709,38 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
     const uint8_t* data,
     size_t data_length);
 
+//------------------------------------------------------------------------------
+/// @brief      Send a response from the native side to a platform message from
+///             the Dart Flutter application without copying the response
+///             data. The engine hands the buffer to Dart code directly and
+///             invokes `data_collect_callback` with `user_data`, on any
+///             thread, once no isolate needs it anymore. Until then, the
+///             embedder must keep the buffer alive and not modify it. Dart
+///             code may modify the buffer, so it must not have page
+///             protections that restrict writing to it.
+///
+/// @param[in]  engine                 The running engine instance.
+/// @param[in]  handle                 The platform message response handle.
+/// @param[in]  data                   The data to associate with the platform
+///                                    message response.
+/// @param[in]  data_length            The length of the platform message
+///                                    response data.
+/// @param[in]  data_collect_callback  The callback invoked when the engine is
+///                                    done with the data. Not invoked if the
+///                                    call doesn't return kSuccess.
+/// @param[in]  user_data              The user data passed to the callback.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSendPlatformMessageResponseNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    const uint8_t* data,
+    size_t data_length,
+    VoidCallback data_collect_callback,
+    void* user_data);
+
 //------------------------------------------------------------------------------
 /// @brief      This API is only meant to be used by platforms that need to
 ///             flush tasks on a message loop not controlled by the Flutter
@@ -1864,6 +2087,69 @@ FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineNotifyLowMemoryWarning(
     FLUTTER_API_SYMBOL(FlutterEngine) engine);
 
+//------------------------------------------------------------------------------
+/// @brief      Gets the bytes held by a category of memory of a running
+///             engine instance, along with its budget. Usage is updated by the
+///             engine as it happens or after each frame depending on the
+///             category. This call is thread safe.
+///
+/// @param[in]  engine     A running engine instance.
+/// @param[in]  category   The category of memory to query.
+/// @param[out] usage_out  The usage of the category. Its `struct_size` must be
+///                        set by the caller.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetMemoryUsage(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterMemoryCategory category,
+    FlutterMemoryUsage* usage_out);
+
+//------------------------------------------------------------------------------
+/// @brief      Sets or removes the budget of a category of memory of a running
+///             engine instance. Categories with a native limit, like the
+///             raster cache and Skia's resource cache, apply the budget as
+///             that limit. When the usage of a category goes over its budget,
+///             the engine purges that category and invokes the
+///             `memory_pressure_callback` of the project arguments. This call
+///             is thread safe.
+///
+/// @param[in]  engine      A running engine instance.
+/// @param[in]  category    The category of memory to set the budget of.
+/// @param[in]  has_budget  Whether to set the budget. If false, the budget is
+///                         removed.
+/// @param[in]  budget      The budget in bytes.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSetMemoryBudget(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterMemoryCategory category,
+    bool has_budget,
+    uint64_t budget);
+
+//------------------------------------------------------------------------------
+/// @brief      Asks a running engine instance to free memory held in one
+///             category until it holds at most `target_bytes`. Unlike
+///             `FlutterEngineNotifyLowMemoryWarning`, other categories are left
+///             untouched. The purge happens asynchronously on the thread that
+///             owns the memory, and may free less than asked for memory that
+///             is still in use.
+///
+/// @param[in]  engine        A running engine instance.
+/// @param[in]  category      The category of memory to purge.
+/// @param[in]  target_bytes  The bytes the category may keep.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEnginePurgeMemory(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterMemoryCategory category,
+    uint64_t target_bytes);
+
 //------------------------------------------------------------------------------
 /// @brief      Schedule a callback to be run on all engine managed threads.
 ///             The engine will attempt to service this callback the next time
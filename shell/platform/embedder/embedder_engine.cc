@@ -5,6 +5,8 @@
 #include "flutter/shell/platform/embedder/embedder_engine.h"
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/task_runner.h"
 #include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
 
 namespace flutter {
@@ -38,7 +40,11 @@ EmbedderEngine::EmbedderEngine(
                                               on_create_rasterizer)),
       external_texture_callback_(external_texture_callback) {}
 
-EmbedderEngine::~EmbedderEngine() = default;
+EmbedderEngine::~EmbedderEngine() {
+  // Engines kept warm in a pool are collected with their shell still running.
+  // The shell must go away before its thread host does.
+  CollectShell();
+}
 
 bool EmbedderEngine::LaunchShell() {
   if (!shell_args_) {
@@ -58,11 +64,24 @@ bool EmbedderEngine::LaunchShell() {
   // shell again.
   shell_args_.reset();
 
+  if (IsValid() && memory_pressure_callback_) {
+    shell_->GetMemoryAccounting()->AddPressureObserver(
+        memory_pressure_callback_);
+  }
+
   return IsValid();
 }
 
+void EmbedderEngine::SetMemoryPressureCallback(
+    MemoryAccounting::PressureObserver callback) {
+  memory_pressure_callback_ = std::move(callback);
+}
+
 bool EmbedderEngine::CollectShell() {
-  shell_.reset();
+  if (shell_) {
+    RunOnPlatformThread([this]() { shell_.reset(); });
+  }
+  is_running_ = false;
   return IsValid();
 }
 
@@ -70,10 +89,20 @@ bool EmbedderEngine::RunRootIsolate() {
   if (!IsValid() || !run_configuration_.IsValid()) {
     return false;
   }
-  shell_->RunEngine(std::move(run_configuration_));
+  RunOnPlatformThread(
+      [this]() { shell_->RunEngine(std::move(run_configuration_)); });
+  is_running_ = true;
   return true;
 }
 
+bool EmbedderEngine::IsRunning() const {
+  return is_running_;
+}
+
+void EmbedderEngine::SetDartEntrypoint(std::string entrypoint) {
+  run_configuration_.SetEntrypoint(std::move(entrypoint));
+}
+
 bool EmbedderEngine::IsValid() const {
   return static_cast<bool>(shell_);
 }
@@ -87,7 +116,7 @@ bool EmbedderEngine::NotifyCreated() {
     return false;
   }
 
-  shell_->GetPlatformView()->NotifyCreated();
+  RunOnPlatformThread([this]() { shell_->GetPlatformView()->NotifyCreated(); });
   return true;
 }
 
@@ -96,7 +125,8 @@ bool EmbedderEngine::NotifyDestroyed() {
     return false;
   }
 
-  shell_->GetPlatformView()->NotifyDestroyed();
+  RunOnPlatformThread(
+      [this]() { shell_->GetPlatformView()->NotifyDestroyed(); });
   return true;
 }
 
@@ -109,7 +139,9 @@ bool EmbedderEngine::SetViewportMetrics(flutter::ViewportMetrics metrics) {
   if (!platform_view) {
     return false;
   }
-  platform_view->SetViewportMetrics(std::move(metrics));
+  RunOnPlatformThread([&platform_view, &metrics]() {
+    platform_view->SetViewportMetrics(std::move(metrics));
+  });
   return true;
 }
 
@@ -124,7 +156,9 @@ bool EmbedderEngine::DispatchPointerDataPacket(
     return false;
   }
 
-  platform_view->DispatchPointerDataPacket(std::move(packet));
+  RunOnPlatformThread([&platform_view, &packet]() {
+    platform_view->DispatchPointerDataPacket(std::move(packet));
+  });
   return true;
 }
 
@@ -139,7 +173,9 @@ bool EmbedderEngine::SendPlatformMessage(
     return false;
   }
 
-  platform_view->DispatchPlatformMessage(message);
+  RunOnPlatformThread([&platform_view, &message]() {
+    platform_view->DispatchPlatformMessage(message);
+  });
   return true;
 }
 
@@ -147,9 +183,11 @@ bool EmbedderEngine::RegisterTexture(int64_t texture) {
   if (!IsValid() || !external_texture_callback_) {
     return false;
   }
-  shell_->GetPlatformView()->RegisterTexture(
-      std::make_unique<EmbedderExternalTextureGL>(texture,
-                                                  external_texture_callback_));
+  RunOnPlatformThread([this, texture]() {
+    shell_->GetPlatformView()->RegisterTexture(
+        std::make_unique<EmbedderExternalTextureGL>(
+            texture, external_texture_callback_));
+  });
   return true;
 }
 
@@ -157,7 +195,9 @@ bool EmbedderEngine::UnregisterTexture(int64_t texture) {
   if (!IsValid() || !external_texture_callback_) {
     return false;
   }
-  shell_->GetPlatformView()->UnregisterTexture(texture);
+  RunOnPlatformThread([this, texture]() {
+    shell_->GetPlatformView()->UnregisterTexture(texture);
+  });
   return true;
 }
 
@@ -165,7 +205,9 @@ bool EmbedderEngine::MarkTextureFrameAvailable(int64_t texture) {
   if (!IsValid() || !external_texture_callback_) {
     return false;
   }
-  shell_->GetPlatformView()->MarkTextureFrameAvailable(texture);
+  RunOnPlatformThread([this, texture]() {
+    shell_->GetPlatformView()->MarkTextureFrameAvailable(texture);
+  });
   return true;
 }
 
@@ -178,7 +220,9 @@ bool EmbedderEngine::SetSemanticsEnabled(bool enabled) {
   if (!platform_view) {
     return false;
   }
-  platform_view->SetSemanticsEnabled(enabled);
+  RunOnPlatformThread([&platform_view, enabled]() {
+    platform_view->SetSemanticsEnabled(enabled);
+  });
   return true;
 }
 
@@ -190,7 +234,9 @@ bool EmbedderEngine::SetAccessibilityFeatures(int32_t flags) {
   if (!platform_view) {
     return false;
   }
-  platform_view->SetAccessibilityFeatures(flags);
+  RunOnPlatformThread([&platform_view, flags]() {
+    platform_view->SetAccessibilityFeatures(flags);
+  });
   return true;
 }
 
@@ -204,7 +250,9 @@ bool EmbedderEngine::DispatchSemanticsAction(int id,
   if (!platform_view) {
     return false;
   }
-  platform_view->DispatchSemanticsAction(id, action, std::move(args));
+  RunOnPlatformThread([&platform_view, id, action, &args]() {
+    platform_view->DispatchSemanticsAction(id, action, std::move(args));
+  });
   return true;
 }
 
@@ -224,7 +272,11 @@ bool EmbedderEngine::ReloadSystemFonts() {
     return false;
   }
 
-  return shell_->ReloadSystemFonts();
+  bool reloaded = false;
+  RunOnPlatformThread([this, &reloaded]() {
+    reloaded = shell_->ReloadSystemFonts();
+  });
+  return reloaded;
 }
 
 bool EmbedderEngine::PostRenderThreadTask(const fml::closure& task) {
@@ -275,6 +327,20 @@ bool EmbedderEngine::PostTaskOnEngineManagedNativeThreads(
   return true;
 }
 
+void EmbedderEngine::RunOnPlatformThread(const fml::closure& closure) {
+  if (!thread_host_->HasEngineManagedPlatformThread()) {
+    closure();
+    return;
+  }
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(task_runners_.GetPlatformTaskRunner(),
+                                    [&closure, &latch]() {
+                                      closure();
+                                      latch.Signal();
+                                    });
+  latch.Wait();
+}
+
 Shell& EmbedderEngine::GetShell() {
   FML_DCHECK(shell_);
   return *shell_.get();
@@ -46,6 +46,13 @@ class EmbedderEngine {
 
   bool RunRootIsolate();
 
+  // Whether the root isolate was run on the current shell.
+  bool IsRunning() const;
+
+  // Replaces the entrypoint of the root isolate. Must be called before the
+  // root isolate is run.
+  void SetDartEntrypoint(std::string entrypoint);
+
   bool IsValid() const;
 
   bool SetViewportMetrics(flutter::ViewportMetrics metrics);
@@ -84,14 +91,26 @@ class EmbedderEngine {
 
   Shell& GetShell();
 
+  // Installs |callback| as a memory pressure observer of the shell once it is
+  // launched.
+  void SetMemoryPressureCallback(
+      MemoryAccounting::PressureObserver callback);
+
  private:
   const std::unique_ptr<EmbedderThreadHost> thread_host_;
   TaskRunners task_runners_;
   RunConfiguration run_configuration_;
   std::unique_ptr<ShellArgs> shell_args_;
   std::unique_ptr<Shell> shell_;
+  bool is_running_ = false;
   const EmbedderExternalTextureGL::ExternalTextureCallback
       external_texture_callback_;
+  MemoryAccounting::PressureObserver memory_pressure_callback_;
+
+  // Runs |closure| on the platform thread and waits for it when the engine
+  // manages that thread, as pooled engines do, since the embedder calls from
+  // a thread of its own. Otherwise runs it on the calling thread.
+  void RunOnPlatformThread(const fml::closure& closure);
 
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderEngine);
 };
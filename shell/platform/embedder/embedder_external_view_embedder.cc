@@ -269,4 +269,15 @@ void EmbedderExternalViewEmbedder::SubmitFrame(
   frame->Submit();
 }
 
+// |ExternalViewEmbedder|
+size_t EmbedderExternalViewEmbedder::GetRenderTargetCacheBytes() const {
+  return render_target_cache_.GetCachedTargetsBytes();
+}
+
+// |ExternalViewEmbedder|
+void EmbedderExternalViewEmbedder::PurgeRenderTargetCache() {
+  // @warning: Embedder may trample on our OpenGL context here.
+  render_target_cache_.ClearAllRenderTargetsInCache();
+}
+
 }  // namespace flutter
@@ -97,6 +97,12 @@ class EmbedderExternalViewEmbedder final : public ExternalViewEmbedder {
   // |ExternalViewEmbedder|
   SkCanvas* GetRootCanvas() override;
 
+  // |ExternalViewEmbedder|
+  size_t GetRenderTargetCacheBytes() const override;
+
+  // |ExternalViewEmbedder|
+  void PurgeRenderTargetCache() override;
+
  private:
   const CreateRenderTargetCallback create_render_target_callback_;
   const PresentCallback present_callback_;
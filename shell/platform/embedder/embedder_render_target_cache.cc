@@ -70,4 +70,14 @@ size_t EmbedderRenderTargetCache::GetCachedTargetsCount() const {
   return count;
 }
 
+size_t EmbedderRenderTargetCache::GetCachedTargetsBytes() const {
+  size_t bytes = 0;
+  for (const auto& targets : cached_render_targets_) {
+    // Targets in a stack share a descriptor, and so a size.
+    const SkISize& size = targets.first.surface_size;
+    bytes += targets.second.size() * size.width() * size.height() * 4;
+  }
+  return bytes;
+}
+
 }  // namespace flutter
@@ -43,6 +43,10 @@ class EmbedderRenderTargetCache {
 
   size_t GetCachedTargetsCount() const;
 
+  // The estimated bytes held by the cached targets, assuming their surfaces
+  // have no extra buffers like multisampling or depth attachments.
+  size_t GetCachedTargetsBytes() const;
+
  private:
   using CachedRenderTargets =
       std::unordered_map<EmbedderExternalView::RenderTargetDescriptor,
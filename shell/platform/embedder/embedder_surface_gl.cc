@@ -45,8 +45,8 @@ bool EmbedderSurfaceGL::GLContextClearCurrent() {
 }
 
 // |GPUSurfaceGLDelegate|
-bool EmbedderSurfaceGL::GLContextPresent(uint32_t fbo_id) {
-  return gl_dispatch_table_.gl_present_callback(fbo_id);
+bool EmbedderSurfaceGL::GLContextPresent(const GLPresentInfo& present_info) {
+  return gl_dispatch_table_.gl_present_callback(present_info);
 }
 
 // |GPUSurfaceGLDelegate|
@@ -59,6 +59,15 @@ bool EmbedderSurfaceGL::GLContextFBOResetAfterPresent() const {
   return fbo_reset_after_present_;
 }
 
+// |GPUSurfaceGLDelegate|
+uint32_t EmbedderSurfaceGL::GLContextFBOAge() const {
+  auto callback = gl_dispatch_table_.gl_fbo_age_callback;
+  if (!callback) {
+    return 0;
+  }
+  return callback();
+}
+
 // |GPUSurfaceGLDelegate|
 SkMatrix EmbedderSurfaceGL::GLContextSurfaceTransformation() const {
   auto callback = gl_dispatch_table_.gl_surface_transformation_callback;
@@ -77,7 +77,8 @@ sk_sp<SkSurface> EmbedderSurfaceSoftware::AcquireBackingStore(
 
 // |GPUSurfaceSoftwareDelegate|
 bool EmbedderSurfaceSoftware::PresentBackingStore(
-    sk_sp<SkSurface> backing_store) {
+    sk_sp<SkSurface> backing_store,
+    const SkIRect& damage) {
   if (!IsValid()) {
     FML_LOG(ERROR) << "Tried to present an invalid software surface.";
     return false;
@@ -102,7 +103,8 @@ bool EmbedderSurfaceSoftware::PresentBackingStore(
   return software_dispatch_table_.software_present_backing_store(
       pixmap.addr(),      //
       pixmap.rowBytes(),  //
-      pixmap.height()     //
+      pixmap.height(),    //
+      damage              //
   );
 }
 
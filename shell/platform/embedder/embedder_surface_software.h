@@ -16,7 +16,10 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
                                       public GPUSurfaceSoftwareDelegate {
  public:
   struct SoftwareDispatchTable {
-    std::function<bool(const void* allocation, size_t row_bytes, size_t height)>
+    std::function<bool(const void* allocation,
+                       size_t row_bytes,
+                       size_t height,
+                       const SkIRect& damage)>
         software_present_backing_store;  // required
   };
 
@@ -45,7 +48,8 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   sk_sp<SkSurface> AcquireBackingStore(const SkISize& size) override;
 
   // |GPUSurfaceSoftwareDelegate|
-  bool PresentBackingStore(sk_sp<SkSurface> backing_store) override;
+  bool PresentBackingStore(sk_sp<SkSurface> backing_store,
+                           const SkIRect& damage) override;
 
   // |GPUSurfaceSoftwareDelegate|
   ExternalViewEmbedder* GetExternalViewEmbedder() override;
@@ -81,7 +81,8 @@ CreateEmbedderTaskRunner(const FlutterTaskRunnerDescription* description) {
 
 std::unique_ptr<EmbedderThreadHost>
 EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
-    const FlutterCustomTaskRunners* custom_task_runners) {
+    const FlutterCustomTaskRunners* custom_task_runners,
+    bool create_platform_thread) {
   {
     auto host = CreateEmbedderManagedThreadHost(custom_task_runners);
     if (host && host->IsValid()) {
@@ -94,7 +95,7 @@ EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
   // configuration if the embedder attempted to specify a configuration but
   // messed up with an incorrect configuration.
   if (custom_task_runners == nullptr) {
-    auto host = CreateEngineManagedThreadHost();
+    auto host = CreateEngineManagedThreadHost(create_platform_thread);
     if (host && host->IsValid()) {
       return host;
     }
@@ -205,17 +206,23 @@ EmbedderThreadHost::CreateEmbedderManagedThreadHost(
 
 // static
 std::unique_ptr<EmbedderThreadHost>
-EmbedderThreadHost::CreateEngineManagedThreadHost() {
-  // Create a thread host with the current thread as the platform thread and all
-  // other threads managed.
-  ThreadHost thread_host(kFlutterThreadName, ThreadHost::Type::GPU |
-                                                 ThreadHost::Type::IO |
-                                                 ThreadHost::Type::UI);
-
-  // For embedder platforms that don't have native message loop interop, this
-  // will reference a task runner that points to a null message loop
-  // implementation.
-  auto platform_task_runner = GetCurrentThreadTaskRunner();
+EmbedderThreadHost::CreateEngineManagedThreadHost(
+    bool create_platform_thread) {
+  // Create a thread host with the current thread as the platform thread, unless
+  // asked to create one, and all other threads managed.
+  uint64_t engine_thread_host_mask =
+      ThreadHost::Type::GPU | ThreadHost::Type::IO | ThreadHost::Type::UI;
+  if (create_platform_thread) {
+    engine_thread_host_mask |= ThreadHost::Type::Platform;
+  }
+  ThreadHost thread_host(kFlutterThreadName, engine_thread_host_mask);
+
+  // For embedder platforms that don't have native message loop interop, the
+  // current thread task runner will reference a task runner that points to a
+  // null message loop implementation.
+  auto platform_task_runner =
+      create_platform_thread ? thread_host.platform_thread->GetTaskRunner()
+                             : GetCurrentThreadTaskRunner();
 
   flutter::TaskRunners task_runners(
       kFlutterThreadName,
@@ -270,4 +277,8 @@ bool EmbedderThreadHost::PostTask(int64_t runner, uint64_t task) const {
   return found->second->PostTask(task);
 }
 
+bool EmbedderThreadHost::HasEngineManagedPlatformThread() const {
+  return host_.platform_thread != nullptr;
+}
+
 }  // namespace flutter
@@ -19,9 +19,13 @@ namespace flutter {
 
 class EmbedderThreadHost {
  public:
+  // Without custom task runners, the calling thread becomes the platform
+  // thread unless |create_platform_thread| is set, in which case the engine
+  // creates and manages a platform thread too.
   static std::unique_ptr<EmbedderThreadHost>
   CreateEmbedderOrEngineManagedThreadHost(
-      const FlutterCustomTaskRunners* custom_task_runners);
+      const FlutterCustomTaskRunners* custom_task_runners,
+      bool create_platform_thread = false);
 
   EmbedderThreadHost(
       ThreadHost host,
@@ -36,6 +40,10 @@ class EmbedderThreadHost {
 
   bool PostTask(int64_t runner, uint64_t task) const;
 
+  // Whether the platform thread was created by the engine rather than being
+  // a thread of the embedder.
+  bool HasEngineManagedPlatformThread() const;
+
  private:
   ThreadHost host_;
   flutter::TaskRunners runners_;
@@ -44,7 +52,8 @@ class EmbedderThreadHost {
   static std::unique_ptr<EmbedderThreadHost> CreateEmbedderManagedThreadHost(
       const FlutterCustomTaskRunners* custom_task_runners);
 
-  static std::unique_ptr<EmbedderThreadHost> CreateEngineManagedThreadHost();
+  static std::unique_ptr<EmbedderThreadHost> CreateEngineManagedThreadHost(
+      bool create_platform_thread);
 
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderThreadHost);
 };
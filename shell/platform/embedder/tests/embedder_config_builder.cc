@@ -283,6 +283,30 @@ UniqueEngine EmbedderConfigBuilder::InitializeEngine() const {
   return SetupEngine(false);
 }
 
+UniqueEnginePool EmbedderConfigBuilder::CreateEnginePool(
+    size_t warm_engine_count) {
+  // Unlike engines, the pool reads the project arguments after this call
+  // returns, whenever it launches an engine.
+  pool_project_args_ = project_args_;
+  pool_command_line_argv_.clear();
+  for (const auto& arg : command_line_arguments_) {
+    pool_command_line_argv_.push_back(arg.c_str());
+  }
+  pool_project_args_.command_line_argv =
+      pool_command_line_argv_.empty() ? nullptr
+                                      : pool_command_line_argv_.data();
+  pool_project_args_.command_line_argc = pool_command_line_argv_.size();
+
+  FlutterEnginePool pool = nullptr;
+  if (FlutterEnginePoolCreate(FLUTTER_ENGINE_VERSION, &renderer_config_,
+                              &pool_project_args_, &context_,
+                              warm_engine_count, &pool) != kSuccess) {
+    return {};
+  }
+
+  return UniqueEnginePool{pool};
+}
+
 UniqueEngine EmbedderConfigBuilder::SetupEngine(bool run) const {
   FlutterEngine engine = nullptr;
   FlutterProjectArgs project_args = project_args_;
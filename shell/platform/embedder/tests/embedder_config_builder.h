@@ -29,6 +29,22 @@ struct UniqueEngineTraits {
 
 using UniqueEngine = fml::UniqueObject<FlutterEngine, UniqueEngineTraits>;
 
+struct UniqueEnginePoolTraits {
+  static FlutterEnginePool InvalidValue() { return nullptr; }
+
+  static bool IsValid(const FlutterEnginePool& value) {
+    return value != nullptr;
+  }
+
+  static void Free(FlutterEnginePool& pool) {
+    auto result = FlutterEnginePoolCollect(pool);
+    FML_CHECK(result == kSuccess);
+  }
+};
+
+using UniqueEnginePool =
+    fml::UniqueObject<FlutterEnginePool, UniqueEnginePoolTraits>;
+
 class EmbedderConfigBuilder {
  public:
   enum class InitializationPreference {
@@ -96,6 +112,10 @@ class EmbedderConfigBuilder {
 
   UniqueEngine InitializeEngine() const;
 
+  // The pool launches engines using the configuration of the builder, which
+  // must outlive it.
+  UniqueEnginePool CreateEnginePool(size_t warm_engine_count);
+
  private:
   EmbedderTestContext& context_;
   FlutterProjectArgs project_args_ = {};
@@ -106,6 +126,8 @@ class EmbedderConfigBuilder {
   FlutterCustomTaskRunners custom_task_runners_ = {};
   FlutterCompositor compositor_ = {};
   std::vector<std::string> command_line_arguments_;
+  FlutterProjectArgs pool_project_args_ = {};
+  std::vector<const char*> pool_command_line_argv_;
 
   UniqueEngine SetupEngine(bool run) const;
 
@@ -5,6 +5,7 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -446,6 +447,63 @@ TEST_F(EmbedderTest, PlatformMessagesCanBeSentWithoutResponseHandles) {
   message.Wait();
 }
 
+//------------------------------------------------------------------------------
+/// Tests that a platform message whose buffer is owned by the embedder is
+/// delivered without a copy and that the buffer is handed back once the engine
+/// is done with it.
+///
+TEST_F(EmbedderTest, PlatformMessagesCanBeSentWithoutCopies) {
+  auto& context = GetEmbedderContext(ContextType::kSoftwareContext);
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetDartEntrypoint("platform_messages_no_response");
+
+  // Large enough to be handed to Dart as external typed data.
+  const std::string message_data(16 << 10, 'a');
+
+  fml::AutoResetWaitableEvent ready, message;
+  context.AddNativeCallback(
+      "SignalNativeTest",
+      CREATE_NATIVE_ENTRY(
+          [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+  context.AddNativeCallback(
+      "SignalNativeMessage",
+      CREATE_NATIVE_ENTRY(
+          ([&message, &message_data](Dart_NativeArguments args) {
+            auto received_message = tonic::DartConverter<std::string>::FromDart(
+                Dart_GetNativeArgument(args, 0));
+            ASSERT_EQ(received_message, message_data);
+            message.Signal();
+          })));
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+  ready.Wait();
+
+  std::atomic<int> collect_count(0);
+  FlutterPlatformMessage platform_message = {};
+  platform_message.struct_size = sizeof(FlutterPlatformMessage);
+  platform_message.channel = "test_channel";
+  platform_message.message =
+      reinterpret_cast<const uint8_t*>(message_data.data());
+  platform_message.message_size = message_data.size();
+  platform_message.response_handle = nullptr;  // No response needed.
+  platform_message.user_data = &collect_count;
+  platform_message.message_collect_callback = [](void* user_data) {
+    reinterpret_cast<std::atomic<int>*>(user_data)->fetch_add(1);
+  };
+
+  auto result =
+      FlutterEngineSendPlatformMessage(engine.get(), &platform_message);
+  ASSERT_EQ(result, kSuccess);
+  message.Wait();
+
+  // Shutting down the isolate finalizes the typed data that held the buffer.
+  engine.reset();
+  ASSERT_EQ(collect_count.load(), 1);
+}
+
 //------------------------------------------------------------------------------
 /// Tests that a null platform message can be sent.
 ///
@@ -2511,6 +2569,123 @@ TEST_F(EmbedderTest, CanRunInitializedEngine) {
   engine.reset();
 }
 
+//------------------------------------------------------------------------------
+/// Test that engines acquired from a pool run the entrypoint they are given,
+/// and that the pool launches a replacement.
+///
+TEST_F(EmbedderTest, CanRunEngineFromPool) {
+  auto& context = GetEmbedderContext(ContextType::kSoftwareContext);
+  fml::AutoResetWaitableEvent latch;
+  context.AddNativeCallback(
+      "SayHiFromCustomEntrypoint",
+      CREATE_NATIVE_ENTRY([&latch](Dart_NativeArguments args) {
+        latch.Signal();
+      }));
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto pool = builder.CreateEnginePool(1);
+  ASSERT_TRUE(pool.is_valid());
+
+  for (int i = 0; i < 2; i++) {
+    FlutterEngine engine = nullptr;
+    ASSERT_EQ(FlutterEnginePoolAcquireEngine(pool.get(), "customEntrypoint",
+                                             &engine),
+              kSuccess);
+    UniqueEngine unique_engine{engine};
+    ASSERT_EQ(FlutterEngineRunInitialized(engine), kSuccess);
+    latch.Wait();
+    // Cannot re-run an already running engine.
+    ASSERT_EQ(FlutterEngineRunInitialized(engine), kInvalidArguments);
+  }
+
+  pool.reset();
+}
+
+//------------------------------------------------------------------------------
+/// Test that engines acquired from a pool keep working after the pool is
+/// collected.
+///
+TEST_F(EmbedderTest, EngineFromPoolOutlivesThePool) {
+  auto& context = GetEmbedderContext(ContextType::kSoftwareContext);
+  fml::AutoResetWaitableEvent latch;
+  context.AddNativeCallback(
+      "SayHiFromCustomEntrypoint",
+      CREATE_NATIVE_ENTRY([&latch](Dart_NativeArguments args) {
+        latch.Signal();
+      }));
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto pool = builder.CreateEnginePool(1);
+  ASSERT_TRUE(pool.is_valid());
+
+  FlutterEngine engine = nullptr;
+  ASSERT_EQ(
+      FlutterEnginePoolAcquireEngine(pool.get(), "customEntrypoint", &engine),
+      kSuccess);
+  UniqueEngine unique_engine{engine};
+  pool.reset();
+
+  ASSERT_EQ(FlutterEngineRunInitialized(engine), kSuccess);
+  latch.Wait();
+
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine, &event), kSuccess);
+  ASSERT_EQ(FlutterEngineDeinitialize(engine), kSuccess);
+  unique_engine.reset();
+}
+
+//------------------------------------------------------------------------------
+/// Test that pooled engines, both acquired and still warm, are shut down on
+/// the platform thread their shell was created on. Debug builds check this
+/// when the shell is collected.
+///
+TEST_F(EmbedderTest, PooledEnginesShutDownOnTheirPlatformThread) {
+  auto& context = GetEmbedderContext(ContextType::kSoftwareContext);
+  fml::AutoResetWaitableEvent latch;
+  context.AddNativeCallback(
+      "SayHiFromCustomEntrypoint",
+      CREATE_NATIVE_ENTRY([&latch](Dart_NativeArguments args) {
+        latch.Signal();
+      }));
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto pool = builder.CreateEnginePool(1);
+  ASSERT_TRUE(pool.is_valid());
+
+  FlutterEngine engine = nullptr;
+  ASSERT_EQ(
+      FlutterEnginePoolAcquireEngine(pool.get(), "customEntrypoint", &engine),
+      kSuccess);
+  ASSERT_EQ(FlutterEngineRunInitialized(engine), kSuccess);
+  latch.Wait();
+  ASSERT_EQ(FlutterEngineShutdown(engine), kSuccess);
+
+  // Collects the warm engine launched to replace the acquired one.
+  pool.reset();
+}
+
+//------------------------------------------------------------------------------
+/// Test that pools reject custom task runners, whose tasks the embedder could
+/// not run for engines it has no handle to.
+///
+TEST_F(EmbedderTest, EnginePoolRejectsCustomTaskRunners) {
+  auto& context = GetEmbedderContext(ContextType::kSoftwareContext);
+  EmbedderTestTaskRunner test_task_runner(
+      CreateNewThread("custom_platform_thread"),
+      [](FlutterTask task) { FML_CHECK(false) << "Unexpected task."; });
+  const auto task_runner_description =
+      test_task_runner.GetFlutterTaskRunnerDescription();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetPlatformTaskRunner(&task_runner_description);
+  auto pool = builder.CreateEnginePool(1);
+  ASSERT_FALSE(pool.is_valid());
+}
+
 //------------------------------------------------------------------------------
 /// Test that an engine can be deinitialized.
 ///
@@ -3954,6 +4129,49 @@ TEST_F(EmbedderTest, CanSendLowMemoryNotification) {
   ASSERT_EQ(FlutterEngineNotifyLowMemoryWarning(engine.get()), kSuccess);
 }
 
+TEST_F(EmbedderTest, CanSetAndQueryMemoryBudgets) {
+  auto& context = GetEmbedderContext(ContextType::kSoftwareContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterMemoryUsage usage = {};
+  usage.struct_size = sizeof(FlutterMemoryUsage);
+  ASSERT_EQ(FlutterEngineGetMemoryUsage(
+                engine.get(), kFlutterMemoryCategoryRasterCache, &usage),
+            kSuccess);
+  ASSERT_FALSE(usage.has_budget);
+
+  ASSERT_EQ(FlutterEngineSetMemoryBudget(
+                engine.get(), kFlutterMemoryCategoryRasterCache, true, 4096),
+            kSuccess);
+  ASSERT_EQ(FlutterEngineGetMemoryUsage(
+                engine.get(), kFlutterMemoryCategoryRasterCache, &usage),
+            kSuccess);
+  ASSERT_EQ(usage.category, kFlutterMemoryCategoryRasterCache);
+  ASSERT_TRUE(usage.has_budget);
+  ASSERT_EQ(usage.budget, 4096u);
+
+  ASSERT_EQ(FlutterEngineSetMemoryBudget(
+                engine.get(), kFlutterMemoryCategoryRasterCache, false, 0),
+            kSuccess);
+  ASSERT_EQ(FlutterEngineGetMemoryUsage(
+                engine.get(), kFlutterMemoryCategoryRasterCache, &usage),
+            kSuccess);
+  ASSERT_FALSE(usage.has_budget);
+
+  ASSERT_EQ(FlutterEnginePurgeMemory(engine.get(),
+                                     kFlutterMemoryCategoryResourceCache, 0),
+            kSuccess);
+  ASSERT_EQ(FlutterEnginePurgeMemory(engine.get(),
+                                     static_cast<FlutterMemoryCategory>(42), 0),
+            kInvalidArguments);
+}
+
 TEST_F(EmbedderTest, CanPostTaskToAllNativeThreads) {
   UniqueEngine engine;
   size_t worker_count = 0;
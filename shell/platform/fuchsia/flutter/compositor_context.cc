@@ -41,8 +41,10 @@ class ScopedFrame final : public flutter::CompositorContext::ScopedFrame {
   VulkanSurfaceProducer& surface_producer_;
   flutter::SceneUpdateContext& scene_update_context_;
 
+  // Scenic composites the frame, so |frame_damage| is not used here.
   flutter::RasterStatus Raster(flutter::LayerTree& layer_tree,
-                               bool ignore_raster_cache) override {
+                               bool ignore_raster_cache,
+                               flutter::FrameDamage* frame_damage) override {
     std::vector<flutter::SceneUpdateContext::PaintTask> frame_paint_tasks;
     std::vector<std::unique_ptr<SurfaceProducerSurface>> frame_surfaces;
 
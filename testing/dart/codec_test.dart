@@ -3,7 +3,9 @@
 // found in the LICENSE file.
 
 // @dart = 2.6
+import 'dart:async';
 import 'dart:io';
+import 'dart:math' as math;
 import 'dart:typed_data';
 import 'dart:ui' as ui;
 
@@ -72,6 +74,42 @@ void main() {
       <int>[0, 240, 246],
     ]));
   });
+
+  test('progressive decoder decodes image added in chunks', () async {
+    final Uint8List data = await _getSkiaResource('baby_tux.png').readAsBytes();
+    final Completer<ui.Image> finalImage = Completer<ui.Image>();
+    final ui.ProgressiveImageDecoder decoder =
+        ui.ProgressiveImageDecoder((ui.Image image, bool isFinal) {
+      if (isFinal) {
+        finalImage.complete(image);
+      }
+    });
+    const int chunkSize = 1024;
+    for (int offset = 0; offset < data.length; offset += chunkSize) {
+      decoder.addChunk(
+          data.sublist(offset, math.min(offset + chunkSize, data.length)));
+    }
+    decoder.close();
+
+    final ui.Image image = await finalImage.future;
+    expect(image, isNotNull);
+    expect(image.width, 240);
+    expect(image.height, 246);
+    decoder.dispose();
+  });
+
+  test('progressive decoder reports invalid data', () async {
+    final Completer<ui.Image> finalImage = Completer<ui.Image>();
+    final ui.ProgressiveImageDecoder decoder =
+        ui.ProgressiveImageDecoder((ui.Image image, bool isFinal) {
+      expect(isFinal, isTrue);
+      finalImage.complete(image);
+    });
+    decoder.addChunk(Uint8List.fromList(List<int>.filled(64, 1)));
+    decoder.close();
+    expect(await finalImage.future, isNull);
+    decoder.dispose();
+  });
 }
 
 /// Returns a File handle to a file in the skia/resources directory.
@@ -35,6 +35,33 @@ void main() {
     }
   });
 
+  test('layoutAll matches laying out each paragraph', () {
+    final List<Paragraph> paragraphs = <Paragraph>[];
+    final List<ParagraphConstraints> constraints = <ParagraphConstraints>[];
+    for (int index = 0; index < 40; index += 1) {
+      final ParagraphBuilder builder = ParagraphBuilder(ParagraphStyle(
+        fontFamily: 'Ahem',
+        fontSize: 10.0,
+      ));
+      builder.addText('Test Ahem');
+      paragraphs.add(builder.build());
+      constraints.add(ParagraphConstraints(width: 50.0 + index * 5.0));
+    }
+    // The same paragraph twice; the last constraints win.
+    paragraphs.add(paragraphs.first);
+    constraints.add(const ParagraphConstraints(width: 400.0));
+
+    Paragraph.layoutAll(paragraphs, constraints);
+
+    expect(paragraphs.first.width, closeTo(400.0, 0.001));
+    expect(paragraphs.first.height, closeTo(10.0, 0.001));
+    for (int index = 1; index < 40; index += 1) {
+      final double width = 50.0 + index * 5.0;
+      expect(paragraphs[index].width, closeTo(width, 0.001));
+      expect(paragraphs[index].height, closeTo(width < 90.0 ? 20.0 : 10.0, 0.001));
+    }
+  });
+
   test('predictably lays out a multi-line paragraph', () {
     for (double fontSize in <double>[10.0, 20.0, 30.0, 40.0]) {
       final ParagraphBuilder builder = ParagraphBuilder(ParagraphStyle(
@@ -16,11 +16,13 @@
 
 #include <minikin/Layout.h>
 
+#include <algorithm>
 #include <cstring>
 
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/logging.h"
 #include "flutter/third_party/txt/tests/txt_test_utils.h"
+#include "minikin/BreakIteratorPool.h"
 #include "minikin/LayoutUtils.h"
 #include "third_party/benchmark/include/benchmark/benchmark_api.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
@@ -245,6 +247,173 @@ BENCHMARK_REGISTER_F(ParagraphFixture, StylesBigO)
     ->Range(1 << 3, 1 << 12)
     ->Complexity(benchmark::oN);
 
+// Lays out the same paragraph at a different width on each iteration, as
+// when resizing a window. With an argument of 1 the paragraph is marked dirty
+// before each layout so that nothing from the previous layout is reused.
+BENCHMARK_DEFINE_F(ParagraphFixture, RelayoutVaryingWidth)
+(benchmark::State& state) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  const bool dirty = state.range(0) != 0;
+  double width = 200;
+  while (state.KeepRunning()) {
+    if (dirty) {
+      paragraph->SetDirty();
+    }
+    paragraph->Layout(width);
+    width = width >= 600 ? 200 : width + 7;
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, RelayoutVaryingWidth)->Arg(0)->Arg(1);
+
+// Builds and lays out a new one line label on each iteration, as a long list
+// of short labels does. This is dominated by the fixed cost of a paragraph.
+BENCHMARK_F(ParagraphFixture, ShortParagraphConstruction)
+(benchmark::State& state) {
+  const char* text = "Hello World";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  while (state.KeepRunning()) {
+    txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    auto paragraph = BuildParagraph(builder);
+    paragraph->Layout(300);
+  }
+}
+
+// Lays out a one line label again on each iteration, through the full path
+// (0) and the single line fast path (1) of ParagraphTxt::Layout.
+BENCHMARK_DEFINE_F(ParagraphFixture, ShortLabelLayout)
+(benchmark::State& state) {
+  const char* text = "Hello World";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->SetSingleLineFastPathEnabled(state.range(0) != 0);
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, ShortLabelLayout)->Arg(0)->Arg(1);
+
+// Lays out a paragraph of |size| code units of ordinary sentences, as in a
+// large document in a text editor.
+static std::unique_ptr<ParagraphTxt> BuildLargeParagraph(
+    std::shared_ptr<FontCollection> font_collection,
+    size_t size) {
+  const char* text =
+      "Hello world! This is a simple sentence to test hit testing. ";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string sentence(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+  std::u16string u16_text;
+  while (u16_text.size() < size) {
+    u16_text += sentence;
+  }
+  u16_text.resize(size);
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(600);
+  return paragraph;
+}
+
+// Moves the caret to points spread over the whole paragraph.
+BENCHMARK_DEFINE_F(ParagraphFixture, GetGlyphPositionAtCoordinateBigO)
+(benchmark::State& state) {
+  auto paragraph = BuildLargeParagraph(font_collection_, state.range(0));
+  const double height = paragraph->GetHeight();
+  double dx = 0;
+  double dy = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        paragraph->GetGlyphPositionAtCoordinate(dx, dy).position);
+    dx = dx >= 600 ? 0 : dx + 37;
+    dy = dy >= height ? 0 : dy + 113;
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, GetGlyphPositionAtCoordinateBigO)
+    ->RangeMultiplier(8)
+    ->Range(1 << 8, 1 << 17)
+    ->Complexity(benchmark::oLogN);
+
+// Queries the boxes of short selections spread over the whole paragraph.
+BENCHMARK_DEFINE_F(ParagraphFixture, GetRectsForRangeBigO)
+(benchmark::State& state) {
+  const size_t size = state.range(0);
+  auto paragraph = BuildLargeParagraph(font_collection_, size);
+  size_t start = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(paragraph->GetRectsForRange(
+        start, std::min(start + 20, size), Paragraph::RectHeightStyle::kMax,
+        Paragraph::RectWidthStyle::kTight));
+    start = (start + 997) % size;
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, GetRectsForRangeBigO)
+    ->RangeMultiplier(8)
+    ->Range(1 << 8, 1 << 17)
+    ->Complexity(benchmark::oLogN);
+
 BENCHMARK_F(ParagraphFixture, PaintSimple)(benchmark::State& state) {
   const char* text = "Hello world! This is a simple sentence to test drawing.";
   auto icu_text = icu::UnicodeString::fromUTF8(text);
@@ -389,6 +558,26 @@ BENCHMARK_REGISTER_F(ParagraphFixture, MinikinDoLayout)
     ->Range(1 << 7, 1 << 14)
     ->Complexity(benchmark::oN);
 
+// Obtains a line break iterator by creating it (0), as each paragraph used to,
+// or from the BreakIteratorPool (1).
+BENCHMARK_DEFINE_F(ParagraphFixture, LineBreakIterator)
+(benchmark::State& state) {
+  const bool pooled = state.range(0) != 0;
+  const icu::Locale locale;
+  while (state.KeepRunning()) {
+    if (pooled) {
+      auto iterator = minikin::BreakIteratorPool::acquire(locale);
+      minikin::BreakIteratorPool::release(locale, std::move(iterator));
+    } else {
+      UErrorCode status = U_ZERO_ERROR;
+      std::unique_ptr<icu::BreakIterator> iterator(
+          icu::BreakIterator::createLineInstance(locale, status));
+      benchmark::DoNotOptimize(iterator.get());
+    }
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, LineBreakIterator)->Arg(0)->Arg(1);
+
 BENCHMARK_DEFINE_F(ParagraphFixture, AddStyleRun)(benchmark::State& state) {
   std::vector<uint16_t> text;
   for (uint16_t i = 0; i < 16000 * 2; ++i) {
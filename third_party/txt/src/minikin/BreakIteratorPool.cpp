@@ -0,0 +1,69 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <minikin/BreakIteratorPool.h>
+
+namespace minikin {
+
+// static
+std::unique_ptr<icu::BreakIterator> BreakIteratorPool::acquire(
+    const icu::Locale& locale) {
+  BreakIteratorPool* inst = getInstance();
+  const std::string name(locale.getName());
+  {
+    std::scoped_lock lock(inst->mMutex);
+    auto found = inst->mEntries.find(name);
+    if (found != inst->mEntries.end()) {
+      Entry& entry = found->second;
+      if (!entry.idle.empty()) {
+        std::unique_ptr<icu::BreakIterator> iterator =
+            std::move(entry.idle.back());
+        entry.idle.pop_back();
+        return iterator;
+      }
+      return std::unique_ptr<icu::BreakIterator>(entry.prototype->clone());
+    }
+  }
+
+  // Created without the lock held, since this is the expensive part. If
+  // another thread created the prototype in the meantime, this one is handed
+  // out instead.
+  UErrorCode status = U_ZERO_ERROR;
+  std::unique_ptr<icu::BreakIterator> prototype(
+      icu::BreakIterator::createLineInstance(locale, status));
+  if (U_FAILURE(status) || !prototype) {
+    return nullptr;
+  }
+  std::unique_ptr<icu::BreakIterator> iterator(prototype->clone());
+  std::scoped_lock lock(inst->mMutex);
+  Entry& entry = inst->mEntries[name];
+  if (!entry.prototype) {
+    entry.prototype = std::move(prototype);
+    return iterator;
+  }
+  return prototype;
+}
+
+// static
+void BreakIteratorPool::release(const icu::Locale& locale,
+                                std::unique_ptr<icu::BreakIterator> iterator) {
+  if (!iterator) {
+    return;
+  }
+  BreakIteratorPool* inst = getInstance();
+  std::scoped_lock lock(inst->mMutex);
+  auto found = inst->mEntries.find(locale.getName());
+  if (found != inst->mEntries.end() &&
+      found->second.idle.size() < kMaxIdleIteratorsPerLocale) {
+    found->second.idle.push_back(std::move(iterator));
+  }
+}
+
+// static
+BreakIteratorPool* BreakIteratorPool::getInstance() {
+  static BreakIteratorPool* instance = new BreakIteratorPool();
+  return instance;
+}
+
+}  // namespace minikin
@@ -0,0 +1,60 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MINIKIN_BREAK_ITERATOR_POOL_H
+#define MINIKIN_BREAK_ITERATOR_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "unicode/brkiter.h"
+#include "unicode/locid.h"
+
+namespace minikin {
+
+// A process wide pool of ICU line break iterators. Creating an iterator looks
+// up and loads the break rules of its locale, which costs more than laying out
+// a short paragraph. Iterators are instead cloned from one created per locale
+// and returned to the pool once a paragraph's lines are broken.
+class BreakIteratorPool {
+ public:
+  // The most idle iterators kept per locale. Roughly the number of threads
+  // that break lines at the same time.
+  static constexpr size_t kMaxIdleIteratorsPerLocale = 8;
+
+  // Returns a line break iterator for |locale|, or nullptr if ICU can't create
+  // one. The text of the iterator is unspecified. This method is thread safe.
+  static std::unique_ptr<icu::BreakIterator> acquire(const icu::Locale& locale);
+
+  // Returns an iterator acquired for |locale| to the pool. This method is
+  // thread safe.
+  static void release(const icu::Locale& locale,
+                      std::unique_ptr<icu::BreakIterator> iterator);
+
+ private:
+  BreakIteratorPool() {}  // Singleton
+  ~BreakIteratorPool() {}
+
+  static BreakIteratorPool* getInstance();
+
+  struct Entry {
+    // The iterator the ones handed out are cloned from. It is never handed out
+    // itself, so that it's only used with |mMutex| held.
+    std::unique_ptr<icu::BreakIterator> prototype;
+    std::vector<std::unique_ptr<icu::BreakIterator>> idle;
+  };
+
+  // Guards the members below.
+  std::mutex mMutex;
+
+  // Keyed by the name of the locale.
+  std::unordered_map<std::string, Entry> mEntries;
+};
+
+}  // namespace minikin
+
+#endif  // MINIKIN_BREAK_ITERATOR_POOL_H
@@ -191,6 +191,18 @@ uint8_t getTablePriority(uint16_t platformId, uint16_t encodingId) {
 SparseBitSet CmapCoverage::getCoverage(const uint8_t* cmap_data,
                                        size_t cmap_size,
                                        bool* has_cmap_format14_subtable) {
+  vector<uint32_t> coverageVec =
+      getCoverageRanges(cmap_data, cmap_size, has_cmap_format14_subtable);
+  if (coverageVec.empty()) {
+    return SparseBitSet();
+  }
+  return SparseBitSet(&coverageVec.front(), coverageVec.size() >> 1);
+}
+
+vector<uint32_t> CmapCoverage::getCoverageRanges(
+    const uint8_t* cmap_data,
+    size_t cmap_size,
+    bool* has_cmap_format14_subtable) {
   constexpr size_t kHeaderSize = 4;
   constexpr size_t kNumTablesOffset = 2;
   constexpr size_t kTableSize = 8;
@@ -201,11 +213,11 @@ SparseBitSet CmapCoverage::getCoverage(const uint8_t* cmap_data,
   constexpr uint32_t kInvalidOffset = UINT32_MAX;
 
   if (kHeaderSize > cmap_size) {
-    return SparseBitSet();
+    return vector<uint32_t>();
   }
   uint32_t numTables = readU16(cmap_data, kNumTablesOffset);
   if (kHeaderSize + numTables * kTableSize > cmap_size) {
-    return SparseBitSet();
+    return vector<uint32_t>();
   }
 
   uint32_t bestTableOffset = kInvalidOffset;
@@ -284,7 +296,7 @@ SparseBitSet CmapCoverage::getCoverage(const uint8_t* cmap_data,
     }
   }
   if (bestTableOffset == kInvalidOffset) {
-    return SparseBitSet();
+    return vector<uint32_t>();
   }
   const uint8_t* tableData = cmap_data + bestTableOffset;
   const size_t tableSize = cmap_size - bestTableOffset;
@@ -295,11 +307,10 @@ SparseBitSet CmapCoverage::getCoverage(const uint8_t* cmap_data,
   } else {
     success = getCoverageFormat12(coverageVec, tableData, tableSize);
   }
-  if (success && (coverageVec.size() != 0)) {
-    return SparseBitSet(&coverageVec.front(), coverageVec.size() >> 1);
-  } else {
-    return SparseBitSet();
+  if (!success) {
+    return vector<uint32_t>();
   }
+  return coverageVec;
 }
 
 }  // namespace minikin
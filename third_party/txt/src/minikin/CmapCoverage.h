@@ -17,6 +17,8 @@
 #ifndef MINIKIN_CMAP_COVERAGE_H
 #define MINIKIN_CMAP_COVERAGE_H
 
+#include <vector>
+
 #include <minikin/SparseBitSet.h>
 
 namespace minikin {
@@ -26,6 +28,14 @@ class CmapCoverage {
   static SparseBitSet getCoverage(const uint8_t* cmap_data,
                                   size_t cmap_size,
                                   bool* has_cmap_format14_subtable);
+
+  // libtxt extension: the ranges getCoverage builds its set from, as pairs of
+  // an inclusive start and an exclusive end in increasing order. Returns an
+  // empty vector if the cmap can't be read.
+  static std::vector<uint32_t> getCoverageRanges(
+      const uint8_t* cmap_data,
+      size_t cmap_size,
+      bool* has_cmap_format14_subtable);
 };
 
 }  // namespace minikin
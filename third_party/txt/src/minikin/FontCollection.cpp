@@ -68,7 +68,6 @@ void FontCollection::init(
     const vector<std::shared_ptr<FontFamily>>& typefaces) {
   std::scoped_lock _l(gMinikinLock);
   mId = sNextId++;
-  vector<uint32_t> lastChar;
   size_t nTypefaces = typefaces.size();
 #ifdef VERBOSE_DEBUG
   ALOGD("nTypefaces = %zd\n", nTypefaces);
@@ -79,8 +78,25 @@ void FontCollection::init(
     if (family->getClosestMatch(defaultStyle).font == nullptr) {
       continue;
     }
-    const SparseBitSet& coverage = family->getCoverage();
     mFamilies.push_back(family);  // emplace_back would be better
+  }
+  nTypefaces = mFamilies.size();
+  LOG_ALWAYS_FATAL_IF(nTypefaces == 0,
+                      "Font collection must have at least one valid typeface");
+  LOG_ALWAYS_FATAL_IF(nTypefaces > 254,
+                      "Font collection may only have up to 254 font families.");
+}
+
+void FontCollection::computeCoverage() const {
+  std::scoped_lock _l(gMinikinLock);
+  if (mCoverageComputed.load(std::memory_order_relaxed)) {
+    return;
+  }
+  vector<uint32_t> lastChar;
+  const size_t nTypefaces = mFamilies.size();
+  for (size_t i = 0; i < nTypefaces; i++) {
+    const std::shared_ptr<FontFamily>& family = mFamilies[i];
+    const SparseBitSet& coverage = family->getCoverage();
     if (family->hasVSTable()) {
       mVSFamilyVec.push_back(family);
     }
@@ -90,11 +106,6 @@ void FontCollection::init(
     const std::unordered_set<AxisTag>& supportedAxes = family->supportedAxes();
     mSupportedAxes.insert(supportedAxes.begin(), supportedAxes.end());
   }
-  nTypefaces = mFamilies.size();
-  LOG_ALWAYS_FATAL_IF(nTypefaces == 0,
-                      "Font collection must have at least one valid typeface");
-  LOG_ALWAYS_FATAL_IF(nTypefaces > 254,
-                      "Font collection may only have up to 254 font families.");
   size_t nPages = (mMaxChar + kPageMask) >> kLogCharsPerPage;
   // TODO: Use variation selector map for mRanges construction.
   // A font can have a glyph for a base code point and variation selector pair
@@ -125,6 +136,7 @@ void FontCollection::init(
   // See the comment in Range for more details.
   LOG_ALWAYS_FATAL_IF(mFamilyVec.size() >= 0xFFFF,
                       "Exceeded the maximum indexable cmap coverage.");
+  mCoverageComputed.store(true, std::memory_order_release);
 }
 
 // Special scores for the font fallback.
@@ -369,6 +381,7 @@ const std::shared_ptr<FontFamily>& FontCollection::findFallbackFont(
     uint32_t langListId) const {
   std::string locale = GetFontLocale(langListId);
 
+  std::scoped_lock _l(mCachedFallbackFamiliesMutex);
   const auto it = mCachedFallbackFamilies.find(locale);
   if (it != mCachedFallbackFamilies.end()) {
     for (const auto& fallbackFamily : it->second) {
@@ -424,6 +437,7 @@ bool FontCollection::hasVariationSelector(uint32_t baseCodepoint,
   if (!isVariationSelector(variationSelector)) {
     return false;
   }
+  ensureCoverage();
   if (baseCodepoint >= mMaxChar) {
     return false;
   }
@@ -468,6 +482,7 @@ void FontCollection::itemize(const uint16_t* string,
   if (string_size == 0) {
     return;
   }
+  ensureCoverage();
 
   const uint32_t kEndOfString = 0xFFFFFFFF;
 
@@ -539,7 +554,7 @@ FakedFont FontCollection::baseFontFaked(FontStyle style) {
 
 std::shared_ptr<FontCollection> FontCollection::createCollectionWithVariation(
     const std::vector<FontVariation>& variations) {
-  if (variations.empty() || mSupportedAxes.empty()) {
+  if (variations.empty() || getSupportedTags().empty()) {
     return nullptr;
   }
 
@@ -573,4 +588,55 @@ uint32_t FontCollection::getId() const {
   return mId;
 }
 
+uint64_t FontCollection::getContentHash() const {
+  std::call_once(mContentHashOnce, [this] {
+    uint64_t hash = MinikinFont::CombineContentHash(0, mFamilies.size());
+    for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+      const FontLanguages& languages =
+          FontLanguageListCache::getById(family->langId());
+      hash = MinikinFont::CombineContentHash(hash, family->variant());
+      hash = MinikinFont::CombineContentHash(hash, languages.size());
+      for (size_t i = 0; i < languages.size(); i++) {
+        hash = MinikinFont::CombineContentHash(hash,
+                                               languages[i].getIdentifier());
+      }
+      hash = MinikinFont::CombineContentHash(hash, family->getNumFonts());
+      for (size_t i = 0; i < family->getNumFonts(); i++) {
+        const uint64_t fontHash = family->getFont(i)->GetContentHash();
+        if (fontHash == 0) {
+          return;
+        }
+        const FontStyle style = family->getStyle(i);
+        hash = MinikinFont::CombineContentHash(hash, fontHash);
+        hash = MinikinFont::CombineContentHash(hash, style.getWeight());
+        hash = MinikinFont::CombineContentHash(hash, style.getItalic());
+      }
+    }
+    mContentHash = hash == 0 ? 1 : hash;
+  });
+  return mContentHash;
+}
+
+int FontCollection::getFontIndex(const MinikinFont* font) const {
+  int index = 0;
+  for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+    for (size_t i = 0; i < family->getNumFonts(); i++, index++) {
+      if (family->getFont(i).get() == font) {
+        return index;
+      }
+    }
+  }
+  return -1;
+}
+
+MinikinFont* FontCollection::getFontAtIndex(size_t index) const {
+  for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+    if (index < family->getNumFonts()) {
+      return family->getFont(index).get();
+    }
+    index -= family->getNumFonts();
+  }
+  return nullptr;
+}
+
 }  // namespace minikin
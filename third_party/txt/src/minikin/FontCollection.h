@@ -17,8 +17,11 @@
 #ifndef MINIKIN_FONT_COLLECTION_H
 #define MINIKIN_FONT_COLLECTION_H
 
+#include <atomic>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 
@@ -69,11 +72,26 @@ class FontCollection {
       const std::vector<FontVariation>& variations);
 
   const std::unordered_set<AxisTag>& getSupportedTags() const {
+    ensureCoverage();
     return mSupportedAxes;
   }
 
   uint32_t getId() const;
 
+  // libtxt extension: a hash of the families of this collection and their
+  // fonts that, unlike the id, is the same in every process that builds an
+  // equal collection. Returns 0 if a font can't be identified by its data.
+  // Fallback fonts discovered later are not part of the hash.
+  uint64_t getContentHash() const;
+
+  // libtxt extension: the position of |font| among the fonts of this
+  // collection's families, or -1 if it is not one of them.
+  int getFontIndex(const MinikinFont* font) const;
+
+  // libtxt extension: the font at a position returned by getFontIndex, or
+  // nullptr if the position is out of range.
+  MinikinFont* getFontAtIndex(size_t index) const;
+
   void set_fallback_font_provider(std::unique_ptr<FallbackFontProvider> ffp) {
     mFallbackFontProvider = std::move(ffp);
   }
@@ -96,6 +114,17 @@ class FontCollection {
   // Initialize the FontCollection.
   void init(const std::vector<std::shared_ptr<FontFamily>>& typefaces);
 
+  // libtxt extension: mMaxChar, mRanges and the other coverage tables are
+  // built the first time a character is looked up rather than when the
+  // collection is created, so that creating a collection doesn't parse the
+  // cmap of its fonts.
+  void ensureCoverage() const {
+    if (!mCoverageComputed.load(std::memory_order_acquire)) {
+      computeCoverage();
+    }
+  }
+  void computeCoverage() const;
+
   const std::shared_ptr<FontFamily>& getFamilyForChar(uint32_t ch,
                                                       uint32_t vs,
                                                       uint32_t langListId,
@@ -128,7 +157,7 @@ class FontCollection {
   uint32_t mId;
 
   // Highest UTF-32 code point that can be mapped
-  uint32_t mMaxChar;
+  mutable uint32_t mMaxChar;
 
   // This vector has pointers to the all font family instances in this
   // collection. This vector can't be empty.
@@ -140,23 +169,33 @@ class FontCollection {
   // mFamilyVec[mRanges[0xXXYY].start] to mFamilyVec[mRange[0xXXYY].end] instead
   // of whole mFamilies. This vector contains indices into mFamilies. This
   // vector can't be empty.
-  std::vector<Range> mRanges;
-  std::vector<uint8_t> mFamilyVec;
+  mutable std::vector<Range> mRanges;
+  mutable std::vector<uint8_t> mFamilyVec;
 
   // This vector has pointers to the font family instances which have cmap 14
   // subtables.
-  std::vector<std::shared_ptr<FontFamily>> mVSFamilyVec;
+  mutable std::vector<std::shared_ptr<FontFamily>> mVSFamilyVec;
 
   // Set of supported axes in this collection.
-  std::unordered_set<AxisTag> mSupportedAxes;
+  mutable std::unordered_set<AxisTag> mSupportedAxes;
+
+  // libtxt extension: Set, under gMinikinLock, once computeCoverage has
+  // filled in mMaxChar and the tables above.
+  mutable std::atomic<bool> mCoverageComputed{false};
 
   // libtxt extension: Fallback font provider.
   std::unique_ptr<FallbackFontProvider> mFallbackFontProvider;
 
   // libtxt extension: Fallback fonts discovered after this font collection
-  // was constructed.
-  mutable std::map<std::string, std::vector<std::shared_ptr<FontFamily>>>
+  // was constructed. References to the families are handed out, so they are
+  // kept in deques which don't move elements on insertion.
+  mutable std::map<std::string, std::deque<std::shared_ptr<FontFamily>>>
       mCachedFallbackFamilies;
+  mutable std::mutex mCachedFallbackFamiliesMutex;
+
+  // libtxt extension: computed by the first call to getContentHash.
+  mutable std::once_flag mContentHashOnce;
+  mutable uint64_t mContentHash = 0;
 };
 
 }  // namespace minikin
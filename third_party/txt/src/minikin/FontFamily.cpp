@@ -20,6 +20,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <mutex>
+#include <string>
+
 #include <log/log.h>
 #include <utils/JenkinsHash.h>
 
@@ -108,9 +111,18 @@ FontFamily::FontFamily(uint32_t langId, int variant, std::vector<Font>&& fonts)
     : mLangId(langId),
       mVariant(variant),
       mFonts(std::move(fonts)),
-      mHasVSTable(false) {
-  computeCoverage();
-}
+      mHasVSTable(false),
+      mCoverageComputed(false) {}
+
+FontFamily::FontFamily(const FontFamily& coverageSource,
+                       std::vector<Font>&& fonts)
+    : mLangId(coverageSource.mLangId),
+      mVariant(coverageSource.mVariant),
+      mFonts(std::move(fonts)),
+      mSupportedAxes(coverageSource.mSupportedAxes),
+      mCoverage(coverageSource.mCoverage),
+      mHasVSTable(coverageSource.mHasVSTable),
+      mCoverageComputed(true) {}
 
 bool FontFamily::analyzeStyle(const std::shared_ptr<MinikinFont>& typeface,
                               int* weight,
@@ -174,30 +186,109 @@ bool FontFamily::isColorEmojiFamily() const {
   return false;
 }
 
-void FontFamily::computeCoverage() {
+static std::mutex gCoverageStoreMutex;
+static std::shared_ptr<PersistentStore> gCoverageStore;
+
+// static
+void FontFamily::setPersistentStore(std::shared_ptr<PersistentStore> store) {
+  std::scoped_lock lock(gCoverageStoreMutex);
+  gCoverageStore = std::move(store);
+}
+
+static const uint32_t kPersistentCoverageTag =
+    MinikinFont::MakeTag('c', 'm', 'a', 'p');
+static const uint32_t kPersistentCoverageVersion = 1;
+
+template <typename T>
+static void appendBytes(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// The stored value is whether the cmap has a format 14 subtable followed by
+// the coverage ranges. Returns false if |value| isn't a valid such entry.
+static bool readCoverage(const std::string& value,
+                         bool* hasVSTable,
+                         vector<uint32_t>* ranges) {
+  if (value.empty() || (value.size() - 1) % (2 * sizeof(uint32_t)) != 0) {
+    return false;
+  }
+  *hasVSTable = value[0] != 0;
+  ranges->resize((value.size() - 1) / sizeof(uint32_t));
+  if (!ranges->empty()) {
+    memcpy(ranges->data(), value.data() + 1, value.size() - 1);
+  }
+  uint32_t prevEnd = 0;
+  for (size_t i = 0; i < ranges->size(); i += 2) {
+    if ((*ranges)[i] < prevEnd || (*ranges)[i] >= (*ranges)[i + 1]) {
+      return false;
+    }
+    prevEnd = (*ranges)[i + 1];
+  }
+  return true;
+}
+
+void FontFamily::computeCoverage() const {
   std::scoped_lock _l(gMinikinLock);
+  if (mCoverageComputed.load(std::memory_order_relaxed)) {
+    return;
+  }
   const FontStyle defaultStyle;
   const MinikinFont* typeface = getClosestMatch(defaultStyle).font;
-  const uint32_t cmapTag = MinikinFont::MakeTag('c', 'm', 'a', 'p');
-  HbBlob cmapTable(getFontTable(typeface, cmapTag));
-  if (cmapTable.get() == nullptr) {
-    ALOGE("Could not get cmap table size!\n");
-    return;
+
+  std::shared_ptr<PersistentStore> store;
+  {
+    std::scoped_lock lock(gCoverageStoreMutex);
+    store = gCoverageStore;
+  }
+  std::string persistentKey;
+  const uint64_t contentHash = typeface ? typeface->GetContentHash() : 0;
+  if (store && contentHash != 0) {
+    appendBytes(&persistentKey, kPersistentCoverageTag);
+    appendBytes(&persistentKey, kPersistentCoverageVersion);
+    appendBytes(&persistentKey, contentHash);
+  }
+
+  bool hasVSTable = false;
+  vector<uint32_t> ranges;
+  std::string value;
+  if (persistentKey.empty() || !store->load(persistentKey, &value) ||
+      !readCoverage(value, &hasVSTable, &ranges)) {
+    hasVSTable = false;
+    ranges.clear();
+    const uint32_t cmapTag = MinikinFont::MakeTag('c', 'm', 'a', 'p');
+    HbBlob cmapTable(getFontTable(typeface, cmapTag));
+    if (cmapTable.get() == nullptr) {
+      ALOGE("Could not get cmap table size!\n");
+    } else {
+      ranges = CmapCoverage::getCoverageRanges(
+          cmapTable.get(), cmapTable.size(), &hasVSTable);
+      if (!persistentKey.empty()) {
+        value.clear();
+        appendBytes(&value, static_cast<uint8_t>(hasVSTable));
+        value.append(reinterpret_cast<const char*>(ranges.data()),
+                     ranges.size() * sizeof(uint32_t));
+        store->store(std::move(persistentKey), std::move(value));
+      }
+    }
   }
-  mCoverage = CmapCoverage::getCoverage(cmapTable.get(), cmapTable.size(),
-                                        &mHasVSTable);
+  mCoverage = ranges.empty()
+                  ? std::make_shared<SparseBitSet>()
+                  : std::make_shared<SparseBitSet>(ranges.data(),
+                                                   ranges.size() / 2);
+  mHasVSTable = hasVSTable;
 
   for (size_t i = 0; i < mFonts.size(); ++i) {
     std::unordered_set<AxisTag> supportedAxes =
         mFonts[i].getSupportedAxesLocked();
     mSupportedAxes.insert(supportedAxes.begin(), supportedAxes.end());
   }
+  mCoverageComputed.store(true, std::memory_order_release);
 }
 
 bool FontFamily::hasGlyph(uint32_t codepoint,
                           uint32_t variationSelector) const {
   assertMinikinLocked();
-  if (variationSelector != 0 && !mHasVSTable) {
+  if (variationSelector != 0 && !hasVSTable()) {
     // Early exit if the variation selector is specified but the font doesn't
     // have a cmap format 14 subtable.
     return false;
@@ -214,7 +305,7 @@ bool FontFamily::hasGlyph(uint32_t codepoint,
 
 std::shared_ptr<FontFamily> FontFamily::createFamilyWithVariation(
     const std::vector<FontVariation>& variations) const {
-  if (variations.empty() || mSupportedAxes.empty()) {
+  if (variations.empty() || supportedAxes().empty()) {
     return nullptr;
   }
 
@@ -253,8 +344,9 @@ std::shared_ptr<FontFamily> FontFamily::createFamilyWithVariation(
     fonts.push_back(Font(std::move(minikinFont), font.style));
   }
 
-  return std::shared_ptr<FontFamily>(
-      new FontFamily(mLangId, mVariant, std::move(fonts)));
+  // Variations don't change the cmap, so the coverage is shared rather than
+  // parsed again for every instance.
+  return std::shared_ptr<FontFamily>(new FontFamily(*this, std::move(fonts)));
 }
 
 }  // namespace minikin
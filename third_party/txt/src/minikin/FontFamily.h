@@ -17,6 +17,7 @@
 #ifndef MINIKIN_FONT_FAMILY_H
 #define MINIKIN_FONT_FAMILY_H
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -26,6 +27,7 @@
 
 #include <utils/TypeHelpers.h>
 
+#include <minikin/PersistentStore.h>
 #include <minikin/SparseBitSet.h>
 
 namespace minikin {
@@ -154,11 +156,15 @@ class FontFamily {
   FontStyle getStyle(size_t index) const { return mFonts[index].style; }
   bool isColorEmojiFamily() const;
   const std::unordered_set<AxisTag>& supportedAxes() const {
+    ensureCoverage();
     return mSupportedAxes;
   }
 
   // Get Unicode coverage.
-  const SparseBitSet& getCoverage() const { return mCoverage; }
+  const SparseBitSet& getCoverage() const {
+    ensureCoverage();
+    return *mCoverage;
+  }
 
   // Returns true if the font has a glyph for the code point and variation
   // selector pair. Caller should acquire a lock before calling the method.
@@ -166,23 +172,47 @@ class FontFamily {
 
   // Returns true if this font family has a variaion sequence table (cmap format
   // 14 subtable).
-  bool hasVSTable() const { return mHasVSTable; }
+  bool hasVSTable() const {
+    ensureCoverage();
+    return mHasVSTable;
+  }
 
   // Creates new FontFamily based on this family while applying font variations.
   // Returns nullptr if none of variations apply to this family.
   std::shared_ptr<FontFamily> createFamilyWithVariation(
       const std::vector<FontVariation>& variations) const;
 
+  // libtxt extension: Sets the store the cmap coverage of fonts is kept in
+  // across runs, keyed by the content hash of the font. Passing nullptr stops
+  // using the store. This method is thread safe.
+  static void setPersistentStore(std::shared_ptr<PersistentStore> store);
+
  private:
-  void computeCoverage();
+  // libtxt extension: Creates a family of |fonts| that shares the coverage of
+  // |coverageSource|, which must have computed it. Used for variations, which
+  // don't change the cmap.
+  FontFamily(const FontFamily& coverageSource, std::vector<Font>&& fonts);
+
+  // libtxt extension: The coverage is computed from the cmap table the first
+  // time it is asked for rather than when the family is created, so that
+  // creating a family doesn't parse its fonts.
+  void ensureCoverage() const {
+    if (!mCoverageComputed.load(std::memory_order_acquire)) {
+      computeCoverage();
+    }
+  }
+  void computeCoverage() const;
 
   uint32_t mLangId;
   int mVariant;
   std::vector<Font> mFonts;
-  std::unordered_set<AxisTag> mSupportedAxes;
 
-  SparseBitSet mCoverage;
-  bool mHasVSTable;
+  // Written once by computeCoverage, under gMinikinLock. The coverage is
+  // shared with the families created by createFamilyWithVariation.
+  mutable std::unordered_set<AxisTag> mSupportedAxes;
+  mutable std::shared_ptr<const SparseBitSet> mCoverage;
+  mutable bool mHasVSTable;
+  mutable std::atomic<bool> mCoverageComputed;
 
   // Forbid copying and assignment.
   FontFamily(const FontFamily&) = delete;
@@ -21,6 +21,8 @@
 #include <log/log.h>
 #include <utils/LruCache.h>
 
+#include <mutex>
+
 #include <hb-ot.h>
 #include <hb.h>
 
@@ -54,40 +56,39 @@ class HbFontCache : private android::OnEntryRemoved<int32_t, hb_font_t*> {
   android::LruCache<int32_t, hb_font_t*> mCache;
 };
 
-HbFontCache* getFontCacheLocked() {
-  assertMinikinLocked();
-  static HbFontCache* cache = nullptr;
-  if (cache == nullptr) {
-    cache = new HbFontCache();
-  }
+// The cache is shared by all threads doing layout, so it has its own lock
+// rather than relying on the global minikin lock.
+static std::mutex gHbFontCacheMutex;
+
+static HbFontCache* getFontCache() {
+  static HbFontCache* cache = new HbFontCache();
   return cache;
 }
 
 void purgeHbFontCacheLocked() {
-  assertMinikinLocked();
-  getFontCacheLocked()->clear();
+  std::scoped_lock lock(gHbFontCacheMutex);
+  getFontCache()->clear();
 }
 
 void purgeHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
   const int32_t fontId = minikinFont->GetUniqueId();
-  getFontCacheLocked()->remove(fontId);
+  std::scoped_lock lock(gHbFontCacheMutex);
+  getFontCache()->remove(fontId);
 }
 
 // Returns a new reference to a hb_font_t object, caller is
-// responsible for calling hb_font_destroy() on it.
+// responsible for calling hb_font_destroy() on it. The returned font may be
+// shared with other threads and must not be modified, create a sub font to
+// change its scale or other settings.
 hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
   // TODO: get rid of nullFaceFont
-  static hb_font_t* nullFaceFont = nullptr;
   if (minikinFont == nullptr) {
-    if (nullFaceFont == nullptr) {
-      nullFaceFont = hb_font_create(nullptr);
-    }
+    static hb_font_t* nullFaceFont = hb_font_create(nullptr);
     return hb_font_reference(nullFaceFont);
   }
 
-  HbFontCache* fontCache = getFontCacheLocked();
+  std::scoped_lock lock(gHbFontCacheMutex);
+  HbFontCache* fontCache = getFontCache();
   const int32_t fontId = minikinFont->GetUniqueId();
   hb_font_t* font = fontCache->get(fontId);
   if (font != nullptr) {
@@ -110,6 +111,7 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
   hb_font_set_variations(font, variations.data(), variations.size());
   hb_font_destroy(parent_font);
   hb_face_destroy(face);
+  hb_font_make_immutable(font);
   fontCache->put(fontId, font);
   return hb_font_reference(font);
 }
@@ -22,6 +22,8 @@ struct hb_font_t;
 namespace minikin {
 class MinikinFont;
 
+// These functions are thread safe. The "Locked" suffix is historical, the
+// cache no longer requires the global minikin lock to be held.
 void purgeHbFontCacheLocked();
 void purgeHbFontLocked(const MinikinFont* minikinFont);
 hb_font_t* getHbFontLocked(const MinikinFont* minikinFont);
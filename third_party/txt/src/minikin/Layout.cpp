@@ -20,8 +20,11 @@
 #include <unicode/ubidi.h>
 #include <unicode/utf16.h>
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -35,6 +38,7 @@
 
 #include <minikin/Emoji.h>
 #include <minikin/Layout.h>
+#include "flutter/fml/thread_local.h"
 #include "FontLanguage.h"
 #include "FontLanguageListCache.h"
 #include "HbFontCache.h"
@@ -99,6 +103,10 @@ class LayoutCacheKey {
     mChars = NULL;
   }
 
+  size_t getMemoryUsage() const {
+    return sizeof(LayoutCacheKey) + mNchars * sizeof(uint16_t);
+  }
+
   void doLayout(Layout* layout,
                 LayoutContext* ctx,
                 const std::shared_ptr<FontCollection>& collection) const {
@@ -108,6 +116,14 @@ class LayoutCacheKey {
                         collection);
   }
 
+  size_t getCount() const { return mCount; }
+
+  // Sets |out| to a key for a PersistentStore, which unlike this key
+  // identifies the fonts and languages the same way in every run. Returns
+  // false if the fonts of |collection| can't be identified.
+  bool getPersistentKey(const FontCollection& collection,
+                        std::string* out) const;
+
  private:
   const uint16_t* mChars;
   size_t mNchars;
@@ -129,56 +145,187 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+// Caches the layouts of words. The cache is split into shards picked by the
+// hash of the key, each with its own lock, so that text can be laid out on
+// several threads at once. Each shard evicts its least recently used layouts
+// once they take more than its share of the memory budget.
+class LayoutCache {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
+  // About what the previous limit of 5000 layouts amounted to.
+  static const size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+  LayoutCache() { setMaxBytes(kDefaultMaxBytes); }
+
+  void clear() {
+    for (Shard& shard : mShards) {
+      std::scoped_lock _l(shard.mutex);
+      shard.cache.clear();
+    }
+  }
+
+  void setMaxBytes(size_t maxBytes) {
+    for (Shard& shard : mShards) {
+      std::scoped_lock _l(shard.mutex);
+      shard.maxBytes = maxBytes / kShardCount;
+      shard.evictLocked();
+    }
+  }
+
+  size_t getBytes() {
+    size_t bytes = 0;
+    for (Shard& shard : mShards) {
+      std::scoped_lock _l(shard.mutex);
+      bytes += shard.bytes;
+    }
+    return bytes;
   }
 
-  void clear() { mCache.clear(); }
+  void setPersistentStore(std::shared_ptr<PersistentStore> store) {
+    std::scoped_lock _l(mStoreMutex);
+    mStore = std::move(store);
+  }
+
+  std::shared_ptr<Layout> get(
+      LayoutCacheKey& key,
+      LayoutContext* ctx,
+      const std::shared_ptr<FontCollection>& collection) {
+    Shard& shard = mShards[key.hash() % kShardCount];
+    {
+      std::scoped_lock _l(shard.mutex);
+      std::shared_ptr<Layout> layout = shard.cache.get(key);
+      if (layout) {
+        return layout;
+      }
+    }
 
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
+    // Shape without holding the lock. If another thread lays out the same
+    // word meanwhile, the first layout to be put in the cache is kept.
+    std::shared_ptr<Layout> layout = loadPersistent(key, *collection);
+    if (!layout) {
+      layout = std::make_shared<Layout>();
+      key.doLayout(layout.get(), ctx, collection);
+      storePersistent(key, *collection, *layout);
+    }
+
+    std::scoped_lock _l(shard.mutex);
+    if (shard.cache.get(key) == nullptr) {
       key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
+      shard.cache.put(key, layout);
+      shard.bytes += key.getMemoryUsage() + layout->getMemoryUsage();
+      shard.evictLocked();
     }
     return layout;
   }
 
  private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
+  static const size_t kShardCount = 16;
+
+  class Shard : private android::OnEntryRemoved<LayoutCacheKey,
+                                                std::shared_ptr<Layout>> {
+   public:
+    Shard() : cache(decltype(cache)::kUnlimitedCapacity) {
+      cache.setOnEntryRemovedListener(this);
+    }
+
+    void evictLocked() {
+      while (bytes > maxBytes && cache.removeOldest()) {
+      }
+    }
+
+    std::mutex mutex;
+    android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>> cache;
+    size_t bytes = 0;
+    size_t maxBytes = 0;
+
+   private:
+    // callback for OnEntryRemoved
+    void operator()(LayoutCacheKey& key, std::shared_ptr<Layout>& value) {
+      bytes -= key.getMemoryUsage() + value->getMemoryUsage();
+      key.freeText();
+      // Threads still using the layout keep it alive.
+      value.reset();
+    }
+  };
+
+  std::shared_ptr<PersistentStore> getPersistentStore() {
+    std::scoped_lock _l(mStoreMutex);
+    return mStore;
+  }
+
+  // Returns the layout of the word from the persistent store, or nullptr if
+  // it isn't there.
+  std::shared_ptr<Layout> loadPersistent(const LayoutCacheKey& key,
+                                         const FontCollection& collection) {
+    std::shared_ptr<PersistentStore> store = getPersistentStore();
+    std::string persistentKey;
+    std::string value;
+    if (!store || !key.getPersistentKey(collection, &persistentKey) ||
+        !store->load(persistentKey, &value)) {
+      return nullptr;
+    }
+    std::shared_ptr<Layout> layout = std::make_shared<Layout>();
+    if (!layout->deserialize(collection, key.getCount(), value)) {
+      return nullptr;
+    }
+    return layout;
+  }
+
+  void storePersistent(const LayoutCacheKey& key,
+                       const FontCollection& collection,
+                       const Layout& layout) {
+    std::shared_ptr<PersistentStore> store = getPersistentStore();
+    std::string persistentKey;
+    std::string value;
+    if (store && key.getPersistentKey(collection, &persistentKey) &&
+        layout.serialize(collection, &value)) {
+      store->store(std::move(persistentKey), std::move(value));
+    }
   }
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
+  std::array<Shard, kShardCount> mShards;
 
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+  std::mutex mStoreMutex;
+  std::shared_ptr<PersistentStore> mStore;
+};
+
+// Owns a HarfBuzz buffer for a single thread.
+class HbBuffer {
+ public:
+  explicit HbBuffer(hb_unicode_funcs_t* unicodeFunctions)
+      : mBuffer(hb_buffer_create()) {
+    hb_buffer_set_unicode_funcs(mBuffer, unicodeFunctions);
+  }
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+  ~HbBuffer() { hb_buffer_destroy(mBuffer); }
+
+  hb_buffer_t* get() const { return mBuffer; }
+
+ private:
+  hb_buffer_t* mBuffer;
+
+  HbBuffer(const HbBuffer&) = delete;
+  void operator=(const HbBuffer&) = delete;
 };
 
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
+  // Returns the HarfBuzz buffer of the calling thread. Each thread shapes
+  // with its own buffer so that layouts can run concurrently.
+  hb_buffer_t* getHbBuffer() {
+    FML_THREAD_LOCAL fml::ThreadLocalUniquePtr<HbBuffer> tls_buffer;
+    if (!tls_buffer.get()) {
+      tls_buffer.reset(new HbBuffer(unicodeFunctions));
+    }
+    return tls_buffer.get()->get();
+  }
+
   static LayoutEngine& getInstance() {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
@@ -215,6 +362,61 @@ android::hash_t hash_type(const LayoutCacheKey& key) {
   return key.hash();
 }
 
+// Starts the keys of persistent layouts, followed by a version that is bumped
+// whenever the bytes of persistent layouts change.
+static const uint32_t kPersistentLayoutTag =
+    MinikinFont::MakeTag('l', 'y', 'o', 't');
+static const uint32_t kPersistentLayoutVersion = 1;
+
+template <typename T>
+static void appendBytes(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool readBytes(const std::string& in, size_t* offset, T* value) {
+  if (in.size() - *offset < sizeof(T)) {
+    return false;
+  }
+  memcpy(value, in.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return true;
+}
+
+bool LayoutCacheKey::getPersistentKey(const FontCollection& collection,
+                                      std::string* out) const {
+  const uint64_t collectionHash = collection.getContentHash();
+  if (collectionHash == 0) {
+    return false;
+  }
+  out->clear();
+  appendBytes(out, kPersistentLayoutTag);
+  appendBytes(out, kPersistentLayoutVersion);
+  appendBytes(out, collectionHash);
+  appendBytes(out, static_cast<uint32_t>(mStart));
+  appendBytes(out, static_cast<uint32_t>(mCount));
+  appendBytes(out, static_cast<uint32_t>(mNchars));
+  appendBytes(out, static_cast<uint8_t>(mStyle.getWeight()));
+  appendBytes(out, static_cast<uint8_t>(mStyle.getItalic()));
+  appendBytes(out, static_cast<uint8_t>(mStyle.getVariant()));
+  const FontLanguages& languages =
+      FontLanguageListCache::getById(mStyle.getLanguageListId());
+  appendBytes(out, static_cast<uint32_t>(languages.size()));
+  for (size_t i = 0; i < languages.size(); i++) {
+    appendBytes(out, languages[i].getIdentifier());
+  }
+  appendBytes(out, mSize);
+  appendBytes(out, mScaleX);
+  appendBytes(out, mSkewX);
+  appendBytes(out, mLetterSpacing);
+  appendBytes(out, mPaintFlags);
+  appendBytes(out, mHyphenEdit.getHyphen());
+  appendBytes(out, static_cast<uint8_t>(mIsRtl));
+  out->append(reinterpret_cast<const char*>(mChars),
+              mNchars * sizeof(uint16_t));
+  return true;
+}
+
 void MinikinRect::join(const MinikinRect& r) {
   if (isEmpty()) {
     set(r);
@@ -254,34 +456,31 @@ static hb_bool_t harfbuzzGetGlyphHorizontalOrigin(hb_font_t* /* hbFont */,
   return true;
 }
 
-hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
-  assertMinikinLocked();
-
-  static hb_font_funcs_t* hbFuncs = nullptr;
-  static hb_font_funcs_t* hbFuncsForColorBitmap = nullptr;
-
-  hb_font_funcs_t** funcs =
-      forColorBitmapFont ? &hbFuncs : &hbFuncsForColorBitmap;
-  if (*funcs == nullptr) {
-    *funcs = hb_font_funcs_create();
-    if (forColorBitmapFont) {
-      // Don't override the h_advance function since we use HarfBuzz's
-      // implementation for emoji for performance reasons. Note that it is
-      // technically possible for a TrueType font to have outline and embedded
-      // bitmap at the same time. We ignore modified advances of hinted outline
-      // glyphs in that case.
-    } else {
-      // Override the h_advance function since we can't use HarfBuzz's
-      // implemenation. It may return the wrong value if the font uses hinting
-      // aggressively.
-      hb_font_funcs_set_glyph_h_advance_func(
-          *funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
-    }
-    hb_font_funcs_set_glyph_h_origin_func(
-        *funcs, harfbuzzGetGlyphHorizontalOrigin, 0, 0);
-    hb_font_funcs_make_immutable(*funcs);
+static hb_font_funcs_t* createHbFontFuncs(bool forColorBitmapFont) {
+  hb_font_funcs_t* funcs = hb_font_funcs_create();
+  if (forColorBitmapFont) {
+    // Don't override the h_advance function since we use HarfBuzz's
+    // implementation for emoji for performance reasons. Note that it is
+    // technically possible for a TrueType font to have outline and embedded
+    // bitmap at the same time. We ignore modified advances of hinted outline
+    // glyphs in that case.
+  } else {
+    // Override the h_advance function since we can't use HarfBuzz's
+    // implemenation. It may return the wrong value if the font uses hinting
+    // aggressively.
+    hb_font_funcs_set_glyph_h_advance_func(
+        funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
   }
-  return *funcs;
+  hb_font_funcs_set_glyph_h_origin_func(funcs, harfbuzzGetGlyphHorizontalOrigin,
+                                        0, 0);
+  hb_font_funcs_make_immutable(funcs);
+  return funcs;
+}
+
+hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
+  static hb_font_funcs_t* hbFuncs = createHbFontFuncs(true);
+  static hb_font_funcs_t* hbFuncsForColorBitmap = createHbFontFuncs(false);
+  return forColorBitmapFont ? hbFuncs : hbFuncsForColorBitmap;
 }
 
 static bool isColorBitmapFont(hb_font_t* font) {
@@ -316,19 +515,20 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
-    hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
+    // The cached font is shared with other threads, so the paint and scale of
+    // this layout are set on a sub font of it.
+    hb_font_t* cachedFont = getHbFontLocked(face.font);
+    hb_font_t* font = hb_font_create_sub_font(cachedFont);
+    hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(cachedFont)),
                       &ctx->paint, 0);
+    hb_font_destroy(cachedFont);
     ctx->hbFonts.push_back(font);
   }
   return ix;
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -588,8 +788,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -612,8 +810,6 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -720,9 +916,9 @@ float Layout::doLayoutWord(const uint16_t* buf,
     }
     advance = layoutForWord.getAdvance();
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
+    std::shared_ptr<Layout> layoutForWord = cache.get(key, ctx, collection);
     if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
+      layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
     }
     if (advances) {
       layoutForWord->getAdvances(advances);
@@ -748,7 +944,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,7 +1115,7 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = LayoutEngine::getInstance().getHbBuffer();
   std::vector<FontCollection::Run> items;
   collection->itemize(buf + start, count, ctx->style, &items);
 
@@ -1184,7 +1380,7 @@ float Layout::getAdvance() const {
   return mAdvance;
 }
 
-void Layout::getAdvances(float* advances) {
+void Layout::getAdvances(float* advances) const {
   memcpy(advances, &mAdvances[0], mAdvances.size() * sizeof(float));
 }
 
@@ -1192,11 +1388,117 @@ void Layout::getBounds(MinikinRect* bounds) const {
   bounds->set(mBounds);
 }
 
+size_t Layout::getMemoryUsage() const {
+  return sizeof(Layout) + mGlyphs.capacity() * sizeof(LayoutGlyph) +
+         mAdvances.capacity() * sizeof(float) +
+         mFaces.capacity() * sizeof(FakedFont);
+}
+
+bool Layout::serialize(const FontCollection& collection,
+                       std::string* out) const {
+  out->clear();
+  appendBytes(out, static_cast<uint32_t>(mFaces.size()));
+  for (const FakedFont& face : mFaces) {
+    const int fontIndex = collection.getFontIndex(face.font);
+    if (fontIndex < 0) {
+      return false;
+    }
+    FontFakery fakery = face.fakery;
+    appendBytes(out, static_cast<uint32_t>(fontIndex));
+    appendBytes(out, static_cast<uint8_t>(fakery.isFakeBold()));
+    appendBytes(out, static_cast<uint8_t>(fakery.isFakeItalic()));
+  }
+  appendBytes(out, static_cast<uint32_t>(mGlyphs.size()));
+  for (const LayoutGlyph& glyph : mGlyphs) {
+    if (glyph.glyph_id == 0) {
+      return false;
+    }
+    appendBytes(out, static_cast<uint32_t>(glyph.font_ix));
+    appendBytes(out, static_cast<uint32_t>(glyph.glyph_id));
+    appendBytes(out, glyph.x);
+    appendBytes(out, glyph.y);
+    appendBytes(out, glyph.cluster);
+  }
+  appendBytes(out, static_cast<uint32_t>(mAdvances.size()));
+  for (float advance : mAdvances) {
+    appendBytes(out, advance);
+  }
+  appendBytes(out, mAdvance);
+  appendBytes(out, mBounds);
+  return true;
+}
+
+bool Layout::deserialize(const FontCollection& collection,
+                         size_t count,
+                         const std::string& data) {
+  reset();
+  size_t offset = 0;
+  uint32_t faceCount;
+  if (!readBytes(data, &offset, &faceCount)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < faceCount; i++) {
+    uint32_t fontIndex;
+    uint8_t fakeBold;
+    uint8_t fakeItalic;
+    if (!readBytes(data, &offset, &fontIndex) ||
+        !readBytes(data, &offset, &fakeBold) ||
+        !readBytes(data, &offset, &fakeItalic)) {
+      return false;
+    }
+    MinikinFont* font = collection.getFontAtIndex(fontIndex);
+    if (font == nullptr) {
+      return false;
+    }
+    mFaces.push_back({font, FontFakery(fakeBold, fakeItalic)});
+  }
+  uint32_t glyphCount;
+  if (!readBytes(data, &offset, &glyphCount)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < glyphCount; i++) {
+    uint32_t fontIx;
+    LayoutGlyph glyph;
+    if (!readBytes(data, &offset, &fontIx) || fontIx >= faceCount ||
+        !readBytes(data, &offset, &glyph.glyph_id) ||
+        !readBytes(data, &offset, &glyph.x) ||
+        !readBytes(data, &offset, &glyph.y) ||
+        !readBytes(data, &offset, &glyph.cluster)) {
+      return false;
+    }
+    glyph.font_ix = fontIx;
+    mGlyphs.push_back(glyph);
+  }
+  uint32_t advanceCount;
+  if (!readBytes(data, &offset, &advanceCount) || advanceCount != count) {
+    return false;
+  }
+  mAdvances.resize(advanceCount);
+  for (float& advance : mAdvances) {
+    if (!readBytes(data, &offset, &advance)) {
+      return false;
+    }
+  }
+  return readBytes(data, &offset, &mAdvance) &&
+         readBytes(data, &offset, &mBounds) && offset == data.size();
+}
+
 void Layout::purgeCaches() {
-  std::scoped_lock _l(gMinikinLock);
   LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
   layoutCache.clear();
   purgeHbFontCacheLocked();
 }
 
+void Layout::setCacheMaxBytes(size_t maxBytes) {
+  LayoutEngine::getInstance().layoutCache.setMaxBytes(maxBytes);
+}
+
+size_t Layout::getCacheBytes() {
+  return LayoutEngine::getInstance().layoutCache.getBytes();
+}
+
+void Layout::setPersistentStore(std::shared_ptr<PersistentStore> store) {
+  LayoutEngine::getInstance().layoutCache.setPersistentStore(std::move(store));
+}
+
 }  // namespace minikin
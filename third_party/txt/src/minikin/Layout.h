@@ -20,9 +20,11 @@
 #include <hb.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <minikin/FontCollection.h>
+#include <minikin/PersistentStore.h>
 
 namespace minikin {
 
@@ -59,7 +61,8 @@ enum {
 
 // Lifecycle and threading assumptions for Layout:
 // The object is assumed to be owned by a single thread; multiple threads
-// may not mutate it at the same time.
+// may not mutate it at the same time. Different Layout objects may be laid
+// out on different threads concurrently.
 class Layout {
  public:
   Layout() : mGlyphs(), mAdvances(), mFaces(), mAdvance(0), mBounds() {
@@ -106,7 +109,7 @@ class Layout {
 
   // Get advances, copying into caller-provided buffer. The size of this
   // buffer must match the length of the string (count arg to doLayout).
-  void getAdvances(float* advances);
+  void getAdvances(float* advances) const;
 
   // The i parameter is an offset within the buf relative to start, it is <
   // count, where start and count are the parameters to doLayout
@@ -114,11 +117,39 @@ class Layout {
 
   void getBounds(MinikinRect* rect) const;
 
+  // Estimated number of bytes of memory used by this layout.
+  size_t getMemoryUsage() const;
+
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // Sets how many bytes of memory the cache of word layouts may use. The least
+  // recently used layouts are evicted beyond that.
+  static void setCacheMaxBytes(size_t maxBytes);
+
+  // Number of bytes of memory currently used by the cache of word layouts.
+  static size_t getCacheBytes();
+
+  // libtxt extension: sets the store that words missing from the cache of
+  // word layouts are looked up in before they are shaped, and that words are
+  // offered to once shaped, so that words laid out in an earlier run are not
+  // shaped again. Passing nullptr stops using the store.
+  static void setPersistentStore(std::shared_ptr<PersistentStore> store);
+
  private:
   friend class LayoutCacheKey;
+  friend class LayoutCache;
+
+  // Serializes this layout of a word for a PersistentStore. Returns
+  // false if the layout uses a font that isn't one of |collection|'s own
+  // fonts, or a missing glyph, either of which could differ in another run.
+  bool serialize(const FontCollection& collection, std::string* out) const;
+
+  // Restores a layout of |count| characters serialized with |collection|.
+  // Returns false if |data| is malformed.
+  bool deserialize(const FontCollection& collection,
+                   size_t count,
+                   const std::string& data);
 
   // Find a face in the mFaces vector, or create a new entry
   int findFace(const FakedFont& face, LayoutContext* ctx);
@@ -91,11 +91,13 @@ class LineBreaker {
       29;  // keep synchronized with TAB_MASK in StaticLayout.java
 
   // Note: Locale persists across multiple invocations (it is not cleaned up by
-  // finish()), explicitly to avoid the cost of creating ICU BreakIterator
-  // objects. It should always be set on the first invocation, but callers are
-  // encouraged not to call again unless locale has actually changed. That logic
-  // could be here but it's better for performance that it's upstream because of
-  // the cost of constructing and comparing the ICU Locale object.
+  // finish()). The ICU BreakIterator for it is borrowed from the
+  // BreakIteratorPool for each text and returned by finish(), to avoid the
+  // cost of creating one per paragraph. It should always be set on the first
+  // invocation, but callers are encouraged not to call again unless locale has
+  // actually changed. That logic could be here but it's better for performance
+  // that it's upstream because of the cost of constructing and comparing the
+  // ICU Locale object.
   // Note: caller is responsible for managing lifetime of hyphenator
   void setLocale(const icu::Locale& locale, Hyphenator* hyphenator);
 
@@ -145,6 +147,16 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // libtxt: Same as addStyleRun, but uses the character widths already in the
+  // width buffer instead of measuring the text again. Used to break the same
+  // text at another width without reshaping it.
+  void addMeasuredStyleRun(MinikinPaint* paint,
+                           const std::shared_ptr<FontCollection>& typeface,
+                           FontStyle style,
+                           size_t start,
+                           size_t end,
+                           bool isRtl);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
@@ -190,6 +202,14 @@ class LineBreaker {
 
   float currentLineWidth() const;
 
+  // Finds the candidate breaks of a run whose widths are in mCharWidths.
+  void addCandidates(MinikinPaint* paint,
+                     const std::shared_ptr<FontCollection>& typeface,
+                     FontStyle style,
+                     size_t start,
+                     size_t end,
+                     bool isRtl);
+
   void addWordBreak(size_t offset,
                     ParaWidth preBreak,
                     ParaWidth postBreak,
@@ -17,6 +17,8 @@
 #ifndef MINIKIN_FONT_H
 #define MINIKIN_FONT_H
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 
@@ -117,6 +119,23 @@ class MinikinFont {
 
   int32_t GetUniqueId() const { return mUniqueId; }
 
+  // libtxt extension: a hash of the font data and variation, which unlike the
+  // unique id is the same in every process that loads the font. Returns 0 if
+  // the font can't be identified by its data. The hash is 64 bits wide on
+  // every platform, since it keys entries that persist across runs.
+  virtual uint64_t GetContentHash() const { return 0; }
+
+  // libtxt extension: mixes |value| into the content hash |seed|.
+  static uint64_t CombineContentHash(uint64_t seed, uint64_t value) {
+    // The 64-bit finalizer of MurmurHash3 spreads small values over all bits.
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+  }
+
  private:
   const int32_t mUniqueId;
 };
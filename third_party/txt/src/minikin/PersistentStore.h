@@ -0,0 +1,31 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MINIKIN_PERSISTENT_STORE_H
+#define MINIKIN_PERSISTENT_STORE_H
+
+#include <string>
+
+namespace minikin {
+
+// A store that keeps what minikin computes from fonts across runs of the
+// process, such as the layouts of words and the coverage of fonts. Keys and
+// values are opaque bytes. The keys of each kind of entry start with a
+// different tag, so one store can hold all of them.
+class PersistentStore {
+ public:
+  virtual ~PersistentStore() = default;
+
+  // Returns true and sets |value| if an entry for |key| was stored, in this
+  // or an earlier run. Called on the threads that lay out text.
+  virtual bool load(const std::string& key, std::string* value) = 0;
+
+  // Stores an entry for |key|. Called on the threads that lay out text, so
+  // implementations should not write to disk before returning.
+  virtual void store(std::string key, std::string value) = 0;
+};
+
+}  // namespace minikin
+
+#endif  // MINIKIN_PERSISTENT_STORE_H
@@ -18,6 +18,7 @@
 
 #include <log/log.h>
 
+#include <minikin/BreakIteratorPool.h>
 #include <minikin/Emoji.h>
 #include <minikin/Hyphenator.h>
 #include <minikin/WordBreaker.h>
@@ -32,12 +33,16 @@ const uint32_t CHAR_SOFT_HYPHEN = 0x00AD;
 const uint32_t CHAR_ZWJ = 0x200D;
 
 void WordBreaker::setLocale(const icu::Locale& locale) {
-  UErrorCode status = U_ZERO_ERROR;
-  mBreakIterator.reset(icu::BreakIterator::createLineInstance(locale, status));
-  // TODO: handle failure status
-  if (mText != nullptr) {
-    mBreakIterator->setText(&mUText, status);
+  if (mBreakIterator) {
+    BreakIteratorPool::release(mLocale, std::move(mBreakIterator));
+    mBreakIterator = BreakIteratorPool::acquire(locale);
+    // TODO: handle failure status
+    if (mText != nullptr) {
+      UErrorCode status = U_ZERO_ERROR;
+      mBreakIterator->setText(&mUText, status);
+    }
   }
+  mLocale = locale;
   mIteratorWasReset = true;
 }
 
@@ -52,6 +57,9 @@ void WordBreaker::setText(const uint16_t* data, size_t size) {
   UErrorCode status = U_ZERO_ERROR;
   utext_openUChars(&mUText, reinterpret_cast<const UChar*>(data), size,
                    &status);
+  if (!mBreakIterator) {
+    mBreakIterator = BreakIteratorPool::acquire(mLocale);
+  }
   mBreakIterator->setText(&mUText, status);
   mBreakIterator->first();
 }
@@ -278,6 +286,7 @@ void WordBreaker::finish() {
   mText = nullptr;
   // Note: calling utext_close multiply is safe
   utext_close(&mUText);
+  BreakIteratorPool::release(mLocale, std::move(mBreakIterator));
 }
 
 }  // namespace minikin
@@ -25,6 +25,7 @@
 
 #include <memory>
 #include "unicode/brkiter.h"
+#include "unicode/locid.h"
 #include "utils/WindowsUtils.h"
 
 namespace minikin {
@@ -33,6 +34,8 @@ class WordBreaker {
  public:
   ~WordBreaker() { finish(); }
 
+  // The break iterator for the locale is borrowed from the
+  // |BreakIteratorPool| when text is set, and returned by finish().
   void setLocale(const icu::Locale& locale);
 
   void setText(const uint16_t* data, size_t size);
@@ -59,6 +62,7 @@ class WordBreaker {
   void detectEmailOrUrl();
   ssize_t findNextBreakInEmailOrUrl();
 
+  icu::Locale mLocale;
   std::unique_ptr<icu::BreakIterator> mBreakIterator;
   UText mUText = UTEXT_INITIALIZER;
   const uint16_t* mText = nullptr;
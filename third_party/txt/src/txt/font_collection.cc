@@ -130,6 +130,8 @@ std::shared_ptr<minikin::FontCollection>
 FontCollection::GetMinikinFontCollectionForFamilies(
     const std::vector<std::string>& font_families,
     const std::string& locale) {
+  std::scoped_lock lock(cache_mutex_);
+
   // Look inside the font collections cache first.
   FamilyKey family_key(font_families, locale);
   auto cached = font_collections_cache_.find(family_key);
@@ -191,15 +193,19 @@ FontCollection::GetMinikinFontCollectionForFamilies(
 std::shared_ptr<minikin::FontFamily> FontCollection::FindFontFamilyInManagers(
     const std::string& family_name) {
   TRACE_EVENT0("flutter", "FontCollection::FindFontFamilyInManagers");
+  auto cached = font_families_cache_.find(family_name);
+  if (cached != font_families_cache_.end()) {
+    return cached->second;
+  }
   // Search for the font family in each font manager.
+  std::shared_ptr<minikin::FontFamily> found;
   for (sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
-    std::shared_ptr<minikin::FontFamily> minikin_family =
-        CreateMinikinFontFamily(manager, family_name);
-    if (!minikin_family)
-      continue;
-    return minikin_family;
+    found = CreateMinikinFontFamily(manager, family_name);
+    if (found)
+      break;
   }
-  return nullptr;
+  font_families_cache_[family_name] = found;
+  return found;
 }
 
 void FontCollection::SortSkTypefaces(
@@ -278,6 +284,8 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  std::scoped_lock lock(cache_mutex_);
+
   // Check if the ch's matched font has been cached. We cache the results of
   // this method as repeated matchFamilyStyleCharacter calls can become
   // extremely laggy when typing a large number of complex emojis.
@@ -342,7 +350,9 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
 }
 
 void FontCollection::ClearFontFamilyCache() {
+  std::scoped_lock lock(cache_mutex_);
   font_collections_cache_.clear();
+  font_families_cache_.clear();
 }
 
 #if FLUTTER_ENABLE_SKSHAPER
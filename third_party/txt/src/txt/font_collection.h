@@ -18,6 +18,7 @@
 #define LIB_TXT_SRC_FONT_COLLECTION_H_
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -98,6 +99,12 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
                      std::shared_ptr<minikin::FontCollection>,
                      FamilyKey::Hasher>
       font_collections_cache_;
+  // The families found by FindFontFamilyInManagers, or nullptr for names that
+  // no manager has. Font collections are rebuilt whenever a fallback font is
+  // added, and reusing the families keeps their coverage from being computed
+  // again.
+  std::unordered_map<std::string, std::shared_ptr<minikin::FontFamily>>
+      font_families_cache_;
   // Cache that stores the results of MatchFallbackFont to ensure lag-free emoji
   // font fallback matching.
   std::unordered_map<uint32_t, const std::shared_ptr<minikin::FontFamily>*>
@@ -106,6 +113,9 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
       fallback_fonts_;
   std::unordered_map<std::string, std::vector<std::string>>
       fallback_fonts_for_locale_;
+  // Guards the caches above, which are filled in while laying out text.
+  // Paragraphs may be laid out on several threads at once.
+  std::mutex cache_mutex_;
   bool enable_font_fallback_;
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -18,6 +18,9 @@
 
 #include <minikin/MinikinFont.h>
 
+#include <cstring>
+#include <vector>
+
 #include "third_party/skia/include/core/SkFont.h"
 
 namespace txt {
@@ -90,6 +93,42 @@ const std::vector<minikin::FontVariation>& FontSkia::GetAxes() const {
   return variations_;
 }
 
+uint64_t FontSkia::GetContentHash() const {
+  // The head table holds a checksum of the whole font file, so fonts are told
+  // apart without reading all of their data.
+  const SkFontTableTag head_tag = SkSetFourByteTag('h', 'e', 'a', 'd');
+  const size_t head_size = typeface_->getTableSize(head_tag);
+  if (head_size == 0)
+    return 0;
+  std::vector<uint8_t> head(head_size);
+  if (typeface_->getTableData(head_tag, 0, head_size, head.data()) !=
+      head_size)
+    return 0;
+
+  uint64_t hash = CombineContentHash(head_size, typeface_->countGlyphs());
+  for (uint8_t byte : head) {
+    hash = CombineContentHash(hash, byte);
+  }
+
+  // Instances of a variable font share its data but not its advances.
+  int axis_count = typeface_->getVariationDesignPosition(nullptr, 0);
+  if (axis_count > 0) {
+    std::vector<SkFontArguments::VariationPosition::Coordinate> coordinates(
+        axis_count);
+    if (typeface_->getVariationDesignPosition(coordinates.data(),
+                                              axis_count) == axis_count) {
+      for (const auto& coordinate : coordinates) {
+        uint32_t value_bits;
+        static_assert(sizeof(value_bits) == sizeof(coordinate.value));
+        memcpy(&value_bits, &coordinate.value, sizeof(value_bits));
+        hash = CombineContentHash(hash, coordinate.axis);
+        hash = CombineContentHash(hash, value_bits);
+      }
+    }
+  }
+  return hash == 0 ? 1 : hash;
+}
+
 const sk_sp<SkTypeface>& FontSkia::GetSkTypeface() const {
   return typeface_;
 }
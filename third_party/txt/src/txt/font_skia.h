@@ -39,6 +39,8 @@ class FontSkia : public minikin::MinikinFont {
 
   const std::vector<minikin::FontVariation>& GetAxes() const override;
 
+  uint64_t GetContentHash() const override;
+
   const sk_sp<SkTypeface>& GetSkTypeface() const;
 
  private:
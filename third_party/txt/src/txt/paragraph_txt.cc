@@ -204,8 +204,10 @@ void ParagraphTxt::GlyphPosition::Shift(double delta) {
   x_pos.Shift(delta);
 }
 
-ParagraphTxt::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu)
-    : positions(std::move(p)), total_code_units(tcu) {}
+ParagraphTxt::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p,
+                                   size_t tcu,
+                                   size_t scu)
+    : positions(std::move(p)), total_code_units(tcu), start_code_unit(scu) {}
 
 ParagraphTxt::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
                                        Range<size_t> cu,
@@ -257,31 +259,43 @@ bool ParagraphTxt::ComputeLineBreaks() {
   line_widths_.clear();
   max_intrinsic_width_ = 0;
 
-  std::vector<size_t> newline_positions;
-  // Discover and add all hard breaks.
-  for (size_t i = 0; i < text_.size(); ++i) {
-    ULineBreak ulb = static_cast<ULineBreak>(
-        u_getIntPropertyValue(text_[i], UCHAR_LINE_BREAK));
-    if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
-      newline_positions.push_back(i);
+  // The hard breaks and the widths of the characters don't depend on the
+  // layout width. They are only measured if the text or its styles changed
+  // since the last layout.
+  const bool measure = !line_break_measurements_valid_;
+  if (measure) {
+    newline_positions_.clear();
+    char_widths_.assign(text_.size(), 0);
+    block_widths_.clear();
+
+    // Discover and add all hard breaks.
+    for (size_t i = 0; i < text_.size(); ++i) {
+      ULineBreak ulb = static_cast<ULineBreak>(
+          u_getIntPropertyValue(text_[i], UCHAR_LINE_BREAK));
+      if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
+        newline_positions_.push_back(i);
+    }
+    // Break at the end of the paragraph.
+    newline_positions_.push_back(text_.size());
   }
-  // Break at the end of the paragraph.
-  newline_positions.push_back(text_.size());
 
   // Calculate and add any breaks due to a line being too long.
   size_t run_index = 0;
   size_t inline_placeholder_index = 0;
-  for (size_t newline_index = 0; newline_index < newline_positions.size();
+  for (size_t newline_index = 0; newline_index < newline_positions_.size();
        ++newline_index) {
     size_t block_start =
-        (newline_index > 0) ? newline_positions[newline_index - 1] + 1 : 0;
-    size_t block_end = newline_positions[newline_index];
+        (newline_index > 0) ? newline_positions_[newline_index - 1] + 1 : 0;
+    size_t block_end = newline_positions_[newline_index];
     size_t block_size = block_end - block_start;
 
     if (block_size == 0) {
       line_metrics_.emplace_back(block_start, block_end, block_end,
                                  block_end + 1, true);
       line_widths_.push_back(0);
+      if (measure) {
+        block_widths_.push_back(0);
+      }
       continue;
     }
 
@@ -295,6 +309,10 @@ bool ParagraphTxt::ComputeLineBreaks() {
     memcpy(breaker_.buffer(), text_.data() + block_start,
            block_size * sizeof(text_[0]));
     breaker_.setText();
+    if (!measure) {
+      memcpy(breaker_.charWidths(), char_widths_.data() + block_start,
+             block_size * sizeof(char_widths_[0]));
+    }
 
     // Add the runs that include this line to the LineBreaker.
     double block_total_width = 0;
@@ -344,17 +362,27 @@ bool ParagraphTxt::ComputeLineBreaks() {
         breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
                              isRtl);
         inline_placeholder_index++;
-      } else {
+      } else if (measure) {
         // Is a regular text run.
         double run_width = breaker_.addStyleRun(&paint, collection, font,
                                                 run_start, run_end, isRtl);
         block_total_width += run_width;
+      } else {
+        breaker_.addMeasuredStyleRun(&paint, collection, font, run_start,
+                                     run_end, isRtl);
       }
 
       if (run.end > block_end)
         break;
       run_index++;
     }
+    if (measure) {
+      memcpy(char_widths_.data() + block_start, breaker_.charWidths(),
+             block_size * sizeof(char_widths_[0]));
+      block_widths_.push_back(block_total_width);
+    } else {
+      block_total_width = block_widths_[newline_index];
+    }
     max_intrinsic_width_ = std::max(max_intrinsic_width_, block_total_width);
 
     size_t breaks_count = breaker_.computeBreaks();
@@ -381,6 +409,81 @@ bool ParagraphTxt::ComputeLineBreaks() {
     breaker_.finish();
   }
 
+  line_break_measurements_valid_ = true;
+  return true;
+}
+
+bool ParagraphTxt::IsSingleLineFastPathEligible() const {
+  if (!single_line_fast_path_enabled_ || text_.empty() || runs_.size() != 1 ||
+      !inline_placeholders_.empty() ||
+      paragraph_style_.text_direction != TextDirection::ltr ||
+      paragraph_style_.text_align == TextAlign::justify)
+    return false;
+  StyledRuns::Run run = runs_.GetRun(0);
+  if (run.start != 0 || run.end != text_.size())
+    return false;
+  // Printable characters of the Basic Latin, Latin-1 Supplement and Latin
+  // Extended blocks. Each is either strong left to right or neutral, and none
+  // is a hard break. The soft hyphen is left to the full path.
+  for (uint16_t c : text_) {
+    if (c < 0x20 || (c > 0x7E && c < 0xA0) || c == 0xAD || c > 0x24F)
+      return false;
+  }
+  return true;
+}
+
+bool ParagraphTxt::ComputeSingleLine(std::vector<BidiRun>* result) {
+  if (!IsSingleLineFastPathEligible())
+    return false;
+
+  StyledRuns::Run run = runs_.GetRun(0);
+  if (!line_break_measurements_valid_) {
+    minikin::FontStyle font;
+    minikin::MinikinPaint paint;
+    GetFontAndMinikinPaint(run.style, &font, &paint);
+    std::shared_ptr<minikin::FontCollection> collection =
+        GetMinikinFontCollectionForStyle(run.style);
+    if (collection == nullptr)
+      return false;
+
+    // Shape the text once, as Layout() shapes a line holding all of it. The
+    // advances are the ones the line breaker would measure, and if the text
+    // fits the shaped run is reused for the line.
+    auto shaped_run = std::make_unique<minikin::Layout>();
+    shaped_run->doLayout(text_.data(), 0, text_.size(), text_.size(), false,
+                         font, paint, collection);
+    newline_positions_.assign(1, text_.size());
+    char_widths_.resize(text_.size());
+    shaped_run->getAdvances(char_widths_.data());
+    block_widths_.assign(1, shaped_run->getAdvance());
+    shaped_runs_[ShapedRunKey(0, text_.size(), &run.style, false)] =
+        std::move(shaped_run);
+    // The measurements are also valid for ComputeLineBreaks() if the text
+    // does not fit.
+    line_break_measurements_valid_ = true;
+  }
+
+  // Sum the advances as the line breaker does, so that the text fits exactly
+  // when ComputeLineBreaks() would keep it on one line.
+  double text_width = 0;
+  double line_width = 0;
+  size_t end_excluding_whitespace = 0;
+  for (size_t i = 0; i < text_.size(); ++i) {
+    text_width += char_widths_[i];
+    if (!minikin::isLineEndSpace(text_[i])) {
+      line_width = text_width;
+      end_excluding_whitespace = i + 1;
+    }
+  }
+  if (line_width > width_)
+    return false;
+
+  line_metrics_.clear();
+  line_metrics_.emplace_back(0, text_.size(), end_excluding_whitespace,
+                             text_.size(), true);
+  line_widths_.assign(1, static_cast<float>(line_width));
+  max_intrinsic_width_ = std::max(0.0, block_widths_[0]);
+  result->emplace_back(0, text_.size(), TextDirection::ltr, run.style);
   return true;
 }
 
@@ -667,6 +770,12 @@ void ParagraphTxt::Layout(double width) {
 
   width_ = rounded_width;
 
+  // Anything measured or shaped by earlier layouts is only reused if the
+  // text, its styles and the fonts are unchanged.
+  if (needs_layout_) {
+    line_break_measurements_valid_ = false;
+    shaped_runs_.clear();
+  }
   needs_layout_ = false;
 
   records_.clear();
@@ -677,19 +786,27 @@ void ParagraphTxt::Layout(double width) {
   min_left_ = FLT_MAX;
   final_line_count_ = 0;
 
-  if (!ComputeLineBreaks())
-    return;
-
+  // A short label is typically a single line of Latin text, which does not
+  // need the line breaker or the bidi algorithm.
   std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
-    return;
+  if (!ComputeSingleLine(&bidi_runs)) {
+    if (!ComputeLineBreaks())
+      return;
+    if (!ComputeBidiRuns(&bidi_runs))
+      return;
+  }
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
   font.setSubpixel(true);
   font.setHinting(SkFontHinting::kSlight);
 
-  minikin::Layout layout;
+  // Runs shaped by the previous layout are moved to shaped_runs_ as they are
+  // reused, the rest are dropped at the end of this layout.
+  std::map<ShapedRunKey, std::unique_ptr<minikin::Layout>>
+      previous_shaped_runs;
+  previous_shaped_runs.swap(shaped_runs_);
+
   SkTextBlobBuilder builder;
   double y_offset = 0;
   double prev_max_descent = 0;
@@ -825,16 +942,16 @@ void ParagraphTxt::Layout(double width) {
           line_run_it == line_runs.end() - 1 &&
           (line_number == line_limit - 1 ||
            paragraph_style_.unlimited_lines())) {
-        float ellipsis_width = layout.measureText(
+        float ellipsis_width = minikin::Layout::measureText(
             reinterpret_cast<const uint16_t*>(ellipsis.data()), 0,
             ellipsis.length(), ellipsis.length(), run.is_rtl(), minikin_font,
             minikin_paint, minikin_font_collection, nullptr);
 
         std::vector<float> text_advances(text_count);
-        float text_width =
-            layout.measureText(text_ptr, text_start, text_count, text_.size(),
-                               run.is_rtl(), minikin_font, minikin_paint,
-                               minikin_font_collection, text_advances.data());
+        float text_width = minikin::Layout::measureText(
+            text_ptr, text_start, text_count, text_.size(), run.is_rtl(),
+            minikin_font, minikin_paint, minikin_font_collection,
+            text_advances.data());
 
         // Truncate characters from the text until the ellipsis fits.
         size_t truncate_count = 0;
@@ -864,8 +981,28 @@ void ParagraphTxt::Layout(double width) {
         }
       }
 
-      layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
-                      minikin_font, minikin_paint, minikin_font_collection);
+      // Shaping only depends on the run of text and its style, so a run that
+      // was already on a line in the previous layout is not shaped again.
+      // Ellipsized runs are shaped from a copy of the text and never reused.
+      std::unique_ptr<minikin::Layout> shaped_run;
+      ShapedRunKey shaped_run_key(run.start(), run.end(), &run.style(),
+                                  run.is_rtl());
+      if (ellipsized_text.empty()) {
+        auto it = previous_shaped_runs.find(shaped_run_key);
+        if (it != previous_shaped_runs.end()) {
+          shaped_run = std::move(it->second);
+        }
+      }
+      if (!shaped_run) {
+        shaped_run = std::make_unique<minikin::Layout>();
+        shaped_run->doLayout(text_ptr, text_start, text_count, text_size,
+                             run.is_rtl(), minikin_font, minikin_paint,
+                             minikin_font_collection);
+      }
+      const minikin::Layout& layout = *shaped_run;
+      if (ellipsized_text.empty()) {
+        shaped_runs_[shaped_run_key] = std::move(shaped_run);
+      }
 
       if (layout.nGlyphs() == 0)
         continue;
@@ -1096,8 +1233,13 @@ void ParagraphTxt::Layout(double width) {
     size_t next_line_start = (line_number < line_metrics_.size() - 1)
                                  ? line_metrics_[line_number + 1].start_index
                                  : text_.size();
+    size_t line_start_code_unit =
+        glyph_lines_.empty() ? 0
+                             : glyph_lines_.back().start_code_unit +
+                                   glyph_lines_.back().total_code_units;
     glyph_lines_.emplace_back(std::move(line_glyph_positions),
-                              next_line_start - line_metrics.start_index);
+                              next_line_start - line_metrics.start_index,
+                              line_start_code_unit);
     code_unit_runs_.insert(code_unit_runs_.end(), line_code_unit_runs.begin(),
                            line_code_unit_runs.end());
     inline_placeholder_code_unit_runs_.insert(
@@ -1657,8 +1799,24 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
   size_t min_line = INT_MAX;
   size_t glyph_length = 0;
 
+  // Skip the runs that end before the range. Only the last of them can be on
+  // a line whose newline is in the range, so it's the only one that needs its
+  // newline x position.
+  auto first_run = std::partition_point(
+      code_unit_runs_.begin(), code_unit_runs_.end(),
+      [start](const CodeUnitRun& run) { return run.code_units.end <= start; });
+  if (first_run != code_unit_runs_.begin()) {
+    const CodeUnitRun& run = *(first_run - 1);
+    if (run.code_units.start < end) {
+      newline_x_positions[run.line_number] = run.direction == TextDirection::ltr
+                                                 ? run.x_pos.end
+                                                 : run.x_pos.start;
+    }
+  }
+
   // Generate initial boxes and calculate metrics.
-  for (const CodeUnitRun& run : code_unit_runs_) {
+  for (auto run_it = first_run; run_it != code_unit_runs_.end(); ++run_it) {
+    const CodeUnitRun& run = *run_it;
     // Check to see if we are finished.
     if (run.code_units.start >= end)
       break;
@@ -1727,7 +1885,13 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
 
   // Add empty rectangles representing any newline characters within the
   // range.
-  for (size_t line_number = 0; line_number < line_metrics_.size();
+  size_t first_line =
+      std::partition_point(line_metrics_.begin(), line_metrics_.end(),
+                           [start](const LineMetrics& line) {
+                             return line.end_including_newline <= start;
+                           }) -
+      line_metrics_.begin();
+  for (size_t line_number = first_line; line_number < line_metrics_.size();
        ++line_number) {
     LineMetrics& line = line_metrics_[line_number];
     if (line.start_index >= end)
@@ -1857,64 +2021,62 @@ Paragraph::PositionWithAffinity ParagraphTxt::GetGlyphPositionAtCoordinate(
   if (final_line_count_ <= 0)
     return PositionWithAffinity(0, DOWNSTREAM);
 
-  size_t y_index;
-  for (y_index = 0; y_index < final_line_count_ - 1; ++y_index) {
-    if (dy < line_metrics_[y_index].height)
-      break;
-  }
-
-  const std::vector<GlyphPosition>& line_glyph_position =
-      glyph_lines_[y_index].positions;
+  // The height of a line is the sum of its height and the heights of the lines
+  // above it, so the first line whose height is past dy holds it.
+  size_t y_index =
+      std::upper_bound(line_metrics_.begin(),
+                       line_metrics_.begin() + final_line_count_ - 1, dy,
+                       [](double y, const LineMetrics& line) {
+                         return y < line.height;
+                       }) -
+      line_metrics_.begin();
+
+  const GlyphLine& glyph_line = glyph_lines_[y_index];
+  const std::vector<GlyphPosition>& line_glyph_position = glyph_line.positions;
   if (line_glyph_position.empty()) {
-    int line_start_index =
-        std::accumulate(glyph_lines_.begin(), glyph_lines_.begin() + y_index, 0,
-                        [](const int a, const GlyphLine& b) {
-                          return a + static_cast<int>(b.total_code_units);
-                        });
-    return PositionWithAffinity(line_start_index, DOWNSTREAM);
+    return PositionWithAffinity(glyph_line.start_code_unit, DOWNSTREAM);
   }
 
-  size_t x_index;
-  const GlyphPosition* gp = nullptr;
-  const GlyphPosition* gp_cluster = nullptr;
-  bool is_cluster_corection = false;
-  for (x_index = 0; x_index < line_glyph_position.size(); ++x_index) {
-    double glyph_end = (x_index < line_glyph_position.size() - 1)
-                           ? line_glyph_position[x_index + 1].x_pos.start
-                           : line_glyph_position[x_index].x_pos.end;
-    if (gp_cluster == nullptr ||
-        gp_cluster->cluster != line_glyph_position[x_index].cluster) {
-      gp_cluster = &line_glyph_position[x_index];
-    }
-    if (dx < glyph_end) {
-      // Check if the glyph position is part of a cluster. If it is,
-      // we assign the cluster's root GlyphPosition to represent it.
-      if (gp_cluster->cluster == line_glyph_position[x_index].cluster) {
-        gp = gp_cluster;
-        // Detect if the matching GlyphPosition was non-root for the cluster.
-        if (gp_cluster != &line_glyph_position[x_index]) {
-          is_cluster_corection = true;
-        }
-      } else {
-        gp = &line_glyph_position[x_index];
-      }
-      break;
-    }
-  }
-
-  if (gp == nullptr) {
+  // Each glyph ends where the next one starts, and the last one at its own
+  // end. Since the glyphs are sorted by x, the glyph at dx is the one before
+  // the first glyph that starts past dx.
+  size_t x_index =
+      std::upper_bound(line_glyph_position.begin() + 1,
+                       line_glyph_position.end(), dx,
+                       [](double x, const GlyphPosition& next) {
+                         return x < next.x_pos.start;
+                       }) -
+      line_glyph_position.begin() - 1;
+  if (x_index == line_glyph_position.size() - 1 &&
+      !(dx < line_glyph_position.back().x_pos.end)) {
     const GlyphPosition& last_glyph = line_glyph_position.back();
     return PositionWithAffinity(last_glyph.code_units.end, UPSTREAM);
   }
 
-  // Find the direction of the run that contains this glyph.
+  // Check if the glyph position is part of a cluster. If it is, we assign the
+  // cluster's root GlyphPosition to represent it.
+  size_t cluster_index = x_index;
+  while (cluster_index > 0 &&
+         line_glyph_position[cluster_index - 1].cluster ==
+             line_glyph_position[x_index].cluster) {
+    cluster_index--;
+  }
+  const GlyphPosition* gp = &line_glyph_position[cluster_index];
+  // Detect if the matching GlyphPosition was non-root for the cluster.
+  bool is_cluster_corection = cluster_index != x_index;
+
+  // Find the direction of the run that contains this glyph. Only the last run
+  // starting at or before the glyph can contain it.
   TextDirection direction = TextDirection::ltr;
-  for (const CodeUnitRun& run : code_unit_runs_) {
-    if (gp->code_units.start >= run.code_units.start &&
-        gp->code_units.end <= run.code_units.end) {
-      direction = run.direction;
-      break;
-    }
+  auto run_it = std::upper_bound(
+      code_unit_runs_.begin(), code_unit_runs_.end(), gp->code_units.start,
+      [](size_t code_unit, const CodeUnitRun& run) {
+        return code_unit < run.code_units.start;
+      });
+  if (run_it != code_unit_runs_.begin()) {
+    --run_it;
+    if (gp->code_units.end <= run_it->code_units.end)
+      direction = run_it->direction;
   }
 
   double glyph_center = (gp->x_pos.start + gp->x_pos.end) / 2;
@@ -2010,6 +2172,11 @@ void ParagraphTxt::SetDirty(bool dirty) {
   needs_layout_ = dirty;
 }
 
+void ParagraphTxt::SetSingleLineFastPathEnabled(bool enabled) {
+  single_line_fast_path_enabled_ = enabled;
+  needs_layout_ = true;
+}
+
 std::vector<LineMetrics>& ParagraphTxt::GetLineMetrics() {
   FML_DCHECK(!needs_layout_) << "only valid after layout";
   return line_metrics_;
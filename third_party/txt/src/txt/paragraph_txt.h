@@ -17,7 +17,10 @@
 #ifndef LIB_TXT_SRC_PARAGRAPH_TXT_H_
 #define LIB_TXT_SRC_PARAGRAPH_TXT_H_
 
+#include <map>
+#include <memory>
 #include <set>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -25,6 +28,7 @@
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
 #include "line_metrics.h"
+#include "minikin/Layout.h"
 #include "minikin/LineBreaker.h"
 #include "paint_record.h"
 #include "paragraph.h"
@@ -71,6 +75,10 @@ class ParagraphTxt : public Paragraph {
   // number of characters. However, this is not significant for reasonably sized
   // paragraphs. It is currently recommended to break up very long paragraphs
   // (10k+ characters) to ensure speedy layout.
+  //
+  // Laying out the paragraph again with only a different width reuses the
+  // character widths and shaped runs of the previous layout, and only breaks
+  // the text into lines and positions the glyphs again.
   virtual void Layout(double width) override;
 
   virtual void Paint(SkCanvas* canvas, double x, double y) override;
@@ -122,10 +130,17 @@ class ParagraphTxt : public Paragraph {
   std::vector<LineMetrics>& GetLineMetrics() override;
 
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
-  // be performed when this is set to true. Can also be used to prevent a new
-  // Layout from being calculated by setting to false.
+  // be performed when this is set to true, discarding any measurements cached
+  // by previous layouts. Can also be used to prevent a new Layout from being
+  // calculated by setting to false.
   void SetDirty(bool dirty = true);
 
+  // Enables the fast path of Layout() for a single line of Latin text in one
+  // style, which skips the line breaker and the bidi algorithm. It lays out
+  // the text exactly as the full path does, and is only disabled to compare
+  // the two in tests and benchmarks.
+  void SetSingleLineFastPathEnabled(bool enabled);
+
  private:
   friend class ParagraphBuilderTxt;
   FRIEND_TEST(ParagraphTest, SimpleParagraph);
@@ -153,6 +168,7 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST_LINUX_ONLY(ParagraphTest, EmojiMultiLineRectsParagraph);
   FRIEND_TEST(ParagraphTest, HyphenBreakParagraph);
   FRIEND_TEST(ParagraphTest, RepeatLayoutParagraph);
+  FRIEND_TEST(ParagraphTest, SingleLineFastPathMatchesFullPath);
   FRIEND_TEST(ParagraphTest, Ellipsize);
   FRIEND_TEST(ParagraphTest, UnderlineShiftParagraph);
   FRIEND_TEST(ParagraphTest, WavyDecorationParagraph);
@@ -279,8 +295,10 @@ class ParagraphTxt : public Paragraph {
     // Glyph positions sorted by x coordinate.
     const std::vector<GlyphPosition> positions;
     const size_t total_code_units;
+    // The sum of the total code units of the lines before this one.
+    const size_t start_code_unit;
 
-    GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu);
+    GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu, size_t scu);
   };
 
   struct CodeUnitRun {
@@ -310,7 +328,9 @@ class ParagraphTxt : public Paragraph {
   std::vector<GlyphLine> glyph_lines_;
 
   // Holds the positions of each range of code units in the text.
-  // Sorted in code unit index order.
+  // Sorted in code unit index order. The runs of a line either cover the same
+  // range, when a bidi run is split by typeface, or don't overlap, so their
+  // ends are sorted too.
   std::vector<CodeUnitRun> code_unit_runs_;
   // Holds the positions of the inline placeholders.
   std::vector<CodeUnitRun> inline_placeholder_code_unit_runs_;
@@ -326,6 +346,24 @@ class ParagraphTxt : public Paragraph {
 
   bool needs_layout_ = true;
 
+  bool single_line_fast_path_enabled_ = true;
+
+  // Measurements of the text made by ComputeLineBreaks() that don't depend on
+  // the layout width. They are reused when only the width changes.
+  bool line_break_measurements_valid_ = false;
+  // Indexes of the hard line breaks, followed by the end of the text.
+  std::vector<size_t> newline_positions_;
+  // The advance of each code unit of the text.
+  std::vector<float> char_widths_;
+  // The width of each block of text between hard line breaks.
+  std::vector<double> block_widths_;
+
+  // Runs of text shaped by the most recent Layout(), keyed by their code unit
+  // range, style and direction. Lines that are unchanged when the width
+  // changes reuse them instead of shaping the text again.
+  using ShapedRunKey = std::tuple<size_t, size_t, const TextStyle*, bool>;
+  std::map<ShapedRunKey, std::unique_ptr<minikin::Layout>> shaped_runs_;
+
   struct WaveCoordinates {
     double x_start;
     double y_start;
@@ -354,6 +392,16 @@ class ParagraphTxt : public Paragraph {
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
 
+  // Whether the text is a single style run of printable Latin characters in a
+  // left to right paragraph that isn't justified, without placeholders. Such
+  // text has no hard breaks and is a single left to right bidi run.
+  bool IsSingleLineFastPathEligible() const;
+
+  // Stands in for ComputeLineBreaks() and ComputeBidiRuns() when the text is
+  // eligible for the fast path and fits on one line. Returns false if the
+  // full path must be used instead.
+  bool ComputeSingleLine(std::vector<BidiRun>* result);
+
   // Calculates and populates strut based on paragraph_style_ strut info.
   void ComputeStrut(StrutMetrics* strut, SkFont& font);
 
@@ -0,0 +1,95 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <minikin/BreakIteratorPool.h>
+#include <minikin/WordBreaker.h>
+#include <unicode/unistr.h>
+
+namespace minikin {
+
+TEST(BreakIteratorPoolTest, ReusesReleasedIterators) {
+  auto iterator = BreakIteratorPool::acquire(icu::Locale::getUS());
+  ASSERT_NE(iterator, nullptr);
+  icu::BreakIterator* released = iterator.get();
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(iterator));
+
+  iterator = BreakIteratorPool::acquire(icu::Locale::getUS());
+  EXPECT_EQ(iterator.get(), released);
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(iterator));
+}
+
+TEST(BreakIteratorPoolTest, IteratorsAreNotSharedAcrossLocales) {
+  auto us = BreakIteratorPool::acquire(icu::Locale::getUS());
+  auto other_us = BreakIteratorPool::acquire(icu::Locale::getUS());
+  ASSERT_NE(us, nullptr);
+  ASSERT_NE(other_us, nullptr);
+  EXPECT_NE(us.get(), other_us.get());
+
+  icu::BreakIterator* japanese = nullptr;
+  {
+    auto iterator = BreakIteratorPool::acquire(icu::Locale::getJapanese());
+    ASSERT_NE(iterator, nullptr);
+    japanese = iterator.get();
+    BreakIteratorPool::release(icu::Locale::getJapanese(), std::move(iterator));
+  }
+  auto third_us = BreakIteratorPool::acquire(icu::Locale::getUS());
+  EXPECT_NE(third_us.get(), japanese);
+
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(us));
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(other_us));
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(third_us));
+}
+
+TEST(BreakIteratorPoolTest, ReusedIteratorsBreakNewText) {
+  icu::UnicodeString first("hello world");
+  auto iterator = BreakIteratorPool::acquire(icu::Locale::getUS());
+  ASSERT_NE(iterator, nullptr);
+  iterator->setText(first);
+  EXPECT_EQ(iterator->following(0), 6);
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(iterator));
+
+  icu::UnicodeString second("a bc");
+  iterator = BreakIteratorPool::acquire(icu::Locale::getUS());
+  iterator->setText(second);
+  EXPECT_EQ(iterator->first(), 0);
+  EXPECT_EQ(iterator->next(), 2);
+  EXPECT_EQ(iterator->next(), 4);
+  EXPECT_EQ(iterator->next(), icu::BreakIterator::DONE);
+  BreakIteratorPool::release(icu::Locale::getUS(), std::move(iterator));
+}
+
+TEST(BreakIteratorPoolTest, WordBreakersOnManyThreadsShareThePool) {
+  const uint16_t text[] = {'h', 'e', 'l', 'l', 'o', ' ',
+                           'w', 'o', 'r', 'l', 'd'};
+  const size_t text_size = sizeof(text) / sizeof(text[0]);
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4, 0);
+  for (size_t i = 0; i < failures.size(); i++) {
+    threads.emplace_back([&text, &failures, i]() {
+      WordBreaker breaker;
+      breaker.setLocale(icu::Locale::getUS());
+      for (int j = 0; j < 100; j++) {
+        breaker.setText(text, text_size);
+        if (breaker.next() != 6 ||
+            breaker.next() != static_cast<ssize_t>(text_size)) {
+          failures[i]++;
+        }
+        breaker.finish();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int thread_failures : failures) {
+    EXPECT_EQ(thread_failures, 0);
+  }
+}
+
+}  // namespace minikin
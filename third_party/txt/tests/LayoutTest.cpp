@@ -16,6 +16,9 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+#include <vector>
+
 #include "../util/FontTestUtils.h"
 #include "../util/UnicodeUtils.h"
 #include "ICUTestBase.h"
@@ -426,6 +429,51 @@ TEST_F(LayoutTest, hyphenationTest) {
   }
 }
 
+TEST_F(LayoutTest, cacheStaysWithinByteBudget) {
+  Layout::purgeCaches();
+  Layout::setCacheMaxBytes(16 * 1024);
+  MinikinPaint paint;
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<uint16_t> text = utf8ToUtf16("word" + std::to_string(i));
+    Layout layout;
+    layout.doLayout(text.data(), 0, text.size(), text.size(), kBidi_LTR,
+                    FontStyle(), paint, mCollection);
+  }
+  EXPECT_GT(Layout::getCacheBytes(), 0u);
+  EXPECT_LE(Layout::getCacheBytes(), 16u * 1024);
+
+  Layout::purgeCaches();
+  EXPECT_EQ(0u, Layout::getCacheBytes());
+  Layout::setCacheMaxBytes(4 * 1024 * 1024);
+}
+
+TEST_F(LayoutTest, concurrentLayoutMatchesSerialLayout) {
+  std::vector<uint16_t> text = utf8ToUtf16("the quick brown fox jumps");
+  MinikinPaint paint;
+  Layout expected;
+  expected.doLayout(text.data(), 0, text.size(), text.size(), kBidi_LTR,
+                    FontStyle(), paint, mCollection);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 100; ++i) {
+        if (i % 10 == 0) {
+          Layout::purgeCaches();
+        }
+        Layout layout;
+        layout.doLayout(text.data(), 0, text.size(), text.size(), kBidi_LTR,
+                        FontStyle(), paint, mCollection);
+        EXPECT_EQ(expected.getAdvance(), layout.getAdvance());
+        EXPECT_EQ(expected.nGlyphs(), layout.nGlyphs());
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 // TODO: Add more test cases, e.g. measure text, letter spacing.
 
 }  // namespace minikin
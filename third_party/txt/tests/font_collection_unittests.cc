@@ -14,10 +14,15 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <cstdlib>
+
 #include "flutter/fml/logging.h"
 #include "gtest/gtest.h"
+#include "minikin/FontFamily.h"
 #include "third_party/skia/include/utils/SkCustomTypeface.h"
 #include "txt/font_collection.h"
+#include "txt/font_skia.h"
 #include "txt_test_utils.h"
 
 namespace txt {
@@ -63,6 +68,57 @@ void PopulateUserTypefaceBoilerplate(SkCustomTypefaceBuilder* builder) {
     builder->setGlyph(index, width / upem, path.makeTransform(scale));
   }
 }
+
+// A FontSkia that counts how many times the cmap table of its typeface is
+// read.
+class CmapCountingFont : public FontSkia {
+ public:
+  CmapCountingFont(sk_sp<SkTypeface> typeface, std::atomic<int>* cmap_reads)
+      : FontSkia(std::move(typeface)), cmap_reads_(cmap_reads) {}
+
+  hb_face_t* CreateHarfBuzzFace() const override {
+    return hb_face_create_for_tables(
+        GetTable, new TableContext{GetSkTypeface(), cmap_reads_},
+        [](void* context) { delete static_cast<TableContext*>(context); });
+  }
+
+ private:
+  struct TableContext {
+    sk_sp<SkTypeface> typeface;
+    std::atomic<int>* cmap_reads;
+  };
+
+  static hb_blob_t* GetTable(hb_face_t* face, hb_tag_t tag, void* context) {
+    TableContext* table_context = static_cast<TableContext*>(context);
+    if (tag == HB_TAG('c', 'm', 'a', 'p')) {
+      (*table_context->cmap_reads)++;
+    }
+    const size_t table_size = table_context->typeface->getTableSize(tag);
+    if (table_size == 0)
+      return nullptr;
+    void* buffer = malloc(table_size);
+    if (buffer == nullptr)
+      return nullptr;
+    if (table_context->typeface->getTableData(tag, 0, table_size, buffer) !=
+        table_size) {
+      free(buffer);
+      return nullptr;
+    }
+    return hb_blob_create(reinterpret_cast<char*>(buffer), table_size,
+                          HB_MEMORY_MODE_WRITABLE, buffer, free);
+  }
+
+  std::atomic<int>* cmap_reads_;
+};
+
+std::vector<minikin::FontCollection::Run> Itemize(
+    const minikin::FontCollection& collection,
+    const std::u16string& text) {
+  std::vector<minikin::FontCollection::Run> runs;
+  collection.itemize(reinterpret_cast<const uint16_t*>(text.data()),
+                     text.length(), minikin::FontStyle(), &runs);
+  return runs;
+}
 }  // namespace
 
 TEST(FontCollectionTest, CheckSkTypefacesSorting) {
@@ -138,6 +194,115 @@ TEST(FontCollectionTest, CheckSkTypefacesSorting) {
             SkFontStyle::kExpanded_Width);
 }
 
+TEST(FontCollectionTest, FontFamiliesAreSharedByCollections) {
+  std::shared_ptr<FontCollection> collection = GetTestFontCollection();
+  auto roboto = collection->GetMinikinFontCollectionForFamilies(
+      std::vector<std::string>{"Roboto"}, "");
+  auto roboto_and_apple = collection->GetMinikinFontCollectionForFamilies(
+      std::vector<std::string>{"Roboto", "Homemade Apple"}, "");
+  ASSERT_NE(roboto, nullptr);
+  ASSERT_NE(roboto_and_apple, nullptr);
+  ASSERT_NE(roboto->getFontAtIndex(0), nullptr);
+  EXPECT_EQ(roboto->getFontAtIndex(0), roboto_and_apple->getFontAtIndex(0));
+
+  collection->ClearFontFamilyCache();
+  auto reloaded = collection->GetMinikinFontCollectionForFamilies(
+      std::vector<std::string>{"Roboto"}, "");
+  EXPECT_NE(reloaded->getFontAtIndex(0), roboto->getFontAtIndex(0));
+}
+
+TEST(FontCollectionTest, PersistentStoreRestoresFontCoverage) {
+  const std::u16string text = u"Coverage read back from the store";
+  const std::vector<std::string> families{"Roboto", "Homemade Apple"};
+
+  auto store = std::make_shared<InMemoryStore>();
+  minikin::FontFamily::setPersistentStore(store);
+
+  auto parsed =
+      GetTestFontCollection()->GetMinikinFontCollectionForFamilies(families,
+                                                                   "");
+  ASSERT_NE(parsed, nullptr);
+  std::vector<minikin::FontCollection::Run> parsed_runs =
+      Itemize(*parsed, text);
+  const size_t entry_count = store->GetEntryCount();
+  EXPECT_GT(entry_count, 0u);
+  EXPECT_EQ(store->GetHitCount(), 0u);
+
+  // A new collection creates new families, as a new run of the process would.
+  auto restored =
+      GetTestFontCollection()->GetMinikinFontCollectionForFamilies(families,
+                                                                   "");
+  ASSERT_NE(restored, nullptr);
+  std::vector<minikin::FontCollection::Run> restored_runs =
+      Itemize(*restored, text);
+  minikin::FontFamily::setPersistentStore(nullptr);
+  EXPECT_EQ(store->GetHitCount(), entry_count);
+  EXPECT_EQ(store->GetEntryCount(), entry_count);
+
+  ASSERT_EQ(restored_runs.size(), parsed_runs.size());
+  for (size_t i = 0; i < restored_runs.size(); i++) {
+    EXPECT_EQ(restored_runs[i].start, parsed_runs[i].start);
+    EXPECT_EQ(restored_runs[i].end, parsed_runs[i].end);
+    EXPECT_EQ(restored->getFontIndex(restored_runs[i].fakedFont.font),
+              parsed->getFontIndex(parsed_runs[i].fakedFont.font));
+  }
+}
+
+TEST(FontCollectionTest, FontFamilyReadsTheCmapOnlyWhenNotStored) {
+  sk_sp<SkTypeface> typeface = SkTypeface::MakeFromFile(
+      (GetFontDir() + "/Roboto-Regular.ttf").c_str());
+  ASSERT_NE(typeface, nullptr);
+  std::atomic<int> cmap_reads(0);
+  auto make_family = [&typeface, &cmap_reads]() {
+    std::vector<minikin::Font> fonts;
+    fonts.push_back(minikin::Font(
+        std::make_shared<CmapCountingFont>(typeface, &cmap_reads),
+        minikin::FontStyle()));
+    return std::make_shared<minikin::FontFamily>(std::move(fonts));
+  };
+
+  auto store = std::make_shared<InMemoryStore>();
+  minikin::FontFamily::setPersistentStore(store);
+  auto parsed = make_family();
+  EXPECT_EQ(cmap_reads, 0);
+  EXPECT_TRUE(parsed->getCoverage().get('R'));
+  EXPECT_EQ(cmap_reads, 1);
+
+  // A family for the same font data is built from the stored coverage.
+  auto restored = make_family();
+  EXPECT_TRUE(restored->getCoverage().get('R'));
+  minikin::FontFamily::setPersistentStore(nullptr);
+  EXPECT_EQ(cmap_reads, 1);
+  EXPECT_EQ(store->GetHitCount(), 1u);
+  EXPECT_EQ(restored->hasVSTable(), parsed->hasVSTable());
+
+  make_family()->getCoverage();
+  EXPECT_EQ(cmap_reads, 2);
+}
+
+TEST(FontCollectionTest, CollectionReadsTheCmapOnFirstLookup) {
+  sk_sp<SkTypeface> typeface = SkTypeface::MakeFromFile(
+      (GetFontDir() + "/Roboto-Regular.ttf").c_str());
+  ASSERT_NE(typeface, nullptr);
+  std::atomic<int> cmap_reads(0);
+  std::vector<minikin::Font> fonts;
+  fonts.push_back(
+      minikin::Font(std::make_shared<CmapCountingFont>(typeface, &cmap_reads),
+                    minikin::FontStyle()));
+  minikin::FontCollection collection(
+      std::make_shared<minikin::FontFamily>(std::move(fonts)));
+  EXPECT_EQ(cmap_reads, 0);
+
+  std::vector<minikin::FontCollection::Run> runs =
+      Itemize(collection, u"Roboto");
+  EXPECT_EQ(cmap_reads, 1);
+  ASSERT_EQ(runs.size(), 1u);
+  EXPECT_EQ(collection.getFontIndex(runs[0].fakedFont.font), 0);
+
+  Itemize(collection, u"Roboto");
+  EXPECT_EQ(cmap_reads, 1);
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
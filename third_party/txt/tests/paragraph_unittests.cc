@@ -18,6 +18,7 @@
 #include <iostream>
 
 #include "flutter/fml/logging.h"
+#include "minikin/Layout.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -5378,6 +5379,255 @@ TEST_F(ParagraphTest, RepeatLayoutParagraph) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, RelayoutAtNewWidthMatchesFreshLayout) {
+  const char* text =
+      "Sentence to layout at diff widths to get diff line counts. short words "
+      "short words short words short words short words short words short words "
+      "short words short words short words short words short words short words "
+      "end";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = TextAlign::center;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 31;
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+
+  for (double width : {300.0, 600.0, 250.0, 300.0, 1000.0}) {
+    txt::ParagraphBuilderTxt fresh_builder(paragraph_style,
+                                           GetTestFontCollection());
+    fresh_builder.PushStyle(text_style);
+    fresh_builder.AddText(u16_text);
+    fresh_builder.Pop();
+    auto fresh = BuildParagraph(fresh_builder);
+    fresh->Layout(width);
+
+    paragraph->Layout(width);
+    ASSERT_EQ(paragraph->GetLineCount(), fresh->GetLineCount());
+    EXPECT_EQ(paragraph->GetHeight(), fresh->GetHeight());
+    EXPECT_EQ(paragraph->GetLongestLine(), fresh->GetLongestLine());
+    EXPECT_EQ(paragraph->GetMaxIntrinsicWidth(),
+              fresh->GetMaxIntrinsicWidth());
+    EXPECT_EQ(paragraph->GetMinIntrinsicWidth(),
+              fresh->GetMinIntrinsicWidth());
+    for (size_t i = 0; i < paragraph->GetLineCount(); i++) {
+      EXPECT_EQ(paragraph->GetLineMetrics()[i].end_index,
+                fresh->GetLineMetrics()[i].end_index);
+      EXPECT_EQ(paragraph->GetLineMetrics()[i].left,
+                fresh->GetLineMetrics()[i].left);
+    }
+
+    std::vector<txt::Paragraph::TextBox> boxes = paragraph->GetRectsForRange(
+        0, u16_text.length(), Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    std::vector<txt::Paragraph::TextBox> fresh_boxes = fresh->GetRectsForRange(
+        0, u16_text.length(), Paragraph::RectHeightStyle::kTight,
+        Paragraph::RectWidthStyle::kTight);
+    ASSERT_EQ(boxes.size(), fresh_boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) {
+      EXPECT_EQ(boxes[i].rect, fresh_boxes[i].rect);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, SingleLineFastPathMatchesFullPath) {
+  const char* texts[] = {"Hello World", "Trailing spaces   ",
+                         "Café crème brûlée"};
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 26;
+  text_style.letter_spacing = 1;
+  text_style.color = SK_ColorBLACK;
+
+  for (const char* text : texts) {
+    auto icu_text = icu::UnicodeString::fromUTF8(text);
+    std::u16string u16_text(icu_text.getBuffer(),
+                            icu_text.getBuffer() + icu_text.length());
+    for (TextAlign align :
+         {TextAlign::left, TextAlign::center, TextAlign::right}) {
+      txt::ParagraphStyle paragraph_style;
+      paragraph_style.text_align = align;
+      txt::ParagraphBuilderTxt fast_builder(paragraph_style,
+                                            GetTestFontCollection());
+      fast_builder.PushStyle(text_style);
+      fast_builder.AddText(u16_text);
+      fast_builder.Pop();
+      auto fast = BuildParagraph(fast_builder);
+      ASSERT_TRUE(fast->IsSingleLineFastPathEligible());
+
+      txt::ParagraphBuilderTxt full_builder(paragraph_style,
+                                            GetTestFontCollection());
+      full_builder.PushStyle(text_style);
+      full_builder.AddText(u16_text);
+      full_builder.Pop();
+      auto full = BuildParagraph(full_builder);
+      full->SetSingleLineFastPathEnabled(false);
+
+      // The narrow width does not fit the text, which then takes the full
+      // path after being measured by the fast path.
+      for (double width : {1000.0, 300.0, 60.0, 300.0}) {
+        fast->Layout(width);
+        full->Layout(width);
+        ASSERT_EQ(fast->GetLineCount(), full->GetLineCount());
+        EXPECT_EQ(fast->GetHeight(), full->GetHeight());
+        EXPECT_EQ(fast->GetLongestLine(), full->GetLongestLine());
+        EXPECT_EQ(fast->GetMaxIntrinsicWidth(), full->GetMaxIntrinsicWidth());
+        EXPECT_EQ(fast->GetMinIntrinsicWidth(), full->GetMinIntrinsicWidth());
+        for (size_t i = 0; i < fast->GetLineCount(); i++) {
+          const LineMetrics& fast_line = fast->GetLineMetrics()[i];
+          const LineMetrics& full_line = full->GetLineMetrics()[i];
+          EXPECT_EQ(fast_line.end_index, full_line.end_index);
+          EXPECT_EQ(fast_line.end_excluding_whitespace,
+                    full_line.end_excluding_whitespace);
+          EXPECT_EQ(fast_line.width, full_line.width);
+          EXPECT_EQ(fast_line.left, full_line.left);
+        }
+        ASSERT_EQ(fast->records_.size(), full->records_.size());
+        for (size_t i = 0; i < fast->records_.size(); i++) {
+          EXPECT_EQ(fast->records_[i].offset(), full->records_[i].offset());
+        }
+
+        std::vector<txt::Paragraph::TextBox> fast_boxes =
+            fast->GetRectsForRange(0, u16_text.length(),
+                                   Paragraph::RectHeightStyle::kMax,
+                                   Paragraph::RectWidthStyle::kTight);
+        std::vector<txt::Paragraph::TextBox> full_boxes =
+            full->GetRectsForRange(0, u16_text.length(),
+                                   Paragraph::RectHeightStyle::kMax,
+                                   Paragraph::RectWidthStyle::kTight);
+        ASSERT_EQ(fast_boxes.size(), full_boxes.size());
+        for (size_t i = 0; i < fast_boxes.size(); i++) {
+          EXPECT_EQ(fast_boxes[i].rect, full_boxes[i].rect);
+        }
+        for (double dx = 0; dx < width; dx += 7) {
+          EXPECT_EQ(fast->GetGlyphPositionAtCoordinate(dx, 5).position,
+                    full->GetGlyphPositionAtCoordinate(dx, 5).position);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(ParagraphTest, GlyphPositionAtCenterOfEachCodeUnitRect) {
+  const char* text =
+      "Hit testing uses a binary search over lines and glyphs.\n\nShort "
+      "line\nA longer line of text that wraps around at the layout width.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = TextAlign::center;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 24;
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  ASSERT_GT(paragraph->GetLineCount(), 4ull);
+
+  for (size_t i = 0; i < u16_text.length(); i++) {
+    std::vector<txt::Paragraph::TextBox> boxes = paragraph->GetRectsForRange(
+        i, i + 1, Paragraph::RectHeightStyle::kMax,
+        Paragraph::RectWidthStyle::kTight);
+    if (u16_text[i] == '\n') {
+      // Newlines are empty boxes.
+      for (const txt::Paragraph::TextBox& box : boxes) {
+        EXPECT_EQ(box.rect.width(), 0);
+      }
+      continue;
+    }
+    // Spaces may be trailing whitespace that isn't part of the line.
+    if (u16_text[i] == ' ')
+      continue;
+    ASSERT_EQ(boxes.size(), 1ull);
+    const SkRect& rect = boxes[0].rect;
+    if (rect.width() == 0)
+      continue;
+    // The left half of a glyph is before it, and the right half after it.
+    double left_half = rect.left() + 0.25 * rect.width();
+    double right_half = rect.left() + 0.75 * rect.width();
+    EXPECT_EQ(
+        paragraph->GetGlyphPositionAtCoordinate(left_half, rect.centerY())
+            .position,
+        i);
+    EXPECT_EQ(
+        paragraph->GetGlyphPositionAtCoordinate(right_half, rect.centerY())
+            .position,
+        i + 1);
+  }
+}
+
+TEST_F(ParagraphTest, PersistentStoreRestoresWordLayouts) {
+  const char* text = "Words shaped by an earlier run are not shaped again.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  // A size no other test uses, so that no word is in the memory cache yet.
+  text_style.font_size = 27.25;
+  text_style.color = SK_ColorBLACK;
+
+  auto store = std::make_shared<InMemoryStore>();
+  minikin::Layout::setPersistentStore(store);
+
+  txt::ParagraphBuilderTxt shaped_builder(paragraph_style,
+                                          GetTestFontCollection());
+  shaped_builder.PushStyle(text_style);
+  shaped_builder.AddText(u16_text);
+  shaped_builder.Pop();
+  auto shaped = BuildParagraph(shaped_builder);
+  shaped->Layout(200);
+  const size_t entry_count = store->GetEntryCount();
+  EXPECT_GT(entry_count, 0u);
+  EXPECT_EQ(store->GetHitCount(), 0u);
+
+  // As in a new run of the process, nothing but the store knows the words.
+  minikin::Layout::purgeCaches();
+  txt::ParagraphBuilderTxt restored_builder(paragraph_style,
+                                            GetTestFontCollection());
+  restored_builder.PushStyle(text_style);
+  restored_builder.AddText(u16_text);
+  restored_builder.Pop();
+  auto restored = BuildParagraph(restored_builder);
+  restored->Layout(200);
+  minikin::Layout::setPersistentStore(nullptr);
+
+  EXPECT_GT(store->GetHitCount(), 0u);
+  EXPECT_EQ(store->GetEntryCount(), entry_count);
+  ASSERT_EQ(restored->GetLineCount(), shaped->GetLineCount());
+  EXPECT_EQ(restored->GetMaxIntrinsicWidth(), shaped->GetMaxIntrinsicWidth());
+  for (size_t i = 0; i < u16_text.length(); i++) {
+    std::vector<txt::Paragraph::TextBox> restored_boxes =
+        restored->GetRectsForRange(i, i + 1, Paragraph::RectHeightStyle::kMax,
+                                   Paragraph::RectWidthStyle::kTight);
+    std::vector<txt::Paragraph::TextBox> shaped_boxes =
+        shaped->GetRectsForRange(i, i + 1, Paragraph::RectHeightStyle::kMax,
+                                 Paragraph::RectWidthStyle::kTight);
+    ASSERT_EQ(restored_boxes.size(), shaped_boxes.size());
+    for (size_t j = 0; j < restored_boxes.size(); j++) {
+      EXPECT_EQ(restored_boxes[j].rect, shaped_boxes[j].rect);
+    }
+  }
+}
+
 TEST_F(ParagraphTest, Ellipsize) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
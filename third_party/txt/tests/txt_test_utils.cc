@@ -127,4 +127,29 @@ std::unique_ptr<ParagraphTxt> BuildParagraph(
       static_cast<txt::ParagraphTxt*>(builder.Build().release()));
 }
 
+bool InMemoryStore::load(const std::string& key, std::string* value) {
+  std::scoped_lock lock(mutex_);
+  auto found = entries_.find(key);
+  if (found == entries_.end())
+    return false;
+  *value = found->second;
+  hits_++;
+  return true;
+}
+
+void InMemoryStore::store(std::string key, std::string value) {
+  std::scoped_lock lock(mutex_);
+  entries_[std::move(key)] = std::move(value);
+}
+
+size_t InMemoryStore::GetEntryCount() {
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+size_t InMemoryStore::GetHitCount() {
+  std::scoped_lock lock(mutex_);
+  return hits_;
+}
+
 }  // namespace txt
@@ -14,9 +14,12 @@
  * limitations under the License.
  */
 
+#include <map>
+#include <mutex>
 #include <string>
 
 #include "flutter/fml/command_line.h"
+#include "minikin/PersistentStore.h"
 #include "txt/font_collection.h"
 #include "txt/paragraph_builder_txt.h"
 #include "txt/paragraph_txt.h"
@@ -35,4 +38,22 @@ std::shared_ptr<FontCollection> GetTestFontCollection();
 
 std::unique_ptr<ParagraphTxt> BuildParagraph(ParagraphBuilderTxt& builder);
 
+// Keeps the entries of a minikin::PersistentStore in memory.
+class InMemoryStore : public minikin::PersistentStore {
+ public:
+  bool load(const std::string& key, std::string* value) override;
+
+  void store(std::string key, std::string value) override;
+
+  size_t GetEntryCount();
+
+  // The number of loads that found an entry.
+  size_t GetHitCount();
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::string> entries_;
+  size_t hits_ = 0;
+};
+
 }  // namespace txt